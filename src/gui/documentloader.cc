@@ -0,0 +1,142 @@
+/*
+ * PDFedit - free program for PDF document manipulation.
+ * Copyright (C) 2006-2009  PDFedit team: Michal Hocko,
+ *                                        Jozef Misutka,
+ *                                        Martin Petricek
+ *                   Former team members: Miroslav Jahoda
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program (in doc/LICENSE.GPL); if not, write to the 
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, 
+ * MA  02111-1307  USA
+ *
+ * Project is hosted on http://sourceforge.net/projects/pdfedit
+ */
+/** @file
+ DocumentLoader - thread opening PDF document in background
+*/
+#include "documentloader.h"
+#include "pdfutil.h"
+#include "util.h"
+#include <QtCore/QObject>
+#include <utils/debug.h>
+
+namespace gui {
+
+using namespace std;
+
+/**
+ Constructor of progress forwarder
+ @param _loader Loader thread which will emit the progress
+*/
+DocumentLoader::Progress::Progress(DocumentLoader *_loader) {
+ loader=_loader;
+}
+
+/**
+ Called by kernel when new loading stage starts
+ @param stage Stage of loading
+ @param total Number of steps in stage (unused, count of revisions and pages is not known in advance)
+*/
+void DocumentLoader::Progress::stage(Stage stage,__attribute__((unused)) size_t total) {
+ switch(stage) {
+  case OpenStage:	stageName=QObject::tr("Reading cross reference table"); break;
+  case RevisionsStage:	stageName=QObject::tr("Collecting revisions"); break;
+  case PagesStage:	stageName=QObject::tr("Counting pages"); break;
+  case DoneStage:	stageName=QObject::tr("Document loaded"); break;
+  default:		stageName=QString::null;
+ }
+ emit loader->progress(stageName);
+}
+
+/**
+ Called by kernel when one step of current stage is done
+ @param step Number of steps done
+*/
+void DocumentLoader::Progress::step(size_t step) {
+ emit loader->progress(stageName+" ("+QString::number(step)+")");
+}
+
+/**
+ Constructor of DocumentLoader.
+ The thread is not started yet, call start() to load the document.
+ @param _fileName Name of file to open
+ @param _mode Mode in which the document should be opened
+ @param parent parent object
+*/
+DocumentLoader::DocumentLoader(const QString &_fileName,CPdf::OpenMode _mode,QObject *parent/*=0*/) : QThread(parent), loadProgress(this) {
+ fileName=_fileName;
+ mode=_mode;
+ wasCanceled=false;
+}
+
+/** destructor - waits for the loading to finish */
+DocumentLoader::~DocumentLoader() {
+ loadProgress.cancel();
+ wait();
+}
+
+/**
+ Cancel the loading. Loading thread will stop in short time and
+ no document will be loaded.
+*/
+void DocumentLoader::cancel() {
+ loadProgress.cancel();
+}
+
+/**
+ Return loaded document. Must be called only after the thread has finished.
+ @return loaded document or NULL pointer if loading failed
+*/
+boost::shared_ptr<CPdf> DocumentLoader::document() {
+ return pdf;
+}
+
+/**
+ Return error message of failed loading. Must be called only after the thread has finished.
+ @return error message or null string if there was no error
+*/
+QString DocumentLoader::error() {
+ return errorMessage;
+}
+
+/**
+ Check if the loading was canceled. Must be called only after the thread has finished.
+ @return true if canceled
+*/
+bool DocumentLoader::canceled() {
+ return wasCanceled;
+}
+
+/** Body of loading thread */
+void DocumentLoader::run() {
+ try {
+  guiPrintDbg(debug::DBG_DBG,"Loading document in background");
+  pdf=util::openPdfWithFallback(fileName,mode,&loadProgress);
+  //Load first page dictionary in advance too, so it will be ready for page view
+  if (!pdf->needsCredentials() && pdf->getPageCount()>0) pdf->getFirstPage();
+ } catch (LoadCanceledException &) {
+  guiPrintDbg(debug::DBG_INFO,"Loading canceled");
+  pdf.reset();
+  wasCanceled=true;
+ } catch (PdfOpenException &ex) {
+  string err;
+  ex.getMessage(err);
+  pdf.reset();
+  errorMessage=util::convertToUnicode(err,util::UTF8);
+ } catch (...) {
+  pdf.reset();
+  errorMessage=QObject::tr("Unknown error");
+ }
+}
+
+} // namespace gui
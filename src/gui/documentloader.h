@@ -0,0 +1,94 @@
+/*
+ * PDFedit - free program for PDF document manipulation.
+ * Copyright (C) 2006-2009  PDFedit team: Michal Hocko,
+ *                                        Jozef Misutka,
+ *                                        Martin Petricek
+ *                   Former team members: Miroslav Jahoda
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program (in doc/LICENSE.GPL); if not, write to the 
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, 
+ * MA  02111-1307  USA
+ *
+ * Project is hosted on http://sourceforge.net/projects/pdfedit
+ */
+#ifndef __DOCUMENTLOADER_H__
+#define __DOCUMENTLOADER_H__
+
+#include <QtCore/QThread>
+#include <QtCore/QString>
+#include <boost/shared_ptr.hpp>
+#include <kernel/cpdf.h>
+#include <kernel/loadprogress.h>
+
+namespace gui {
+
+using namespace pdfobjects;
+
+/**
+ Thread opening PDF document in background.<br>
+ Document is opened (with fallback to read-only mode, see util::openPdfWithFallback)
+ by the kernel, which reports progress of loading stages to this class.
+ The progress is sent out in progress() signal, which is delivered to
+ receivers in GUI thread as queued signal, so the GUI stays responsive.
+ The loading may be canceled at any time by cancel() slot.<br>
+ The document must not be used until the thread has finished.
+ \brief Background loader of PDF documents
+*/
+class DocumentLoader : public QThread {
+Q_OBJECT
+public:
+ DocumentLoader(const QString &_fileName,CPdf::OpenMode _mode,QObject *parent=0);
+ ~DocumentLoader();
+ boost::shared_ptr<CPdf> document();
+ QString error();
+ bool canceled();
+public slots:
+ void cancel();
+signals:
+ /**
+  Signal emitted from loading thread when loading progresses
+  @param message Description of current loading stage
+ */
+ void progress(const QString &message);
+protected:
+ virtual void run();
+private:
+ /** LoadProgress forwarding kernel notifications to progress() signal */
+ class Progress : public LoadProgress {
+ public:
+  Progress(DocumentLoader *_loader);
+  virtual void stage(Stage stage,size_t total);
+  virtual void step(size_t step);
+ private:
+  /** Loader emitting the signal */
+  DocumentLoader *loader;
+  /** Description of current stage */
+  QString stageName;
+ };
+ /** Name of file to open */
+ QString fileName;
+ /** Requested mode */
+ CPdf::OpenMode mode;
+ /** Progress given to kernel */
+ Progress loadProgress;
+ /** Loaded document (NULL until loaded) */
+ boost::shared_ptr<CPdf> pdf;
+ /** Error message if loading failed */
+ QString errorMessage;
+ /** True if the loading was canceled */
+ bool wasCanceled;
+};
+
+} // namespace gui
+
+#endif
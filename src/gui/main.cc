@@ -221,6 +221,9 @@ int main(int argc, char *argv[]){
    return 1;
  }
 
+ //debug messages are written by a background thread so that GUI doesn't wait for the output
+ debug::startAsyncLog();
+
  //parse commandline parameters
  /*
   Whole name of one parameter should not be prefix of another parameter, as unpredictable behaviour can occur,
@@ -25,9 +25,11 @@
 
 #include <stdlib.h>
 #include <QtGui/QPixmap>
+#include <QtCore/QThread>
 #include <assert.h>
 
 #include "util.h"
+#include "settings.h"
 #include "utils/debug.h"
 #include "kernel/pdfoperators.h"
 
@@ -209,6 +211,9 @@ void PageViewS::setPixmap (const QRect & r) {
 	_splashMakeRGB8(paperColor, 0xff, 0xff, 0xff);
 	QOutputDevPixmap output ( paperColor );
 
+	// rasterize large pages in bands on all cores
+	output.setRenderThreads( globalSettings->readNum( "gui/PageSpace/RenderThreads", QThread::idealThreadCount() ) );
+
 	// create pixmap for page
 	// if width or height is 0 then change because call displayPage do segmentation fault in xpdf code
 	actualPage->displayPage( output, displayParams, r.left(), r.top(), (r.width() != 0) ? r.width() : 1, (r.height() != 0) ? r.height() : 1 );
@@ -161,8 +161,8 @@ HEADERS += treeitemref.h  treeitemarray.h  treeitemsimple.h  treeitemdict.h  tre
 SOURCES += treeitemref.cc treeitemarray.cc treeitemsimple.cc treeitemdict.cc treeitempage.cc
 HEADERS += treeitemcstream.h  treeitempdf.h  treeitem.h  treeitemcontentstream.h
 SOURCES += treeitemcstream.cc treeitempdf.cc treeitem.cc treeitemcontentstream.cc
-HEADERS += treeitempdfoperator.h  treeitemoperatorcontainer.h  treeitemoutline.h
-SOURCES += treeitempdfoperator.cc treeitemoperatorcontainer.cc treeitemoutline.cc
+HEADERS += treeitempdfoperator.h  treeitemoperatorcontainer.h  treeitemoperatorrange.h  treeitemoutline.h
+SOURCES += treeitempdfoperator.cc treeitemoperatorcontainer.cc treeitemoperatorrange.cc treeitemoutline.cc
 HEADERS += treeitemannotation.h  treeitemannotationcontainer.h  
 SOURCES += treeitemannotation.cc treeitemannotationcontainer.cc
 
@@ -202,8 +202,8 @@ SOURCES += revisiontool.cc colortool.cc zoomtool.cc pagetool.cc toolbutton.cc to
 SOURCES += edittool.cc numbertool.cc selecttool.cc
 
 # Main Window
-HEADERS += pdfeditwindow.h  commandwindow.h  pagespace.h  pageviewS.h  statusbar.h  progressbar.h
-SOURCES += pdfeditwindow.cc commandwindow.cc pagespace.cc pageviewS.cc statusbar.cc progressbar.cc
+HEADERS += pdfeditwindow.h  commandwindow.h  pagespace.h  pageviewS.h  statusbar.h  progressbar.h  documentloader.h
+SOURCES += pdfeditwindow.cc commandwindow.cc pagespace.cc pageviewS.cc statusbar.cc progressbar.cc documentloader.cc
 
 # Commandline mode
 HEADERS += consolewindow.h
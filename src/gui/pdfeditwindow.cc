@@ -31,6 +31,7 @@
 #include "basegui.h"
 #include "commandwindow.h"
 #include "dialog.h"
+#include "documentloader.h"
 #include "menu.h"
 #include "multitreewindow.h"
 #include "pagespace.h"
@@ -48,10 +49,12 @@
 #include "version.h"
 #include <iostream>
 #include <QtWidgets/QApplication>
+#include <QtCore/QEventLoop>
 #include <QtCore/QFile>
 #include <QtGui/QFont>
 #include <QtWidgets/QMenuBar>
 #include <QtWidgets/QMessageBox>
+#include <QtWidgets/QProgressDialog>
 #include <QtWidgets/QPushButton>
 #include <QtCore/QRegExp>
 #include <QtWidgets/QSplitter>
@@ -806,6 +809,35 @@ void PdfEditWindow::destroyFile() {
  setFileName(QString::null);
 }
 
+/**
+ Load document in background thread (see DocumentLoader).<br>
+ Modal progress dialog allowing to cancel the loading is shown right away, so the
+ GUI is kept responsive while loading, but the user can't work with the window
+ (and the document being replaced) until the loading is done.
+ @param name Name of file to open
+ @param mode Mode in which the document should be opened
+ @return Loaded document or NULL pointer if the loading was canceled
+ @throw PdfOpenException if the document can't be opened
+*/
+boost::shared_ptr<CPdf> PdfEditWindow::loadDocument(const QString &name,CPdf::OpenMode mode) {
+ DocumentLoader loader(name,mode);
+ QProgressDialog progressDialog(tr("Loading document")+" "+name,tr("&Cancel"),0,0,this);
+ progressDialog.setWindowModality(Qt::WindowModal);
+ //Showing the dialog later would let the input through until then
+ progressDialog.setMinimumDuration(0);
+ progressDialog.show();
+ QEventLoop loop;
+ //Signals from loader are emitted in the loading thread, so they are queued
+ connect(&loader,SIGNAL(progress(const QString&)),&progressDialog,SLOT(setLabelText(const QString&)));
+ connect(&progressDialog,SIGNAL(canceled()),&loader,SLOT(cancel()));
+ connect(&loader,SIGNAL(finished()),&loop,SLOT(quit()));
+ loader.start();
+ loop.exec();
+ loader.wait();
+ if (!loader.error().isNull()) throw PdfOpenException(util::convertFromUnicode(loader.error(),util::UTF8));
+ return loader.document();
+}
+
 /**
  Open file in editor.
  @param name Name of file to open
@@ -821,8 +853,15 @@ bool PdfEditWindow::openFile(const QString &name, bool askPassword/*=true*/) {
  CPdf::OpenMode mode=globalSettings->readBool("mode/advanced")?(CPdf::Advanced):(CPdf::ReadWrite);
  try {
   guiPrintDbg(debug::DBG_DBG,"Opening document");
-  document=getPdfInstance(this,name,mode,askPassword);
-  if (askPassword && document->needsCredentials()) {
+  document=loadDocument(name,mode);
+  if (!document) {
+   //User canceled the loading
+   base->setError(tr("Loading of document canceled")+" : "+name);
+   emptyFile();
+   base->call("onLoadError");
+   return false;
+  }
+  if (askPassword && !util::askPdfPassword(this,document,name)) {
    //User failed to enter correct password when asked.
    //resets document instance to force closing
    document.reset();
@@ -141,6 +141,7 @@ private:
  void setFileName(const QString &name);
  void destroyFile();
  void emptyFile();
+ boost::shared_ptr<CPdf> loadDocument(const QString &name,CPdf::OpenMode mode);
  /** Progress observer which holds progress bar.
   * Value is initialized in constructor. Wrapped qt progress bar
   * instance is allocated in constructor but deallocating by
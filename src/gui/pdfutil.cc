@@ -448,13 +448,17 @@ QString annotTypeName(boost::shared_ptr<CAnnotation> anot) {
  If the file cannot be opened, exception is thrown
  @param filename Name of file for CPdf::getInstance
  @param mode Open mode for CPdf::getInstance
+ @param progress Loading progress for CPdf::getInstance (may be NULL)
  @return Opened PDF
 */
-boost::shared_ptr<CPdf> openPdfWithFallback(const QString &filename, CPdf::OpenMode mode) {
+boost::shared_ptr<CPdf> openPdfWithFallback(const QString &filename, CPdf::OpenMode mode, LoadProgress *progress/*=NULL*/) {
  boost::shared_ptr<CPdf> pdf;
  do {
   try {
-   pdf = CPdf::getInstance(util::convertFromUnicode(filename,util::NAME).c_str(),mode);
+   pdf = CPdf::getInstance(util::convertFromUnicode(filename,util::NAME).c_str(),mode,progress);
+  } catch(LoadCanceledException &) {
+   // canceled by user, no fallback
+   throw;
   } catch(PdfOpenException &e) {
    // try to fallback to readonly mode
    if (mode >= CPdf::ReadWrite) {
@@ -477,19 +481,29 @@ boost::shared_ptr<CPdf> openPdfWithFallback(const QString &filename, CPdf::OpenM
 */
 boost::shared_ptr<CPdf> getPdfInstance(QWidget *parent, const QString &filename, CPdf::OpenMode mode, bool askPassword) {
  boost::shared_ptr<CPdf> pdf=openPdfWithFallback(filename,mode);
- if (askPassword && pdf->needsCredentials()) {
-  for(;;) {
-   //Ask for password until we either get the right one or user gets bored with retrying
-   QString pwd=gui::PasswordDialog::ask(parent,QObject::tr("Enter password for %1:").arg(filename));
+ if (askPassword) askPdfPassword(parent,pdf,filename);
+ return pdf;
+}
+
+/**
+ Ask user for password of opened PDF document, if the document needs it
+ @param parent parent widget of the dialog
+ @param pdf CPdf instance
+ @param filename Name of the document (shown in dialog)
+ @return true if the document does not need password (anymore), false if user gave up
+*/
+bool askPdfPassword(QWidget *parent, boost::shared_ptr<CPdf> pdf, const QString &filename) {
+ if (!pdf->needsCredentials()) return true;
+ for(;;) {
+  //Ask for password until we either get the right one or user gets bored with retrying
+  QString pwd=gui::PasswordDialog::ask(parent,QObject::tr("Enter password for %1:").arg(filename));
 
-   //Dialog aborted -> exit
-   if (pwd.isNull()) return pdf;
+  //Dialog aborted -> exit
+  if (pwd.isNull()) return false;
 
-   //We succedded with passwod -> exit
-   if (setPdfPassword(pdf,pwd)) return pdf;
-  }
+  //We succedded with passwod -> exit
+  if (setPdfPassword(pdf,pwd)) return true;
  }
- return pdf;
 }
 
 /**
@@ -31,6 +31,7 @@
 #include <kernel/cobject.h>
 #include <kernel/cpdf.h>
 #include <kernel/iproperty.h>
+#include <kernel/loadprogress.h>
 class QString;
 class QWidget;
 
@@ -59,10 +60,11 @@ QString propertyPreview(boost::shared_ptr<IProperty> obj);
 QString annotType(CAnnotation::AnnotType at);
 QString annotType(boost::shared_ptr<CAnnotation> anot);
 QString annotTypeName(boost::shared_ptr<CAnnotation> anot);
-boost::shared_ptr<CPdf> openPdfWithFallback(const QString &filename, CPdf::OpenMode mode);
+boost::shared_ptr<CPdf> openPdfWithFallback(const QString &filename, CPdf::OpenMode mode, LoadProgress *progress=NULL);
 
 //Password-related functions
 boost::shared_ptr<CPdf> getPdfInstance(QWidget *parent, const QString &filename, CPdf::OpenMode mode, bool askPassword=true);
+bool askPdfPassword(QWidget *parent, boost::shared_ptr<CPdf> pdf, const QString &filename);
 bool setPdfPassword(boost::shared_ptr<CPdf> pdf, const QString &pass);
 
 } // namespace util
@@ -204,6 +204,79 @@ void QSContentStream::saveChange() {
  }
 }
 
+/**
+ Delete range of operators from content stream
+ \see CContentStream::deleteOperators
+ @param first First operator to delete
+ @param last Last operator to delete
+ @return number of deleted operators
+*/
+int QSContentStream::deleteOperators(QSPdfOperator *first,QSPdfOperator *last) {
+ //First check for validity
+ if (!opValid(first,true)) return 0;
+ if (!opValid(last,true)) return 0;
+ try {
+  return obj->deleteOperators(first->get(),last->get());
+ } catch (ReadOnlyDocumentException &e) {
+  base->errorException("ContentStream","deleteOperators",QObject::tr("Document is read-only"));
+ }
+ return 0;
+}
+
+/**
+ \copydoc deleteOperators(QSPdfOperator*,QSPdfOperator*)
+ QSA bugfixed version
+*/
+int QSContentStream::deleteOperators(QObject *first,QObject *last) {
+ QSPdfOperator* qfirst=qobject_cast<QSPdfOperator*>(first,"deleteOperators",1,"PdfOperator");
+ QSPdfOperator* qlast=qobject_cast<QSPdfOperator*>(last,"deleteOperators",2,"PdfOperator");
+ if (!(qfirst && qlast)) return 0;
+ return deleteOperators((QSPdfOperator*)qfirst,(QSPdfOperator*)qlast);
+}
+
+/**
+ Replace all operators with given name
+ \see CContentStream::replaceOperators
+ @param name Name of operators to replace
+ @param newOp Operator to put (copied) in place of each of them
+ @return number of replaced operators
+*/
+int QSContentStream::replaceOperators(const QString &name,QSPdfOperator *newOp) {
+ if (!opValid(newOp)) return 0;
+ try {
+  return obj->replaceOperators(util::convertFromUnicode(name,util::PDF),newOp->get());
+ } catch (ReadOnlyDocumentException &e) {
+  base->errorException("ContentStream","replaceOperators",QObject::tr("Document is read-only"));
+ }
+ return 0;
+}
+
+/**
+ \copydoc replaceOperators(const QString&,QSPdfOperator*)
+ QSA bugfixed version
+*/
+int QSContentStream::replaceOperators(const QString &name,QObject *newOp) {
+ QSPdfOperator* qopNew=qobject_cast<QSPdfOperator*>(newOp,"replaceOperators",2,"PdfOperator");
+ if (!qopNew) return 0;
+ return replaceOperators(name,(QSPdfOperator*)qopNew);
+}
+
+/**
+ Replace text in all text operators of content stream
+ \see CContentStream::replaceText
+ @param what text to replace
+ @param with replacement
+ @return number of changed operators
+*/
+int QSContentStream::replaceText(const QString &what,const QString &with) {
+ try {
+  return obj->replaceText(util::convertFromUnicode(what,util::PDF),util::convertFromUnicode(with,util::PDF));
+ } catch (ReadOnlyDocumentException &e) {
+  base->errorException("ContentStream","replaceText",QObject::tr("Document is read-only"));
+ }
+ return 0;
+}
+
 /**
  Return first operator in this contentstream.
  @return If not contains any operator, return NULL.
@@ -72,6 +72,26 @@ public slots:
  void replace(QObject* oldOp,QObject* newOp,bool indicateChange=true);
  /*- Write any unwritten changes to operators to underlying stream. */
  void saveChange();
+ /*-
+  Delete all operators from operator first to operator last (both inclusive) in this content stream.
+  Changes are written to underlying stream once, after all operators are deleted.
+  Return number of deleted operators.
+ */
+ int deleteOperators(QSPdfOperator *first,QSPdfOperator *last);
+ int deleteOperators(QObject *first,QObject *last);
+ /*-
+  Replace every operator with given name in this content stream by a copy of operator newOp.
+  Changes are written to underlying stream once, after all operators are replaced.
+  Return number of replaced operators.
+ */
+ int replaceOperators(const QString &name,QSPdfOperator *newOp);
+ int replaceOperators(const QString &name,QObject *newOp);
+ /*-
+  Replace all occurences of text "what" with "with" in all text operators of this content stream.
+  Changes are written to underlying stream once.
+  Return number of changed text operators.
+ */
+ int replaceText(const QString &what,const QString &with);
  /*-
   Return first operator in this contentstream.
   If not contains any operator, return NULL.
@@ -239,6 +239,22 @@ QString QSPage::getText() {
  return QString::fromUtf8(text.c_str());
 }
 
+/**
+ Replace text in all text operators of the page
+ \see CPage::replaceText
+ @param what text to replace
+ @param with replacement
+ @return number of changed operators
+*/
+int QSPage::replaceText(const QString &what,const QString &with) {
+ try {
+  return obj->replaceText(convertFromUnicode(what,PDF),convertFromUnicode(with,PDF));
+ } catch (ReadOnlyDocumentException &e) {
+  base->errorException("Page","replaceText",QObject::tr("Document is read-only"));
+ }
+ return 0;
+}
+
 /**
  Return stream with given number from page.
  Get the streams from CPage and store for later use if necessary
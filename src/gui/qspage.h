@@ -141,6 +141,12 @@ public slots:
  QSDict* getDictionary();
  /*- Return text representation of this page */
  QString getText();
+ /*-
+  Replace all occurences of text "what" with "with" in all text operators of this page.
+  Each content stream is written and reparsed only once.
+  Return number of changed text operators.
+ */
+ int replaceText(const QString &what,const QString &with);
  /*-
   Return media box of this page as array (x1,y1,x2,y2).
   The mediabox is a rectangle from (x1,y1) to (x2,y2)
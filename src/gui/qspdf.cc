@@ -36,6 +36,7 @@
 #include "qsdict.h"
 #include <kernel/cobject.h>
 #include <kernel/cpdf.h>
+#include <kernel/cpage.h>
 #include "util.h"
 
 namespace gui {
@@ -209,6 +210,34 @@ void QSPdf::removePage(int position) {
  }
 }
 
+/**
+ Replace text in text operators of range of pages.
+ Pages are processed in kernel, without creating wrappers for them.
+ \see CPage::replaceText
+ @param what text to replace
+ @param with replacement
+ @param firstPage First page to process
+ @param lastPage Last page to process (last page of document if smaller than 1)
+ @return number of changed operators
+*/
+int QSPdf::replaceText(const QString &what,const QString &with,int firstPage/*=1*/,int lastPage/*=0*/) {
+ if (nullPtr(obj,"replaceText")) return 0;
+ std::string _what=util::convertFromUnicode(what,util::PDF);
+ std::string _with=util::convertFromUnicode(with,util::PDF);
+ if (lastPage<1) lastPage=obj->getPageCount();
+ int replaced=0;
+ try {
+  for (int i=firstPage;i<=lastPage;i++) {
+   replaced+=obj->getPage(i)->replaceText(_what,_with);
+  }
+ } catch (ReadOnlyDocumentException &e) {
+  base->errorException("Pdf","replaceText",QObject::tr("Document is read-only"));
+ } catch (PageNotFoundException &e) {
+  base->errorException("Pdf","replaceText",tr("Page not found"));
+ }
+ return replaced;
+}
+
 /**
  Return position of given page
  \see CPdf::getPagePosition
@@ -127,6 +127,13 @@ public slots:
  /*- Return true, if there is previous page in document for given page. */
  bool hasPrevPage(QSPage* page);
  bool hasPrevPage(QObject* page);
+ /*-
+  Replace all occurences of text "what" with "with" in all text operators
+  of pages firstPage to lastPage (all pages by default, lastPage smaller than 1 means the last page).
+  Each content stream is written and reparsed only once.
+  Return number of changed text operators.
+ */
+ int replaceText(const QString &what,const QString &with,int firstPage=1,int lastPage=0);
  /*- Return number of available revisions in document */
  int getRevisionsCount();
  /*- Return number of currently active revisions */
@@ -70,7 +70,7 @@ public:
  virtual void deleteChild(Q_ListViewItem *target);
  void eraseItems();
  void moveAllChildsFrom(TreeItemAbstract* src);
- Q_ListViewItem* child(const QString &name);
+ virtual Q_ListViewItem* child(const QString &name);
  virtual QSCObject* getQSObject(BaseCore *_base);
  virtual void setOpen(bool open);
  virtual bool deepReload(const QString &childName,Q_ListViewItem *oldItem);
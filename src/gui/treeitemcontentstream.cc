@@ -33,6 +33,7 @@
 #include "treedata.h"
 #include "treeitempage.h"
 #include "treeitempdfoperator.h"
+#include "treeitemoperatorrange.h"
 #include "util.h"
 #include <kernel/ccontentstream.h>
 
@@ -77,6 +78,8 @@ TreeItemContentStream::TreeItemContentStream(TreeData *_data,Q_ListViewItem *par
  */
 void TreeItemContentStream::init(const QString &name) {
  mode=All;
+ topShown.assign(1,0);
+ changeKnown=false;
  if (name.isNull()) {
   setText(0,QObject::tr("<no name>"));
  } else {
@@ -109,6 +112,7 @@ void TreeItemContentStream::showMode() {
 */
 void TreeItemContentStream::setMode(TreeItemContentStreamMode newMode) {
  mode=newMode;
+ changeKnown=false;
  showMode();
  reload();
 }
@@ -143,20 +147,76 @@ TreeItemContentStream::~TreeItemContentStream() {
  data->multi()->deactivate(obj);
 }
 
+/**
+ Check if the operators are too many to be shown directly
+ and are shown split into ranges (see TreeItemOperatorRange)
+ @return true if children of this item are operator ranges
+*/
+bool TreeItemContentStream::grouped() {
+ return op.size()>OPERATOR_RANGE_SIZE;
+}
+
+/**
+ Return number of operators shown under this item
+ @return number of operators
+*/
+size_t TreeItemContentStream::getOperatorCount() {
+ return op.size();
+}
+
+/**
+ Return operator shown under this item
+ @param position Position of the operator (less than getOperatorCount())
+ @return operator at given position
+*/
+boost::shared_ptr<PdfOperator> TreeItemContentStream::getOperator(size_t position) {
+ assert(position<op.size());
+ return op[position];
+}
+
+/**
+ Return child item with given name.<br>
+ If the operators are split into ranges, operators can be still looked up
+ by their position, the range containing the operator is opened as necessary.
+ @param name Name of child item
+ @return child item or NULL if not found
+*/
+Q_ListViewItem* TreeItemContentStream::child(const QString &name) {
+ if (!grouped()) return TreeItemAbstract::child(name);
+ bool ok;
+ unsigned int position=name.toUInt(&ok);
+ if (!ok || position>=op.size()) return TreeItemAbstract::child(name);
+ TreeItemAbstract *range=dynamic_cast<TreeItemAbstract*>(TreeItemAbstract::child(TreeItemOperatorRange::rangeName(position/OPERATOR_RANGE_SIZE)));
+ if (!range) return NULL;
+ return range->child(name);
+}
+
 //See TreeItemAbstract for description of this virtual method
-TreeItemAbstract* TreeItemContentStream::createChild(const QString &name,__attribute__((unused)) ChildType typ,Q_ListViewItem *after/*=NULL*/) {
+TreeItemAbstract* TreeItemContentStream::createChild(const QString &name,ChildType typ,Q_ListViewItem *after/*=NULL*/) {
+ if (typ==2) { //Range of operators
+  unsigned int range=name.mid(QString("Range").length()).toUInt();
+  return new TreeItemOperatorRange(data,this,range,after,name);
+ }
  size_t position=name.toUInt();
  return new TreeItemPdfOperator(data,this,op[position],obj,name,after);
 }
 
 //See TreeItemAbstract for description of this virtual method
-ChildType TreeItemContentStream::getChildType(__attribute__((unused)) const QString &name) {
- return 1;//Just one type : PDF Operator
+ChildType TreeItemContentStream::getChildType(const QString &name) {
+ if (name.startsWith("Range")) return 2;//Range of operators
+ return 1;//PDF Operator
 }
 
 //See TreeItemAbstract for description of this virtual method
 QStringList TreeItemContentStream::getChildNames() {
- return util::countList(op.size());
+ if (!grouped()) return util::countList(op.size());
+ //Too many operators, show them in ranges
+ QStringList items;
+ unsigned int ranges=(op.size()+OPERATOR_RANGE_SIZE-1)/OPERATOR_RANGE_SIZE;
+ for(unsigned int i=0;i<ranges;i++) {
+  items+=TreeItemOperatorRange::rangeName(i);
+ }
+ return items;
 }
 
 //See TreeItemAbstract for description of this virtual method
@@ -171,33 +231,77 @@ void TreeItemContentStream::remove() {
  return;
 }
 
-//See TreeItemAbstract for description of this virtual method
-void TreeItemContentStream::reloadSelf() {
- //Iterator to filter items
- PdfOperator::Iterator *it=NULL;
- //Reload list of pdf operators
- obj->getPdfOperators(op);
- if (!op.size()) return;//Nothing in here
- if (mode==Text) {
-  // "Show only text operators" mode
-  it=new TextOperatorIterator(op[0]);
- } else if (mode==Font){
-  // "Show only font operators" mode
-  it=new FontOperatorIterator(op[0]);
- } else if (mode==Graphic){
-  // "Show only graphical operators" mode
-  it=new GraphicalOperatorIterator(op[0]);
- } else {
+/**
+ Notify the item about extent of a change of the content stream
+ (see CContentStream::OperatorsChange), so that next reload
+ has to filter only changed operators
+ @param front Number of unchanged first level operators at the front
+ @param back Number of unchanged first level operators at the back
+*/
+void TreeItemContentStream::operatorsChanged(size_t front,size_t back) {
+ if (changeKnown) { //Not reloaded since the last change
+  front=min(front,unchangedFront);
+  back=min(back,unchangedBack);
+ }
+ unchangedFront=front;
+ unchangedBack=back;
+ changeKnown=true;
+}
+
+/**
+ Append operators shown for given first level operator according to mode
+ @param oper First level operator
+ @param out Vector to which the operators are appended
+*/
+void TreeItemContentStream::filter(boost::shared_ptr<PdfOperator> oper,std::vector<boost::shared_ptr<PdfOperator> > &out) {
+ if (mode==All) {
   // "Show everything we got" mode -> no filtering is done
+  out.push_back(oper);
   return;
  }
- //We have the iterator, now clear the vector and populate it with ... something else
- op.clear();
- while (!it->isEnd()) {
-  op.push_back(it->getCurrent());
-  it->next();
+ //Walk the operator including all operators in it, if it is a composite
+ boost::shared_ptr<PdfOperator> last=getLastOperator(oper);
+ for (PdfOperator::Iterator it=PdfOperator::getIterator(oper);!it.isEnd();it.next()) {
+  boost::shared_ptr<PdfOperator> cur=it.getCurrent();
+  string name;
+  cur->getOperatorName(name);
+  if ((mode==Text && TextOperatorIterator::accepts(name))
+   || (mode==Font && FontOperatorIterator::accepts(name))
+   || (mode==Graphic && GraphicalOperatorIterator::accepts(name))) {
+   out.push_back(cur);
+  }
+  if (cur==last) break;
+ }
+}
+
+//See TreeItemAbstract for description of this virtual method
+void TreeItemContentStream::reloadSelf() {
+ //Reload list of first level pdf operators
+ vector<boost::shared_ptr<PdfOperator> > current;
+ obj->getPdfOperators(current);
+ //Only operators in between the unchanged ones have to be filtered again
+ size_t front=0,back=0;
+ if (changeKnown) {
+  front=min(unchangedFront,min(topOp.size(),current.size()));
+  back=min(unchangedBack,min(topOp.size(),current.size())-front);
+  changeKnown=false;
+ }
+ size_t oldEnd=topOp.size()-back;
+ vector<boost::shared_ptr<PdfOperator> > shown(op.begin(),op.begin()+topShown[front]);
+ vector<size_t> positions(topShown.begin(),topShown.begin()+front);
+ for (size_t i=front;i<current.size()-back;i++) {
+  positions.push_back(shown.size());
+  filter(current[i],shown);
+ }
+ //Unchanged operators at the back just move
+ size_t moved=shown.size();
+ for (size_t i=oldEnd;i<topShown.size();i++) {
+  positions.push_back(topShown[i]-topShown[oldEnd]+moved);
  }
- delete it;
+ shown.insert(shown.end(),op.begin()+topShown[oldEnd],op.end());
+ op.swap(shown);
+ topShown.swap(positions);
+ topOp.swap(current);
 }
 
 //See TreeItemAbstract for description of this virtual method
@@ -259,6 +363,8 @@ void TreeItemContentStream::uninitObserver() {
 
 //See TreeItemAbstract for description of this virtual method
 bool TreeItemContentStream::validChild(const QString &name,Q_ListViewItem *oldChild) {
+ //Ranges are always valid, they will check their operators themselves
+ if (dynamic_cast<TreeItemOperatorRange*>(oldChild)) return true;
  size_t i=name.toUInt();
  TreeItemPdfOperator *it=dynamic_cast<TreeItemPdfOperator*>(oldChild);
  assert(it);
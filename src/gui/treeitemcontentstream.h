@@ -75,7 +75,13 @@ public:
  void setMode(TreeItemContentStreamMode newMode);
  void setMode(const QString &newMode);
  QString getMode();
+ size_t getOperatorCount();
+ boost::shared_ptr<PdfOperator> getOperator(size_t position);
+ virtual Q_ListViewItem* child(const QString &name);
+ void operatorsChanged(size_t front,size_t back);
 private:
+ bool grouped();
+ void filter(boost::shared_ptr<PdfOperator> oper,std::vector<boost::shared_ptr<PdfOperator> > &out);
  void showMode();
  void initObserver();
  void uninitObserver();
@@ -83,8 +89,18 @@ private:
  void init(const QString &name);
  /**  ContentStream object held in this item */
  boost::shared_ptr<CContentStream> obj;
- /** Vector with pdf operators */
+ /** Vector with pdf operators (already filtered according to mode) */
  std::vector<boost::shared_ptr<PdfOperator> > op;
+ /** First level operators of the content stream at the time of last reload */
+ std::vector<boost::shared_ptr<PdfOperator> > topOp;
+ /** Position in op of the first operator shown for each of topOp (and size of op at the end) */
+ std::vector<size_t> topShown;
+ /** Is the extent of change since the last reload known (see operatorsChanged) */
+ bool changeKnown;
+ /** Number of unchanged first level operators at the front */
+ size_t unchangedFront;
+ /** Number of unchanged first level operators at the back */
+ size_t unchangedBack;
  /** Observer registered for this item */
  boost::shared_ptr<TreeItemContentStreamObserver> observer;
  /** Mode - what should be shown? */
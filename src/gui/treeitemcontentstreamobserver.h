@@ -25,6 +25,7 @@
 #define __TREEITEMCONTENTSTREAMOBSERVER_H__
 
 #include "treeitemgenericobserver.h"
+#include "treeitemcontentstream.h"
 #include <kernel/ccontentstream.h>
 #include <utils/observer.h>
 #include <utils/debug.h>
@@ -33,7 +34,8 @@ namespace gui {
 
 /**
  This class provides observer monitoring CContentstream item.<br>
- The observer will reload associated tree item when the observed item changes.
+ The observer will reload associated tree item when the observed item changes,
+ telling it which operators have changed if the content stream reports it.
  \brief Observer for TreeItemContentStream
 */
 class TreeItemContentStreamObserver : public TreeItemGenericObserver<pdfobjects::CContentStream> {
@@ -42,15 +44,34 @@ public:
   Constructor
   @param _parent Object to be reloaded on any change to monitored item
  */
- TreeItemContentStreamObserver(TreeItemAbstract* _parent) : TreeItemGenericObserver<pdfobjects::CContentStream> (_parent) {
+ TreeItemContentStreamObserver(TreeItemContentStream* _parent) : TreeItemGenericObserver<pdfobjects::CContentStream> (_parent) {
   guiPrintDbg(debug::DBG_DBG, "OBServer begin" );
-  //No extra initialization
+  item=_parent;
  };
+
+ /**
+  Notification function called by changing content stream
+  @param newValue New value of content stream
+  @param context Context of change
+ */
+ virtual void notify (boost::shared_ptr<pdfobjects::CContentStream> newValue,
+                      boost::shared_ptr<const observer::IChangeContext<pdfobjects::CContentStream> > context) const throw() {
+  if (parent && context && context->getType()==observer::ComplexChangeContextType) {
+   boost::shared_ptr<const pdfobjects::CContentStream::OperatorsChangeContext> change=
+    boost::dynamic_pointer_cast<const pdfobjects::CContentStream::OperatorsChangeContext>(context);
+   if (change) item->operatorsChanged(change->getValueId().front,change->getValueId().back);
+  }
+  TreeItemGenericObserver<pdfobjects::CContentStream>::notify(newValue,context);
+ }
+
  /** Destructor */
  virtual ~TreeItemContentStreamObserver() throw() {
   guiPrintDbg(debug::DBG_DBG, "OBServer end" );
   //Empty for now
  }
+private:
+ /** Observed tree item (the same as parent, unless deactivated) */
+ TreeItemContentStream *item;
 };
 
 } // namespace gui
@@ -0,0 +1,127 @@
+/*
+ * PDFedit - free program for PDF document manipulation.
+ * Copyright (C) 2006-2009  PDFedit team: Michal Hocko,
+ *                                        Jozef Misutka,
+ *                                        Martin Petricek
+ *                   Former team members: Miroslav Jahoda
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program (in doc/LICENSE.GPL); if not, write to the 
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, 
+ * MA  02111-1307  USA
+ *
+ * Project is hosted on http://sourceforge.net/projects/pdfedit
+ */
+/** @file
+ TreeItemOperatorRange - class holding range of operators from large content stream
+*/
+
+#include "treeitemoperatorrange.h"
+#include "treeitemcontentstream.h"
+#include "treeitempdfoperator.h"
+#include "treedata.h"
+#include "util.h"
+#include <kernel/ccontentstream.h>
+
+namespace gui {
+
+class TreeData;
+
+using namespace std;
+
+/**
+ constructor of TreeItemOperatorRange - create child item of content stream tree item
+ @param _data TreeData containing necessary information about tree in which this item will be inserted
+ @param parent Content stream tree item under which to put this item
+ @param _range Index of the range (range N holds operators from N*OPERATOR_RANGE_SIZE)
+ @param after Item after which this one will be inserted
+ @param nameId Internal name of this item
+ */
+TreeItemOperatorRange::TreeItemOperatorRange(TreeData *_data,TreeItemContentStream *parent,unsigned int _range,Q_ListViewItem *after/*=NULL*/,const QString &nameId/*=NULL*/):TreeItemAbstract(nameId,_data,parent,after) {
+ cs=parent;
+ range=_range;
+ // object type
+ setText(1,QObject::tr("Operators"));
+ setText(2,"");
+ reload();
+}
+
+/** default destructor */
+TreeItemOperatorRange::~TreeItemOperatorRange() {
+}
+
+/**
+ Return internal name of range with given index
+ @param range Index of the range
+ @return name of the range
+*/
+QString TreeItemOperatorRange::rangeName(unsigned int range) {
+ return QString("Range")+QString::number(range);
+}
+
+//See TreeItemAbstract for description of this virtual method
+TreeItemAbstract* TreeItemOperatorRange::createChild(const QString &name,__attribute__((unused)) ChildType typ,Q_ListViewItem *after/*=NULL*/) {
+ size_t position=name.toUInt();
+ return new TreeItemPdfOperator(data,this,cs->getOperator(position),cs->getObject(),name,after);
+}
+
+//See TreeItemAbstract for description of this virtual method
+bool TreeItemOperatorRange::validChild(const QString &name,Q_ListViewItem *oldChild) {
+ TreeItemPdfOperator* oper=dynamic_cast<TreeItemPdfOperator*>(oldChild);
+ if (!oper) return false;
+ size_t position=name.toUInt();
+ //Same address = same item
+ return (oper->getObject()==cs->getOperator(position));
+}
+
+//See TreeItemAbstract for description of this virtual method
+ChildType TreeItemOperatorRange::getChildType(__attribute__((unused)) const QString &name) {
+ return 1;//Just one type : PDF Operator
+}
+
+//See TreeItemAbstract for description of this virtual method
+QStringList TreeItemOperatorRange::getChildNames() {
+ return util::countList(last-first,first);
+}
+
+//See TreeItemAbstract for description of this virtual method
+QSCObject* TreeItemOperatorRange::getQSObject() {
+ return NULL;
+}
+
+//See TreeItemAbstract for description of this virtual method
+void TreeItemOperatorRange::remove() {
+ // Do nothing, ranges exist only as long as the content stream is long enough
+ return;
+}
+
+//See TreeItemAbstract for description of this virtual method
+void TreeItemOperatorRange::reloadSelf() {
+ //Operators are held by the content stream item, just update the bounds
+ size_t count=cs->getOperatorCount();
+ first=range*OPERATOR_RANGE_SIZE;
+ last=first+OPERATOR_RANGE_SIZE;
+ if (first>count) first=count;
+ if (last>count) last=count;
+ if (first<last) {
+  setText(0,QString::number(first)+" - "+QString::number(last-1));
+ } else {
+  setText(0,QObject::tr("<empty>"));
+ }
+}
+
+//See TreeItemAbstract for description of this virtual method
+bool TreeItemOperatorRange::haveChild() {
+ return first<last;
+}
+
+} // namespace gui
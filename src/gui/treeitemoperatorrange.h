@@ -0,0 +1,77 @@
+/*
+ * PDFedit - free program for PDF document manipulation.
+ * Copyright (C) 2006-2009  PDFedit team: Michal Hocko,
+ *                                        Jozef Misutka,
+ *                                        Martin Petricek
+ *                   Former team members: Miroslav Jahoda
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program (in doc/LICENSE.GPL); if not, write to the 
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, 
+ * MA  02111-1307  USA
+ *
+ * Project is hosted on http://sourceforge.net/projects/pdfedit
+ */
+#ifndef __TREEITEMOPERATORRANGE_H__
+#define __TREEITEMOPERATORRANGE_H__
+
+#include "treeitemabstract.h"
+class QString;
+
+namespace gui {
+
+class TreeData;
+class TreeItemContentStream;
+
+/**
+ Maximal number of operators shown directly under content stream tree item.
+ Longer content streams are split to ranges of this size.
+*/
+const unsigned int OPERATOR_RANGE_SIZE=1000;
+
+/**
+ Tree item holding one range of operators of a large content stream.<br>
+ The operators are not copied, they are taken from the content stream tree item
+ which is parent of this item. Child items are named by the operator position
+ in the whole content stream, so operator "1234" is in the second range.<br>
+ Like any other tree item, children are created only when the range is opened,
+ so the tree contains items only for operators the user has seen.
+ \brief Tree item containing range of operators from content stream
+*/
+class TreeItemOperatorRange : public TreeItemAbstract {
+public:
+ TreeItemOperatorRange(TreeData *_data,TreeItemContentStream *parent,unsigned int _range,Q_ListViewItem *after=NULL,const QString &nameId=NULL);
+ virtual ~TreeItemOperatorRange();
+ static QString rangeName(unsigned int range);
+ //From TreeItemAbstract interface
+ virtual bool validChild(const QString &name,Q_ListViewItem *oldChild);
+ virtual ChildType getChildType(const QString &name);
+ virtual TreeItemAbstract* createChild(const QString &name,ChildType typ,Q_ListViewItem *after=NULL);
+ virtual QStringList getChildNames();
+ virtual bool haveChild();
+ virtual QSCObject* getQSObject();
+ virtual void remove();
+ virtual void reloadSelf();
+private:
+ /** Content stream tree item holding the operators */
+ TreeItemContentStream *cs;
+ /** Index of this range */
+ unsigned int range;
+ /** Position of first operator in this range */
+ unsigned int first;
+ /** Position after last operator in this range */
+ unsigned int last;
+};
+
+} // namespace gui
+
+#endif
@@ -32,6 +32,7 @@
 #include "treedata.h"
 #include "treeitem.h"
 #include "treeitempdfoperator.h"
+#include "treeitemoperatorrange.h"
 #include "util.h"
 #include <kernel/cobject.h>
 #include <kernel/ccontentstream.h>
@@ -189,6 +190,10 @@ QSCObject* TreeItemPdfOperator::getQSObject() {
 void TreeItemPdfOperator::remove() {
  if (!obj->getContentStream()) return;// Content stream is not known, so deletion is not possible
  TreeItemAbstract *parentItem=dynamic_cast<TreeItemAbstract*>(parent());
+ if (dynamic_cast<TreeItemOperatorRange*>(parentItem)) {
+  //Range may vanish when the stream gets shorter, reload the content stream item instead
+  parentItem=dynamic_cast<TreeItemAbstract*>(parentItem->parent());
+ }
  obj->getContentStream()->deleteOperator(obj);
  //TODO: monitor parentItem for deletion, or maybe this should not be necessary (observers ..)
  if (parentItem) parentItem->reload(); ///This will delete the operator treeitem and also the operator itself
@@ -36,6 +36,7 @@
 #include "kernel/cinlineimage.h"
 #include "kernel/contentschangetag.h"
 #include "kernel/pdfoperatorsiter.h"
+#include "utils/trace.h"
 
 //fabs
 #include <math.h>
@@ -274,6 +275,8 @@ namespace {
 	{
 		// Create operator with its operands
 		boost::shared_ptr<PdfOperator> result = createOperatorFromStream (streamreader, operands);
+		if (result)
+			trace::count (trace::OPERATORS_PARSED);
 	
 		if (result && isCompositeOp (result) && !isInlineImageOp (result))
 		{
@@ -338,6 +341,8 @@ namespace {
 						boost::shared_ptr<IPropertyObserver> observer,
 						CContentStream::CStreams* parsedstreams = NULL)
 	{
+		TRACE_SCOPE ("kernel", "CContentStream::parse");
+
 		// Clear operators
 		operators.clear ();
 	
@@ -548,8 +553,8 @@ throw ()
 			assert (hasValidRef (newValue));
 		}
 
-		// Stream has changed, reparse it
-		contentstream->saveChange ();
+		// Save the stream, operators stay the same
+		contentstream->_objectChanged ();
 		
 	}catch (ReadOnlyDocumentException&)
 	{
@@ -570,6 +575,7 @@ throw ()
 //
 CContentStream::CContentStream (boost::shared_ptr<GfxState> state, 
 		boost::shared_ptr<GfxResources> res) : gfxstate (state), gfxres (res) {
+	changedOperators.front = changedOperators.back = std::numeric_limits<size_t>::max();
 }
 
 CContentStream::CContentStream (CStreams& strs, 
@@ -578,6 +584,7 @@ CContentStream::CContentStream (CStreams& strs,
 	: gfxstate (state), gfxres (res)
 {
 	kernelPrintDbg (DBG_DBG, "");
+	changedOperators.front = changedOperators.back = std::numeric_limits<size_t>::max();
 	setStreams(strs);
 }
 
@@ -609,6 +616,7 @@ void CContentStream::setStreams (CStreams& strs) {
 	operandobserver = boost::shared_ptr<OperandObserver> (new OperandObserver (this));
 	
 	// Parse it, move parsed streams from strs to cstreams
+	_allOperatorsChanged ();
 	parse (operators, strs, *this, operandobserver, &cstreams);
 	
 	// Save bounding boxes
@@ -643,6 +651,7 @@ CContentStream::reparse (bool bboxOnly, boost::shared_ptr<GfxState> state, boost
 	if (!bboxOnly)
 	{
 		// Clear operators	
+		_allOperatorsChanged ();
 		operators.clear ();
 		parse (operators, cstreams, *this, operandobserver);
 	}
@@ -655,39 +664,60 @@ CContentStream::reparse (bool bboxOnly, boost::shared_ptr<GfxState> state, boost
 //
 //
 //
-void 
-CContentStream::replaceText (const std::string& what, const std::string& with)
-{
-	bool dirty = false;
-		if (operators.empty())
-			return;
-
-	operandobserver->lock();
-
-	TextOperatorIterator tit = PdfOperator::getIterator<TextOperatorIterator> (operators.front());
-	while (!tit.isEnd())
+namespace {
+	/** Replaces text in text operators. */
+	struct TextReplacer
 	{
-		// uff
-		boost::shared_ptr<TextSimpleOperator> _cur 
-				= boost::dynamic_pointer_cast<TextSimpleOperator, PdfOperator> (tit.getCurrent());
-		std::string tmp;
-		_cur->getFontText (tmp);
-		string replaced = boost::replace_all_copy (tmp, what, with);
-		if (tmp != replaced)
+		const std::string& what;
+		const std::string& with;
+		TextReplacer (const std::string& _what, const std::string& _with) : what (_what), with (_with) {}
+		bool operator() (boost::shared_ptr<PdfOperator> op) const
 		{
-			dirty = true;
 			boost::shared_ptr<TextSimpleOperator> _cur 
-					= boost::dynamic_pointer_cast<TextSimpleOperator, PdfOperator> (tit.getCurrent());
+					= boost::dynamic_pointer_cast<TextSimpleOperator, PdfOperator> (op);
+			std::string tmp;
+			_cur->getFontText (tmp);
+			string replaced = boost::replace_all_copy (tmp, what, with);
+			if (tmp == replaced)
+				return false;
 			_cur->setFontText (replaced);
+			return true;
 		}
-		tit.next();
-	}
+	};
+} // namespace
+
+size_t
+CContentStream::replaceText (const std::string& what, const std::string& with)
+{
+	TextReplacer replacer (what, with);
+	return changeOperators<TextOperatorIterator> (replacer);
+}
 
-	operandobserver->unlock();
-	if (dirty)
-		_objectChanged();
+
+//
+//
+//
+void
+CContentStream::_checkCanChange () const
+{
+	assert (!cstreams.empty());
+	cstreams.front()->canChange();
 }
 
+/** Content stream save postponed by a transaction. */
+class CContentStream::PendingSave : public IPendingChange
+{
+	boost::weak_ptr<CContentStream> cs;
+public:
+	PendingSave (boost::weak_ptr<CContentStream> _cs) : cs (_cs) {}
+	virtual void merge (const IPendingChange&) {}
+	virtual void dispatch ()
+	{
+		boost::shared_ptr<CContentStream> current = cs.lock();
+		if (current)
+			current->_saveChange ();
+	}
+};
 
 //
 //
@@ -701,6 +731,42 @@ CContentStream::_objectChanged ()
 		return;
 	assert (hasValidRef (cstreams.front()));
 
+	// Save it once at the end of the transaction
+	boost::shared_ptr<CPdf> pdf = cstreams.front()->getPdf().lock();
+	if (pdf && pdf->inTransaction() && !smart_this.expired())
+	{
+		pdf->deferChange (this, std::string (), 
+				boost::shared_ptr<IPendingChange> (new PendingSave (smart_this)));
+		return;
+	}
+	_saveChange ();
+}
+
+//
+//
+//
+void
+CContentStream::_dropPendingChanges () const
+{
+	if (cstreams.empty())
+		return;
+	boost::shared_ptr<CPdf> pdf = cstreams.front()->getPdf().lock();
+	if (pdf && pdf->inTransaction())
+		pdf->dropChanges (this);
+}
+
+//
+//
+//
+void
+CContentStream::_saveChange ()
+{
+	assert (!cstreams.empty());
+	// Do not notify anything if we are not in a valid pdf
+	if (!hasValidPdf (cstreams.front()))
+		return;
+	assert (hasValidRef (cstreams.front()));
+
 	//
 	// Make the change
 	//  -- unregister OBSERVERS, because when saving to ccs which consists of
@@ -748,7 +814,42 @@ CContentStream::_objectChanged ()
 
 	// Notify observers
 	boost::shared_ptr<CContentStream> current (this, EmptyDeallocator<CContentStream> ());
-	this->notifyObservers (current, boost::shared_ptr<const ObserverContext> (new BasicObserverContext (current)));
+	OperatorsChange change = changedOperators;
+	changedOperators.front = changedOperators.back = std::numeric_limits<size_t>::max();
+	this->notifyObservers (current, boost::shared_ptr<const ObserverContext> (new OperatorsChangeContext (current, change)));
+}
+
+//
+//
+//
+void
+CContentStream::_operatorsChanged (size_t pos, size_t removed)
+{
+	assert (pos + removed <= operators.size());
+	changedOperators.front = std::min (changedOperators.front, pos);
+	changedOperators.back = std::min (changedOperators.back, operators.size() - pos - removed);
+}
+
+//
+//
+//
+size_t
+CContentStream::_topLevelPosition (boost::shared_ptr<PdfOperator> oper) const
+{
+	size_t pos = 0;
+	for (Operators::const_iterator it = operators.begin(); it != operators.end(); ++it, ++pos)
+	{
+		// Walk through children of composites
+		boost::shared_ptr<PdfOperator> last = getLastOperator (*it);
+		for (OperatorIterator child = PdfOperator::getIterator (*it); !child.isEnd(); child.next())
+		{
+			if (child.getCurrent() == oper)
+				return pos;
+			if (child.getCurrent() == last)
+				break;
+		}
+	}
+	throw CObjInvalidObject ();
 }
 
 
@@ -773,6 +874,7 @@ CContentStream::deleteOperator (OperatorIterator it, bool indicateChange)
 	
 	// Be sure that the operator won't get deallocated along the way
 	boost::shared_ptr<PdfOperator> toDel = it.getCurrent ();
+	_operatorsChanged (_topLevelPosition (toDel), 1);
 	
 	//
 	// Remove it from operators or composite
@@ -859,6 +961,7 @@ CContentStream::insertOperator (OperatorIterator it, boost::shared_ptr<PdfOperat
 	if (operators.empty ())
 	{
 		assert (!it.valid());
+		_operatorsChanged (0, 0);
 		operators.push_back (newOper);
 		return;
 	}
@@ -877,9 +980,12 @@ CContentStream::insertOperator (OperatorIterator it, boost::shared_ptr<PdfOperat
 	// Insert into operators or composite
 	// 
 	
+	size_t pos = _topLevelPosition (it.getCurrent());
 	Operators::iterator operIt = std::find (operators.begin(), operators.end(), it.getCurrent());
 	if (operIt == operators.end())
 	{
+		// The first level composite containing it changes
+		_operatorsChanged (pos, 1);
 		// Find the composite in which the operator resides
 		OperatorIterator begin = PdfOperator::getIterator (operators.front());
 		boost::shared_ptr<PdfOperator> composite = findCompositeOfPdfOperator (begin, it.getCurrent());
@@ -895,6 +1001,7 @@ CContentStream::insertOperator (OperatorIterator it, boost::shared_ptr<PdfOperat
 	
 	}else
 	{
+		_operatorsChanged (pos + 1, 0);
 		// Insert it into operators
 		++operIt;
 		operators.insert (operIt, newOper);
@@ -953,6 +1060,7 @@ CContentStream::frontInsertOperator (boost::shared_ptr<PdfOperator> newoper,
 	assert (pdf.lock());
 	// set accordingly	
 	opsSetPdfRefCs (newoper, pdf, rf, *this, operandobserver);
+	_operatorsChanged (0, 0);
 
 	if (operators.empty ())
 	{ // Insert into empty contentstream
@@ -1000,6 +1108,7 @@ CContentStream::replaceOperator (OperatorIterator it,
 
 	// Be sure that the operator won't get deallocated along the way
 	boost::shared_ptr<PdfOperator> toReplace = it.getCurrent ();
+	_operatorsChanged (_topLevelPosition (toReplace), 1);
 	
 	// Set correct IndiRef, CPdf and cs to inserted operator
 	assert (hasValidRef (cstreams.front()));
@@ -1085,6 +1194,91 @@ CContentStream::replaceOperator (OperatorIterator it,
 	}
 }
 
+//
+//
+//
+size_t
+CContentStream::deleteOperators (OperatorIterator first, OperatorIterator last)
+{
+	kernelPrintDbg (debug::DBG_DBG, "");
+	assert (!cstreams.empty());
+
+	// Check whether we can make the change
+	cstreams.front()->canChange();
+
+	boost::shared_ptr<PdfOperator> stop = last.getCurrent ();
+	size_t deleted = 0;
+	OperatorIterator it = first;
+	while (!it.isEnd())
+	{
+		// Walk through the whole operator (it can be a composite) to find
+		// out whether last is in it and where the next operator is
+		boost::shared_ptr<PdfOperator> cur = it.getCurrent ();
+		boost::shared_ptr<PdfOperator> curLast = getLastOperator (cur);
+		bool done = false;
+		OperatorIterator nxt = it;
+		for (;;)
+		{
+			if (nxt.getCurrent() == stop)
+				done = true;
+			if (nxt.getCurrent() == curLast)
+				break;
+			nxt.next();
+		}
+		nxt.next();
+
+		deleteOperator (it, false);
+		++deleted;
+		if (done)
+			break;
+		it = nxt;
+	}
+
+	if (deleted)
+		_objectChanged ();
+	return deleted;
+}
+
+//
+//
+//
+size_t
+CContentStream::replaceOperators (const std::string& name, boost::shared_ptr<PdfOperator> newOper)
+{
+	kernelPrintDbg (debug::DBG_DBG, name);
+	assert (!cstreams.empty());
+	if (operators.empty())
+		return 0;
+
+	// Check whether we can make the change
+	cstreams.front()->canChange();
+
+	size_t replaced = 0;
+	OperatorIterator it = PdfOperator::getIterator (operators.front());
+	while (!it.isEnd())
+	{
+		boost::shared_ptr<PdfOperator> cur = it.getCurrent ();
+		std::string curName;
+		cur->getOperatorName (curName);
+		if (curName != name)
+		{
+			it.next ();
+			continue;
+		}
+
+		// Get "real" next (behind children of a composite) before the
+		// operator is unlinked
+		OperatorIterator nxt = PdfOperator::getIterator (getLastOperator (cur)).next();
+		replaceOperator (it, newOper->clone(), false);
+		++replaced;
+		it = nxt;
+	}
+
+	if (replaced)
+		_objectChanged ();
+	return replaced;
+}
+
 //
 // Observer interface
 //
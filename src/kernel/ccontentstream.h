@@ -96,6 +96,22 @@ public:
 	typedef std::list<boost::shared_ptr<CStream> > CStreams;
 	typedef PdfOperator::Iterator OperatorIterator;
 	typedef observer::BasicChangeContext<CContentStream> BasicObserverContext;
+
+	/**
+	 * Extent of a change of operators reported to observers.
+	 *
+	 * The first front and the last back first level operators are the
+	 * same objects (containing the same operators) as before the change, so
+	 * an observer has to look only at the operators in between. Changes of
+	 * operands only are reported with front and back covering all operators
+	 * (their sum can exceed the number of operators).
+	 */
+	struct OperatorsChange
+	{
+		size_t front;	/**< Number of unchanged operators at the front. */
+		size_t back;	/**< Number of unchanged operators at the back. */
+	};
+	typedef observer::ComplexChangeContext<CContentStream, OperatorsChange> OperatorsChangeContext;
 	
 private:
 
@@ -114,6 +130,9 @@ private:
 	/** Smart pointer to this object. */
 	boost::weak_ptr<CContentStream> smart_this;
 
+	/** Operators changed since observers were notified the last time. */
+	OperatorsChange changedOperators;
+
 	//
 	// Observer observing underlying cstreams and operands
 	//
@@ -446,6 +465,91 @@ public:
 						  bool indicateChange = true)
 		{ replaceOperator (PdfOperator::getIterator<OperatorIterator> (oper), newOper, indicateChange); }
 
+	//
+	// Batch change methods
+	//
+	// Each of them makes all its changes first and then writes the content
+	// stream and notifies observers just once.
+	//
+public:
+	/**
+	 * Delete all operators from first to last (both inclusive).
+	 *
+	 * Operators are walked in the iterator order, a composite is deleted as a
+	 * whole (including its last operator even if it is after last). Last must
+	 * not precede first, otherwise everything from first to the end of the
+	 * stream is deleted.
+	 *
+	 * @param first Iterator pointing to the first operator to delete.
+	 * @param last Iterator pointing to the last operator to delete.
+	 *
+	 * @return Number of deleted (top most) operators.
+	 */
+	size_t deleteOperators (OperatorIterator first, OperatorIterator last);
+
+	/** \see deleteOperators */
+	size_t deleteOperators (boost::shared_ptr<PdfOperator> first, boost::shared_ptr<PdfOperator> last)
+	{
+		return deleteOperators (PdfOperator::getIterator<OperatorIterator> (first),
+								PdfOperator::getIterator<OperatorIterator> (last));
+	}
+
+	/**
+	 * Replace all operators with specified name by a copy of an operator.
+	 *
+	 * All operators are searched including children of composites (e.g.
+	 * text operators inside BT/ET), except children of a replaced composite
+	 * which are replaced together with it.
+	 *
+	 * @param name Name of operators to replace.
+	 * @param newOper Operator which clones will replace the operators.
+	 *
+	 * @return Number of replaced operators.
+	 */
+	size_t replaceOperators (const std::string& name, boost::shared_ptr<PdfOperator> newOper);
+
+	/**
+	 * Change operators in place.
+	 *
+	 * Functor is called for all operators the iterator of type ItType walks
+	 * through and returns true if it has changed the operator. Operand change
+	 * notifications are suppressed during the walk, the stream is saved
+	 * afterwards if anything has changed.
+	 *
+	 * @param fctor Functor taking boost::shared_ptr<PdfOperator> and returning bool.
+	 *
+	 * @return Number of changed operators.
+	 */
+	template<typename ItType, typename Functor>
+	size_t changeOperators (Functor& fctor)
+	{
+		if (operators.empty())
+			return 0;
+
+		// Check whether we can make the change
+		_checkCanChange ();
+
+		size_t changed = 0;
+		operandobserver->lock();
+		try {
+			ItType it = PdfOperator::getIterator<ItType> (operators.front());
+			for (; !it.isEnd(); it.next())
+				if (fctor (it.getCurrent()))
+					++changed;
+		}catch (...)
+		{
+			operandobserver->unlock();
+			if (changed)
+				_objectChanged ();
+			throw;
+		}
+		operandobserver->unlock();
+
+		if (changed)
+			_objectChanged ();
+		return changed;
+	}
+
 	//
 	// Helper methods
 	//
@@ -489,10 +593,11 @@ public:
 	/**
 	 * Save content stream to underlying cstream(s) and notify all observers. 
 	 *
-	 * Does not reparse anything. 
+	 * Does not reparse anything. Operators could have been changed directly
+	 * (not by methods of this class), so all of them are reported as changed.
 	 */
 	void saveChange () 
-		{ _objectChanged(); }
+		{ _allOperatorsChanged (); _objectChanged(); }
 
 	/**
 	 * Get smart pointer to this content stream.
@@ -512,17 +617,53 @@ public:
 
 	/**
 	 * Replaces text in this content stream. Simple method implemented so far.
+	 *
+	 * @return Number of changed text operators.
 	 */
-	void replaceText (const std::string& what, const std::string& with);
+	size_t replaceText (const std::string& what, const std::string& with);
 
 
 private:
 	/**
 	 * Save changes and indicate that the object has changed by calling all
 	 * observers.
+	 *
+	 * If the pdf is in a transaction, saving is postponed to its end (see
+	 * CPdf::beginTransaction), so that the content stream is written just once.
 	 */
 	void _objectChanged ();
 
+	/** Does the work of _objectChanged. */
+	void _saveChange ();
+
+	/**
+	 * Extends the change reported to observers by replacing removed first
+	 * level operators starting at position pos. Has to be called before
+	 * operators are changed.
+	 */
+	void _operatorsChanged (size_t pos, size_t removed);
+
+	/** Reports all operators as changed. */
+	void _allOperatorsChanged ()
+		{ changedOperators.front = changedOperators.back = 0; }
+
+	/** Position of the first level operator which is or contains oper. */
+	size_t _topLevelPosition (boost::shared_ptr<PdfOperator> oper) const;
+
+	/** Postponed save. */
+	class PendingSave;
+
+	/** Drops postponed save of this content stream. */
+	void _dropPendingChanges () const;
+
+	/**
+	 * Checks whether the content stream can be changed (CStream is not
+	 * complete in this header, so templates can't check it directly).
+	 *
+	 * @throw ReadOnlyDocumentException if the document can't be changed.
+	 */
+	void _checkCanChange () const;
+
 	//
 	// Observers
 	//
@@ -555,6 +696,7 @@ public:
 		kernelPrintDbg (debug::DBG_DBG, "destructing..");
 		// Unregister cstream observers
 		unregisterCStreamObservers ();
+		_dropPendingChanges ();
 		check_observerlist (this->observers);
 	}
 };
@@ -31,6 +31,8 @@
 #include "kernel/cobjectsimple.h"
 #include "kernel/carray.h"
 
+class Encryptor;
+
 
 //=====================================================================================
 namespace pdfobjects {
@@ -561,6 +563,8 @@ typedef unsigned char* (*stream_data_extractor)(const Object& obj, size_t& size)
  * @param outputBuf Output byte buffer containing complete representation.
  * @param extractor Function to be used to extract data from the object's 
  * 	stream.
+ * @param encryptor Encryptor for extracted data (NULL if data are not
+ * 	encrypted).
  *
  * Allocates and fills buffer in given outputBuf with pdf object format
  * representation of given stream object. Moreover adds indirect header and
@@ -576,7 +580,7 @@ typedef unsigned char* (*stream_data_extractor)(const Object& obj, size_t& size)
  * @return number of bytes used in outputBuf or 0 if problem occures.
  */
 size_t streamToCharBuffer (const Object & streamObject, Ref* ref, CharBuffer & outputBuf, 
-		stream_data_extractor extractor);
+		stream_data_extractor extractor, ::Encryptor * encryptor = NULL);
 	
 /**
  * Convert xpdf object to string
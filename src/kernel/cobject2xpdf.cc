@@ -27,10 +27,12 @@
 #include "kernel/static.h"
 // xpdf
 #include "kernel/xpdf.h"
+#include "xpdf/Decrypt.h"
 //
 #include "kernel/pdfspecification.h"
 #include "kernel/factories.h"
 #include "kernel/cobject.h"
+#include "utils/trace.h"
 
 
 // =====================================================================================
@@ -593,6 +595,7 @@ getStringFromXpdfStream (std::string& str, ::Object& obj)
 	int c;
 	while (EOF != (c = obj.streamGetChar())) 
 		str += static_cast<std::string::value_type> (c);
+	trace::count (trace::BYTES_DECODED, str.size());
 	// Cleanup
 	obj.streamClose ();
 }
@@ -604,6 +607,7 @@ getStringFromXpdfStream (std::string& str, ::Object& obj)
 IProperty*
 createObjFromXpdfObj (boost::shared_ptr<CPdf> pdf, const Object& obj,const IndiRef& ref)
 {
+	TRACE_SCOPE("kernel", "createObjFromXpdfObj");
 	switch (obj.getType ())
 	{
 		case objBool:
@@ -947,6 +951,7 @@ unsigned char* convertStreamToDecodedData(const Object& obj, size_t& size)
 	unsigned char * buffer = bufferFromStream(*str, streamLength, size);
 	if(!buffer)
 		return NULL;
+	trace::count(trace::BYTES_DECODED, size);
 
 	// if there were some filters we have to remove them with 
 	// all associated parameters, because they are no longer 
@@ -966,7 +971,7 @@ unsigned char* convertStreamToDecodedData(const Object& obj, size_t& size)
 }
 
 size_t streamToCharBuffer (const Object & streamObject, Ref* ref, CharBuffer & outputBuf, 
-		stream_data_extractor extractor)
+		stream_data_extractor extractor, ::Encryptor * encryptor)
 {
 	utilsPrintDbg(debug::DBG_DBG, "");
 	if(streamObject.getType()!=objStream)
@@ -1002,6 +1007,22 @@ size_t streamToCharBuffer (const Object & streamObject, Ref* ref, CharBuffer & o
 		return 0;
 	if(!realBufferLen)
 		utilsPrintDbg(debug::DBG_WARN, "Stream " << *ref << " with zero bytes in encountered");
+
+	// encrypts data (already encoded by filters) - Length is updated below
+	if(encryptor)
+	{
+		size_t encryptedLen = encryptor->getEncryptedLength(realBufferLen);
+		unsigned char * encrypted = (unsigned char *)malloc(encryptedLen);
+		if(!encrypted)
+		{
+			utilsPrintDbg(debug::DBG_CRIT, "Allocation failure");
+			free(dataBuff);
+			return 0;
+		}
+		realBufferLen = encryptor->encrypt(dataBuff, realBufferLen, encrypted);
+		free(dataBuff);
+		dataBuff = encrypted;
+	}
 	
 	// indirect header is filled only if asIndirect flag is set
 	// same way footer
@@ -275,6 +275,10 @@ CPage::invalidate ()
 void
 CPage::_objectChanged (bool invalid)
 {
+	// Recorded drawing operations are stale now
+	if (_display)
+		_display->invalidateDisplayList ();
+
 	// Do not notify anything if we are not in a valid pdf
 		if (!hasValidPdf (_dict))
 			return;
@@ -302,6 +302,11 @@ public:
 	void getContentStreams (Container& container)
 		{ _contents->getContentStreams (container); }
 
+	/** Fills container with contents streams which have been already parsed. */
+	template<typename Container> 
+	void getParsedContentStreams (Container& container) const
+		{ _contents->getParsedContentStreams (container); }
+
 
 	/** Get pdf operators at position specified by rectangle. @see getObjectsAtPosition() */
 	template<typename OpContainer>
@@ -504,11 +509,22 @@ public:
 	 */
 	void getText (std::string& text, const std::string* encoding = NULL, const libs::Rectangle* rc = NULL) const
 		{ _contents->getText (text, encoding, rc); }
+
+	/**  
+	 * Returns plain text extracted from a page without displaying it.
+	 * 
+	 * @see CPageContents::getSimpleText
+	 * @param text Output string  where the text will be saved.
+	 * @param encoding Encoding format.
+	 * @param rc Rectangle from which to extract the text.
+	 */
+	void getSimpleText (std::string& text, const std::string* encoding = NULL, const libs::Rectangle* rc = NULL)
+		{ _contents->getSimpleText (text, encoding, rc); }
  
 	 /**
 	  * Find all occurences of a text on this page.
 	  *
-	  * It uses xpdf TextOutputDevice to get the bounding box of found text.
+	  * Searches the text index of the page, see CPageContents::findText.
 	  *
 	  * @param text Text to find.
 	  * @param recs Output container of rectangles of all occurences of the text.
@@ -522,6 +538,21 @@ public:
 					  const TextSearchParams& params = TextSearchParams()) const
 		{ return _contents->findText (text, recs, params);	}
 
+	 /**
+	  * Find all occurences of several texts on this page at once.
+	  *
+	  * @param texts Texts to find.
+	  * @param recs Output container of rectangles of all occurences.
+	  * @param params Search parameters.
+	  *
+	  * @return Number of occurences found.
+	  */
+	 template<typename RectangleContainer>
+	 size_t findText (const std::vector<std::string>& texts, 
+					  RectangleContainer& recs, 
+					  const TextSearchParams& params = TextSearchParams()) const
+		{ return _contents->findText (texts, recs, params);	}
+
 	/**
 	 * Move contentstream up one level. Which means it will be repainted by less objects.
 	 */
@@ -585,11 +616,13 @@ public:
 
 	/**
 	 * Replaces text in the whole page.
+	 *
+	 * @return Number of changed text operators.
 	 */
-	void replaceText (const std::string& what, const std::string& with)
+	size_t replaceText (const std::string& what, const std::string& with)
 	{
 			_check_validity();
-		_contents->replaceText (what, with);
+		return _contents->replaceText (what, with);
 	}
 
 	/**
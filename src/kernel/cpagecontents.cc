@@ -152,6 +152,9 @@ CPageContents::ContentsWatchDog::notify (boost::shared_ptr<IProperty> newValue,
 			break;
 	}
 
+	// Text of the page is not valid anymore
+	_cnt->_textIndex.reset ();
+
 	// Parse content streams (add or delete of object)
 	try {
 		_cnt->parse ();
@@ -410,6 +413,36 @@ CPageContents::getText (std::string& text, const string* encoding, const libs::R
 	text = gtxt->getCString();
 }
 
+//
+//
+//
+void
+CPageContents::getSimpleText (std::string& text, const string* encoding, const libs::Rectangle* rc)
+{
+		kernelPrintDbg (debug::DBG_DBG, "");
+
+	// Set encoding
+	if (encoding)
+    	globalParams->setTextEncoding(const_cast<char*>(encoding->c_str()));
+
+	// Restrict the text to the rectangle (the same way as getText), but do
+	// not clip to the page, operator bboxes are only approximate
+	libs::Rectangle rec;
+	if (rc)
+	{
+		rec = *rc;
+		int rot = _page->getRotation ();
+		if (90 == rot || 270 == rot)
+			std::swap (rec.xright, rec.yright);
+	}
+
+	textoutput::PlainTextOutputBuilder out (rec);
+	convert<textoutput::SimpleWordEngine, 
+			textoutput::SimpleLineEngine, 
+			textoutput::SimpleColumnEngine> (out);
+	text = out.str();
+}
+
 
 //
 // Text search/find
@@ -421,51 +454,25 @@ CPageContents::getText (std::string& text, const string* encoding, const libs::R
 template<typename RectangleContainer>
 size_t CPageContents::findText (std::string text, 
 					  RectangleContainer& recs, 
-					  const TextSearchParams&) const
+					  const TextSearchParams& params) const
 {
-	// Create text output device
-	boost::scoped_ptr<TextOutputDev> textDev (new ::TextOutputDev (NULL, gFalse, gFalse, gFalse));
-		assert (textDev->isOk());
-		if (!textDev->isOk())
-			throw CObjInvalidOperation ();
-
-	// Get the text
-	_page->display()->displayPage (*textDev);	
-
-	GBool startAtTop, stopAtBottom, startAtLast, stopAtLast, caseSensitive, backward;
-	startAtTop = stopAtBottom = startAtLast = stopAtLast = gTrue;
-	caseSensitive = backward = gFalse;
-	
-	double xMin = 0, yMin = 0, xMax = 0, yMax = 0;
-
-	// Convert text to unicode (slightly modified from from PDFCore.cc)
-	int length = static_cast<int>(text.length());
-	::Unicode* utext = static_cast<Unicode*> (new Unicode [length]);
-	for (int i = 0; i < length; ++i)
-	    utext[i] = static_cast<Unicode> (text[i] & 0xff);
-	
-	if (textDev->findText(utext, length, startAtTop, stopAtBottom, 
-				startAtLast,stopAtLast, caseSensitive, backward,
-				&xMin, &yMin, &xMax, &yMax))
-	{
-		startAtTop = gFalse;
-		
-		recs.push_back (libs::Rectangle (xMin, yMin, xMax, yMax));
-		// Get all text objects
-		while (textDev->findText (utext, length,
-								  startAtTop, stopAtBottom, 
-								  startAtLast, stopAtLast, 
-								  caseSensitive, backward,
-								  &xMin, &yMin, &xMax, &yMax))
-		{
-			recs.push_back (libs::Rectangle (xMin, yMin, xMax, yMax));
-		}
-	}
+	std::vector<std::string> texts;
+	texts.push_back (text);
+	return findText (texts, recs, params);
+}
 
-	//
-	// Find out the words...
-	//
-	delete[] utext;	
+// 
+// Find all occcurences of several texts on a page
+//
+template<typename RectangleContainer>
+size_t CPageContents::findText (const std::vector<std::string>& texts, 
+					  RectangleContainer& recs, 
+					  const TextSearchParams& params) const
+{
+	TextMatcher matcher (texts, params.caseSensitive);
+	std::vector<libs::Rectangle> found;
+	textIndex().find (matcher, params.wholeWord, found);
+	std::copy (found.begin(), found.end(), std::back_inserter (recs));
 	return recs.size();
 }
 
@@ -474,17 +481,37 @@ template size_t CPageContents::findText<std::vector<libs::Rectangle> >
 	(std::string text, 
 	 std::vector<libs::Rectangle>& recs, 
 	 const TextSearchParams& params) const;
+template size_t CPageContents::findText<std::vector<libs::Rectangle> >
+	(const std::vector<std::string>& texts, 
+	 std::vector<libs::Rectangle>& recs, 
+	 const TextSearchParams& params) const;
 
 //
 //
 //
-void 
+const PageTextIndex&
+CPageContents::textIndex () const
+{
+	boost::shared_ptr<CPdf> pdf = _dict->getPdf().lock();
+	unsigned long stamp = (pdf) ? pdf->getCXref()->getChangeStamp() : 0;
+	const DisplayParams& params = _page->display()->getDisplayParams();
+
+	if (!_textIndex || !_textIndex->isValid (params, stamp))
+		_textIndex = boost::shared_ptr<PageTextIndex> (new PageTextIndex (*_page->display(), stamp));
+	return *_textIndex;
+}
+
+//
+//
+//
+size_t
 CPageContents::replaceText (const std::string& what, const std::string& with)
 {
 	init();
-	// Get the objects with specific comparator
+	size_t replaced = 0;
 	for (CCs::iterator it = _ccs.begin (); it != _ccs.end(); ++it)
-		(*it)->replaceText (what, with);
+		replaced += (*it)->replaceText (what, with);
+	return replaced;
 }
 
 //
@@ -971,6 +998,7 @@ CPageContents::unreg_observer (boost::shared_ptr<IProperty> ip) const
 void 
 CPageContents::change (bool invalid)
 { 
+	_textIndex.reset ();
 	_page->_objectChanged (invalid); 
 }
 
@@ -35,6 +35,7 @@
 #include "kernel/cstream.h"
 #include "kernel/textoutput.h"
 #include "kernel/textsearchparams.h"
+#include "kernel/textindex.h"
 #include "kernel/stateupdater.h"
 #include "kernel/cobjectsimple.h"
 
@@ -124,6 +125,7 @@ private:
 	boost::shared_ptr<CDict> _dict;	// pages
 	boost::shared_ptr<ContentsWatchDog> _wd;
 	Tm _likely_tm;
+	mutable boost::shared_ptr<PageTextIndex> _textIndex;	// extracted text, see findText
 
 
 	// Ctor & Dtor
@@ -213,7 +215,9 @@ public:
 	/**
 	 * Find all occurences of a text on this page.
 	 *
-	 * It uses xpdf TextOutputDevice to get the bounding box of found text.
+	 * The page is displayed just once to build a text index (text with glyph
+	 * bounding boxes) which is used by all following searches until the page
+	 * changes (or its display parameters do).
 	 *
 	 * @param text Text to find.
 	 * @param recs Output container of rectangles of all occurences of the text.
@@ -226,10 +230,31 @@ public:
 					  RectangleContainer& recs, 
 					  const TextSearchParams& params = TextSearchParams()) const;
 
+	/**
+	 * Find all occurences of several texts on this page.
+	 *
+	 * The page text is scanned only once whatever the number of texts is.
+	 *
+	 * @param texts Texts to find.
+	 * @param recs Output container of rectangles of all occurences in the page
+	 * text order.
+	 * @param params Search parameters.
+	 *
+	 * @return Number of occurences found.
+	 */
+	 template<typename RectangleContainer>
+	 size_t findText (const std::vector<std::string>& texts, 
+					  RectangleContainer& recs, 
+					  const TextSearchParams& params = TextSearchParams()) const;
+
 	/**
 	 * Replaces text in the whole page.
+	 *
+	 * Each content stream is saved at most once.
+	 *
+	 * @return Number of changed text operators.
 	 */
-	void replaceText (const std::string& what, const std::string& with);
+	size_t replaceText (const std::string& what, const std::string& with);
 
 	/**
 	 * Adds text in to the page.
@@ -332,6 +357,17 @@ public:
 		std::copy (_ccs.begin(), _ccs.end(), std::back_inserter(container));
 	}
 
+	/** 
+	 * Fills container with contents streams which have been already parsed
+	 * (nothing is parsed). 
+	 */
+	template<typename Container> 
+	void getParsedContentStreams (Container& container) const
+	{
+		container.clear();
+		std::copy (_ccs.begin(), _ccs.end(), std::back_inserter(container));
+	}
+
 	/**  
 	 * Returns plain text extracted from a page using xpdf code.
 	 * 
@@ -347,6 +383,23 @@ public:
 	void getText (std::string& text, 
 				  const std::string* encoding = NULL, 
 				  const libs::Rectangle* rc = NULL) const;
+
+	/**  
+	 * Returns plain text extracted from a page by the simple text engines.
+	 * 
+	 * Unlike getText, the page is not displayed again. Text is taken from the
+	 * parsed content streams using graphical states computed by StateUpdater
+	 * and words and lines are formed by SimpleWordEngine and
+	 * SimpleLineEngine. Lines are output in the line engine order, which
+	 * needn't be the reading order xpdf tries to reconstruct.
+	 *
+	 * @param text Output string  where the text will be saved.
+	 * @param encoding Encoding format.
+	 * @param rc Rectangle from which to extract the text.
+	 */
+	void getSimpleText (std::string& text, 
+						const std::string* encoding = NULL, 
+						const libs::Rectangle* rc = NULL);
  
 	/**
 	 * Move contentstream up one level. Which means it will be repainted by less objects.
@@ -416,6 +469,11 @@ private:
 	 */
 	inline void change (bool invalid = false);
 
+	/**
+	 * Returns up to date text index of the page, builds it if necessary.
+	 */
+	const PageTextIndex& textIndex () const;
+
 	//
 	// Helper methods because of cpage not included in headers
 	//
@@ -31,6 +31,7 @@
 #include "kernel/cpage.h"
 #include "kernel/cpdf.h"
 #include "kernel/cpageattributes.h"
+#include "utils/trace.h"
 
 // =====================================================================================
 namespace pdfobjects {
@@ -39,6 +40,87 @@ namespace pdfobjects {
 using namespace boost;
 using namespace utils;
 
+//=====================================================================================
+// DisplayListCache
+//=====================================================================================
+
+const size_t DisplayListCache::DEFAULT_BUDGET;
+
+//
+//
+//
+void
+DisplayListCache::setBudget (size_t budget)
+{
+	_budget = budget;
+	shrink ();
+}
+
+//
+//
+//
+void
+DisplayListCache::use (DisplayListPtr list)
+{
+	Index::iterator i = _index.find (list.get());
+	if (i != _index.end())
+	{
+		_lists.splice (_lists.begin(), _lists, i->second);
+	}else
+	{
+		size_t size = list->getMemoryUsage ();
+		_lists.push_front (std::make_pair (list, size));
+		_index[list.get()] = _lists.begin();
+		_size += size;
+	}
+	shrink ();
+}
+
+//
+//
+//
+void
+DisplayListCache::remove (const DisplayListOutputDev* list)
+{
+	Index::iterator i = _index.find (list);
+	if (i == _index.end())
+		return;
+	_size -= i->second->second;
+	_lists.erase (i->second);
+	_index.erase (i);
+}
+
+//
+//
+//
+void
+DisplayListCache::clear ()
+{
+	_index.clear ();
+	_lists.clear ();
+	_size = 0;
+}
+
+//
+//
+//
+void
+DisplayListCache::shrink ()
+{
+	while (_size > _budget && !_lists.empty())
+	{
+		kernelPrintDbg (debug::DBG_DBG, "dropping display list of " << _lists.back().second << " bytes");
+		_size -= _lists.back().second;
+		_index.erase (_lists.back().first.get());
+		_lists.pop_back ();
+	}
+}
+
+
+//=====================================================================================
+// CPageDisplay
+//=====================================================================================
+
 //
 //
 //
@@ -86,6 +168,8 @@ CPageDisplay::displayPage (::OutputDev& out,
 						   boost::shared_ptr<CDict> pagedict, 
 						   int x, int y, int w, int h)
 {
+	TRACE_SCOPE ("render", "CPageDisplay::displayPage");
+
 	// Get xref
 	boost::shared_ptr<CPdf> pdf = pagedict->getPdf().lock();
 	XRef* xref = (pdf)?pdf->getCXref ():NULL;
@@ -123,6 +207,50 @@ CPageDisplay::displayPage (::OutputDev& out,
 	// Create catalog
 	boost::scoped_ptr<Catalog> xpdfCatalog (new Catalog (xref));
 	
+	//
+	// Replay our own page from the display list, record it first if
+	// the document has changed since the last time (or the resolution,
+	// if the list contains shadings split according to it) or if the list
+	// has been dropped by the cache
+	//
+	if (sout && pagedict == _page->getDictionary())
+	{
+		DisplayListCache& cache = pdf->getDisplayListCache ();
+		unsigned long stamp = pdf->getCXref()->getChangeStamp();
+		boost::shared_ptr<DisplayListOutputDev> list = _displayList.lock ();
+		if (_displayListStamp != stamp || (list && list->isResolutionDependent() &&
+				 (list->getHDPI() != _params.hDpi || list->getVDPI() != _params.vDpi)))
+		{
+			if (list)
+				cache.remove (list.get());
+			list.reset ();
+			_displayDirectly = false;
+		}
+		if (!list && !_displayDirectly)
+		{
+			list = boost::shared_ptr<DisplayListOutputDev> (new DisplayListOutputDev (cache.getBudget ()));
+			list->record (&page, xpdfCatalog.get(), _params.hDpi, _params.vDpi);
+			_displayListStamp = stamp;
+			kernelPrintDbg (debug::DBG_DBG, "recorded " << list->getLength ()
+					<< " operations, " << list->getMemoryUsage () << " bytes");
+			// pages which can't be kept are drawn directly until they change
+			if (!list->isOk () || list->getMemoryUsage () > cache.getBudget ())
+			{
+				list.reset ();
+				_displayDirectly = true;
+			}
+			_displayList = list;
+		}
+		if (list)
+		{
+			cache.use (list);
+			list->replay (&out, &page, _params.hDpi, _params.vDpi,
+					0, _params.useMediaBox, _params.crop,
+					x, y, w, h);
+			return;
+		}
+	}
+
 	//
 	// Page object display (..., useMediaBox, crop, links, catalog)
 	//
@@ -136,6 +264,23 @@ CPageDisplay::displayPage (::OutputDev& out,
 
 
 
+//
+//
+//
+void
+CPageDisplay::invalidateDisplayList ()
+{
+	boost::shared_ptr<DisplayListOutputDev> list = _displayList.lock ();
+	_displayList.reset ();
+	_displayDirectly = false;
+	if (!list || !_page || !_page->getDictionary())
+		return;
+	boost::shared_ptr<CPdf> pdf = _page->getDictionary()->getPdf().lock();
+	if (pdf)
+		pdf->getDisplayListCache().remove (list.get());
+}
+
+
 //
 //
 //
@@ -40,6 +40,72 @@ class CPage;
 class CDict;
 
 
+//=====================================================================================
+// DisplayListCache
+//=====================================================================================
+
+/**
+ * Display lists of pages of one document.
+ *
+ * Lists are kept while their total size fits into the budget, the least
+ * recently used ones are dropped first. Pages refer to their lists weakly, a
+ * dropped list is recorded again when the page is displayed next time.
+ *
+ * @see CPdf::getDisplayListCache
+ */
+class DisplayListCache : public noncopyable
+{
+public:
+	typedef boost::shared_ptr<DisplayListOutputDev> DisplayListPtr;
+
+	/** Default budget in bytes. */
+	static const size_t DEFAULT_BUDGET = 64 * 1024 * 1024;
+
+	// Variables
+private:
+	typedef std::list<std::pair<DisplayListPtr, size_t> > Lists;
+	typedef std::map<const DisplayListOutputDev*, Lists::iterator> Index;
+	Lists _lists;		/**< Lists with their sizes, most recently used first. */
+	Index _index;		/**< Positions of lists in _lists. */
+	size_t _size;		/**< Total size of kept lists. */
+	size_t _budget;		/**< Maximal total size of kept lists. */
+
+	// Ctor
+public:
+	DisplayListCache (size_t budget = DEFAULT_BUDGET) : _size (0), _budget (budget) {}
+
+	// Methods
+public:
+	/** Returns maximal total size of kept lists. */
+	size_t getBudget () const
+		{ return _budget; }
+
+	/** Sets maximal total size of kept lists, drops lists over it. */
+	void setBudget (size_t budget);
+
+	/** Returns total size of kept lists. */
+	size_t getMemoryUsage () const
+		{ return _size; }
+
+	/**
+	 * Marks the list as the most recently used one.
+	 * The list is kept from now on if it is not yet. The least recently used
+	 * lists are dropped if the budget is exceeded.
+	 */
+	void use (DisplayListPtr list);
+
+	/** Drops the list if it is kept. */
+	void remove (const DisplayListOutputDev* list);
+
+	/** Drops all lists. */
+	void clear ();
+
+private:
+	/** Drops least recently used lists until the budget is met. */
+	void shrink ();
+};
+
+
 //=====================================================================================
 // CPageDisplay 
 //=====================================================================================
@@ -55,11 +121,18 @@ private:
 	CPage* _page;
 	/** Actual display parameters. */
 	DisplayParams _params;
+	/** Recorded drawing operations of the page kept by the document
+	 * DisplayListCache, see displayPage. */
+	boost::weak_ptr<DisplayListOutputDev> _displayList;
+	/** Xref change stamp at which _displayList was recorded. */
+	unsigned long _displayListStamp;
+	/** The page can't be recorded at _displayListStamp and is drawn directly. */
+	bool _displayDirectly;
 
 
 	// Ctor & Dtor
 public:
-	CPageDisplay (CPage* page) : _page(page) {}
+	CPageDisplay (CPage* page) : _page(page), _displayListStamp(0), _displayDirectly(false) {}
 	~CPageDisplay () 
 		{ _page = NULL; }
 
@@ -122,6 +195,12 @@ public:
 	 */
 	void setDisplayParams (const DisplayParams& dp);
 
+	/**
+	 * Returns actual display params.
+	 */
+	const DisplayParams& getDisplayParams () const
+		{ return _params; }
+
 	/**
 	 * Draws page on an output device.
 	 * Use old display params.
@@ -131,6 +210,15 @@ public:
 	/**
 	 * Draws page using specified page dictionary on an output device with last used display parameters.
 	 *
+	 * When this page is drawn on a splash device, its content stream is
+	 * interpreted only once per document change: the drawing operations
+	 * are recorded into a display list which is then replayed at the
+	 * requested resolution, rotation and slice. Pages with axial or radial
+	 * shadings are recorded again when the resolution changes. Pages with
+	 * DCT images are drawn directly, so that the images can be decoded at
+	 * reduced resolution. Lists of all pages of the document share the
+	 * budget of its DisplayListCache.
+	 *
 	 * @param out Output device.
 	 * @param dict If not null, page is created from dict otherwise
 	 * this page dictionary is used. But still some information is gathered from this page dictionary.
@@ -145,6 +233,12 @@ public:
 	void createXpdfDisplayParams (boost::shared_ptr<GfxResources>& res, 
 								  boost::shared_ptr<GfxState>& state);
 
+	/**
+	 * Drops the recorded display list.
+	 * It is recorded again by the next displayPage call.
+	 */
+	void invalidateDisplayList ();
+
 
 }; // class CPageDisplay
 
@@ -28,11 +28,13 @@
 #include "kernel/cobjecthelpers.h"
 #include "kernel/cpdf.h"
 #include "kernel/cpage.h"
+#include "kernel/cpagedisplay.h"
 #include "kernel/factories.h"
 #include "utils/debug.h"
 #include "kernel/cpageattributes.h"
 #include "kernel/pdfedit-core-dev.h"
 #include "kernel/streamwriter.h"
+#include "kernel/loadprogress.h"
 
 using namespace boost;
 using namespace std;
@@ -1658,18 +1660,19 @@ void CPdf::initRevisionSpecific()
 		registerPageTreeObservers(pageTreeRoot);
 }
 
-CPdf::CPdf(StreamWriter * stream, OpenMode openMode)
+CPdf::CPdf(StreamWriter * stream, OpenMode openMode, LoadProgress * progress)
 	:pageTreeRootObserver(new PageTreeRootObserver(this)),
 	 pageTreeNodeObserver(new PageTreeNodeObserver(this)),
 	 pageTreeKidsObserver(new PageTreeKidsObserver(this)),
 	 id(NO_PDF_ID),
 	 change(false), 
+	 transactionDepth(0),
 	 modeController(NULL)
 {
 	// gets xref writer - if error occures, exception is thrown 
 	// Note that we can't do anything that could use cobjects here
 	// because of weak_ptr & shared_ptr are not initialized yet
-	xref=new XRefWriter(stream, this);
+	xref=new XRefWriter(stream, this, progress);
 	mode=openMode;
 
 	// sets mode accoring openMode
@@ -1815,6 +1818,9 @@ CPdf::~CPdf()
 {
 	kernelPrintDbg(DBG_DBG, "");
 
+	// display lists keep fonts of the document
+	displayLists.reset();
+
 	// deallocates XRefWriter
 	delete xref;
 
@@ -2241,6 +2247,18 @@ void CPdf::changeIndirectProperty(const boost::shared_ptr<IProperty> &prop)
 		throw CObjInvalidObject();
 	}
 
+	// the same instance is written to the xref at the end of transaction, 
+	// so that bulk changes don't serialize it again and again
+	if(inTransaction() && prop==getIndirectProperty(indiRef))
+	{
+		kernelPrintDbg(DBG_DBG, "Change of "<<indiRef<<" postponed");
+		pendingIndirectChanges[indiRef]=prop;
+		change=true;
+		return;
+	}
+	// this change replaces any pending one
+	pendingIndirectChanges.erase(indiRef);
+
 	// gets xpdf Object instance and calls xref->change
 	// changeObject may throw if we are in read only mode or if xrefwriter is
 	// in paranoid mode and type check fails - to make it easier for such a case
@@ -2267,6 +2285,98 @@ void CPdf::changeIndirectProperty(const boost::shared_ptr<IProperty> &prop)
 	change=true;
 }
 
+void CPdf::flushIndirectChanges()const
+{
+	while(!pendingIndirectChanges.empty())
+	{
+		IndirectMapping::iterator i=pendingIndirectChanges.begin();
+		IndiRef indiRef=i->first;
+		boost::shared_ptr<IProperty> prop=i->second;
+
+		kernelPrintDbg(DBG_DBG, "Registering postponed change of "<<indiRef);
+		boost::shared_ptr<Object> propObject(prop->_makeXpdfObject(), xpdf::object_deleter());
+		xref->changeObject(indiRef.num, indiRef.gen, propObject.get());
+		// removed only when written, so that a failed write stays pending
+		pendingIndirectChanges.erase(indiRef);
+	}
+}
+
+void CPdf::beginTransaction()
+{
+	++transactionDepth;
+	kernelPrintDbg(DBG_DBG, "depth="<<transactionDepth);
+}
+
+void CPdf::commitTransaction()
+{
+	kernelPrintDbg(DBG_DBG, "depth="<<transactionDepth);
+	assert(transactionDepth);
+	if(transactionDepth!=1)
+	{
+		if(transactionDepth)
+			--transactionDepth;
+		return;
+	}
+
+	// transaction stays open while dispatching, so that changes made by
+	// observers are collected and dispatched in this loop too
+	try
+	{
+		for(;;)
+		{
+			// observers may work with xpdf objects
+			flushIndirectChanges();
+			if(pendingChanges.empty())
+				break;
+
+			boost::shared_ptr<IPendingChange> pending=pendingChanges.front().second;
+			pendingChangesIndex.erase(pendingChanges.front().first);
+			pendingChanges.pop_front();
+			pending->dispatch();
+		}
+	}catch(...)
+	{
+		kernelPrintDbg(DBG_ERR, "Dispatching of postponed changes failed. Dropping "
+				<<pendingChanges.size()<<" notifications");
+		pendingChanges.clear();
+		pendingChangesIndex.clear();
+		transactionDepth=0;
+		// properties already hold new values, so they have to get to the 
+		// xref even though their observers are not notified. If this fails
+		// as well, they stay pending and are written by the next flush.
+		flushIndirectChanges();
+		throw;
+	}
+	transactionDepth=0;
+}
+
+bool CPdf::deferChange(const void * subject, const std::string & id, boost::shared_ptr<IPendingChange> change)
+{
+	if(!inTransaction())
+		return false;
+
+	PendingChangeKey key(subject, id);
+	std::map<PendingChangeKey, PendingChanges::iterator>::iterator i=pendingChangesIndex.find(key);
+	if(i!=pendingChangesIndex.end())
+		i->second->second->merge(*change);
+	else
+		pendingChangesIndex.insert(std::make_pair(key, 
+				pendingChanges.insert(pendingChanges.end(), std::make_pair(key, change))));
+	return true;
+}
+
+void CPdf::dropChanges(const void * subject)
+{
+	// keys are ordered by subject first
+	std::map<PendingChangeKey, PendingChanges::iterator>::iterator 
+		i=pendingChangesIndex.lower_bound(PendingChangeKey(subject, std::string()));
+	while(i!=pendingChangesIndex.end() && i->first.first==subject)
+	{
+		pendingChanges.erase(i->second);
+		pendingChangesIndex.erase(i++);
+	}
+}
+
 /** Deleter for file based CPdf instance.
  * Used by shared_ptr as destructor. It is initialized from file handle used 
  * for CPdf and it is responsible for proper CPdf deallocation and file handle
@@ -2294,7 +2404,7 @@ public:
 	}
 };
 
-boost::shared_ptr<CPdf> CPdf::getInstance(const char * filename, OpenMode mode)
+boost::shared_ptr<CPdf> CPdf::getInstance(const char * filename, OpenMode mode, LoadProgress * progress)
 {
 using namespace std;
 
@@ -2335,7 +2445,9 @@ using namespace std;
 	boost::shared_ptr<CPdf> instance;
 	try
 	{
-		instance = boost::shared_ptr<CPdf>(new CPdf(stream, mode), PdfFileDeleter(file));
+		if(progress)
+			progress->stage(LoadProgress::OpenStage, 0);
+		instance = boost::shared_ptr<CPdf>(new CPdf(stream, mode, progress), PdfFileDeleter(file));
 		instance->_this = instance;
 
 		// initializes revision specific data for the newest revision
@@ -2349,9 +2461,34 @@ using namespace std;
 		// prevent from changes at all.
 		if(instance->isLinearized())
 			instance->mode = ReadOnly;
+
+		if(progress)
+		{
+			// page count is cached, so it is cheap for the user 
+			// of the instance then
+			progress->checkCanceled();
+			if(!instance->needsCredentials())
+			{
+				progress->stage(LoadProgress::PagesStage, 0);
+				progress->step(instance->getPageCount());
+			}
+			progress->checkCanceled();
+			progress->stage(LoadProgress::DoneStage, 0);
+		}
 		kernelPrintDbg(debug::DBG_INFO, "Instance created successfully file="
 				<<filename<<" openMode=" << openMode);
 		return instance;
+	}catch(LoadCanceledException &)
+	{
+		// closes file handle if constructor didn't finish (same as
+		// bellow) and keeps the exception type for the caller
+		if(!instance) 
+		{
+			fclose(file);
+		}
+		kernelPrintDbg(DBG_INFO, "Pdf instance creation canceled. filename="
+				<<filename);
+		throw;
 	}catch(std::exception &e)
 	{
 		// If we have failed in constructor then we have to close file handle
@@ -2503,6 +2640,68 @@ size_t CPdf::getPagePosition(const boost::shared_ptr<CPage> &page)const
 	throw PageNotFoundException();
 }
 
+MemoryUsage CPdf::getMemoryUsage()const
+{
+using namespace utils;
+
+	kernelPrintDbg(DBG_DBG, "");
+
+	MemoryUsage usage;
+
+	// cached indirect objects
+	for(IndirectMapping::const_iterator i=indMap.begin(); i!=indMap.end(); ++i)
+		usage.cachedObjects+=mapNodeSize<IndirectMapping::value_type>()
+			+ getPropertyMemoryUsage(*i->second, usage.streamBuffers);
+
+	// returned pages and their operators (page dictionaries are cached
+	// objects)
+	for(PageList::const_iterator i=pageList.begin(); i!=pageList.end(); ++i)
+	{
+		usage.cachedObjects+=mapNodeSize<PageList::value_type>() + sizeof(CPage);
+		std::vector<boost::shared_ptr<CContentStream> > streams;
+		i->second->getParsedContentStreams(streams);
+		for(size_t s=0; s<streams.size(); ++s)
+		{
+			CContentStream::Operators operators;
+			streams[s]->getPdfOperators(operators);
+			usage.operators+=sizeof(CContentStream);
+			for(CContentStream::Operators::const_iterator op=operators.begin(); op!=operators.end(); ++op)
+				usage.operators+=getOperatorMemoryUsage(**op);
+		}
+	}
+
+	// properties changed in the current transaction are usually cached too
+	for(IndirectMapping::const_iterator i=pendingIndirectChanges.begin(); i!=pendingIndirectChanges.end(); ++i)
+	{
+		usage.pendingChanges+=mapNodeSize<IndirectMapping::value_type>();
+		IndirectMapping::const_iterator cached=indMap.find(i->first);
+		if(cached==indMap.end() || cached->second!=i->second)
+		{
+			size_t streamBytes=0;
+			usage.pendingChanges+=getPropertyMemoryUsage(*i->second, streamBytes) + streamBytes;
+		}
+	}
+	usage.pendingChanges+=pendingChanges.size()
+		* (sizeof(PendingChanges::value_type) + 2*sizeof(void*)
+				+ mapNodeSize<std::pair<PendingChangeKey, PendingChanges::iterator> >());
+
+	// xref tables and changed objects
+	xref->getMemoryUsage(usage);
+
+	if(displayLists)
+		usage.displayLists=displayLists->getMemoryUsage();
+
+	kernelPrintDbg(DBG_DBG, "total="<<usage.total());
+	return usage;
+}
+
+DisplayListCache & CPdf::getDisplayListCache()const
+{
+	if(!displayLists)
+		displayLists.reset(new DisplayListCache());
+	return *displayLists;
+}
+
 
 void CPdf::consolidatePageList(const boost::shared_ptr<IProperty> & oldValue, const boost::shared_ptr<IProperty> & newValue)
 {
@@ -3131,6 +3330,7 @@ void CPdf::save(bool newRevision)const
 	// delegates all work to the XRefWriter and set change to 
 	// mark, that no changes were stored
 	// check for credentials is done in XRefWriter
+	flushIndirectChanges();
 	xref->saveChanges(newRevision);
 	change=false;
 }
@@ -3152,6 +3352,7 @@ using namespace debug;
 		throw NotImplementedException("Linearized PDF cloning is not supported");
 
 	// delagates to XRefWriter - check for credentials is done there
+	flushIndirectChanges();
 	xref->cloneRevision(file);
 }
 
@@ -3180,6 +3381,7 @@ void CPdf::changeRevision(revision_t revisionNum)
 	kernelPrintDbg(DBG_DBG, "");
 
 	// credentials are checked in XRefWriter
+	flushIndirectChanges();
 	xref->changeRevision(revisionNum);
 	
 	// prepares internal structures for new revision
@@ -32,6 +32,7 @@
 #include "kernel/modecontroller.h"
 #include "kernel/iproperty.h"
 #include "kernel/cstream.h"
+#include "kernel/memoryusage.h"
 
 class StreamWriter;
 
@@ -42,6 +43,8 @@ class IProperty;
 class CDict;
 class CXref;
 class CPage;
+class LoadProgress;
+class DisplayListCache;
 template<typename IP> inline boost::shared_ptr<CDict> getCDictFromDict (IP& ip, const std::string& key);
 
 namespace utils {
@@ -137,6 +140,32 @@ typedef std::map<const IndiRef, boost::shared_ptr<IProperty>, utils::IndComparat
  */
 typedef uintptr_t cpdf_id_t;
 
+/** Change postponed until the end of a transaction.
+ *
+ * Instances are collected by CPdf::deferChange, later changes of the same
+ * subject are merged to the first one and all changes are dispatched when the
+ * outermost transaction is committed.
+ *
+ * @see CPdf::beginTransaction
+ */
+class IPendingChange
+{
+public:
+	/** Empty destructor.
+	 */
+	virtual ~IPendingChange() {}
+
+	/** Merges later change of the same subject.
+	 * @param later Change with the same key made later (it has the same
+	 * type as this instance).
+	 */
+	virtual void merge(const IPendingChange & later) =0;
+
+	/** Dispatches the change (e.g. notifies observers).
+	 */
+	virtual void dispatch() =0;
+};
+
 /** Type for mapping from pdfs to their resolved storage.
  * Maps pdf identificators to their resolved reference storage.
  */
@@ -394,6 +423,13 @@ protected:
 			// TODO some constant
 			return 0;
 		}
+
+		/** Page tree has to be consistent even inside a transaction.
+		 */
+		virtual bool isSynchronous()const throw()
+		{
+			return true;
+		}
 	};
 
 	/** Observer for page tree node synchronization.
@@ -482,6 +518,13 @@ protected:
 			// TODO some constant
 			return 0;
 		}
+
+		/** Page tree has to be consistent even inside a transaction.
+		 */
+		virtual bool isSynchronous()const throw()
+		{
+			return true;
+		}
 	};
 
 	/** Observer for page tree node kids array synchronization.
@@ -573,6 +616,13 @@ protected:
 			// TODO some constant
 			return 0;
 		}
+
+		/** Page tree has to be consistent even inside a transaction.
+		 */
+		virtual bool isSynchronous()const throw()
+		{
+			return true;
+		}
 	};
 	
 	/** Observer for page tree root.
@@ -861,6 +911,39 @@ private:
 	 */
 	mutable IndirectMapping indMap;
 
+	/** Key of pending change.
+	 * Subject of the change and identifier of its changed part.
+	 */
+	typedef std::pair<const void *, std::string> PendingChangeKey;
+
+	/** Type for pending changes in the order they were made.
+	 */
+	typedef std::list<std::pair<PendingChangeKey, boost::shared_ptr<IPendingChange> > > PendingChanges;
+
+	/** Changes collected by the current transaction.
+	 */
+	PendingChanges pendingChanges;
+
+	/** Index to pendingChanges by key.
+	 */
+	std::map<PendingChangeKey, PendingChanges::iterator> pendingChangesIndex;
+
+	/** Indirect properties changed in the current transaction.
+	 *
+	 * Properties are written to the xref by flushIndirectChanges.
+	 */
+	mutable IndirectMapping pendingIndirectChanges;
+
+	/** Depth of nested transactions (0 if there is none).
+	 */
+	size_t transactionDepth;
+
+	/** Writes all pending indirect properties to the xref.
+	 *
+	 * @see changeIndirectProperty
+	 */
+	void flushIndirectChanges()const;
+
 	/** Document catalog dictionary.
 	 *
 	 * It is used for document property handling. Initialization is done by
@@ -895,6 +978,13 @@ private:
 	 */
 	mutable PageList pageList;
 
+	/** Display lists of returned pages.
+	 *
+	 * Created by the first getDisplayListCache call. All pages share it, so
+	 * that their lists fit into one memory budget.
+	 */
+	mutable boost::shared_ptr<DisplayListCache> displayLists;
+
 	/** Number of pages in document.
 	 *
 	 * Keeps value of actual number of pages or 0 if value is invalid and
@@ -1009,12 +1099,13 @@ private:
 	/** Initializating constructor.
 	 * @param stream Stream with data.
 	 * @param openMode Mode for this file.
+	 * @param progress Loading progress given to XRefWriter (may be NULL).
 	 *
 	 * Creates XRefWriter, initializes pageTreeWatchDog and finally calls
 	 * initRevisionSpecific method for initialization of internal structures
 	 * which depends on current revision.
 	 */
-	CPdf(StreamWriter * stream, OpenMode openMode);
+	CPdf(StreamWriter * stream, OpenMode openMode, LoadProgress * progress=NULL);
 	
 	/** Destructor.
 	 * 
@@ -1040,13 +1131,24 @@ public:
 	 *	will be created).
 	 * @param mode Mode to open file.
 	 *
+	 * @param progress Loading progress (may be NULL).
+	 *
 	 * This is only way how to get instance of CPdf type. All necessary 
 	 * initialization is done.
-	 *
+	 * <br>
+	 * If progress is given, all loading stages are reported to it (see
+	 * LoadProgress::Stage) and the page count is computed (and cached) 
+	 * as a part of loading, unless the document needs credentials.
+	 * Loading may be canceled by LoadProgress::cancel from other thread,
+	 * no instance is created in such case. As the kernel is not thread
+	 * safe, the returned instance may be used by other thread only when
+	 * this method has returned.
+	 *
+	 * @throw LoadCanceledException if loading has been canceled.
 	 * @throw PdfOpenException if file open fails.
 	 * @return Initialized (and ready to be used) CPdf instance.
 	 */
-	static boost::shared_ptr<CPdf> getInstance(const char * filename, OpenMode mode);
+	static boost::shared_ptr<CPdf> getInstance(const char * filename, OpenMode mode, LoadProgress * progress=NULL);
 
 	/** Returns unique identificator for this pdf.
 	 *
@@ -1202,6 +1304,117 @@ public:
 	 * paranoid check fails for new value.
 	 */
 	void changeIndirectProperty(const boost::shared_ptr<IProperty> &prop);
+
+	/** Starts a transaction.
+	 *
+	 * Until the matching commitTransaction call, changes of properties and
+	 * content streams of this document are collected instead of being
+	 * dispatched immediately. Changes of the same object (same dictionary
+	 * entry) are merged and observers are notified once when the outermost
+	 * transaction is committed. Indirect objects are written to the xref at
+	 * the same time. Observers returning true from isSynchronous (page tree
+	 * observers) are still notified immediately.
+	 * <br>
+	 * Transactions can be nested, only the outermost one dispatches changes.
+	 * Note that while a transaction is open, observers (e.g. page contents,
+	 * annotations or gui) see the state before the transaction.
+	 *
+	 * @see Transaction
+	 */
+	void beginTransaction();
+
+	/** Ends transaction started by beginTransaction.
+	 *
+	 * If this is the outermost transaction, dispatches all collected changes in
+	 * the order they were made. Changes made by observers during the dispatching
+	 * are collected and dispatched as well.
+	 *
+	 * @throw PdfException if a postponed change fails (collected 
+	 * notifications are dropped and transaction is closed, changed indirect
+	 * properties are still written to the xref).
+	 */
+	void commitTransaction();
+
+	/** Checks whether a transaction is open.
+	 */
+	bool inTransaction()const
+	{
+		return transactionDepth>0;
+	}
+
+	/** Postpones change until the end of transaction.
+	 * @param subject Changed object.
+	 * @param id Identifier of the changed part of the object.
+	 * @param change Pending change.
+	 *
+	 * If there already is a pending change with the same subject and id, given
+	 * change is merged to it.
+	 *
+	 * @return false if no transaction is open (change is not stored and
+	 * should be dispatched immediately), true otherwise.
+	 */
+	bool deferChange(const void * subject, const std::string & id, boost::shared_ptr<IPendingChange> change);
+
+	/** Drops all pending changes of given subject.
+	 * @param subject Object which is being destroyed.
+	 */
+	void dropChanges(const void * subject);
+
+	/** Scoped transaction.
+	 *
+	 * Begins transaction in constructor and commits it in destructor unless
+	 * commit has been called.
+	 * <pre>
+	 * {
+	 * 	CPdf::Transaction transaction(pdf);
+	 * 	// bulk changes
+	 * 	transaction.commit();
+	 * }
+	 * </pre>
+	 */
+	class Transaction: public noncopyable
+	{
+		boost::shared_ptr<CPdf> pdf;
+	public:
+		/** Begins transaction on given pdf.
+		 */
+		Transaction(boost::shared_ptr<CPdf> _pdf):pdf(_pdf)
+		{
+			pdf->beginTransaction();
+		}
+
+		/** Commits transaction.
+		 * Errors are reported by commit, so it should be used explicitly 
+		 * where it matters.
+		 */
+		void commit()
+		{
+			boost::shared_ptr<CPdf> p=pdf;
+			pdf.reset();
+			if(p)
+				p->commitTransaction();
+		}
+
+		/** Commits transaction if commit has not been called yet.
+		 * Commit errors are propagated unless the scope is left because of
+		 * another exception - they are only logged in such case.
+		 */
+		~Transaction()
+		{
+			if(!std::uncaught_exception())
+			{
+				commit();
+				return;
+			}
+			try
+			{
+				commit();
+			}catch(std::exception & e)
+			{
+				kernelPrintDbg(debug::DBG_CRIT, "Transaction commit failed: "<<e.what());
+			}
+		}
+	};
 	
 	/** Saves changes to pdf file.
 	 * @param newRevision Flag for new revision creation.
@@ -1557,6 +1770,24 @@ public:
 		return xref->getRevisionCount();
 	}
 
+	/** Estimates memory held by the document.
+	 *
+	 * Walks cached indirect objects, parsed content streams of returned
+	 * pages, cross reference tables, changes which are not saved yet and
+	 * display lists of pages.
+	 * Nothing is loaded or parsed, so the cost is linear in the size of
+	 * already loaded data and the method can be called at any time.
+	 *
+	 * @return Approximate number of bytes by category.
+	 */
+	MemoryUsage getMemoryUsage()const;
+
+	/** Returns display lists of pages of this document.
+	 *
+	 * @see CPageDisplay::displayPage
+	 */
+	DisplayListCache & getDisplayListCache()const;
+
 	/** Returns container of outlines and the string they represent.
 	 * @param cont Output container.
 	 *
@@ -26,7 +26,10 @@
 #include "xpdf/Object.h"
 #include "xpdf/encrypt_utils.h"
 #include "kernel/cxref.h"
+#include "kernel/xrefsnapshot.h"
+#include "kernel/memoryusage.h"
 #include "utils/debug.h"
+#include "utils/trace.h"
 #include "kernel/factories.h"
 #include "kernel/pdfedit-core-dev.h"
 
@@ -52,7 +55,7 @@ void CXref::init()
 	internal_fetch = false;
 }
 
-CXref::CXref(BaseStream * stream):XRef(stream), internal_fetch(true)
+CXref::CXref(BaseStream * stream):XRef(stream), internal_fetch(true), changeStamp(0)
 {
 	try
 	{
@@ -191,6 +194,7 @@ using namespace debug;
 		newStorage.put(ref, INITIALIZED_REF);
 		kernelPrintDbg(DBG_DBG, "newStorage entry changed to INITIALIZED_REF for "<<ref);
 	}
+	++changeStamp;
 	
 	// returns old version
 	return changed;
@@ -239,6 +243,7 @@ using namespace debug;
 	// dictionary
 	if(prev)
 		gfree(key);
+	++changeStamp;
 
 	return prev;
 }
@@ -572,6 +577,8 @@ using namespace debug;
 {
 	using namespace debug;
 
+	TRACE_SCOPE("kernel", "CXref::fetch");
+	trace::count(trace::OBJECTS_FETCHED);
 	kernelPrintDbg(DBG_DBG, "num="<<num<<" gen="<<gen);
 	
 	// internal objects fetching don't require credentials.
@@ -680,6 +687,23 @@ int CXref::getNumObjects()const
 	return XRef::getNumObjects() + newSize;
 }
 
+void CXref::getMemoryUsage(MemoryUsage & usage)const
+{
+	// tables of all revisions share their chunks
+	std::set<const XRefSnapshot::Chunk *> counted;
+	size_t tables = size * sizeof(XRefEntry);
+	for(Snapshots::const_iterator i=snapshots.begin(); i!=snapshots.end(); ++i)
+		tables += utils::mapNodeSize<Snapshots::value_type>() + i->second->getMemoryUsage(counted);
+	usage.xrefTables += tables;
+
+	size_t changes = 0;
+	for(ChangedStorage::ConstIterator i=changedStorage.begin(); i!=changedStorage.end(); ++i)
+		changes += utils::mapNodeSize<ChangedStorage::ConstIterator::value_type>()
+			+ sizeof(ObjectEntry) + utils::getXpdfObjectMemoryUsage(*i->second->object);
+	changes += newStorage.size() * utils::mapNodeSize<RefStorage::ConstIterator::value_type>();
+	usage.pendingChanges += changes;
+}
+
 
 void CXref::reopen(size_t xrefOff, bool dropChanges)
 {
@@ -692,20 +716,162 @@ using namespace debug;
 	if(dropChanges)
 		cleanUp();
 
-	// clears XRef internals and forces to fill them again
-	kernelPrintDbg(DBG_DBG, "Destroing XRef internals");
-	XRef::destroyInternals();
-	kernelPrintDbg(DBG_DBG, "Initializes XRef internals");
-	XRef::initInternals(xrefOff);
+	if(!switchToSnapshot(getSnapshot(xrefOff)))
+	{
+		// clears XRef internals and forces to fill them again
+		kernelPrintDbg(DBG_DBG, "Destroing XRef internals");
+		XRef::destroyInternals();
+		kernelPrintDbg(DBG_DBG, "Initializes XRef internals");
+		XRef::initInternals(xrefOff);
+		currentSnapshot.reset();
+	}
 
 	// sets lastXRefPos to xrefOff, because initRevisionSpecific doesn't do it
 	lastXRefPos=xrefOff;
+	++changeStamp;
 	kernelPrintDbg(DBG_DBG, "New lastXRefPos value="<<lastXRefPos);
 
 	// checks encryption state for the revision
 	checkEncryptedContent();
 }
 
+void CXref::appendRevision(size_t xrefOff, const std::vector<std::pair< ::Ref, size_t> > & offsets)
+{
+using namespace debug;
+
+	kernelPrintDbg(DBG_DBG, "xrefOff="<<xrefOff<<" objects="<<offsets.size());
+
+	// the current table is the base for the new revision - it hasn't been
+	// parsed by sections if there was no reopen yet. The trailer has already
+	// been rewritten so the base can't be cached for its revision
+	boost::shared_ptr<const XRefSnapshot> base=currentSnapshot;
+	if(!base)
+	{
+		::Object null;
+		null.initNull();
+		base.reset(new XRefSnapshot(NULL, entries, size, maxObj, &null));
+	}
+
+	// getTrailerDict has been updated by the writer to the written trailer
+	boost::shared_ptr<const XRefSnapshot> snapshot(new XRefSnapshot(base.get(), offsets, getTrailerDict()));
+	snapshots[xrefOff]=snapshot;
+
+	cleanUp();
+	if(!switchToSnapshot(snapshot))
+	{
+		kernelPrintDbg(DBG_WARN, "Unable to use written section. Parsing it.");
+		snapshots.erase(xrefOff);
+		reopen(xrefOff);
+		return;
+	}
+
+	lastXRefPos=xrefOff;
+	++changeStamp;
+	kernelPrintDbg(DBG_DBG, "New lastXRefPos value="<<lastXRefPos);
+	checkEncryptedContent();
+}
+
+bool CXref::switchToSnapshot(boost::shared_ptr<const XRefSnapshot> snapshot)
+{
+using namespace debug;
+
+	if(!snapshot)
+		return false;
+	::Object root;
+	bool valid=snapshot->getTrailer()->dictLookupNF("Root", &root)->isRef();
+	root.free();
+	if(!valid)
+	{
+		kernelPrintDbg(DBG_WARN, "Snapshot trailer doesn't contain Root reference.");
+		return false;
+	}
+
+	// copies just entries which differ from the current table
+	kernelPrintDbg(DBG_DBG, "Switching XRef internals to the snapshot");
+	entries = (XRefEntry *)greallocn(entries, snapshot->getSize(), sizeof(XRefEntry));
+	size_t copied = snapshot->copyTo(entries, currentSnapshot.get());
+	XRef::switchInternals(snapshot->getSize(), snapshot->getMaxObj(), snapshot->getTrailer());
+	currentSnapshot = snapshot;
+	kernelPrintDbg(DBG_DBG, copied<<" entries of "<<snapshot->getSize()<<" copied");
+	return true;
+}
+
+namespace {
+
+/** Parsed xref section waiting for its snapshot.
+ */
+struct XRefSection
+{
+	size_t off;
+	XRefEntry * entries;
+	int size;
+	Guint maxObj;
+	::Object trailer;
+};
+
+} // namespace
+
+boost::shared_ptr<const XRefSnapshot> CXref::getSnapshot(size_t xrefOff)
+{
+using namespace debug;
+
+	std::vector<XRefSection> sections;
+	std::set<size_t> visited;
+	boost::shared_ptr<const XRefSnapshot> snapshot;
+
+	// collects sections until the first one with a known snapshot
+	size_t off=xrefOff;
+	bool ok=true;
+	while(true)
+	{
+		Snapshots::const_iterator i=snapshots.find(off);
+		if(i!=snapshots.end())
+		{
+			snapshot=i->second;
+			break;
+		}
+		if(!visited.insert(off).second)
+		{
+			kernelPrintDbg(DBG_ERR, "Prev points to already processed section "
+					"(endless loop). Assuming no more sections.");
+			break;
+		}
+		XRefSection section;
+		section.off=off;
+		Guint prev;
+		GBool hasPrev;
+		if(!XRef::readXRefSection((Guint)off, &section.entries, &section.size, 
+					&section.maxObj, &section.trailer, &prev, &hasPrev))
+		{
+			kernelPrintDbg(DBG_WARN, "Unable to parse xref section at "<<off);
+			ok=false;
+			break;
+		}
+		sections.push_back(section);
+		if(!hasPrev)
+			break;
+		off=prev;
+	}
+
+	// creates snapshots from the oldest section
+	for(std::vector<XRefSection>::reverse_iterator i=sections.rbegin(); i!=sections.rend(); ++i)
+	{
+		if(ok)
+		{
+			snapshot.reset(new XRefSnapshot(snapshot.get(), i->entries, 
+						i->size, i->maxObj, &i->trailer));
+			snapshots[i->off]=snapshot;
+			kernelPrintDbg(DBG_DBG, "Snapshot for section at "<<i->off<<" created");
+		}
+		gfree(i->entries);
+		i->trailer.free();
+	}
+	if(!ok)
+		return boost::shared_ptr<const XRefSnapshot>();
+
+	return snapshot;
+}
+
 bool CXref::checkEncryptedContent()
 {
 	boost::shared_ptr< ::Object> encrypt(XPdfObjectFactory::getInstance(), xpdf::object_deleter());
@@ -45,6 +45,9 @@ const int MAXOBJNUM = INT_MAX;
  */
 const int MAXOBJGEN = 65535;
 
+class XRefSnapshot;
+struct MemoryUsage;
+
 
 /** Adapter for xpdf XRef class.
  * 
@@ -111,6 +114,40 @@ private:
 	 */
 	bool internal_fetch;
 
+	/** Change stamp.
+	 * Increased by each change of an object or the trailer and by reopen.
+	 * @see getChangeStamp
+	 */
+	unsigned long changeStamp;
+
+	/** Snapshots of revision tables keyed by their xref section offsets.
+	 * Filled by reopen, each xref section is parsed just once.
+	 */
+	typedef std::map<size_t, boost::shared_ptr<const XRefSnapshot> > Snapshots;
+	Snapshots snapshots;
+
+	/** Snapshot whose entries are in XRef::entries array (if any).
+	 */
+	boost::shared_ptr<const XRefSnapshot> currentSnapshot;
+
+	/** Returns snapshot of the table for given xref section offset.
+	 * @param xrefOff Offset of the newest xref section of the revision.
+	 *
+	 * Parses sections which are not known yet and creates snapshots for
+	 * them on top of the snapshot of their Prev section.
+	 *
+	 * @return Snapshot or NULL if some of the sections is malformed.
+	 */
+	boost::shared_ptr<const XRefSnapshot> getSnapshot(size_t xrefOff);
+
+	/** Uses given snapshot as the current table.
+	 * @param snapshot Snapshot of a revision (may be NULL).
+	 *
+	 * @return false if the snapshot is NULL or unusable (XRef internals are
+	 * not changed in such case), true otherwise.
+	 */
+	bool switchToSnapshot(boost::shared_ptr<const XRefSnapshot> snapshot);
+
 	/** Core initialization for instance.
 	 * Called by constructor only.
 	 */
@@ -121,7 +158,7 @@ protected:
 	 * This constructor is protected to prevent uninitialized instances.
 	 * We need at least to specify stream with data.
 	 */
-	CXref(): XRef(NULL), needs_credentials(false), internal_fetch(false){}
+	CXref(): XRef(NULL), needs_credentials(false), internal_fetch(false), changeStamp(0){}
 
 	/** Entry for ChangedStorage.
 	 *
@@ -225,6 +262,11 @@ protected:
 	 * to throw away all internal structures as well and parse them again from 
 	 * the given stream position.
 	 * <br>
+	 * Tables of revisions are kept as snapshots, so xref sections which
+	 * have been parsed once are not parsed again and only entries which
+	 * differ from the current table are copied. Full parsing (with xref
+	 * reconstruction) is used only if a section is malformed.
+	 * <br>
 	 * If the dropChanges flag is true then also all changed objects are droped.
 	 * This flag should be set to false when we are changing the current 
 	 * revision and kept in default (true) value otherwise (final cleanup, saving
@@ -232,6 +274,17 @@ protected:
 	 */
 	void reopen(size_t xrefOff, bool dropChanges=true);
 
+	/** Switches to the revision which has just been written.
+	 * @param xrefOff Offset of the written cross reference section.
+	 * @param offsets References and file offsets of all objects written to
+	 * the section.
+	 *
+	 * Has the same effect as reopen(xrefOff) but the new table is created
+	 * from the current one and given offsets, the written section is not
+	 * parsed. Current trailer has to be the written one.
+	 */
+	void appendRevision(size_t xrefOff, const std::vector<std::pair< ::Ref, size_t> > & offsets);
+
 	/** Reserves reference for new indirect object.
 	 *
 	 * Searches for free object number and generation number and uses
@@ -376,6 +429,20 @@ public:
 	 */
 	virtual ~CXref();
 
+	/** Returns change stamp.
+	 *
+	 * The stamp is increased whenever an object or the trailer is changed
+	 * and when the xref is reopened (e.g. when the revision is changed).
+	 * Caches of data derived from objects (e.g. recorded page display
+	 * lists) compare stamps to find out that they are stale.
+	 *
+	 * @return Current change stamp.
+	 */
+	unsigned long getChangeStamp()const
+	{
+		return changeStamp;
+	}
+
 	/** Sets credentials for encrypted documents.
 	 * This method is mandatory prerequisity if encrypted content is required.
 	 * If it has not been called before the fetch method is called, it will
@@ -476,6 +543,15 @@ public:
 	 */
 	virtual int getNumObjects()const; 
 
+	/** Estimates memory held by the cross reference tables and changes.
+	 * @param usage Structure where xrefTables and pendingChanges are
+	 * updated.
+	 *
+	 * Snapshots of all known revisions and changed objects which are
+	 * not saved yet are included.
+	 */
+	void getMemoryUsage(MemoryUsage & usage)const;
+
 	/** Fetches object.
 	 * @param num Object number.
 	 * @param gen Object generation.
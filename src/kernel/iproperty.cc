@@ -121,6 +121,106 @@ IProperty::dispatchChange () const
 }
 
 
+//
+// Postponed notifications
+//
+
+/** Notification postponed by a transaction. */
+class IProperty::PendingNotification : public IPendingChange
+{
+public:
+	typedef std::vector<IPropertyObserverSubject::Observer> Observers;
+
+	IProperty* subject;
+	boost::shared_ptr<IProperty> newValue;
+	boost::shared_ptr<const ObserverContext> context;
+	Observers observers;	/**< Observers to notify. */
+
+	PendingNotification (IProperty* _subject, boost::shared_ptr<IProperty> _newValue, boost::shared_ptr<const ObserverContext> _context)
+		: subject (_subject), newValue (_newValue), context (_context) {}
+
+	// Keep the original context, take the new value and notify everybody
+	// interested in any of the changes
+	virtual void merge (const IPendingChange& later)
+	{
+		const PendingNotification& other = static_cast<const PendingNotification&> (later);
+		newValue = other.newValue;
+		for (Observers::const_iterator it = other.observers.begin(); it != other.observers.end(); ++it)
+			if (observers.end() == std::find (observers.begin(), observers.end(), *it))
+				observers.push_back (*it);
+	}
+
+	// Observers unregistered in the meantime are not notified
+	virtual void dispatch ()
+	{
+		for (Observers::const_iterator it = observers.begin(); it != observers.end(); ++it)
+			if ((*it)->isActive() && subject->observers.end() != subject->observers.find (*it))
+				(*it)->notify (newValue, context);
+	}
+};
+
+namespace {
+	/**
+	 * Returns identifier of the changed part of a complex property.
+	 *
+	 * Array changes are never merged, because an index does not identify an
+	 * item when items are inserted or removed.
+	 */
+	std::string changeId (const IPropertyObserverSubject::ObserverContext* context)
+	{
+		static unsigned long unique = 0;
+		if (!context || observer::BasicChangeContextType == context->getType())
+			return std::string ();
+		const CDict::CDictComplexObserverContext* dictContext = 
+			dynamic_cast<const CDict::CDictComplexObserverContext*> (context);
+		if (dictContext)
+			return "/" + dictContext->getValueId();
+		std::ostringstream oss;
+		oss << "#" << ++unique;
+		return oss.str();
+	}
+} // namespace
+
+//
+//
+//
+void
+IProperty::notifyObservers (boost::shared_ptr<IProperty> newValue, boost::shared_ptr<const ObserverContext> context)
+{
+	boost::shared_ptr<CPdf> p = pdf.lock();
+	if (!p || !p->inTransaction())
+	{
+		IPropertyObserverSubject::notifyObservers (newValue, context);
+		return;
+	}
+
+	boost::shared_ptr<PendingNotification> pending (new PendingNotification (this, newValue, context));
+	for (ObserverList::const_iterator it = observers.begin(); it != observers.end(); ++it)
+	{
+		Observer o = *it;
+		if (!o->isActive())
+			continue;
+		if (o->isSynchronous())
+			o->notify (newValue, context);
+		else
+			pending->observers.push_back (o);
+	}
+	if (!pending->observers.empty())
+		p->deferChange (this, changeId (context.get()), pending);
+}
+
+//
+//
+//
+void
+IProperty::_dropPendingChanges () const
+{
+	boost::shared_ptr<CPdf> p = pdf.lock();
+	if (p && p->inTransaction())
+		p->dropChanges (this);
+}
+
+
 //=====================================================================================
 // Output functions
 //=====================================================================================
@@ -276,6 +276,29 @@ public:
 	 */
 	void unlockChange () {assert (false == wantDispatch); wantDispatch = true;}
 
+	/**
+	 * Notify observers about a change.
+	 *
+	 * If the pdf of this object is in a transaction, only synchronous
+	 * observers are notified now and the notification of the others is
+	 * postponed (see CPdf::beginTransaction). Changes of the same dictionary
+	 * entry are merged, observers get the original value from the first
+	 * change and the new value from the last one.
+	 *
+	 * @param newValue New value.
+	 * @param context Context of the change.
+	 */
+	virtual void notifyObservers (boost::shared_ptr<IProperty> newValue, boost::shared_ptr<const ObserverContext> context);
+
+private:
+	/** Postponed notification. */
+	class PendingNotification;
+
+	/** Drops postponed notifications of this object. */
+	void _dropPendingChanges () const;
+
+public:
+
 	/**
 	 * Create xpdf object from this object. This is a factory method because we
 	 * do not know the type of instance of this object.
@@ -289,6 +312,7 @@ public:
 	 */
 	virtual ~IProperty () {
 		check_observerlist (this->observers);
+		_dropPendingChanges ();
 	}
 
 }; /* class IProperty */
@@ -0,0 +1,133 @@
+/*
+ * PDFedit - free program for PDF document manipulation.
+ * Copyright (C) 2006-2009  PDFedit team: Michal Hocko,
+ *                                        Jozef Misutka,
+ *                                        Martin Petricek
+ *                   Former team members: Miroslav Jahoda
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program (in doc/LICENSE.GPL); if not, write to the 
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, 
+ * MA  02111-1307  USA
+ *
+ * Project is hosted on http://sourceforge.net/projects/pdfedit
+ */
+// vim:tabstop=4:shiftwidth=4:noexpandtab:textwidth=80
+
+#ifndef _LOADPROGRESS_H_
+#define _LOADPROGRESS_H_
+
+#include "kernel/exceptions.h"
+
+//=====================================================================================
+namespace pdfobjects {
+//=====================================================================================
+
+/** Exception thrown when document loading was canceled.
+ * It is a PdfOpenException so that code which does not care about
+ * cancelation handles it as any other failed open.
+ */
+class LoadCanceledException: public PdfOpenException
+{
+public:
+	LoadCanceledException():PdfOpenException("Document loading canceled."){}
+};
+
+/** Progress of document loading.
+ *
+ * Instance can be given to CPdf::getInstance which reports each loading
+ * stage and steps inside stages to it. Implementator should provide
+ * visualization by overriding stage and step methods (both are called
+ * from the thread which opens the document, so they have to pass
+ * information to user interface in a thread safe way if the document is
+ * loaded in background).
+ * <br>
+ * Loading can be canceled from any other thread by cancel method. Loader
+ * checks the flag between steps and throws LoadCanceledException when it
+ * is set, so the document is not created at all.
+ */
+class LoadProgress
+{
+public:
+	/** Loading stages in order in which they come.
+	 */
+	enum Stage {
+		/** Parsing cross reference table. */
+		OpenStage, 
+		/** Collecting document revisions. */
+		RevisionsStage, 
+		/** Counting pages. */
+		PagesStage, 
+		/** Document is loaded. */
+		DoneStage
+	};
+private:
+	/** Flag set when loading should stop.
+	 * It is volatile, because it is set asynchronously from other thread.
+	 */
+	volatile bool canceled;
+public:
+	/** Initializes non canceled progress.
+	 */
+	LoadProgress():canceled(false) {}
+
+	/** Default virtual destructor.
+	 */
+	virtual ~LoadProgress() {}
+
+	/** Asks loader to stop as soon as possible.
+	 * Can be called from any thread.
+	 */
+	void cancel()
+	{
+		canceled=true;
+	}
+
+	/** Checks whether cancel was requested.
+	 * @return true if the loading should stop.
+	 */
+	bool isCanceled()const
+	{
+		return canceled;
+	}
+
+	/** Throws LoadCanceledException if cancel was requested.
+	 * Called by the loader between loading steps.
+	 */
+	void checkCanceled()const
+	{
+		if(canceled)
+			throw LoadCanceledException();
+	}
+
+	/** New loading stage has started.
+	 * @param stage Stage identifier.
+	 * @param total Number of steps in the stage or 0 if not known in
+	 * advance.
+	 *
+	 * Default implementation does nothing.
+	 */
+	virtual void stage(Stage /*stage*/, size_t /*total*/) {}
+
+	/** Step inside current stage is done.
+	 * @param step Number of steps done in current stage.
+	 *
+	 * Default implementation does nothing.
+	 */
+	virtual void step(size_t /*step*/) {}
+};
+
+//=====================================================================================
+} // namespace pdfobjects
+//=====================================================================================
+
+#endif // _LOADPROGRESS_H_
@@ -0,0 +1,217 @@
+/*
+ * PDFedit - free program for PDF document manipulation.
+ * Copyright (C) 2006-2009  PDFedit team: Michal Hocko,
+ *                                        Jozef Misutka,
+ *                                        Martin Petricek
+ *                   Former team members: Miroslav Jahoda
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program (in doc/LICENSE.GPL); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA  02111-1307  USA
+ *
+ * Project is hosted on http://sourceforge.net/projects/pdfedit
+ */
+// vim:tabstop=4:shiftwidth=4:noexpandtab:textwidth=80
+
+// static
+#include "kernel/static.h"
+
+#include "kernel/memoryusage.h"
+#include "kernel/cobject.h"
+#include "kernel/pdfoperatorsbase.h"
+
+//==========================================================
+namespace pdfobjects {
+//==========================================================
+namespace utils {
+//==========================================================
+
+using namespace std;
+
+namespace {
+
+	/** Estimated overhead of the shared_ptr counter. */
+	const size_t SHARED_COUNT_SIZE = 2 * sizeof (long) + 2 * sizeof (void*);
+
+	/** Estimated size of a std::list node with given value type. */
+	template<typename Value>
+	size_t listNodeSize ()
+		{ return sizeof (Value) + 2 * sizeof (void*); }
+
+	/** Estimates size of dictionary entries (names and values). */
+	template<typename Dict>
+	size_t dictEntriesMemoryUsage (const Dict& dict, size_t& streamBytes)
+	{
+		size_t size = 0;
+
+		vector<string> names;
+		dict.getAllPropertyNames (names);
+		for (vector<string>::const_iterator it = names.begin(); it != names.end(); ++it)
+			size += listNodeSize<pair<string, boost::shared_ptr<IProperty> > > () + it->capacity ();
+
+		vector<boost::shared_ptr<IProperty> > children;
+		dict._getAllChildObjects (children);
+		for (vector<boost::shared_ptr<IProperty> >::const_iterator it = children.begin(); it != children.end(); ++it)
+			size += SHARED_COUNT_SIZE + getPropertyMemoryUsage (**it, streamBytes);
+
+		return size;
+	}
+
+	/** Estimates size of xpdf dictionary including its entries. */
+	size_t xpdfDictMemoryUsage (const ::Dict& dict)
+	{
+		size_t size = sizeof (::Dict);
+		for (int i = 0; i < dict.getLength (); ++i)
+		{
+			::Object elem;
+			size += sizeof (DictEntry) + strlen (dict.getKey (i)) + 1
+				+ getXpdfObjectMemoryUsage (*dict.getValNF (i, &elem));
+			elem.free ();
+		}
+		return size;
+	}
+
+} // namespace
+
+//
+//
+//
+size_t
+getPropertyMemoryUsage (const IProperty& ip, size_t& streamBytes)
+{
+	switch (ip.getType ())
+	{
+		case pNull:
+			return sizeof (CNull);
+		case pBool:
+			return sizeof (CBool);
+		case pInt:
+			return sizeof (CInt);
+		case pReal:
+			return sizeof (CReal);
+		case pRef:
+			return sizeof (CRef);
+
+		case pString:
+			return sizeof (CString) + static_cast<const CString&> (ip).getValue ().capacity ();
+		case pName:
+			return sizeof (CName) + static_cast<const CName&> (ip).getValue ().capacity ();
+
+		case pArray:
+			{
+				const CArray& array = static_cast<const CArray&> (ip);
+				vector<boost::shared_ptr<IProperty> > children;
+				array._getAllChildObjects (children);
+				size_t size = sizeof (CArray) + children.size () * sizeof (boost::shared_ptr<IProperty>);
+				for (vector<boost::shared_ptr<IProperty> >::const_iterator it = children.begin(); it != children.end(); ++it)
+					size += SHARED_COUNT_SIZE + getPropertyMemoryUsage (**it, streamBytes);
+				return size;
+			}
+
+		case pDict:
+			return sizeof (CDict) + dictEntriesMemoryUsage (static_cast<const CDict&> (ip), streamBytes);
+
+		case pStream:
+			{
+				const CStream& stream = static_cast<const CStream&> (ip);
+				streamBytes += stream.getBuffer ().capacity ();
+				return sizeof (CStream) + dictEntriesMemoryUsage (stream, streamBytes);
+			}
+
+		default:
+			assert (!"Unknown property type.");
+			return sizeof (IProperty);
+	}
+}
+
+//
+//
+//
+size_t
+getOperatorMemoryUsage (const PdfOperator& op)
+{
+	// most of operators are simple ones with a name
+	size_t size = sizeof (PdfOperator) + 4 * sizeof (void*) + SHARED_COUNT_SIZE;
+
+	PdfOperator::Operands operands;
+	op.getParameters (operands);
+	size_t streamBytes = 0;
+	for (PdfOperator::Operands::const_iterator it = operands.begin(); it != operands.end(); ++it)
+		size += sizeof (boost::shared_ptr<IProperty>) + SHARED_COUNT_SIZE + getPropertyMemoryUsage (**it, streamBytes);
+	// inline images
+	size += streamBytes;
+
+	if (op.getChildrenCount ())
+	{
+		PdfOperator::PdfOperators children;
+		op.getChildren (children);
+		for (PdfOperator::PdfOperators::const_iterator it = children.begin(); it != children.end(); ++it)
+			size += listNodeSize<boost::shared_ptr<PdfOperator> > () + getOperatorMemoryUsage (**it);
+	}
+	return size;
+}
+
+//
+//
+//
+size_t
+getXpdfObjectMemoryUsage (const ::Object& obj)
+{
+	::Object& o = const_cast< ::Object&> (obj);
+	size_t size = sizeof (::Object);
+
+	switch (o.getType ())
+	{
+		case objString:
+			return size + sizeof (GString) + o.getString ()->getLength ();
+		case objName:
+			return size + strlen (o.getName ()) + 1;
+		case objCmd:
+			return size + strlen (o.getCmd ()) + 1;
+
+		case objArray:
+			size += sizeof (Array);
+			for (int i = 0; i < o.arrayGetLength (); ++i)
+			{
+				::Object elem;
+				size += getXpdfObjectMemoryUsage (*o.arrayGetNF (i, &elem));
+				elem.free ();
+			}
+			return size;
+
+		case objDict:
+			return size + xpdfDictMemoryUsage (*o.getDict ());
+
+		case objStream:
+			{
+				size += xpdfDictMemoryUsage (*o.streamGetDict ());
+
+				// stream data are kept in memory for changed streams
+				::Object length;
+				o.streamGetDict ()->lookupNF ("Length", &length);
+				if (length.isInt () && 0 < length.getInt ())
+					size += length.getInt ();
+				length.free ();
+			}
+			return size;
+
+		default:
+			return size;
+	}
+}
+
+//==========================================================
+} // namespace utils
+//==========================================================
+} // namespace pdfobjects
+//==========================================================
@@ -0,0 +1,126 @@
+/*
+ * PDFedit - free program for PDF document manipulation.
+ * Copyright (C) 2006-2009  PDFedit team: Michal Hocko,
+ *                                        Jozef Misutka,
+ *                                        Martin Petricek
+ *                   Former team members: Miroslav Jahoda
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program (in doc/LICENSE.GPL); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA  02111-1307  USA
+ *
+ * Project is hosted on http://sourceforge.net/projects/pdfedit
+ */
+// vim:tabstop=4:shiftwidth=4:noexpandtab:textwidth=80
+
+#ifndef _MEMORYUSAGE_H_
+#define _MEMORYUSAGE_H_
+
+#include "kernel/static.h"
+
+
+//=====================================================================================
+namespace pdfobjects {
+//=====================================================================================
+
+class IProperty;
+class PdfOperator;
+
+//=====================================================================================
+// MemoryUsage
+//=====================================================================================
+
+/**
+ * Approximate memory held by a document, in bytes by category.
+ *
+ * Values are estimates computed from sizes of kernel structures and
+ * container elements, allocator overhead is not included.
+ *
+ * @see CPdf::getMemoryUsage
+ */
+struct MemoryUsage
+{
+	/** Indirect objects cached by the document (without stream data). */
+	size_t cachedObjects;
+	/** Data of cached streams. */
+	size_t streamBuffers;
+	/** Parsed content stream operators of returned pages. */
+	size_t operators;
+	/** Cross reference tables of all revisions. */
+	size_t xrefTables;
+	/** Changed objects which have not been saved yet. */
+	size_t pendingChanges;
+	/** Display lists of pages. */
+	size_t displayLists;
+
+	MemoryUsage ()
+		: cachedObjects (0), streamBuffers (0), operators (0), xrefTables (0), pendingChanges (0),
+		  displayLists (0)
+		{}
+
+	/** Returns sum of all categories. */
+	size_t total () const
+		{ return cachedObjects + streamBuffers + operators + xrefTables + pendingChanges + displayLists; }
+};
+
+
+//=====================================================================================
+namespace utils {
+//=====================================================================================
+
+/** Estimated size of a std::map (or std::set) node with given value type. */
+template<typename Value>
+inline size_t mapNodeSize ()
+	{ return sizeof (Value) + 4 * sizeof (void*); }
+
+/**
+ * Estimates memory held by the property.
+ *
+ * @param ip Property (direct children are included, referenced objects are
+ * not).
+ * @param streamBytes Incremented by the size of stream buffers of the
+ * property and its children.
+ *
+ * @return Number of bytes without stream buffers.
+ */
+size_t getPropertyMemoryUsage (const IProperty& ip, size_t& streamBytes);
+
+/**
+ * Estimates memory held by the operator including its operands and
+ * children.
+ *
+ * @param op Pdf operator.
+ *
+ * @return Number of bytes.
+ */
+size_t getOperatorMemoryUsage (const PdfOperator& op);
+
+/**
+ * Estimates memory held by the xpdf object.
+ *
+ * @param obj Xpdf object (referenced objects are not included).
+ *
+ * @return Number of bytes.
+ */
+size_t getXpdfObjectMemoryUsage (const ::Object& obj);
+
+//=====================================================================================
+} // namespace utils
+//=====================================================================================
+
+//=====================================================================================
+} // namespace pdfobjects
+//=====================================================================================
+
+
+#endif // _MEMORYUSAGE_H_
@@ -339,7 +339,12 @@ public:
 
 GfxFont* TextSimpleOperator::getCurrentFont()const
 {
-	assert(fontData);
+	// no Tf operator before this one (damaged or edited content)
+	if(!fontData)
+	{
+		utilsPrintDbg(debug::DBG_WARN, "No font set for text operator");
+		return NULL;
+	}
 	const char* tag = fontData->getFontTag();
 	boost::shared_ptr<GfxResources> res = getContentStream()->getResources(); 
 	GfxFont* font = res->lookupFont(tag);
@@ -136,7 +136,7 @@ protected:
 	/** Finds current font for operator from fontName.
 	 * Uses resources from content stream to retriev font by name.
 	 * Returned instance must not be deallocated by caller.
-	 * @return Font instance for this operator.
+	 * @return Font instance for this operator or NULL if no font is set.
 	 */
 	GfxFont* getCurrentFont()const;
 public:
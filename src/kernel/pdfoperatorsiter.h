@@ -95,7 +95,13 @@ struct AcceptingPdfOperatorIterator: public PdfOperator::Iterator
 	{
 		std::string name;
 		_cur.lock()->getOperatorName (name);
+		return accepts (name);
+	}
 
+	/** Does the iterator stop at operators with the name. */
+	static bool
+	accepts (const std::string& name)
+	{
 		for (size_t i = 0; i < namecount; ++i)
 			if (name == accepted_opers[i])
 				return true;
@@ -148,7 +154,13 @@ struct RejectingPdfOperatorIterator: public PdfOperator::Iterator
 	{
 		std::string name;
 		_cur.lock()->getOperatorName (name);
+		return accepts (name);
+	}
 
+	/** Does the iterator stop at operators with the name. */
+	static bool
+	accepts (const std::string& name)
+	{
 		for (size_t i = 0; i < namecount; ++i)
 			if (name == rejected_opers[i])
 				return false;
@@ -28,6 +28,8 @@
 #include "kernel/cobject.h"
 #include "kernel/streamwriter.h"
 #include "kernel/factories.h"
+#include "xpdf/Decrypt.h"
+#include "utils/trace.h"
 #include <zlib.h>
 
 /** Size of buffer for xref table row.
@@ -160,24 +162,25 @@ unsigned char * NullFilterStreamWriter::null_extractor(const Object&obj, size_t&
 	}
 	size_t streamLen = lenghtObj->getInt();
 
-	// we are using BaseStream here because we want to read data
-	// without any decoding
-	Stream* str = obj.getStream()->getBaseStream();
+	// we are using undecoded stream here because we want to read data
+	// without any decoding (but decrypted if the document is encrypted)
+	Stream* str = obj.getStream()->getUndecodedStream();
 	unsigned char* buffer = bufferFromStream(*str, streamLen, size);
 	if(!buffer)
 		return NULL;
-	// size must be same because we are using stream data as is
-	if(streamLen != size)
+	// size must be same because we are using stream data as is (decrypted
+	// data may be shorter)
+	if(streamLen != size && str == obj.getStream()->getBaseStream())
 		utilsPrintDbg(debug::DBG_WARN, "Retrieved stream doesn't have correct length. "
 				<<size<<" bytes read but "<<streamLen<<" expected");
 	return buffer;
 }
 
-void NullFilterStreamWriter::compress(const Object& obj, Ref* ref, StreamWriter& outStream)const
+void NullFilterStreamWriter::compress(const Object& obj, Ref* ref, StreamWriter& outStream, ::Encryptor* encryptor)const
 {
 	assert(obj.isStream());
 	CharBuffer charBuffer;
-	size_t size=streamToCharBuffer(obj, ref, charBuffer, null_extractor);
+	size_t size=streamToCharBuffer(obj, ref, charBuffer, null_extractor, encryptor);
 	if(!size)
 	{
 		utilsPrintDbg(debug::DBG_WARN, "zero size stream returned. Probably error in the the object");
@@ -324,11 +327,11 @@ out:
 	return deflateBuff;
 }
 
-void ZlibFilterStreamWriter::compress(const Object& obj, Ref* ref, StreamWriter& outStream)const
+void ZlibFilterStreamWriter::compress(const Object& obj, Ref* ref, StreamWriter& outStream, ::Encryptor* encryptor)const
 {
 	CharBuffer charBuffer;
 	assert(obj.isStream());
-	size_t size=streamToCharBuffer(obj, ref, charBuffer, deflate);
+	size_t size=streamToCharBuffer(obj, ref, charBuffer, deflate, encryptor);
 	if(!size)
 	{
 		utilsPrintDbg(debug::DBG_WARN, "zero size stream returned. Probably error in the the object");
@@ -405,36 +408,120 @@ boost::shared_ptr<FilterStreamWriter> FilterStreamWriter::getInstance(const Obje
 		
 }
 
+/** Helper function for string encryption.
+ * @param obj Xpdf object.
+ * @param encryptor Encryptor of the indirect object which contains obj.
+ *
+ * Strings are encrypted also inside arrays and dictionaries, all other
+ * objects are just cloned.
+ * @return Copy of the given object with encrypted strings (deallocate with
+ * xpdf::freeXpdfObject).
+ */
+::Object * encryptStrings(const ::Object & obj, ::Encryptor & encryptor)
+{
+	::Object * copy;
+	switch(obj.getType())
+	{
+		case objString:
+			copy = XPdfObjectFactory::getInstance();
+			copy->initString(encryptor.encrypt(obj.getString()));
+			return copy;
+		case objArray:
+			copy = XPdfObjectFactory::getInstance();
+			copy->initArray(obj.getArray()->getXRef());
+			for(int i=0; i<obj.arrayGetLength(); ++i)
+			{
+				::Object elem;
+				obj.arrayGetNF(i, &elem);
+				::Object * encElem = encryptStrings(elem, encryptor);
+				elem.free();
+				// array takes the value, so just the holder is deallocated
+				copy->arrayAdd(encElem);
+				gfree(encElem);
+			}
+			return copy;
+		case objDict:
+			copy = XPdfObjectFactory::getInstance();
+			copy->initDict(obj.getDict()->getXRef());
+			for(int i=0; i<obj.dictGetLength(); ++i)
+			{
+				::Object elem;
+				obj.dictGetValNF(i, &elem);
+				::Object * encElem = encryptStrings(elem, encryptor);
+				elem.free();
+				copy->dictAdd(copyString(obj.dictGetKey(i)), encElem);
+				gfree(encElem);
+			}
+			return copy;
+		default:
+			return obj.clone();
+	}
+}
+
 /** Helper method for xpdf object writing to the stream.
  * @param obj Xpdf object to write.
  * @param ref Object's reference (NULL for indirect object).
  * @param stream Stream where to write.
  * @param indirect Flag for indirect object
+ * @param encryption Encryption of indirect objects (NULL if not
+ * encrypted).
  *
  * Creates correct pdf string representation of given object, adds indirect
  * header and footer if indirect flag is specified and writes everything to 
  * the given stream. 
  * <br>
  * Given xpdf object data (like stream or string) can contain unprintable or 
- * 0 bytes.
+ * 0 bytes. Note that strings of a stream dictionary are encrypted in place.
  */
-void writeObject(const ::Object & obj, StreamWriter & stream, ::Ref* ref, bool indirect)
+void writeObject(const ::Object & obj, StreamWriter & stream, ::Ref* ref, bool indirect, 
+		const IPdfWriter::Encryption * encryption)
 {
 using namespace boost;
 using namespace std;
 
+	// only content of indirect objects is encrypted and never the
+	// encryption dictionary
+	scoped_ptr< ::Encryptor> encryptor;
+	if(encryption && indirect && ref && 
+			!(ref->num == encryption->encryptRef.num && ref->gen == encryption->encryptRef.gen))
+		encryptor.reset(new ::Encryptor(encryption->fileKey, encryption->algorithm, 
+					encryption->keyLength, ref->num, ref->gen));
+
 	// stream requires special handling, because it may
 	// contain binary data
 	if(obj.isStream())
 	{
+		if(encryptor)
+		{
+			BaseStream * base = obj.getStream()->getBaseStream();
+			for(int i=0; i<obj.streamGetDict()->getLength(); ++i)
+			{
+				::Object elem;
+				obj.streamGetDict()->getValNF(i, &elem);
+				if(elem.isString() || elem.isArray() || elem.isDict())
+				{
+					::Object * encElem = encryptStrings(elem, *encryptor);
+					// key is not stored because it is already present
+					::Object * old = base->dictUpdate(obj.streamGetDict()->getKey(i), encElem);
+					gfree(encElem);
+					xpdf::freeXpdfObject(old);
+				}
+				elem.free();
+			}
+		}
 		shared_ptr<FilterStreamWriter> filter = FilterStreamWriter::getInstance(obj);
 		assert(filter->supportObject(obj));
-		filter->compress(obj, ref, stream);
+		filter->compress(obj, ref, stream, encryptor.get());
 	}else
 	{
+		// strings are encrypted in a copy of the object
+		shared_ptr< ::Object> encrypted;
+		if(encryptor)
+			encrypted.reset(encryptStrings(obj, *encryptor), xpdf::object_deleter());
+
 		// converts xpdf object to cobject and gets correct string
 		// representation
-		scoped_ptr<IProperty> cobj_ptr(createObjFromXpdfObj(obj));
+		scoped_ptr<IProperty> cobj_ptr(createObjFromXpdfObj(encrypted ? *encrypted : obj));
 		string objPdfFormat;
 		cobj_ptr->getStringRepresentation(objPdfFormat);
 		
@@ -491,6 +578,7 @@ void OldStylePdfWriter::writeContent(const ObjectList & objectList, StreamWriter
 using namespace debug;
 using namespace boost;
 
+	TRACE_SCOPE("writer", "OldStylePdfWriter::writeContent");
 	utilsPrintDbg(DBG_DBG, "pos="<<off);
 	
 	// if off is not 0, uses it to set position in the stream, otherwise uses
@@ -537,7 +625,7 @@ using namespace boost;
 		size_t objPos=stream.getPos();
 		offTable.insert(OffsetTab::value_type(ref, objPos));		
 		
-		writeObject(*obj, stream, &ref, true);	
+		writeObject(*obj, stream, &ref, true, encryption.get());	
 		utilsPrintDbg(DBG_DBG, "Object with "<<ref<<" stored at offset="<<objPos);
 		
 		// calls observers
@@ -575,6 +663,7 @@ size_t OldStylePdfWriter::writeTrailer(const Object & trailer,const PrevSecInfo
 	using namespace debug;
 	using namespace boost;
 
+	TRACE_SCOPE("writer", "OldStylePdfWriter::writeTrailer");
 	utilsPrintDbg(DBG_DBG, "");
 	
 	// nothing has been stored, so no need for cross ref and trailer
@@ -776,7 +865,7 @@ size_t OldStylePdfWriter::writeTrailer(const Object & trailer,const PrevSecInfo
 
 	// stores changed trailer to the file
 	stream.putLine(TRAILER_KEYWORD, strlen(TRAILER_KEYWORD));
-	writeObject(trailer, stream, NULL, false);
+	writeObject(trailer, stream, NULL, false, NULL);
 	kernelPrintDbg(DBG_DBG, "Trailer saved");
 
 	// stores offset of last (created one) xref table
@@ -808,6 +897,12 @@ size_t OldStylePdfWriter::writeTrailer(const Object & trailer,const PrevSecInfo
 	return pos;
 }
 
+bool OldStylePdfWriter::getOffsets(OffsetList & offsets)const
+{
+	offsets.insert(offsets.end(), offTable.begin(), offTable.end());
+	return true;
+}
+
 void OldStylePdfWriter::reset()
 {
 	offTable.clear();
@@ -878,6 +973,7 @@ int PdfDocumentWriter::writeDocument(FILE *file)
 {
 using namespace debug;
 
+	TRACE_SCOPE("writer", "PdfDocumentWriter::writeDocument");
 	utilsPrintDbg(DBG_DBG, "");
 	if(!file)
 	{
@@ -897,11 +993,27 @@ using namespace debug;
 		utilsPrintDbg(DBG_ERR, "No credentials available for encrypted document.");
 		return EPERM;
 	}
+
+	// encrypted document keeps its encryption - the trailer with Encrypt
+	// and ID entries is written as is, so the same file key is valid for
+	// the written document
+	boost::shared_ptr<IPdfWriter::Encryption> encryption;
 	if(isEncrypted())
 	{
-		utilsPrintDbg(DBG_ERR, "Encrypted documents writing is not implemented");
-		throw NotImplementedException("Encrypted document");
+		encryption.reset(new IPdfWriter::Encryption());
+		memcpy(encryption->fileKey, fileKey, keyLength);
+		encryption->keyLength = keyLength;
+		encryption->algorithm = encAlgorithm;
+		encryption->encryptRef.num = -1;
+		encryption->encryptRef.gen = 0;
+		::Object encryptObj;
+		if(getTrailerDict()->dictLookupNF("Encrypt", &encryptObj)->isRef())
+			encryption->encryptRef = encryptObj.getRef();
+		encryptObj.free();
+		utilsPrintDbg(DBG_INFO, "Document is encrypted (algorithm="<<encAlgorithm
+				<<", keyLength="<<keyLength<<")");
 	}
+	pdfWriter->setEncryption(encryption);
 	
 	// creates outputStream writer from given file
 	Object dict;
@@ -917,6 +1029,19 @@ using namespace debug;
 		// writes collected objects and xref & trailer section
 		utilsPrintDbg(DBG_INFO, "Writing "<<objectList.size()
 				<<" objects to the output outputStream.");
+
+		// encryption dictionary has been decrypted by fetch so it has
+		// to be fetched again as it is stored
+		if(encryption && encryption->encryptRef.num >= 0)
+			for(IPdfWriter::ObjectList::iterator i=objectList.begin(); i!=objectList.end(); ++i)
+			{
+				if(i->first.num != encryption->encryptRef.num || i->first.gen != encryption->encryptRef.gen)
+					continue;
+				i->second->free();
+				useEncrypt = gFalse;
+				XRef::fetch(i->first.num, i->first.gen, i->second);
+				useEncrypt = gTrue;
+			}
 		pdfWriter->writeContent(objectList, *outputStream);
 		// clean up
 		utilsPrintDbg(DBG_DBG, "Cleaning up all writen objects("
@@ -933,6 +1058,7 @@ using namespace debug;
 	IPdfWriter::PrevSecInfo prevInfo={0, 0};
 	pdfWriter->writeTrailer(*getTrailerDict(), prevInfo, *outputStream);
 	outputStream->flush();
+	pdfWriter->setEncryption(boost::shared_ptr<const IPdfWriter::Encryption>());
 
 	return 0;
 }
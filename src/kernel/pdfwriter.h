@@ -57,6 +57,7 @@ extern const char * STARTXREF_KEYWORD;
 extern const char * EOFMARKER;
 
 class StreamWriter;
+class Encryptor;
 
 namespace pdfobjects {
 
@@ -279,11 +280,16 @@ public:
 	 * writen in the stream. Nevertheless it is absolutely free in how it does it.
 	 * It can modify given object to use those filters (and all associated 
 	 * parameters) which are then used when data are written.
+	 * <br>
+	 * If encryptor is given, data are encrypted after they are encoded by
+	 * filters.
 	 * @param obj Object to write (must be stream).
 	 * @param ref Indirect reference for object (NULL for direct object).
 	 * @param outStream Output stream where to put data.
+	 * @param encryptor Encryptor for stream data (NULL if the data are not
+	 * encrypted).
 	 */
-	virtual void compress(const Object& obj, Ref* ref, StreamWriter& outStream)const =0;
+	virtual void compress(const Object& obj, Ref* ref, StreamWriter& outStream, ::Encryptor* encryptor=NULL)const =0;
 };
 
 /** Stream writer implementation with no filters.
@@ -312,7 +318,7 @@ public:
 	 *
 	 * Uses streamToCharBuffer with null_extractor extractor.
 	 */
-	virtual void compress(const Object& obj, Ref* ref, StreamWriter& outStream)const;
+	virtual void compress(const Object& obj, Ref* ref, StreamWriter& outStream, ::Encryptor* encryptor=NULL)const;
 };
 
 /** Implementation of FlateDecode filter stream writer.
@@ -360,7 +366,7 @@ public:
 	 */
 	static unsigned char* deflate(const Object& obj, size_t& size);
 
-	virtual void compress(const Object& obj, Ref* ref, StreamWriter& outStream)const;
+	virtual void compress(const Object& obj, Ref* ref, StreamWriter& outStream, ::Encryptor* encryptor=NULL)const;
 };
 
 /** Interface for pdf content writer.
@@ -406,6 +412,11 @@ public:
 	 */
 	typedef std::vector<ObjectElement> ObjectList;
 
+	/** Type for list of written objects.
+	 * Each element is pair of object reference and its stream offset.
+	 */
+	typedef std::vector<std::pair<Ref, size_t> > OffsetList;
+
 	/** Type for pdf writer observer contenxt.
 	 *
 	 * This context holds OperationScope structure for change scope information. 
@@ -433,6 +444,33 @@ public:
 		size_t entriesNum;
 	};
 
+	/** Encryption of written objects.
+	 * Strings and stream data of all written indirect objects but the
+	 * encryption dictionary are encrypted by a key derived from fileKey and
+	 * the object's reference (see Encryptor).
+	 */
+	struct Encryption
+	{
+		/** File encryption key. */
+		Guchar fileKey[16];
+
+		/** Number of used bytes from fileKey. */
+		int keyLength;
+
+		/** Encryption algorithm. */
+		CryptAlgorithm algorithm;
+
+		/** Reference of the encryption dictionary.
+		 * Its num is -1 if the dictionary is direct in the trailer.
+		 */
+		::Ref encryptRef;
+	};
+
+protected:
+	/** Encryption of written objects (NULL if not encrypted). */
+	boost::shared_ptr<const Encryption> encryption;
+
+public:
 	virtual ~IPdfWriter()
 	{
 #ifdef OBSERVER_DEBUG
@@ -452,6 +490,17 @@ public:
 	 */
 	virtual void writeHeader(const char* version, StreamWriter &stream);
 
+	/** Sets encryption of written objects.
+	 * @param encryption Encryption parameters (NULL to write objects
+	 * without encryption).
+	 *
+	 * Trailer is never encrypted.
+	 */
+	void setEncryption(const boost::shared_ptr<const Encryption> & encryption)
+	{
+		this->encryption = encryption;
+	}
+
 	/** Puts all objects to given stream.
 	 * @param objectList List of objects to store.
 	 * @param stream Stream writer where to write.
@@ -482,6 +531,23 @@ public:
 	 */
 	virtual size_t writeTrailer(const Object & trailer, const PrevSecInfo &prevSection, StreamWriter & stream, size_t off=0)=0;
 
+	/** Gets offsets of objects written by writeContent.
+	 * @param offsets List where to put references and offsets of all objects
+	 * written since the last reset (exactly those which go to the cross
+	 * reference section written by writeTrailer).
+	 *
+	 * Has to be called before writeTrailer because it resets collected data.
+	 * Callers can use offsets to update their cross reference tables without
+	 * parsing the written section. Default implementation doesn't provide
+	 * them.
+	 *
+	 * @return true if offsets are available, false otherwise.
+	 */
+	virtual bool getOffsets(UNUSED_PARAM OffsetList & offsets)const
+	{
+		return false;
+	}
+
 	/** Resets internal data collected in writeContent method.
 	 *
 	 * Everything collected in writeContent method, which is needed by
@@ -623,6 +689,13 @@ public:
 	 */
 	virtual size_t writeTrailer(const Object & trailer, const PrevSecInfo &prevSection, StreamWriter & stream, size_t off=0);
 
+	/** Gets offsets of objects written by writeContent.
+	 * @param offsets List where to put offTable content.
+	 *
+	 * @return always true.
+	 */
+	virtual bool getOffsets(OffsetList & offsets)const;
+
 	/** Resets all collected data.
 	 *
 	 * Clears offTable field and so this instance can be used for another 
@@ -735,7 +808,6 @@ protected:
 	 * delinearize(FILE *) method. If given file doesn't exist, it will be
 	 * created. Finally closes file.
 	 * @return 0 on success, errno otherwise.
-	 * @throw NotImplementedException if document is encrypted.
 	 */
 	virtual int writeDocument(const char *fileName);
 
@@ -754,9 +826,12 @@ protected:
 	 * unpredictable.
 	 * <br>
 	 * Returns with erro (EINVAL) if no pdfWriter is specified (it is NULL).
+	 * <br>
+	 * Encrypted document is written with the same encryption - Encrypt and
+	 * ID entries from the trailer are kept, so the same passwords are valid
+	 * for the new document. Returns with EPERM if no credentials were set.
 	 *
 	 * @return 0 if everything ok, otherwise value of error of the error.
-	 * @throw NotImplementedException if document is encrypted.
 	 * @throw MalformedFormatExeption if the input file is currupted.
 	 * 
 	 * @return 0 on success, errno otherwise.
@@ -29,6 +29,7 @@
 #include "kernel/static.h"
 
 #include "kernel/pdfoperators.h"
+#include "utils/trace.h"
 
 
 //==========================================================
@@ -147,6 +148,7 @@ public:
 						/*const*/ GfxState& state, 
 						Ftor ftor) 
 	{
+		TRACE_SCOPE ("kernel", "StateUpdater::updatePdfOperators");
 		assert (!state.isPath());		// if isPath, state is from other ccontentstream or is bad
 		GfxState* tmpstate = state.copy (false);
 
@@ -0,0 +1,391 @@
+/*
+ * PDFedit - free program for PDF document manipulation.
+ * Copyright (C) 2006-2009  PDFedit team: Michal Hocko,
+ *                                        Jozef Misutka,
+ *                                        Martin Petricek
+ *                   Former team members: Miroslav Jahoda
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program (in doc/LICENSE.GPL); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA  02111-1307  USA
+ *
+ * Project is hosted on http://sourceforge.net/projects/pdfedit
+ */
+// vim:tabstop=4:shiftwidth=4:noexpandtab:textwidth=80
+
+// static
+#include "kernel/static.h"
+
+#include <xpdf/UnicodeTypeTable.h>
+
+#include "kernel/textindex.h"
+#include "kernel/cpagedisplay.h"
+
+//==========================================================
+namespace pdfobjects {
+//==========================================================
+
+using namespace std;
+
+
+//==========================================================
+namespace {
+//==========================================================
+
+	/** Word separator stored in the index. */
+	const Unicode SEPARATOR = 0x20;
+
+	/** Minimal gap between glyphs (relative to font size) which separates words, same as xpdf. */
+	const double MIN_WORD_BREAK_SPACE = 0.1;
+	/** Maximal distance of baselines (relative to font size) of glyphs in one word. */
+	const double MAX_BASELINE_DELTA = 0.5;
+
+	/**
+	 * Is it a character which can be a part of a word.
+	 */
+	inline bool
+	isWordChar (Unicode c)
+	{
+		if (c < 0x80)
+			return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+		return unicodeTypeL (c) || unicodeTypeR (c);
+	}
+
+	/**
+	 * Output device which stores all displayed characters into an index.
+	 *
+	 * Character boxes are computed the same way TextOutputDev does it: from the
+	 * advance of the glyph along the baseline and from the font ascent and
+	 * descent perpendicular to it.
+	 */
+	class TextIndexOutputDev : public ::OutputDev
+	{
+	private:
+		PageTextIndex& _index;
+		double _pageWidth, _pageHeight;
+		bool _hasLast;
+		double _lastX, _lastY;		/**< End of the last glyph on its baseline. */
+		double _lastDx, _lastDy;	/**< Unit direction of the last baseline. */
+		double _lastSize;			/**< Font size of the last glyph. */
+
+	public:
+		TextIndexOutputDev (PageTextIndex& index)
+			: _index (index), _pageWidth (0), _pageHeight (0), _hasLast (false),
+			  _lastX (0), _lastY (0), _lastDx (1), _lastDy (0), _lastSize (0)
+			{}
+
+		virtual GBool upsideDown () const { return gTrue; }
+		virtual GBool useDrawChar () const { return gTrue; }
+		virtual GBool interpretType3Chars () const { return gFalse; }
+		virtual GBool needNonText () const { return gFalse; }
+
+		virtual void startPage (int, GfxState* state)
+		{
+			_pageWidth = state->getPageWidth ();
+			_pageHeight = state->getPageHeight ();
+			_hasLast = false;
+		}
+
+		virtual void endTextObject (GfxState*)
+			{ _index.separate (); _hasLast = false; }
+
+		virtual void drawChar (GfxState* state, double x, double y,
+							   double dx, double dy,
+							   double, double,
+							   CharCode c, int, const Unicode* u, int uLen)
+		{
+			if (0 == uLen)
+				return;
+
+			// Subtract character and word spacing from the advance
+			double sp = state->getCharSpace ();
+			if (c == (CharCode)0x20)
+				sp += state->getWordSpace ();
+			double dx2, dy2;
+			state->textTransformDelta (sp * state->getHorizScaling(), 0, &dx2, &dy2);
+			double x1, y1, w1, h1;
+			state->transformDelta (dx - dx2, dy - dy2, &w1, &h1);
+			state->transform (x, y, &x1, &y1);
+
+			// Throw away characters out of the page
+			if (x1 + w1 < 0 || x1 > _pageWidth || y1 + h1 < 0 || y1 > _pageHeight ||
+				w1 > _pageWidth || h1 > _pageHeight)
+				return;
+
+			// Spaces just separate words
+			if (1 == uLen && SEPARATOR == u[0])
+			{
+				_index.separate ();
+				_hasLast = false;
+				return;
+			}
+
+			double size = state->getTransformedFontSize ();
+			double len = sqrt (w1 * w1 + h1 * h1);
+			double ux = 1, uy = 0;
+			if (len > 0)
+				{ ux = w1 / len; uy = h1 / len; }
+			else if (_hasLast)
+				{ ux = _lastDx; uy = _lastDy; }
+
+			// Separate words on gaps and baseline changes
+			if (_hasLast)
+			{
+				double along = (x1 - _lastX) * ux + (y1 - _lastY) * uy;
+				double across = (x1 - _lastX) * uy - (y1 - _lastY) * ux;
+				double limit = (size > _lastSize) ? size : _lastSize;
+				if (along > MIN_WORD_BREAK_SPACE * limit || along < -MAX_BASELINE_DELTA * limit ||
+						fabs (across) > MAX_BASELINE_DELTA * limit)
+					_index.separate ();
+			}
+
+			// Glyph box from ascent and descent; device space is upside down
+			double ascent = 0.95, descent = -0.35;
+			const GfxFont* font = state->getFont ();
+			if (font)
+			{
+				ascent = font->getAscent ();
+				descent = font->getDescent ();
+			}
+			double upx = uy, upy = -ux;
+
+			// Ligatures share the box of the glyph
+			for (int i = 0; i < uLen; ++i)
+			{
+				double bx = x1 + w1 * i / uLen, by = y1 + h1 * i / uLen;
+				double ex = x1 + w1 * (i + 1) / uLen, ey = y1 + h1 * (i + 1) / uLen;
+				double xs[4] = { bx + upx * ascent * size, bx + upx * descent * size,
+								 ex + upx * ascent * size, ex + upx * descent * size };
+				double ys[4] = { by + upy * ascent * size, by + upy * descent * size,
+								 ey + upy * ascent * size, ey + upy * descent * size };
+				_index.push_back (u[i], *std::min_element (xs, xs + 4), *std::min_element (ys, ys + 4),
+										*std::max_element (xs, xs + 4), *std::max_element (ys, ys + 4));
+			}
+
+			_hasLast = true;
+			_lastX = x1 + w1; _lastY = y1 + h1;
+			_lastDx = ux; _lastDy = uy;
+			_lastSize = size;
+		}
+	};
+
+//==========================================================
+} // namespace
+//==========================================================
+
+
+//==========================================================
+// TextMatcher
+//==========================================================
+
+//
+//
+//
+TextMatcher::TextMatcher (const std::vector<std::string>& patterns, bool caseSensitive)
+	: _nodes (1), _caseSensitive (caseSensitive)
+{
+	_nodes[0].fail = 0;
+
+	// Build the trie
+	for (size_t p = 0; p < patterns.size(); ++p)
+	{
+		const std::string& pattern = patterns[p];
+		_lengths.push_back (pattern.length());
+		if (pattern.empty())
+			continue;
+
+		State state = 0;
+		for (size_t i = 0; i < pattern.length(); ++i)
+		{
+			Unicode c = fold (static_cast<Unicode> (pattern[i] & 0xff));
+			State next = go (state, c);
+			if (-1 == next)
+			{
+				next = static_cast<State> (_nodes.size());
+				_nodes.push_back (Node ());
+				std::vector<std::pair<Unicode, State> >& edges = _nodes[state].next;
+				edges.insert (std::lower_bound (edges.begin(), edges.end(), std::make_pair (c, State (0))),
+							  std::make_pair (c, next));
+			}
+			state = next;
+		}
+		_nodes[state].out.push_back (p);
+	}
+
+	// Failure transitions in breadth first order
+	std::deque<State> queue;
+	for (size_t i = 0; i < _nodes[0].next.size(); ++i)
+	{
+		_nodes[_nodes[0].next[i].second].fail = 0;
+		queue.push_back (_nodes[0].next[i].second);
+	}
+	while (!queue.empty())
+	{
+		State state = queue.front();
+		queue.pop_front();
+		for (size_t i = 0; i < _nodes[state].next.size(); ++i)
+		{
+			Unicode c = _nodes[state].next[i].first;
+			State child = _nodes[state].next[i].second;
+			State f = _nodes[state].fail;
+			while (0 != f && -1 == go (f, c))
+				f = _nodes[f].fail;
+			State target = go (f, c);
+			_nodes[child].fail = (-1 == target || child == target) ? 0 : target;
+			const std::vector<size_t>& inherited = _nodes[_nodes[child].fail].out;
+			_nodes[child].out.insert (_nodes[child].out.end(), inherited.begin(), inherited.end());
+			queue.push_back (child);
+		}
+	}
+}
+
+//
+//
+//
+TextMatcher::State
+TextMatcher::step (State state, Unicode c) const
+{
+	c = fold (c);
+	State next;
+	while (-1 == (next = go (state, c)))
+	{
+		if (0 == state)
+			return 0;
+		state = _nodes[state].fail;
+	}
+	return next;
+}
+
+//
+//
+//
+TextMatcher::State
+TextMatcher::go (State state, Unicode c) const
+{
+	const std::vector<std::pair<Unicode, State> >& edges = _nodes[state].next;
+	std::vector<std::pair<Unicode, State> >::const_iterator it =
+		std::lower_bound (edges.begin(), edges.end(), std::make_pair (c, State (0)));
+	if (it == edges.end() || it->first != c)
+		return -1;
+	return it->second;
+}
+
+//
+//
+//
+Unicode
+TextMatcher::fold (Unicode c) const
+{
+	return (_caseSensitive) ? c : unicodeToUpper (c);
+}
+
+
+//==========================================================
+// PageTextIndex
+//==========================================================
+
+//
+//
+//
+PageTextIndex::PageTextIndex (CPageDisplay& display, unsigned long stamp)
+	: _params (display.getDisplayParams()), _stamp (stamp)
+{
+	TextIndexOutputDev out (*this);
+	display.displayPage (out);
+	separate ();
+
+	// Keep it compact, the index lives as long as the page
+	std::vector<Unicode> (_text).swap (_text);
+	std::vector<float> (_boxes).swap (_boxes);
+
+		kernelPrintDbg (debug::DBG_DBG, "indexed " << _text.size() << " characters");
+}
+
+//
+//
+//
+void
+PageTextIndex::push_back (Unicode c, double xMin, double yMin, double xMax, double yMax)
+{
+	_text.push_back (c);
+	_boxes.push_back (static_cast<float> (xMin));
+	_boxes.push_back (static_cast<float> (yMin));
+	_boxes.push_back (static_cast<float> (xMax));
+	_boxes.push_back (static_cast<float> (yMax));
+}
+
+//
+//
+//
+void
+PageTextIndex::separate ()
+{
+	if (_text.empty() || SEPARATOR == _text.back())
+		return;
+	// Separator gets the box of the previous character
+	size_t last = _boxes.size() - 4;
+	push_back (SEPARATOR, _boxes[last], _boxes[last + 1], _boxes[last + 2], _boxes[last + 3]);
+}
+
+//
+//
+//
+size_t
+PageTextIndex::find (const TextMatcher& matcher, bool wholeWord, std::vector<libs::Rectangle>& recs) const
+{
+	size_t found = 0;
+	// First position where the next occurence of each pattern may start
+	std::vector<size_t> nextStart (matcher.size(), 0);
+
+	TextMatcher::State state = matcher.start();
+	for (size_t pos = 0; pos < _text.size(); ++pos)
+	{
+		state = matcher.step (state, _text[pos]);
+		const std::vector<size_t>& matches = matcher.matches (state);
+		for (std::vector<size_t>::const_iterator it = matches.begin(); it != matches.end(); ++it)
+		{
+			size_t first = pos + 1 - matcher.length (*it);
+			if (first < nextStart[*it])
+				continue;
+			if (wholeWord && ((first > 0 && isWordChar (_text[first - 1])) ||
+							  (pos + 1 < _text.size() && isWordChar (_text[pos + 1]))))
+				continue;
+
+			// Bounding box of all characters except separators
+			double xMin = 0, yMin = 0, xMax = 0, yMax = 0;
+			bool empty = true;
+			for (size_t i = first; i <= pos; ++i)
+			{
+				if (SEPARATOR == _text[i])
+					continue;
+				const float* box = &_boxes[4 * i];
+				if (empty || box[0] < xMin) xMin = box[0];
+				if (empty || box[1] < yMin) yMin = box[1];
+				if (empty || box[2] > xMax) xMax = box[2];
+				if (empty || box[3] > yMax) yMax = box[3];
+				empty = false;
+			}
+			if (empty)
+				continue;
+
+			recs.push_back (libs::Rectangle (xMin, yMin, xMax, yMax));
+			nextStart[*it] = pos + 1;
+			++found;
+		}
+	}
+	return found;
+}
+
+//==========================================================
+} // namespace pdfobjects
+//==========================================================
@@ -0,0 +1,210 @@
+/*
+ * PDFedit - free program for PDF document manipulation.
+ * Copyright (C) 2006-2009  PDFedit team: Michal Hocko,
+ *                                        Jozef Misutka,
+ *                                        Martin Petricek
+ *                   Former team members: Miroslav Jahoda
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program (in doc/LICENSE.GPL); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA  02111-1307  USA
+ *
+ * Project is hosted on http://sourceforge.net/projects/pdfedit
+ */
+// vim:tabstop=4:shiftwidth=4:noexpandtab:textwidth=80
+
+#ifndef _TEXTINDEX_H_
+#define _TEXTINDEX_H_
+
+// all basic includes
+#include "kernel/static.h"
+#include "kernel/displayparams.h"
+
+
+//=====================================================================================
+namespace pdfobjects {
+//=====================================================================================
+
+// Forward declaration
+class CPageDisplay;
+
+
+//=====================================================================================
+// TextMatcher
+//=====================================================================================
+
+/**
+ * Matcher looking for several strings at once.
+ *
+ * It is an Aho-Corasick automaton built from the searched strings, so a
+ * text is scanned just once regardless of the number of patterns. Strings
+ * are converted to unicode the same way the xpdf search does (each byte is
+ * one character). When the matching is not case sensitive both the
+ * patterns and the scanned text are folded to upper case.
+ */
+class TextMatcher
+{
+	// Typedefs
+public:
+	/** Automaton state. */
+	typedef int State;
+
+	// Variables
+private:
+	/** Automaton node. */
+	struct Node
+	{
+		/** Transitions sorted by character. */
+		std::vector<std::pair<Unicode, State> > next;
+		/** Failure transition. */
+		State fail;
+		/** Patterns ending in this node (including those reached by failure transitions). */
+		std::vector<size_t> out;
+	};
+	std::vector<Node> _nodes;
+	std::vector<size_t> _lengths;	/**< Length of each pattern. */
+	bool _caseSensitive;
+
+	// Ctor & Dtor
+public:
+	/**
+	 * Constructor.
+	 *
+	 * @param patterns Strings to look for (empty ones are ignored).
+	 * @param caseSensitive Compare characters exactly or folded to upper case.
+	 */
+	TextMatcher (const std::vector<std::string>& patterns, bool caseSensitive);
+
+	//
+	// Matching
+	//
+public:
+	/** Initial state. */
+	State start () const
+		{ return 0; }
+
+	/** Moves the automaton by one character of the text. */
+	State step (State state, Unicode c) const;
+
+	/** Returns indices of patterns which end in the state. */
+	const std::vector<size_t>& matches (State state) const
+		{ return _nodes[state].out; }
+
+	/** Returns the number of patterns. */
+	size_t size () const
+		{ return _lengths.size(); }
+
+	/** Returns length of the pattern in characters. */
+	size_t length (size_t pattern) const
+		{ return _lengths[pattern]; }
+
+	//
+	// Helper methods
+	//
+private:
+	/** Returns the transition for c or -1. */
+	State go (State state, Unicode c) const;
+	/** Normalizes case of the character if required. */
+	Unicode fold (Unicode c) const;
+};
+
+
+//=====================================================================================
+// PageTextIndex
+//=====================================================================================
+
+/**
+ * Text of a page with bounding boxes of all its glyphs.
+ *
+ * The page is displayed once on a device collecting characters, the text is
+ * then stored as a plain unicode array with four floats per character. Words
+ * are separated by a space character whatever the separation in the content
+ * stream was (space glyph, a gap or a new line). Boxes are in the device
+ * space of the display parameters used when the index was built, the same
+ * space TextOutputDev reports found text in.
+ *
+ * The index does not watch the page, the owner must drop it when the page
+ * changes. Display parameters and the xref change stamp it was built for are
+ * stored to make it easy.
+ */
+class PageTextIndex
+{
+	// Variables
+private:
+	std::vector<Unicode> _text;		/**< Characters of the page. */
+	std::vector<float> _boxes;		/**< xMin, yMin, xMax, yMax of each character. */
+	DisplayParams _params;			/**< Display parameters of the boxes. */
+	unsigned long _stamp;			/**< Xref change stamp of the text. */
+
+	// Ctor & Dtor
+public:
+	/**
+	 * Builds the index of the page displayed by display.
+	 *
+	 * @param display Page display module.
+	 * @param stamp Xref change stamp of the document.
+	 */
+	PageTextIndex (CPageDisplay& display, unsigned long stamp);
+
+	//
+	// Methods
+	//
+public:
+	/**
+	 * Checks whether the index still describes the page.
+	 *
+	 * @param params Current display parameters of the page.
+	 * @param stamp Current xref change stamp.
+	 */
+	bool isValid (const DisplayParams& params, unsigned long stamp) const
+		{ return _stamp == stamp && _params == params; }
+
+	/**
+	 * Finds all occurences of matcher patterns.
+	 *
+	 * Occurences of the same pattern do not overlap, occurences of different
+	 * patterns may. Rectangles are appended in the text order.
+	 *
+	 * @param matcher Patterns to find.
+	 * @param wholeWord Report only occurences not surrounded by letters or digits.
+	 * @param recs Output container of bounding rectangles.
+	 *
+	 * @return Number of occurences found.
+	 */
+	size_t find (const TextMatcher& matcher, bool wholeWord, std::vector<libs::Rectangle>& recs) const;
+
+	/** Returns number of indexed characters. */
+	size_t length () const
+		{ return _text.size(); }
+
+	/** Returns approximate memory used by the index in bytes. */
+	size_t getMemoryUsage () const
+		{ return sizeof (*this) + _text.capacity() * sizeof (Unicode) + _boxes.capacity() * sizeof (float); }
+
+	//
+	// Helper methods
+	//
+public:
+	/** Appends a character with its box. */
+	void push_back (Unicode c, double xMin, double yMin, double xMax, double yMax);
+	/** Appends a word separator unless there already is one. */
+	void separate ();
+};
+
+
+//=====================================================================================
+} // namespace pdfobjects
+//=====================================================================================
+
+
+#endif // _TEXTINDEX_H_
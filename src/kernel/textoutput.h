@@ -122,6 +122,36 @@ public:
 
 };
 
+
+//=====================================================================================
+// Multi page conversion
+//=====================================================================================
+
+/**
+ * Convert pages of a document one after another.
+ *
+ * Each page is passed to the output builder as soon as it is converted, so
+ * a streaming builder writes it before the next page is started.
+ *
+ * @param pdf Document (anything with getPage() returning a page pointer).
+ * @param positions Container of page positions.
+ * @param out Output builder.
+ */
+template<typename WordEngine, 
+		 typename LineEngine, 
+		 typename ColumnEngine,
+		 typename Pdf,
+		 typename PagePositions
+		 >
+void 
+convert_pages (Pdf& pdf, const PagePositions& positions, OutputBuilder& out)
+{
+	out.start_document ();
+	for (typename PagePositions::const_iterator it = positions.begin(); it != positions.end(); ++it)
+		pdf.getPage (*it)->template convert<WordEngine, LineEngine, ColumnEngine> (out);
+	out.end_document ();
+}
+
 //=====================================================================================
 } // namespace textouput
 //=====================================================================================
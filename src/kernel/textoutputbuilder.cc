@@ -25,6 +25,7 @@
 
 #include "kernel/static.h"
 #include "kernel/textoutputbuilder.h"
+#include <xpdf/UnicodeMap.h>
 
 //=====================================================================================
 namespace textoutput {
@@ -281,6 +282,89 @@ namespace {
 	}
 
 
+	//
+	// Json
+	//
+	namespace JSON
+	{
+		// \u escape of one UTF-16 code unit
+		void u16 (ostringstream& res, unsigned int c)
+			{ res << "\\u" << hex << setw(4) << setfill('0') << c << dec; }
+
+		// string literal, everything outside printable ASCII is escaped so
+		// the output does not depend on the text encoding
+		string str (const PageSimpleFragment::Unicodes& u)
+		{
+			ostringstream res;
+			res << '"';
+			for (PageSimpleFragment::Unicodes::const_iterator it = u.begin(); it != u.end(); ++it)
+			{
+				Unicode c = *it;
+				switch (c)
+				{
+					case '"':	res << "\\\""; break;
+					case '\\':	res << "\\\\"; break;
+					case '\n':	res << "\\n"; break;
+					case '\t':	res << "\\t"; break;
+					default:
+						if (0x20 <= c && 0x7f > c)
+							res << static_cast<char> (c);
+						else if (0x10000 <= c && 0x10ffff >= c)
+						{
+							u16 (res, 0xd800 + ((c - 0x10000) >> 10));
+							u16 (res, 0xdc00 + ((c - 0x10000) & 0x3ff));
+						}
+						// lone surrogates and values out of range can't be
+						// represented, use the replacement character
+						else if ((0xd800 <= c && 0xdfff >= c) || 0x10ffff < c)
+							u16 (res, 0xfffd);
+						else
+							u16 (res, c);
+				}
+			}
+			res << '"';
+			return res.str();
+		}
+
+		// bounding box
+		string bbox (const PageLine::BBox& b)
+		{
+			ostringstream res;
+			res << "\"bbox\":[" << b.xleft << "," << b.yleft << "," 
+				<< b.xright << "," << b.yright << "]";
+			return res.str();
+		}
+	}
+
+	//
+	//
+	//
+	string 
+	word2json (const PageFragment& w)
+	{
+		PageSimpleFragment::Unicodes u;
+		for (PageFragment::Iterator it = w.begin(); it != w.end(); ++it)
+			u.insert (u.end(), (*it)->_unicode.begin(), (*it)->_unicode.end());
+		return "{" + JSON::bbox (w.bbox()) + ",\"text\":" + JSON::str (u) + "}";
+	}
+
+	//
+	//
+	//
+	string 
+	line2json (const PageLine& l)
+	{
+		string res ("{" + JSON::bbox (l.bbox()) + ",\"words\":[");
+		for (PageLine::Iterator it = l.begin(); it != l.end(); ++it)
+		{
+			if (it != l.begin())
+				res += ",";
+			res += word2json (**it);
+		}
+		return res + "]}";
+	}
+
+
 //=====================================================================================
 } // namespace
 //=====================================================================================
@@ -332,6 +416,188 @@ XmlOutputBuilder::xml (const XmlOutputBuilder& out)
 	return XML_GENERAL::header + out.str() + XML_GENERAL::footer;
 }
 
+
+//
+// Plain text output builder
+//
+
+//
+// From words
+//
+void
+PlainTextOutputBuilder::build (PageFragmentIterator, PageFragmentIterator)
+{
+}
+
+//
+// From columns
+//
+void
+PlainTextOutputBuilder::build (PageColumnIterator it_s, PageColumnIterator it_e)
+{
+	UnicodeMap* umap = globalParams->getTextEncoding ();
+		if (!umap)
+			return;
+
+	char buf[8];
+	string space (buf, umap->mapUnicode (0x20, buf, sizeof (buf)));
+	string eol;
+	switch (globalParams->getTextEOL ())
+	{
+		case eolDOS:
+			eol.append (buf, umap->mapUnicode (0x0d, buf, sizeof (buf)));
+			// fall through
+		case eolUnix:
+			eol.append (buf, umap->mapUnicode (0x0a, buf, sizeof (buf)));
+			break;
+		case eolMac:
+			eol.append (buf, umap->mapUnicode (0x0d, buf, sizeof (buf)));
+			break;
+	}
+
+	bool all = !BBox::isInitialized (_rect);
+	for (PageColumnIterator it = it_s; it != it_e; ++it)
+	{
+		for (PageColumn::Iterator itl = (*it)->begin(); itl != (*it)->end(); ++itl)
+		{
+			bool empty = true;
+			for (PageLine::Iterator itw = (*itl)->begin(); itw != (*itl)->end(); ++itw)
+			{
+				// Check the center of the word
+				if (!all)
+				{
+					BBox b = (*itw)->bbox();
+					double x = (b.xleft + b.xright) / 2;
+					double y = (b.yleft + b.yright) / 2;
+					if (x <= min (_rect.xleft, _rect.xright) || x >= max (_rect.xleft, _rect.xright)
+							|| y <= min (_rect.yleft, _rect.yright) || y >= max (_rect.yleft, _rect.yright))
+						continue;
+				}
+
+				if (!empty)
+					_str += space;
+				empty = false;
+				for (PageFragment::Iterator itf = (*itw)->begin(); itf != (*itw)->end(); ++itf)
+				{
+					const PageSimpleFragment::Unicodes& u = (*itf)->_unicode;
+					for (PageSimpleFragment::Unicodes::const_iterator itu = u.begin(); itu != u.end(); ++itu)
+						_str.append (buf, umap->mapUnicode (*itu, buf, sizeof (buf)));
+				}
+			}
+			if (!empty)
+				_str += eol;
+		}
+	}
+
+	umap->decRefCnt ();
+}
+
+
+//
+// Stream output builder
+//
+
+//
+//
+//
+void
+StreamOutputBuilder::flush ()
+{
+	_out.write (_buf.data(), _buf.size());
+	_out.flush ();
+	_buf.clear ();
+}
+
+
+//
+// Xml stream output builder
+//
+
+//
+//
+//
+void
+XmlStreamOutputBuilder::start_document ()
+{
+	write (XML_GENERAL::header);
+}
+
+//
+//
+//
+void
+XmlStreamOutputBuilder::end_document ()
+{
+	write (XML_GENERAL::footer);
+	flush ();
+}
+
+//
+// From words
+//
+void
+XmlStreamOutputBuilder::build (PageFragmentIterator, PageFragmentIterator)
+{
+}
+
+//
+// From columns
+//
+void
+XmlStreamOutputBuilder::build (PageColumnIterator it_s, PageColumnIterator it_e)
+{
+	// header
+	write (XML_PAGE::header (_pagepos));
+
+	// stuff
+	for (PageColumnIterator it = it_s; it != it_e; ++it)
+		write (string ("\n") + column2xml (**it));
+
+	// footer
+	write (XML_PAGE::footer + string ("\n"));
+}
+
+
+//
+// Json lines output builder
+//
+
+//
+// From words
+//
+void
+JsonLinesOutputBuilder::build (PageFragmentIterator, PageFragmentIterator)
+{
+}
+
+//
+// From columns
+//
+void
+JsonLinesOutputBuilder::build (PageColumnIterator it_s, PageColumnIterator it_e)
+{
+	ostringstream header;
+	header << "{\"page\":" << _pagepos << ",\"columns\":[";
+	write (header.str());
+
+	for (PageColumnIterator it = it_s; it != it_e; ++it)
+	{
+		const PageColumn& c = **it;
+		if (it != it_s)
+			write (",");
+		write ("{" + JSON::bbox (c.bbox()) + ",\"lines\":[");
+		for (PageColumn::Iterator itl = c.begin(); itl != c.end(); ++itl)
+		{
+			if (itl != c.begin())
+				write (",");
+			write (line2json (**itl));
+		}
+		write ("]}");
+	}
+
+	write ("]}\n");
+}
+
 //=====================================================================================
 } // namespace textoutput
 //=====================================================================================
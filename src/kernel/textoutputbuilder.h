@@ -83,15 +83,21 @@ public:
 	/** Build output from fragments. */
 	virtual void build (PageFragmentIterator, PageFragmentIterator) = 0;
 
+	/** Start document. Called once before the first page. */
+	virtual void start_document () {}
+
+	/** End document. Called once after the last page. */
+	virtual void end_document () {}
+
 	/** Start page. */
-	void start_page (size_t pagepos)
+	virtual void start_page (size_t pagepos)
 	{ 
 		assert (std::numeric_limits<size_t>::max() == _pagepos); 
 		_pagepos = pagepos; 
 	}
 
 	/** End page. */
-	void end_page ()
+	virtual void end_page ()
 	{ 
 		_pagepos = std::numeric_limits<size_t>::max(); 
 	}
@@ -141,6 +147,169 @@ public:
 };
 
 
+
+//
+// Plain text output
+//
+
+/**
+ * Plain text builder.
+ *
+ * Words of each line are separated by a space, lines are ended with the end
+ * of line sequence set in global parameters. Text is encoded with the text
+ * encoding set in global parameters. If a rectangle is given, only words
+ * whose center lies in it are output.
+ */
+
+class PlainTextOutputBuilder : public OutputBuilder
+{
+typedef PageFragment::BBox BBox;
+
+private:
+	std::string _str;	/**< Output text. */
+	BBox _rect;			/**< Area of words to output. */
+
+	//
+	// Ctor
+	//
+public:
+	PlainTextOutputBuilder () {}
+	PlainTextOutputBuilder (const BBox& rect) : _rect (rect) {}
+
+	//
+	// Building interface
+	//
+public:
+
+	/** Build output from fragments. */
+	void build (PageColumnIterator it_s, PageColumnIterator it_e);
+	void build (PageFragmentIterator it_s, PageFragmentIterator it_e);
+
+	/** Get result. */
+	const std::string& str () const 
+		{ return _str; }
+};
+
+
+//
+// Streaming output
+//
+
+/**
+ * Base of builders writing pages to an output stream as they are built.
+ *
+ * Output is collected in a buffer which is written to the stream when it
+ * grows over the limit and at the end of each page, so at most one page
+ * (or a bit more than the limit) is kept in memory.
+ */
+
+class StreamOutputBuilder : public OutputBuilder
+{
+private:
+	std::ostream& _out;		/**< Output stream. */
+	std::string _buf;		/**< Output not written yet. */
+	size_t _limit;			/**< Buffer size limit. */
+
+	//
+	// Ctor
+	//
+public:
+	/**
+	 * Constructor.
+	 *
+	 * @param out Output stream.
+	 * @param limit Size of the buffer in bytes.
+	 */
+	StreamOutputBuilder (std::ostream& out, size_t limit = 64 * 1024) 
+		: _out (out), _limit (limit) 
+		{ _buf.reserve (limit); }
+
+	//
+	// Building interface
+	//
+public:
+	/** End page and write its output. */
+	virtual void end_page ()
+	{
+		OutputBuilder::end_page ();
+		flush ();
+	}
+	
+	/** Write buffered output to the stream. */
+	void flush ();
+
+	//
+	// Helper functions
+	//
+protected:
+	/** Append output, write the buffer if it is full. */
+	void write (const std::string& str)
+	{
+		_buf += str;
+		if (_buf.size() >= _limit)
+			flush ();
+	}
+};
+
+
+/**
+ * Page xml builder writing to a stream.
+ *
+ * Produces the same document as XmlOutputBuilder::xml() without keeping it
+ * in memory. Header of the document is written in start_document and
+ * footer in end_document.
+ */
+
+class XmlStreamOutputBuilder : public StreamOutputBuilder
+{
+	//
+	// Ctor
+	//
+public:
+	XmlStreamOutputBuilder (std::ostream& out, size_t limit = 64 * 1024) 
+		: StreamOutputBuilder (out, limit) {}
+
+	//
+	// Building interface
+	//
+public:
+	void start_document ();
+	void end_document ();
+
+	/** Build output from fragments. */
+	void build (PageColumnIterator it_s, PageColumnIterator it_e);
+	void build (PageFragmentIterator it_s, PageFragmentIterator it_e);
+};
+
+
+/**
+ * Page builder writing one json object per page and line.
+ *
+ * Each page is written as 
+ * {"page":n,"columns":[{"bbox":[...],"lines":[{"bbox":[...],"words":[{"bbox":[...],"text":"..."}]}]}]}
+ * followed by a new line. Bounding boxes are arrays of xleft, yleft, xright
+ * and yright, texts are the same as in the xml output.
+ */
+
+class JsonLinesOutputBuilder : public StreamOutputBuilder
+{
+	//
+	// Ctor
+	//
+public:
+	JsonLinesOutputBuilder (std::ostream& out, size_t limit = 64 * 1024) 
+		: StreamOutputBuilder (out, limit) {}
+
+	//
+	// Building interface
+	//
+public:
+	/** Build output from fragments. */
+	void build (PageColumnIterator it_s, PageColumnIterator it_e);
+	void build (PageFragmentIterator it_s, PageFragmentIterator it_e);
+};
+
+
 //=====================================================================================
 } // namespace textouput
 //=====================================================================================
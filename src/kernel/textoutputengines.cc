@@ -85,10 +85,10 @@ namespace {
 		{ return isPdfOp (op, string ("Tj"), string ("TJ"),string ("'"), string("\"")); }
 
 	//
-	// Get text from text operator
+	// Get text from text operator, unicode text is stored to unicode
 	//
 	string 
-	text_op_text (const PdfOperator& op, const GfxState& state)
+	text_op_text (const PdfOperator& op, const GfxState& state, PageSimpleFragment::Unicodes& unicode)
 	{
 		assert (!isPdfOp(op, string("TJ")));
 
@@ -105,12 +105,16 @@ namespace {
 		//
 		const GfxFont* font = (const_cast<GfxState&>(state)).getFont();
 			if (!font)
+			{
+				for (string::const_iterator it = text.begin(); it != text.end(); ++it)
+					unicode.push_back (static_cast<unsigned char> (*it));
 				return text;
+			}
 		char* p = const_cast<char*> (text.c_str ());
 		size_t len = text.size();
 		int n = 0, uLen = 0;
 		CharCode code;
-		Unicode u;
+		Unicode u[8];
 		double d = 0.0;
 
 		string result;
@@ -119,13 +123,14 @@ namespace {
 			n = font->getNextChar (	p, 
 									static_cast<int>(len), 
 									&code,
-									&u, 
-									sizeof(Unicode), 
+									u, 
+									sizeof(u) / sizeof(Unicode), 
 									&uLen,
 									&d, &d, &d, &d);
 
 			p += n;
 			len -= n;
+			unicode.insert (unicode.end(), u, u + uLen);
 		
 			// Put rather name tham the character
 			const Gfx8BitFont* f = dynamic_cast<const Gfx8BitFont*> (font);
@@ -143,7 +148,7 @@ namespace {
 					result += tmp;
 			
 			}else
-				result += static_cast<char> (u&0xFF);
+				result += static_cast<char> (u[0]&0xFF);
 		}
 
 		return result;
@@ -309,7 +314,9 @@ SimpleWordEngine::operator() (const PdfOperatorPtr op, const GfxState& gfx_state
 			// Add all info needed -- bbox, text, state, font
 			//
 			sfrag->add (o->getBBox ());
-			sfrag->add (o, text_op_text(*o,*s));
+			PageSimpleFragment::Unicodes unicode;
+			sfrag->add (o, text_op_text(*o,*s,unicode));
+			sfrag->add (unicode);
 			// Copy and then set state
 			sfrag->add (s);
 			sfrag->add (res);
@@ -381,35 +388,69 @@ SimpleWordEngine::operator() ()
 //
 
 //
-// Does word belongs to a line
+// Group words into lines
 //
-SimpleLineEngine::LinePart::result 
-SimpleLineEngine::LinePart::line_part (const PageLine& l, const PageFragment& f)
+void
+SimpleLineEngine::group (const PageFragments& words)
 {
-	BBox b1 = l.bbox();
-	BBox b2 = f.bbox();
-	// word height
-	//double lsize = abs (b1.yleft - b1.yright);
-
 	//
-	// Check whether f is "below" current line -- next line
+	// Words are taken in the order of their top edges, so a new line always
+	// comes after all existing ones and it never grows upwards. A word
+	// belongs to the first line which reaches (by itself or by any line
+	// before it) down to the top of the word. Only lines reaching lower than
+	// all lines before them can be such a line, so just these are kept,
+	// ordered by their bottom edges, and the line is found by a binary search.
 	//
-	if (b1.yleft > b1.yright)
+	typedef std::vector<std::pair<double, size_t> > Order;
+	Order order;
+	order.reserve (words.size());
+	for (size_t i = 0; i < words.size(); ++i)
 	{
-		if (b1.yright > max (b2.yleft, b2.yright))
-			return was_part;
-	}else 
-		if (b1.yleft < min (b2.yleft, b2.yright))
-			return was_part;
-
-
-	// Y axis -- if the intersection of y axis is not empty it is one line
-	b2.xleft = b1.xleft;
-	b2.xright = b1.xright;
-	if (!BBox::isInitialized (libs::rectangle_intersect (b1,b2)))
-		return not_part;
-	
-	return is_part;
+		BBox b = words[i]->bbox();
+		order.push_back (std::make_pair (min (b.yleft, b.yright), i));
+	}
+	// words with the same top edge stay in their order
+	std::sort (order.begin(), order.end());
+
+	typedef std::map<double, size_t> Reaching;
+	Reaching reaching;
+	std::vector<std::vector<size_t> > lines;
+	for (Order::const_iterator it = order.begin(); it != order.end(); ++it)
+	{
+		BBox b = words[it->second]->bbox();
+		double bottom = max (b.yleft, b.yright);
+
+		Reaching::iterator line = reaching.lower_bound (it->first);
+		
+		// No line reaches to the word, new one reaches lower than all others
+		if (line == reaching.end())
+		{
+			reaching.insert (std::make_pair (bottom, lines.size()));
+			lines.push_back (std::vector<size_t> (1, it->second));
+			continue;
+		}
+		
+		// Insert into existing line, lines after it which don't reach lower
+		// than it any more are not kept
+		size_t pos = line->second;
+		lines[pos].push_back (it->second);
+		if (bottom > line->first)
+		{
+			reaching.erase (line, reaching.upper_bound (bottom));
+			reaching.insert (std::make_pair (bottom, pos));
+		}
+	}
+
+	// words keep their original order in lines
+	_lines.reserve (_lines.size() + lines.size());
+	for (size_t l = 0; l < lines.size(); ++l)
+	{
+		std::sort (lines[l].begin(), lines[l].end());
+		PageLinePtr line (new PageLine);
+		for (size_t i = 0; i < lines[l].size(); ++i)
+			line->push_back (words[lines[l][i]]);
+		_lines.push_back (line);
+	}
 }
 
 
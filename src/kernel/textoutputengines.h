@@ -104,6 +104,12 @@ public:
 
 /**
  * Simple line engine grouping words in one line.
+ *
+ * Words are taken from the top of the page and each of them is added to
+ * the first line whose vertical extent (or the extent of any line before it)
+ * reaches the word, otherwise the word starts a new line. The line is found
+ * by a binary search, so grouping takes O(n log n) time regardless of the
+ * order of words on input. Words keep their input order within lines.
  */
 
 struct SimpleLineEngine
@@ -112,22 +118,13 @@ typedef boost::shared_ptr<PageLine>	PageLinePtr;
 typedef std::vector<PageLinePtr>	PageLines;
 typedef PageLines::const_iterator 	Iterator;
 typedef SimpleWordEngine::PageFragmentPtr PageFragmentPtr;
+typedef std::vector<PageFragmentPtr> PageFragments;
 
 private:
 	PageLines _lines;	/**< Container of lines. */
 
-	//
-	// Class deciding whether a word belongs to a line
-	//
-	struct LinePart
-	{
-		typedef short unsigned int result;
-		static const result is_part  = 0;
-		static const result was_part = 1;
-		static const result not_part = 2;
-		/** Decide whether word is part of this line. */
-		static result line_part (const PageLine& l, const PageFragment& f);
-	};
+	/** Group words into lines. */
+	void group (const PageFragments& words);
 
 	//
 	// Page source functor
@@ -137,41 +134,10 @@ public:
 	template<typename WordEngine>
 	void operator() (const WordEngine& w)
 	{
-		//
-		// Loop through all words and group them into lines
-		//
+		PageFragments words;
 		for (typename WordEngine::Iterator itw = w.begin(); itw != w.end(); ++itw)
-		{
-			PageLines::iterator itl;
-			LinePart::result 	is_part = LinePart::not_part;
-
-			// Find appropriate place
-			for (itl = _lines.begin(); itl != _lines.end(); ++itl)
-			{
-				is_part = LinePart::line_part (*(*itl), *(*itw));
-				if (LinePart::not_part != is_part)
-					break;
-			}
-			
-			// Insert itw into exsting line
-			if (LinePart::is_part == is_part)
-			{
-				(*itl)->push_back (*itw);
-		
-			// Create new line before existing one
-			}else if (LinePart::was_part == is_part)
-			{
-				itl = _lines.insert (itl, PageLinePtr (new PageLine));
-				(*itl)->push_back (*itw);
-
-			//	Not part make new line at the end
-			}else if (LinePart::not_part == is_part)
-			{
-				_lines.push_back (PageLinePtr (new PageLine));
-				_lines.back()->push_back (*itw);
-			}
-
-		}// for (WordEngine::Iterator itl = w.begin(); itl != w.end(); ++itl)
+			words.push_back (*itw);
+		group (words);
 	
 		//
 		// Sort words in lines
@@ -59,6 +59,18 @@ namespace {
 		return (f1._font_tag == f2._font_tag); // && ...
 	}
 
+	// Gap between fragments (multiplied by font size) which is taken as
+	// a space in unicode text (the same as xpdf minimal word break space)
+	const static double WORD_BREAK_DIV = 0.1;
+
+	/** Is there a space between the bbox and the following fragment. */
+	bool
+	word_break (const BBox& b, const PageSimpleFragment& f)
+	{
+		double fsize = (f._state) ? f._state->getTransformedFontSize() : 0;
+		return (f._bbox.xleft - b.xright) > WORD_BREAK_DIV * fsize;
+	}
+
 //=====================================================================================
 } // namespace
 //=====================================================================================
@@ -110,6 +122,11 @@ PageSimpleFragment::add (const Text& font_tag )
 	// Add operator to ops
 	_font_tag = font_tag;
 }
+void
+PageSimpleFragment::add (const Unicodes& unicode)
+{
+	_unicode = unicode;
+}
 
 
 //=====================================================================================
@@ -135,13 +152,20 @@ PageFragment::push_back (PageSimpleFragmentPtr sfrag)
 	//
 	// If font matches bbox bottom line then merge into one text
 	//
+	bool space = word_break (_bbox, *sfrag);
 	if (similar_frag (*(_sfrags.back()), *sfrag))
 	{
 		_sfrags.back()->_text += sfrag->_text;	
+		PageSimpleFragment::Unicodes& u = _sfrags.back()->_unicode;
+		if (space)
+			u.push_back (0x20);
+		u.insert (u.end(), sfrag->_unicode.begin(), sfrag->_unicode.end());
 
 	}else
 	{
 		kernelPrintDbg (DBG_DBG, "FRAGS ARE NEAR BUT FONT DOES NOT MATCH!");
+		if (space)
+			sfrag->_unicode.insert (sfrag->_unicode.begin(), 0x20);
 		// Add fragment to the end of this word
 		_sfrags.push_back (sfrag);
 	}
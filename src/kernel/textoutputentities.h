@@ -56,6 +56,7 @@ struct PageSimpleFragment
 	typedef boost::shared_ptr<GfxResources> GfxResourcePtr;
 	typedef boost::shared_ptr<GfxFont>  GfxFontPtr;
 	typedef std::string Text;
+	typedef std::vector<Unicode> Unicodes;
 
 	// BBoxes
 	BBox 	 		_bbox;
@@ -66,6 +67,7 @@ struct PageSimpleFragment
 	GfxResourcePtr 	_res;
 	Text		 	_font_tag;
 	Text		 	_text;
+	Unicodes		_unicode;	/**< Unicode text (empty if unknown). */
 
 	//
 	// Interface
@@ -78,6 +80,7 @@ public:
 	void add (BBox bbox);
 	void add (PdfOperatorPtr op, Text text);
 	void add (const Text& font_tag);
+	void add (const Unicodes& unicode);
 
 };
 
@@ -53,11 +53,14 @@ typedef struct TextSearchParams
 	double yStart; 			/**< Start searching from y position. */
 	double xEnd; 			/**< Stop searching from x position.  */
 	double yEnd; 			/**< Stop searching from y position.  */
+	GBool caseSensitive;	/**< Compare letter case. */
+	GBool wholeWord;		/**< Find whole words only. */
 
 	/** Constructor. Default values are set. */
 	TextSearchParams () : 
 		startAtTop (DEFAULT_START_AT_TOP),
-		xStart (DEFAULT_X_START), yStart (DEFAULT_Y_START), xEnd (DEFAULT_X_END), yEnd (DEFAULT_Y_END)
+		xStart (DEFAULT_X_START), yStart (DEFAULT_Y_START), xEnd (DEFAULT_X_END), yEnd (DEFAULT_Y_END),
+		caseSensitive (DEFAULT_CASE_SENSITIVE), wholeWord (DEFAULT_WHOLE_WORD)
 	{}
 
 	//
@@ -67,6 +70,8 @@ typedef struct TextSearchParams
 	// integral type compilator error))
 	//
 	static const GBool DEFAULT_START_AT_TOP = gTrue;	/**< Start at top. */
+	static const GBool DEFAULT_CASE_SENSITIVE = gFalse;	/**< Ignore letter case. */
+	static const GBool DEFAULT_WHOLE_WORD = gFalse;		/**< Find also parts of words. */
 
 	static const int DEFAULT_X_START = 0;	/**< Default x position of left upper corner. */
 	static const int DEFAULT_Y_START = 0;	/**< Default y position of left upper corner. */
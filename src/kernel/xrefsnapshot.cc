@@ -0,0 +1,190 @@
+/*
+ * PDFedit - free program for PDF document manipulation.
+ * Copyright (C) 2006-2009  PDFedit team: Michal Hocko,
+ *                                        Jozef Misutka,
+ *                                        Martin Petricek
+ *                   Former team members: Miroslav Jahoda
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program (in doc/LICENSE.GPL); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA  02111-1307  USA
+ *
+ * Project is hosted on http://sourceforge.net/projects/pdfedit
+ */
+// vim:tabstop=4:shiftwidth=4:noexpandtab:textwidth=80
+
+// static
+#include "kernel/static.h"
+
+#include "kernel/xrefsnapshot.h"
+#include "kernel/memoryusage.h"
+
+//==========================================================
+namespace pdfobjects {
+//==========================================================
+
+using namespace std;
+
+const int XRefSnapshot::CHUNK_SIZE;
+
+//==========================================================
+namespace {
+//==========================================================
+
+	/** Offset of entries which are not present in an xref section. */
+	const Guint UNUSED_OFFSET = 0xffffffff;
+
+	/** Chunk without any entries, shared by all snapshots. */
+	boost::shared_ptr<const XRefSnapshot::Chunk>
+	emptyChunk ()
+	{
+		static boost::shared_ptr<const XRefSnapshot::Chunk> empty;
+		if (!empty)
+		{
+			::XRefEntry entry;
+			entry.offset = UNUSED_OFFSET;
+			entry.gen = 0;
+			entry.type = xrefEntryFree;
+			empty.reset (new XRefSnapshot::Chunk (XRefSnapshot::CHUNK_SIZE, entry));
+		}
+		return empty;
+	}
+
+	/** Deep copy of the trailer, so that nobody else can change it. */
+	void cloneTrailer (const ::Object* trailer, ::Object& result)
+	{
+		::Object* clone = trailer->clone ();
+		result = *clone;
+		gfree (clone);
+	}
+
+//==========================================================
+} // namespace
+//==========================================================
+
+
+//
+//
+//
+XRefSnapshot::XRefSnapshot (const XRefSnapshot* prev, const ::XRefEntry* entries, int size, Guint maxObj, const ::Object* trailer)
+	: _size (prev ? std::max (prev->_size, size) : size),
+	  _maxObj (prev ? std::max (prev->_maxObj, maxObj) : maxObj)
+{
+	cloneTrailer (trailer, _trailer);
+
+	size_t count = (_size + CHUNK_SIZE - 1) / CHUNK_SIZE;
+	_chunks.reserve (count);
+	for (size_t c = 0; c < count; ++c)
+	{
+		boost::shared_ptr<const Chunk> prevChunk = (prev && c < prev->_chunks.size()) ? prev->_chunks[c] : emptyChunk ();
+
+		// skip to the first entry of the section in this chunk
+		int first = (int)c * CHUNK_SIZE;
+		int last = std::min (first + CHUNK_SIZE, size);
+		int i = first;
+		while (i < last && UNUSED_OFFSET == entries[i].offset)
+			++i;
+		if (i >= last)
+		{
+			_chunks.push_back (prevChunk);
+			continue;
+		}
+
+		// newer entries replace older ones
+		boost::shared_ptr<Chunk> chunk (new Chunk (*prevChunk));
+		for (; i < last; ++i)
+			if (UNUSED_OFFSET != entries[i].offset)
+				(*chunk)[i - first] = entries[i];
+		_chunks.push_back (chunk);
+	}
+}
+
+//
+//
+//
+XRefSnapshot::XRefSnapshot (const XRefSnapshot* prev, const OffsetList& offsets, const ::Object* trailer)
+	: _size (prev ? prev->_size : 0),
+	  _maxObj (prev ? prev->_maxObj : 0)
+{
+	cloneTrailer (trailer, _trailer);
+
+	for (OffsetList::const_iterator it = offsets.begin(); it != offsets.end(); ++it)
+	{
+		assert (0 <= it->first.num);
+		_size = std::max (_size, it->first.num + 1);
+		_maxObj = std::max (_maxObj, (Guint)it->first.num);
+	}
+	if (prev)
+		_chunks = prev->_chunks;
+	_chunks.resize ((_size + CHUNK_SIZE - 1) / CHUNK_SIZE, emptyChunk ());
+
+	// newer entries replace older ones in copies of touched chunks
+	typedef std::map<size_t, boost::shared_ptr<Chunk> > Touched;
+	Touched touched;
+	for (OffsetList::const_iterator it = offsets.begin(); it != offsets.end(); ++it)
+	{
+		size_t c = it->first.num / CHUNK_SIZE;
+		Touched::iterator chunk = touched.find (c);
+		if (chunk == touched.end())
+			chunk = touched.insert (std::make_pair (c, boost::shared_ptr<Chunk> (new Chunk (*_chunks[c])))).first;
+
+		::XRefEntry& entry = (*chunk->second)[it->first.num % CHUNK_SIZE];
+		entry.offset = (Guint)it->second;
+		entry.gen = it->first.gen;
+		entry.type = xrefEntryUncompressed;
+	}
+	for (Touched::const_iterator it = touched.begin(); it != touched.end(); ++it)
+		_chunks[it->first] = it->second;
+}
+
+//
+//
+//
+size_t
+XRefSnapshot::copyTo (::XRefEntry* entries, const XRefSnapshot* current) const
+{
+	size_t copied = 0;
+	for (size_t c = 0; c < _chunks.size(); ++c)
+	{
+		int first = (int)c * CHUNK_SIZE;
+		int count = std::min (CHUNK_SIZE, _size - first);
+
+		// the array already contains the same chunk
+		if (current && c < current->_chunks.size() && current->_chunks[c] == _chunks[c]
+				&& current->_size >= first + count)
+			continue;
+
+		std::copy (_chunks[c]->begin(), _chunks[c]->begin() + count, entries + first);
+		copied += count;
+	}
+	return copied;
+}
+
+//
+//
+//
+size_t
+XRefSnapshot::getMemoryUsage (std::set<const Chunk*>& counted) const
+{
+	size_t size = sizeof (*this) + _chunks.capacity () * sizeof (boost::shared_ptr<const Chunk>)
+		+ utils::getXpdfObjectMemoryUsage (_trailer);
+	for (size_t c = 0; c < _chunks.size(); ++c)
+		if (counted.insert (_chunks[c].get()).second)
+			size += sizeof (Chunk) + _chunks[c]->capacity () * sizeof (::XRefEntry);
+	return size;
+}
+
+
+//==========================================================
+} // namespace pdfobjects
+//==========================================================
@@ -0,0 +1,151 @@
+/*
+ * PDFedit - free program for PDF document manipulation.
+ * Copyright (C) 2006-2009  PDFedit team: Michal Hocko,
+ *                                        Jozef Misutka,
+ *                                        Martin Petricek
+ *                   Former team members: Miroslav Jahoda
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program (in doc/LICENSE.GPL); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA  02111-1307  USA
+ *
+ * Project is hosted on http://sourceforge.net/projects/pdfedit
+ */
+// vim:tabstop=4:shiftwidth=4:noexpandtab:textwidth=80
+
+#ifndef _XREFSNAPSHOT_H_
+#define _XREFSNAPSHOT_H_
+
+#include "kernel/static.h"
+#include "xpdf/XRef.h"
+
+
+//=====================================================================================
+namespace pdfobjects {
+//=====================================================================================
+
+
+//=====================================================================================
+// XRefSnapshot
+//=====================================================================================
+
+/**
+ * Immutable cross reference table of one revision.
+ *
+ * Entries are stored in fixed size chunks. A snapshot of a revision is
+ * created from the snapshot of the previous revision and the entries of its
+ * own xref section. Only the chunks touched by the section are copied, all
+ * others are shared with the previous revision, so keeping snapshots of all
+ * revisions costs about the same as keeping the changed entries.
+ * <br>
+ * The table of a revision is materialized into the XRef::entries array by
+ * copyTo. When another snapshot is already there, just the chunks which
+ * differ are copied.
+ */
+class XRefSnapshot
+{
+	// Typedefs
+public:
+	/** Number of entries in one chunk (power of 2). */
+	static const int CHUNK_SIZE = 256;
+
+	/** Chunk of entries, always CHUNK_SIZE long. */
+	typedef std::vector< ::XRefEntry> Chunk;
+
+	/** References and offsets of objects written to a new xref section. */
+	typedef std::vector<std::pair< ::Ref, size_t> > OffsetList;
+
+	// Variables
+private:
+	std::vector<boost::shared_ptr<const Chunk> > _chunks;
+	int _size;			/**< Number of entries. */
+	Guint _maxObj;		/**< Maximum object number used up to this revision. */
+	::Object _trailer;	/**< Trailer of the revision. */
+
+	// Ctor & Dtor
+public:
+	/**
+	 * Creates the snapshot of a revision.
+	 *
+	 * @param prev Snapshot of the previous revision (NULL for the oldest one).
+	 * @param entries Entries of the xref section of this revision, entries
+	 * with 0xffffffff offset are not part of the section.
+	 * @param size Number of entries.
+	 * @param maxObj Maximum object number used in the section.
+	 * @param trailer Trailer of the section (snapshot keeps its deep copy).
+	 */
+	XRefSnapshot (const XRefSnapshot* prev, const ::XRefEntry* entries, int size, Guint maxObj, const ::Object* trailer);
+
+	/**
+	 * Creates the snapshot of a revision which has just been written.
+	 *
+	 * @param prev Snapshot of the previous revision (NULL for the oldest one).
+	 * @param offsets Objects written to the xref section of this revision
+	 * (all of them in use).
+	 * @param trailer Trailer of the section (snapshot keeps its deep copy).
+	 */
+	XRefSnapshot (const XRefSnapshot* prev, const OffsetList& offsets, const ::Object* trailer);
+
+	/** Destructor. */
+	~XRefSnapshot ()
+		{ _trailer.free(); }
+
+	//
+	// Methods
+	//
+public:
+	/** Returns number of entries. */
+	int getSize () const
+		{ return _size; }
+
+	/** Returns maximum object number used up to this revision. */
+	Guint getMaxObj () const
+		{ return _maxObj; }
+
+	/** Returns trailer of the revision. */
+	const ::Object* getTrailer () const
+		{ return &_trailer; }
+
+	/**
+	 * Copies entries to the array.
+	 *
+	 * @param entries Array of getSize entries.
+	 * @param current Snapshot whose content is already in the array or NULL.
+	 *
+	 * @return Number of copied entries.
+	 */
+	size_t copyTo (::XRefEntry* entries, const XRefSnapshot* current = NULL) const;
+
+	/**
+	 * Estimates memory held by the snapshot.
+	 *
+	 * @param counted Chunks which have been already counted (chunks shared
+	 * with other snapshots are counted just once). Chunks of this snapshot
+	 * are added.
+	 *
+	 * @return Number of bytes.
+	 */
+	size_t getMemoryUsage (std::set<const Chunk*>& counted) const;
+
+private:
+	XRefSnapshot (const XRefSnapshot&);
+	XRefSnapshot& operator= (const XRefSnapshot&);
+};
+
+
+//=====================================================================================
+} // namespace pdfobjects
+//=====================================================================================
+
+
+#endif // _XREFSNAPSHOT_H_
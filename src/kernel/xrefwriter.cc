@@ -30,6 +30,8 @@
 #include "kernel/streamwriter.h"
 #include "kernel/pdfwriter.h"
 #include "kernel/factories.h"
+#include "kernel/loadprogress.h"
+#include "utils/trace.h"
 
 using namespace debug;
 
@@ -145,7 +147,7 @@ bool isLatestRevision(const XRefWriter &xref)
 
 } // end of utils namespace
 
-XRefWriter::XRefWriter(StreamWriter * stream, CPdf * _pdf)
+XRefWriter::XRefWriter(StreamWriter * stream, CPdf * _pdf, LoadProgress * progress)
 	:CXref(stream), 
 	mode(paranoid), 
 	pdf(_pdf), 
@@ -173,7 +175,7 @@ XRefWriter::XRefWriter(StreamWriter * stream, CPdf * _pdf)
 	// we are parsing only trailer which doesn't contain any directly
 	// encrypted data - strings
 	// revision is initialized to the most recent one
-	collectRevisions();
+	collectRevisions(progress);
 
 	// sets internal fetch back to normal
 	disableInternalFetch();
@@ -475,6 +477,7 @@ void XRefWriter::saveChanges(bool newRevision)
 {
 	using namespace utils;
 
+	TRACE_SCOPE("writer", "XRefWriter::saveChanges");
 	kernelPrintDbg(DBG_DBG, "");
 
 	check_need_credentials(this);
@@ -520,6 +523,11 @@ void XRefWriter::saveChanges(bool newRevision)
 		xpdf::freeXpdfObject(o);
 	}
 
+	// offsets of written objects are needed for the new revision and
+	// writeTrailer resets them
+	IPdfWriter::OffsetList offsets;
+	bool offsetsKnown=newRevision && pdfWriter->getOffsets(offsets);
+
 	// Stores position of the cross reference section to xrefPos
 	size_t xrefPos=streamWriter->getPos();
 	IPdfWriter::PrevSecInfo secInfo={lastXRefPos, XRef::maxObj+1};
@@ -537,8 +545,12 @@ void XRefWriter::saveChanges(bool newRevision)
 		kernelPrintDbg(DBG_DBG, "New storePos="<<storePos);
 
 		// forces reinitialization of XRef and CXref internal structures from
-		// last xref position
-		CXref::reopen(xrefPos);
+		// last xref position - written section is parsed only if the writer
+		// doesn't tell us what it has written
+		if(offsetsKnown)
+			CXref::appendRevision(xrefPos, offsets);
+		else
+			CXref::reopen(xrefPos);
 
 		// new revision number is added and current revision is updated - 
 		// we insert the newest revision so xrefPos value is stored
@@ -693,10 +705,13 @@ bad_header:
 	return -1;
 }
 
-void XRefWriter::collectRevisions()
+void XRefWriter::collectRevisions(LoadProgress * progress)
 {
 	kernelPrintDbg(DBG_DBG, "");
 
+	if(progress)
+		progress->stage(LoadProgress::RevisionsStage, 0);
+
 	// starts with newest revision
 	size_t off=XRef::lastXRefPos;
 
@@ -748,6 +763,12 @@ void XRefWriter::collectRevisions()
 					revisions.size()<<" revision is "<<off);
 
 			revisions.insert(revisions.begin(), off);
+			if(progress)
+			{
+				progress->step(revisions.size());
+				if(progress->isCanceled())
+					break;
+			}
 		}
 		off = getPrevFromTrailer(trailer);
 		if(isERR_OFFSET(off))
@@ -820,6 +841,9 @@ void XRefWriter::collectRevisions()
 	trailer->free();
 	gfree(trailer);
 
+	if(progress)
+		progress->checkCanceled();
+
 	// initiailizes the current revision to the most recent one.
 	revision = revisions.size()-1;
 	kernelPrintDbg(DBG_INFO, "This document contains "<<revisions.size()<<" revisions.");
@@ -899,14 +923,10 @@ using namespace debug;
 
 	kernelPrintDbg(DBG_DBG, "");
 
+	// content is copied as it is so an encrypted document stays encrypted
+	// with the same Encrypt dictionary
 	check_need_credentials(this);
 
-	if(isEncrypted())
-	{
-		kernelPrintDbg(debug::DBG_WARN, "Operation is not supported for encrypted documents");
-		throw NotImplementedException("cloneRevision");
-	}
-
 	StreamWriter * streamWriter=dynamic_cast<StreamWriter *>(str);
 	size_t pos=streamWriter->getPos();
 
@@ -42,6 +42,7 @@ namespace pdfobjects
 class CPdf;
 struct IndiRef;
 class XRefWriter;
+class LoadProgress;
 
 namespace utils {
 class IPdfWriter;
@@ -228,8 +229,14 @@ protected:
 	 * to revisions storage as later revision and continues same way.
 	 * <br>
 	 * Sets revision field to the most recent one as a side effect.
+	 * <br>
+	 * If progress is given, each found revision is reported as a step of
+	 * LoadProgress::RevisionsStage.
+	 *
+	 * @param progress Loading progress (may be NULL).
+	 * @throw LoadCanceledException if progress has been canceled.
 	 */
-	void collectRevisions();
+	void collectRevisions(LoadProgress * progress=NULL);
 
 	/** Returns end of current revision offset. 
 	 * @param xrefStart Stream offset of xref section start.
@@ -253,6 +260,8 @@ public:
 	 * @param stream File stream with pdf content.
 	 * @param _pdf Pdf instance which maintains this instance (may be also NULL,
 	 * which means that instance is standalone).
+	 * @param progress Loading progress for revisions collecting (may be
+	 * NULL).
 	 *
 	 * Sets mode to paranoid. Sets file to FILE handle from stream. Collects 
 	 * all revisions (uses collectRevisions method) and sets storePos to the 
@@ -264,8 +273,9 @@ public:
 	 *
 	 * @throw MalformedFormatExeption if XRef creation fails (instance is
 	 * unusable in such situation).
+	 * @throw LoadCanceledException if progress has been canceled.
 	 */
-	XRefWriter(StreamWriter * stream, CPdf * _pdf);
+	XRefWriter(StreamWriter * stream, CPdf * _pdf, LoadProgress * progress=NULL);
 
 	/** Destrucrtor.
 	 *
@@ -454,7 +464,7 @@ public:
 	 * @param file File handle where to copy content.
 	 * 
 	 * Clone contains everything from stream starting from 0 position until 
-	 * getRevisionEnd.
+	 * getRevisionEnd. Encrypted document is cloned with its encryption.
 	 *
 	 * @see XRefWriter::getRevisionEnd for limitations.
 	 */
@@ -41,6 +41,8 @@
 
 using namespace QS;
 
+uint QSClass::memberGeneration = 0;
+
 QSClass::QSClass( QSEnv *e, int a )
     : en( e ),
       bclass( 0 ),
@@ -63,6 +65,7 @@ QSClass::QSClass( QSClass *b, int a )
 
 QSClass::~QSClass()
 {
+    ++memberGeneration;
 }
 
 void QSClass::clear()
@@ -77,11 +80,13 @@ void QSClass::clear()
     delete mmap;
     mmap = 0;
     staticMembers.clear();
+    ++memberGeneration;
 }
 
 
 void QSClass::init()
 {
+    ++memberGeneration;
     mmap = new QSMemberMap();
     numVars = base() ? base()->numVariables() : 0;
     numStaticVars = 0;
@@ -356,6 +361,29 @@ bool QSClass::deleteProperty( QSObject *, const QSMember & ) const
     return FALSE;
 }
 
+/*!
+  Returns TRUE if members of objects of this class are found in the
+  member maps of the class and its base classes only, i.e. the lookup
+  result does not depend on the object. Such lookups may be cached as
+  long as generation() stays the same.
+*/
+bool QSClass::hasStaticLookup() const
+{
+    for ( const QSClass *cl = this; cl; cl = cl->base() ) {
+	if ( cl->hasInstanceMembers() )
+	    return FALSE;
+    }
+    return TRUE;
+}
+
+/*!
+  \fn uint QSClass::generation()
+
+  Returns a counter which changes whenever a class is created, destroyed
+  or its members change. Cached member lookups are valid only as long
+  as the counter stays the same.
+*/
+
 /*!
   Retrieves a pointer to the class member \a n; 0 if no such member exists.
 */
@@ -647,6 +675,7 @@ void QSClass::addMember( const QString &n, const QSMember &member, const QSObjec
         break;
     }
     mmap->insert( n, m );
+    ++memberGeneration;
 }
 
 /* Factored out from replace member */
@@ -746,6 +775,7 @@ void QSClass::replaceMember( const QString &name, QSMember *member,
     }
 
     mmap->replace( name, m );
+    ++memberGeneration;
 }
 
 /*!
@@ -758,6 +788,7 @@ bool QSClass::deleteMember( const QString &name ) {
     }
     // ### What do we do about variable indexes??
     mmap->remove( name );
+    ++memberGeneration;
     return TRUE;
 }
 
@@ -60,7 +60,7 @@ public:
 
     QSEnv *env() const { return en; }
     QSClass *base() const { return bclass; }
-    void setBase(QSClass *base) { bclass = base; }
+    void setBase(QSClass *base) { bclass = base; ++memberGeneration; }
     virtual QString name() const = 0;
     virtual QString identifier() const { return name(); }
     QSClassClass *asClass() const;
@@ -95,6 +95,9 @@ public:
     virtual bool deleteProperty( QSObject *obj, const QSMember &mem ) const;
     virtual bool member( const QSObject *o, const QString &n,
 			 QSMember *m ) const;
+    virtual bool hasInstanceMembers() const { return FALSE; }
+    bool hasStaticLookup() const;
+    static uint generation() { return memberGeneration; }
     virtual QSObject fetchValue( const QSObject *objPtr,
 				 const QSMember &mem ) const;
     virtual void write( QSObject *objPtr, const QSMember &mem,
@@ -162,6 +165,7 @@ private:
     QValueList<int> replacedVars;
     int numVars;
     int numStaticVars;
+    static uint memberGeneration;
 };
 
 /*! Object class. Has no parents and is the base for Number etc.
@@ -394,6 +398,7 @@ public:
     void mark( QSObject *o ) const;
     virtual bool member( const QSObject *o, const QString &n,
 			 QSMember *m ) const;
+    virtual bool hasInstanceMembers() const { return TRUE; }
     virtual QSObject fetchValue( const QSObject *objPtr,
 				 const QSMember &mem ) const;
     virtual void write( QSObject *objPtr, const QSMember &mem,
@@ -475,6 +480,7 @@ public:
 
     virtual bool member( const QSObject *o, const QString &n,
 			 QSMember *m ) const;
+    virtual bool hasInstanceMembers() const { return TRUE; }
     virtual QSMemberMap members( const QSObject *obj ) const;
     QSMemberMap allMembers( const QSObject *obj ) const;
 
@@ -458,13 +458,39 @@ QSObject QSAccessorNode1::rhs( QSEnv *env ) const
     return env->throwError( QString::fromLatin1("Trying to access undefined member '%1'").arg(s) );
 }
 
+/*!
+  Looks up member \a ident of \a v. The result is remembered together
+  with the type of \a v, so the next evaluation of this node on an object
+  of the same type skips the lookup. Only lookups which do not depend on
+  the object itself are remembered (see QSClass::hasStaticLookup()) and
+  the remembered result is dropped whenever any class changes.
+*/
+const QSClass *QSAccessorNode2::resolve( const QSObject &v, QSMember *mem ) const
+{
+    const QSClass *type = v.objectType();
+    if ( type && type == cacheType && cacheGeneration == QSClass::generation() ) {
+	*mem = cacheMember;
+	return cacheClass;
+    }
+    int offset = 0;
+    const QSClass *cl = v.resolveMember( ident, mem, type, &offset );
+    Q_ASSERT( !offset );
+    if ( cl && type && mem->isDefined() && type->hasStaticLookup() ) {
+	cacheType = type;
+	cacheClass = cl;
+	cacheMember = *mem;
+	cacheGeneration = QSClass::generation();
+    } else {
+	cacheType = 0;
+    }
+    return cl;
+}
+
 QSReference QSAccessorNode2::lhs( QSEnv *env )
 {
     QSObject v = expr->rhs( env );
     QSMember mem;
-    int offset = 0;
-    const QSClass *cl = v.resolveMember( ident, &mem, v.objectType(), &offset );
-    Q_ASSERT( !offset );
+    const QSClass *cl = resolve( v, &mem );
     if ( !mem.isDefined() ) {
 	mem.setWritable( FALSE );
         QSReference ref(v, mem, cl);
@@ -478,9 +504,7 @@ QSObject QSAccessorNode2::rhs( QSEnv *env ) const
 {
     QSObject v = expr->rhs( env );
     QSMember mem;
-    int offset = 0;
-    const QSClass *cl = v.resolveMember( ident, &mem, v.objectType(), &offset );
-    Q_ASSERT( !offset );
+    const QSClass *cl = resolve( v, &mem );
     if ( cl && mem.isDefined() ) {
 	QSObject obj = cl->fetchValue( &v, mem );
 	if (obj.isUndefined() && mem.type() == QSMember::Identifier)
@@ -313,15 +313,22 @@ private:
 
 class QSAccessorNode2 : public QSNode {
 public:
-    QSAccessorNode2( QSNode *e, const QString *s) : expr( e ), ident( *s ) { }
+    QSAccessorNode2( QSNode *e, const QString *s)
+	: expr( e ), ident( *s ), cacheType( 0 ), cacheClass( 0 ), cacheGeneration( 0 ) { }
     QSReference lhs( QSEnv * );
     QSObject rhs( QSEnv * ) const;
     virtual void check( QSCheckData * );
     bool deref();
     void ref();
 private:
+    const QSClass *resolve( const QSObject &v, QSMember *mem ) const;
     QSNode *expr;
     QString ident;
+    // Inline cache of the last lookup, see resolve()
+    mutable const QSClass *cacheType;
+    mutable const QSClass *cacheClass;
+    mutable QSMember cacheMember;
+    mutable uint cacheGeneration;
 };
 
 class QSArgumentListNode : public QSNode {
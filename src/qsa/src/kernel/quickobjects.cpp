@@ -734,6 +734,17 @@ bool QSWrapperClass::member( const QSObject *objPtr, const QString &p,
     if ( objects.isEmpty() )
         return QSWritableClass::member( objPtr, p, mem );
 
+    // Property and slot names depend only on the class of the object, so a
+    // new wrapper takes them from the wrappers of the same class. Child
+    // objects and unknown names are still searched per object.
+    if ( objects.count() == 1 && objects[ 0 ] && !sh->hasPropCache.contains( p ) ) {
+        const QMap<QString, QSOT::QuickScriptObjectType> &kinds =
+            metaMemberCache[ objects[ 0 ]->metaObject() ];
+        QMap<QString, QSOT::QuickScriptObjectType>::ConstIterator kit = kinds.find( p );
+        if ( kit != kinds.end() )
+            sh->hasPropCache.replace( p, *kit );
+    }
+
     QString key;
     // cache lookup
     QMap<QString, QSOT::QuickScriptObjectType>::ConstIterator it2
@@ -880,6 +891,8 @@ bool QSWrapperClass::member( const QSObject *objPtr, const QString &p,
             if ( !mp->writable() )
                 mem->setWritable( FALSE );
             sh->hasPropCache.replace( p, QSOT::Property );
+            if ( objects.count() == 1 )
+                metaMemberCache[ meta ].replace( p, QSOT::Property );
             QVariant v;
             o->qt_property( mp->id(), 1, &v );
             if ( mp->isEnumType() ) {
@@ -910,6 +923,8 @@ bool QSWrapperClass::member( const QSObject *objPtr, const QString &p,
             sh->propertyCache.
                 replace( key, QuickScriptProperty( QSOT::Slot, func, i ) );
             sh->hasPropCache.replace( p, QSOT::Slot );
+            if ( objects.count() == 1 )
+                metaMemberCache[ meta ].replace( p, QSOT::Slot );
             return TRUE;
         }
 
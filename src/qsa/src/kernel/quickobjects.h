@@ -251,6 +251,8 @@ protected:
     virtual QSObject invoke( QSObject *objPtr, const QSMember &mem ) const;
 
 private:
+    // Kinds of members found for each meta object, shared by all wrappers
+    mutable QMap<const QMetaObject*, QMap<QString, QSOT::QuickScriptObjectType> > metaMemberCache;
 };
 
 class QUICKCORE_EXPORT QSPointerClass : public QSWrapperClass {
@@ -314,6 +316,7 @@ public:
     QSObject construct( const QSList &args ) const;
     QSObject cast( const QSList &args ) const;
     bool member( const QSObject *objPtr, const QString &name, QSMember *m ) const;
+    bool hasInstanceMembers() const { return TRUE; }
     QSObject fetchValue( const QSObject *o, const QSMember &mem ) const;
 
     QSFactoryObjectProxy *proxy() const { return m_proxy; }
@@ -339,6 +342,8 @@ public:
 				 const QSMember &mem ) const;
     virtual void write( QSObject *objPtr, const QSMember &mem,
 			const QSObject &val ) const;
+    // members are taken from the wrapped value, which differs per object
+    virtual bool hasInstanceMembers() const { return TRUE; }
 
     bool toBoolean( const QSObject * ) const;
     double toNumber( const QSObject * ) const;
@@ -6,7 +6,8 @@ usage()
 	echo
 	echo "where"
 	echo -e "\tresult_name - name of results to filter out (grep like)"
-	echo -e "\tfield_name - either number of the field or max, min, avg, count"
+	echo -e "\tfield_name - either number of the field or max, min, avg, count,"
+	echo -e "\t\tmedian, p95, p99, allocs"
 	echo 
 	echo "At least one file is expected. If the file is - then reads from standard input"
 }
@@ -40,6 +41,10 @@ case $WHAT in
 	3|min ) WHAT=3 ;;
 	4|avg ) WHAT=4 ;;
 	5|count) WHAT=5 ;;
+	6|median) WHAT=6 ;;
+	7|p95) WHAT=7 ;;
+	8|p99) WHAT=8 ;;
+	9|allocs) WHAT=9 ;;
 	* ) echo "Bad value for field" >&2; exit 1 ;;
 esac
 
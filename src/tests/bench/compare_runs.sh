@@ -0,0 +1,102 @@
+#!/bin/sh
+
+usage()
+{
+	echo "`basename $0` old new [threshold]"
+	echo
+	echo "where"
+	echo -e "\told, new - JSON results (benchmark -j output) or directories with"
+	echo -e "\t\t*.json results (e.g. created by tools/bench.sh), files with the"
+	echo -e "\t\tsame name are compared"
+	echo -e "\tthreshold - allowed slow down of the median time and growth of"
+	echo -e "\t\tallocations in percents (10 by default)"
+	echo
+	echo "A time regression is reported only if the new samples are slower than"
+	echo "the old ones according to the one sided Mann-Whitney rank test (z score"
+	echo "above MAX_Z, 2.33 by default, i.e. 1% false alarms) and the median slow"
+	echo "down is above the threshold and MIN_DELTA milliseconds (0.01 by default)."
+	echo "The test needs at least 5 samples (measured rounds) of both runs to find"
+	echo "anything, results with fewer samples are marked as such."
+	echo "Exit status is 1 if a regression has been found."
+	exit 2
+}
+
+# prints name, median, allocs and comma separated samples of each result
+# from the given JSON output
+extract()
+{
+	sed -n 's/^{"name": "\([^"]*\)", "count": [1-9].*"median": \([^,]*\),.*"allocs": \([^,]*\), "samples": \[\([^]]*\)\]}.*/\1 \2 \3 \4/p' "$1" \
+		| sed 's/, /,/g'
+}
+
+# compares two JSON outputs and prints regressions
+compare()
+{
+	extract "$1" > "$TMP.old"
+	extract "$2" > "$TMP.new"
+	awk -v label="`basename "$2"`" -v threshold="$THRESHOLD" \
+			-v min_delta="$MIN_DELTA" -v max_z="$MAX_Z" '
+		FNR == NR { median[$1] = $2; allocs[$1] = $3; samples[$1] = $4; next }
+		!($1 in median) { next }
+		{
+			# Mann-Whitney U of new samples being slower than the old ones
+			# (ties count one half) and its normal approximation
+			m = split(samples[$1], old, ",")
+			n = split($4, new, ",")
+			u = 0
+			for (i = 1; i <= n; i++)
+				for (j = 1; j <= m; j++)
+					u += new[i] > old[j] ? 1 : (new[i] == old[j] ? 0.5 : 0)
+			z = (u - n * m / 2) / sqrt(n * m * (n + m + 1) / 12)
+
+			status = "ok"
+			if (z > max_z && $2 - median[$1] > min_delta && $2 > median[$1] * (1 + threshold / 100))
+				status = "REGRESSION(time)"
+			else if ($3 > allocs[$1] * (1 + threshold / 100) && $3 - allocs[$1] >= 1)
+				status = "REGRESSION(allocs)"
+			else if (n < 5 || m < 5)
+				status = "ok(too few samples)"
+			change = median[$1] > 0 ? ($2 - median[$1]) * 100 / median[$1] : 0
+			printf "%s:%s:median=%g->%g(%+.1f%%):z=%.2f:allocs=%g->%g:%s\n", \
+				label, $1, median[$1], $2, change, z, allocs[$1], $3, status
+			if (status ~ /^REGRESSION/)
+				regressions++
+		}
+		END { exit regressions ? 1 : 0 }
+	' "$TMP.old" "$TMP.new" || FOUND=1
+}
+
+if [ $# -lt 2 ]
+then
+	usage
+fi
+
+OLD="$1"
+NEW="$2"
+THRESHOLD=${3:-10}
+MIN_DELTA=${MIN_DELTA:-0.01}
+MAX_Z=${MAX_Z:-2.33}
+TMP=`mktemp` || exit 2
+FOUND=0
+
+if [ -d "$OLD" ] && [ -d "$NEW" ]
+then
+	for f in "$OLD"/*.json
+	do
+		n="$NEW/`basename "$f"`"
+		if [ ! -f "$n" ]
+		then
+			echo "`basename "$f"`: missing in $NEW - skipping" >&2
+			continue
+		fi
+		compare "$f" "$n"
+	done
+elif [ -f "$OLD" ] && [ -f "$NEW" ]
+then
+	compare "$OLD" "$NEW"
+else
+	usage
+fi
+
+rm -f "$TMP" "$TMP.old" "$TMP.new"
+exit $FOUND
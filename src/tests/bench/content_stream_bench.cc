@@ -41,7 +41,7 @@ void bench_get_ccstreams(shared_ptr<CPdf> pdf, struct result *results, int start
 		page->getContentStreams(cs);
 		get_time_stamp(&end);
 		if (results)
-			update_result(time_diff(start, end), *results);
+			update_result(start, end, *results);
 	}
 }
 
@@ -89,7 +89,7 @@ void bench_addTextToStream(shared_ptr<CPdf> pdf, const std::string &fontName, st
 		addText(page, 10, 10, fontId, text);
 		get_time_stamp(&end);
 		if (results)
-			update_result(time_diff(start, end), *results);
+			update_result(start, end, *results);
 	}
 }
 
@@ -101,49 +101,55 @@ int main(int argc, char ** argv)
 	if((ret = init_bench(argc, argv)))
 		return ret;
 
-	time_stamp_t start, end;
-	shared_ptr<CPdf> pdf;
-
-	pdf = open_file(file_name);
-
 	DEFINE_RESULTS(getCStreams_first, "getCStreams_first");
-	int pageCount = pdf->getPageCount();
-	bench_get_ccstreams(pdf, &getCStreams_first, 1, pageCount);
 	DEFINE_RESULTS(getCStreams_again, "getCStreams_again");
-	bench_get_ccstreams(pdf, &getCStreams_again, 1, pageCount);
-
-	// add text on the clean pdf
-	pdf = open_file(file_name);
 	DEFINE_RESULTS(addTextToStream1, "addToStream1");
-	bench_addTextToStream(pdf, fontName, &addTextToStream1, 1, 1);
-
-	pdf = open_file(file_name);
 	DEFINE_RESULTS(addTextToStream10, "addToStream10");
-	bench_addTextToStream(pdf, fontName, &addTextToStream10, 1, 10);
-
-	pdf = open_file(file_name);
 	DEFINE_RESULTS(addTextToStream100, "addToStream100");
-	bench_addTextToStream(pdf, fontName, &addTextToStream100, 1, 100);
-
-	pdf = open_file(file_name);
 	DEFINE_RESULTS(addTextToStream1000, "addToStream1000");
-	bench_addTextToStream(pdf, fontName, &addTextToStream1000, 1, 1000);
-
-	// make changes cumulative
-	pdf = open_file(file_name);
 	DEFINE_RESULTS(addTextToStream1cumulative, "addToStream1cumulative");
-	bench_addTextToStream(pdf, fontName, &addTextToStream1cumulative, 1, 1);
-
 	DEFINE_RESULTS(addTextToStream10cumulative, "addToStream10cumulative");
-	bench_addTextToStream(pdf, fontName, &addTextToStream10cumulative, 1, 10);
-
 	DEFINE_RESULTS(addTextToStream100cumulative, "addToStream100cumulative");
-	bench_addTextToStream(pdf, fontName, &addTextToStream100cumulative, 1, 100);
-
 	DEFINE_RESULTS(addTextToStream1000cumulative, "addToStream1000cumulative");
-	bench_addTextToStream(pdf, fontName, &addTextToStream1000cumulative, 1, 1000);
 
-	pdf.reset();
+	for(int round = 0; round < bench_round_count(); ++round)
+	{
+		bench_start_round(round);
+		time_stamp_t start, end;
+		shared_ptr<CPdf> pdf;
+
+		pdf = open_file(file_name);
+
+		int pageCount = pdf->getPageCount();
+		bench_get_ccstreams(pdf, &getCStreams_first, 1, pageCount);
+		bench_get_ccstreams(pdf, &getCStreams_again, 1, pageCount);
+
+		// add text on the clean pdf
+		pdf = open_file(file_name);
+		bench_addTextToStream(pdf, fontName, &addTextToStream1, 1, 1);
+
+		pdf = open_file(file_name);
+		bench_addTextToStream(pdf, fontName, &addTextToStream10, 1, 10);
+
+		pdf = open_file(file_name);
+		bench_addTextToStream(pdf, fontName, &addTextToStream100, 1, 100);
+
+		pdf = open_file(file_name);
+		bench_addTextToStream(pdf, fontName, &addTextToStream1000, 1, 1000);
+
+		// make changes cumulative
+		pdf = open_file(file_name);
+		bench_addTextToStream(pdf, fontName, &addTextToStream1cumulative, 1, 1);
+
+		bench_addTextToStream(pdf, fontName, &addTextToStream10cumulative, 1, 10);
+
+		bench_addTextToStream(pdf, fontName, &addTextToStream100cumulative, 1, 100);
+
+		bench_addTextToStream(pdf, fontName, &addTextToStream1000cumulative, 1, 1000);
+
+		pdf.reset();
+	}
+
 	struct result *all_results [] = {
 		&getCStreams_first,
 		&getCStreams_again,
@@ -159,7 +165,6 @@ int main(int argc, char ** argv)
 	};
 
 	print_results(stdout, all_results);
-	fprintf(stdout, "\n---\n");
-	gMemReport(stdout);
+	print_memory_report(stdout);
 	return 0;
 }
@@ -0,0 +1,428 @@
+/*
+ * PDFedit - free program for PDF document manipulation.
+ * Copyright (C) 2006-2009  PDFedit team: Michal Hocko,
+ *                                        Jozef Misutka,
+ *                                        Martin Petricek
+ *                   Former team members: Miroslav Jahoda
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program (in doc/LICENSE.GPL); if not, write to the 
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, 
+ * MA  02111-1307  USA
+ *
+ * Project is hosted on http://sourceforge.net/projects/pdfedit
+ */
+#include <kernel/cpdf.h>
+#include <kernel/cpage.h>
+#include <kernel/flattener.h>
+#include "utils.h"
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace boost;
+using namespace pdfobjects;
+using namespace pdfobjects::utils;
+using namespace std;
+
+// Throughput of a whole corpus. Each document is processed by its own
+// worker process (at most -p of them run at the same time), so that
+// damaged documents which crash or hang don't affect the others. Failed
+// documents are reported but not included in stage times and throughput
+// (which is computed from the time workers of successful documents ran,
+// so a document waiting for its timeout doesn't lower it).
+
+enum stage
+{
+	STAGE_OPEN,
+	STAGE_PAGE_COUNT,
+	STAGE_PARSE,
+	STAGE_TEXT,
+	STAGE_FLATTEN,
+	STAGE_COUNT
+};
+
+const char * stage_names[STAGE_COUNT] = {
+	"open",
+	"page_count",
+	"parse",
+	"text",
+	"flatten"
+};
+
+enum doc_status
+{
+	DOC_OK,
+	DOC_FAILED,		// exception
+	DOC_CRASHED,	// worker died or didn't report
+	DOC_TIMEOUT,
+	DOC_STATUS_COUNT
+};
+
+const char * status_names[DOC_STATUS_COUNT] = {
+	"ok",
+	"failed",
+	"crashed",
+	"timeout"
+};
+
+// record sent by the worker process (smaller than PIPE_BUF, so it is
+// written atomically)
+struct doc_record
+{
+	int status;
+	unsigned long pages;
+	double times[STAGE_COUNT];
+	unsigned long allocs[STAGE_COUNT];
+};
+
+// upper bounds of histogram buckets in milliseconds (the last one is
+// unbounded)
+const double bucket_bounds[] = {0.1, 0.3, 1, 3, 10, 30, 100, 300, 1000, 3000};
+const size_t bucket_count = sizeof(bucket_bounds)/sizeof(*bucket_bounds) + 1;
+
+// finishes stage which started at start and starts the next one
+void end_stage(doc_record & rec, stage s, time_stamp_t & start)
+{
+	time_stamp_t end;
+	get_time_stamp(&end);
+	rec.times[s] = time_diff(start, end);
+	rec.allocs[s] = end.allocs - start.allocs;
+	start = end;
+}
+
+// all stages of one document, runs in the worker process
+void process_doc(const char * name, doc_record & rec)
+{
+	time_stamp_t start;
+	get_time_stamp(&start);
+	shared_ptr<CPdf> pdf = open_file(name, CPdf::ReadOnly);
+	// documents encrypted without user password are processed as well
+	if(pdf->needsCredentials())
+		pdf->setCredentials(NULL, NULL);
+	end_stage(rec, STAGE_OPEN, start);
+
+	rec.pages = pdf->getPageCount();
+	end_stage(rec, STAGE_PAGE_COUNT, start);
+
+	vector<shared_ptr<CPage> > pages;
+	for(size_t p = 1; p <= rec.pages; ++p)
+	{
+		pages.push_back(pdf->getPage(p));
+		vector<shared_ptr<CContentStream> > streams;
+		pages.back()->getContentStreams(streams);
+	}
+	end_stage(rec, STAGE_PARSE, start);
+
+	for(size_t p = 0; p < pages.size(); ++p)
+	{
+		string text;
+		pages[p]->getText(text);
+	}
+	end_stage(rec, STAGE_TEXT, start);
+	pages.clear();
+	pdf.reset();
+	get_time_stamp(&start);
+
+	shared_ptr<Flattener> flattener = Flattener::getInstance(name, new OldStylePdfWriter());
+	if(flattener->getNeedCredentials())
+		flattener->setCredentials(NULL, NULL);
+	FILE * out = tmpfile();
+	if(!out)
+		throw std::exception();
+	int err = flattener->flatten(out);
+	fclose(out);
+	if(err)
+		throw std::exception();
+	end_stage(rec, STAGE_FLATTEN, start);
+}
+
+// forks worker for the document, returns pid or -1
+pid_t start_worker(const char * name, unsigned timeout, int & fd)
+{
+	int fds[2];
+	if(pipe(fds))
+	{
+		perror("pipe");
+		return -1;
+	}
+	pid_t pid = fork();
+	if(pid)
+	{
+		close(fds[1]);
+		if(pid < 0)
+		{
+			perror("fork");
+			close(fds[0]);
+			return -1;
+		}
+		fd = fds[0];
+		return pid;
+	}
+
+	// worker
+	close(fds[0]);
+	alarm(timeout);
+	doc_record rec;
+	memset(&rec, 0, sizeof(rec));
+	try
+	{
+		process_doc(name, rec);
+		rec.status = DOC_OK;
+	}catch(...)
+	{
+		rec.status = DOC_FAILED;
+	}
+	ssize_t written = write(fds[1], &rec, sizeof(rec));
+	// skips destructors and atexit handlers of the master
+	_exit(written == sizeof(rec) ? 0 : 1);
+}
+
+// reads record of finished worker
+void finish_worker(int fd, int status, doc_record & rec)
+{
+	ssize_t len = read(fd, &rec, sizeof(rec));
+	close(fd);
+	if(WIFSIGNALED(status) && WTERMSIG(status) == SIGALRM)
+	{
+		rec.status = DOC_TIMEOUT;
+		return;
+	}
+	if(len != sizeof(rec) || !WIFEXITED(status) || WEXITSTATUS(status))
+		rec.status = DOC_CRASHED;
+}
+
+unsigned long file_size(const string & name)
+{
+	struct stat st;
+	return stat(name.c_str(), &st) ? 0 : st.st_size;
+}
+
+// corpus totals of measured rounds
+struct corpus_stats
+{
+	unsigned long docs[DOC_STATUS_COUNT];
+	unsigned long pages;
+	double bytes;
+	double busy_time;	// sum of worker times of successful documents
+	vector<unsigned long> histograms[STAGE_COUNT];
+};
+
+void add_record(const string & name, const doc_record & rec, double elapsed,
+		struct result * results, corpus_stats & stats)
+{
+	if(!bench_measuring())
+		return;
+	++stats.docs[rec.status];
+	if(rec.status != DOC_OK)
+	{
+		fprintf(stderr, "%s: %s\n", name.c_str(), status_names[rec.status]);
+		return;
+	}
+	stats.pages += rec.pages;
+	stats.bytes += file_size(name);
+	stats.busy_time += elapsed;
+	for(int s = 0; s < STAGE_COUNT; ++s)
+	{
+		update_result(rec.times[s], results[s]);
+		results[s].allocs += rec.allocs[s];
+		size_t b = 0;
+		while(b < bucket_count - 1 && rec.times[s] > bucket_bounds[b])
+			++b;
+		++stats.histograms[s][b];
+	}
+}
+
+// running worker process
+struct worker
+{
+	size_t file;		// index of the document
+	int fd;				// pipe with the doc_record
+	time_stamp_t start;
+};
+
+// processes all files with at most processes workers at a time
+void run_corpus(const vector<string> & files, unsigned processes, unsigned timeout,
+		struct result * results, corpus_stats & stats)
+{
+	// running workers by pid
+	typedef map<pid_t, worker> workers_t;
+	workers_t workers;
+	size_t next = 0;
+	while(next < files.size() || !workers.empty())
+	{
+		while(next < files.size() && workers.size() < processes)
+		{
+			worker w;
+			w.file = next;
+			get_time_stamp(&w.start);
+			pid_t pid = start_worker(files[next].c_str(), timeout, w.fd);
+			if(pid < 0)
+			{
+				if(workers.empty())
+				{
+					// nothing will finish to make room for this one
+					doc_record rec;
+					memset(&rec, 0, sizeof(rec));
+					rec.status = DOC_CRASHED;
+					add_record(files[next++], rec, 0, results, stats);
+					continue;
+				}
+				break;
+			}
+			workers[pid] = w;
+			++next;
+		}
+		if(workers.empty())
+			continue;
+
+		int status;
+		pid_t pid = waitpid(-1, &status, 0);
+		time_stamp_t end;
+		get_time_stamp(&end);
+		workers_t::iterator it = workers.find(pid);
+		if(it == workers.end())
+			continue;
+		doc_record rec;
+		memset(&rec, 0, sizeof(rec));
+		finish_worker(it->second.fd, status, rec);
+		add_record(files[it->second.file], rec, time_diff(it->second.start, end), 
+				results, stats);
+		workers.erase(it);
+	}
+}
+
+// maximum resident set size of a worker - the master does no real work
+long max_worker_rss_kb()
+{
+	struct rusage usage;
+	if(getrusage(RUSAGE_CHILDREN, &usage))
+		return -1;
+	return usage.ru_maxrss;
+}
+
+void print_corpus(FILE * out, size_t files, unsigned processes, const corpus_stats & stats)
+{
+	// workers run in parallel, unless there are fewer documents
+	unsigned long parallel = min((unsigned long)processes, stats.docs[DOC_OK]);
+	double seconds = parallel ? stats.busy_time / 1000 / parallel : 0;
+	double docs_per_sec = seconds > 0 ? stats.docs[DOC_OK] / seconds : 0;
+	double pages_per_sec = seconds > 0 ? stats.pages / seconds : 0;
+	double bytes_per_sec = seconds > 0 ? stats.bytes / seconds : 0;
+	if(bench_json_output())
+	{
+		fprintf(out, "{\"corpus\": {\"files\": %lu, \"processes\": %u", 
+				(unsigned long)files, processes);
+		for(int s = 0; s < DOC_STATUS_COUNT; ++s)
+			fprintf(out, ", \"%s\": %lu", status_names[s], stats.docs[s]);
+		fprintf(out, ", \"docs_per_sec\": %g, \"pages_per_sec\": %g, \"bytes_per_sec\": %g, "
+				"\"max_worker_rss_kb\": %ld}, \"histogram_bounds_ms\": [", 
+				docs_per_sec, pages_per_sec, bytes_per_sec, max_worker_rss_kb());
+		for(size_t b = 0; b < bucket_count - 1; ++b)
+			fprintf(out, "%s%g", b ? ", " : "", bucket_bounds[b]);
+		fprintf(out, "], \"histograms\": {");
+		for(int s = 0; s < STAGE_COUNT; ++s)
+		{
+			fprintf(out, "%s\"%s\": [", s ? ", " : "", stage_names[s]);
+			for(size_t b = 0; b < bucket_count; ++b)
+				fprintf(out, "%s%lu", b ? ", " : "", stats.histograms[s][b]);
+			fprintf(out, "]");
+		}
+		fprintf(out, "}}\n");
+		return;
+	}
+
+	fprintf(out, "corpus:files=%lu:processes=%u", (unsigned long)files, processes);
+	for(int s = 0; s < DOC_STATUS_COUNT; ++s)
+		fprintf(out, ":%s=%lu", status_names[s], stats.docs[s]);
+	fprintf(out, ":max_worker_rss_kb=%ld", max_worker_rss_kb());
+	fprintf(out, "\nthroughput:docs_per_sec=%g:pages_per_sec=%g:bytes_per_sec=%g\n",
+			docs_per_sec, pages_per_sec, bytes_per_sec);
+	for(int s = 0; s < STAGE_COUNT; ++s)
+	{
+		fprintf(out, "histogram:%s", stage_names[s]);
+		for(size_t b = 0; b < bucket_count; ++b)
+		{
+			if(b < bucket_count - 1)
+				fprintf(out, ":<=%gms=%lu", bucket_bounds[b], stats.histograms[s][b]);
+			else
+				fprintf(out, ":more=%lu", stats.histograms[s][b]);
+		}
+		fprintf(out, "\n");
+	}
+}
+
+int main(int argc, char ** argv)
+{
+	int ret;
+
+	// -p processes and -t timeout (seconds per document) are not common 
+	// benchmark options, so they are removed before init_bench parses the rest
+	unsigned processes = 1;
+	unsigned timeout = 60;
+	int args = 1;
+	for(int i = 1; i < argc; ++i)
+	{
+		if(!strcmp(argv[i], "-p") && i + 1 < argc)
+			processes = atoi(argv[++i]);
+		else if(!strcmp(argv[i], "-t") && i + 1 < argc)
+			timeout = atoi(argv[++i]);
+		else
+			argv[args++] = argv[i];
+	}
+	argc = args;
+	if(!processes)
+	{
+		fprintf(stderr, "Bad usage. At least one process expected\n");
+		return 1;
+	}
+	if((ret = init_bench(argc, argv)))
+		return ret;
+
+	vector<string> files;
+	for(int i = optind; i < argc; ++i)
+		add_input_files(argv[i], files);
+
+	struct result results[STAGE_COUNT];
+	for(int s = 0; s < STAGE_COUNT; ++s)
+		results[s] = result(stage_names[s]);
+	corpus_stats stats;
+	memset(stats.docs, 0, sizeof(stats.docs));
+	stats.pages = 0;
+	stats.bytes = 0;
+	stats.busy_time = 0;
+	for(int s = 0; s < STAGE_COUNT; ++s)
+		stats.histograms[s].resize(bucket_count);
+
+	for(int round = 0; round < bench_round_count(); ++round)
+	{
+		bench_start_round(round);
+		run_corpus(files, processes, timeout, results, stats);
+	}
+
+	struct result *all_results[STAGE_COUNT + 1];
+	for(int s = 0; s < STAGE_COUNT; ++s)
+		all_results[s] = &results[s];
+	all_results[STAGE_COUNT] = NULL;
+
+	print_results(stdout, all_results);
+	print_corpus(stdout, files.size(), processes, stats);
+	return 0;
+}
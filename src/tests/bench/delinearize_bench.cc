@@ -37,25 +37,30 @@ int main(int argc, char **argv)
 	if((ret = init_bench(argc, argv)))
 		return ret;
 
-	boost::shared_ptr<Delinearizator> delin = Delinearizator::getInstance(file_name, new OldStylePdfWriter());
-
-	// check for existing file and remove it
-	std::string output_file = file_name+std::string("-delinearized.pdf");
-	time_stamp_t start, end;
 	DEFINE_RESULTS(delinearize, "delinearize");
 
-	get_time_stamp(&start);
-	delin->delinearize(output_file.c_str());
-	get_time_stamp(&end);
-	update_result(time_diff(start, end), delinearize);
+	for(int round = 0; round < bench_round_count(); ++round)
+	{
+		bench_start_round(round);
+		boost::shared_ptr<Delinearizator> delin = Delinearizator::getInstance(file_name, new OldStylePdfWriter());
+
+		// check for existing file and remove it
+		std::string output_file = file_name+std::string("-delinearized.pdf");
+		time_stamp_t start, end;
+
+		get_time_stamp(&start);
+		delin->delinearize(output_file.c_str());
+		get_time_stamp(&end);
+		update_result(start, end, delinearize);
+	}
+
 	struct result *all_results [] = {
 		&delinearize,
 		NULL
 	};
 	print_results(stdout, all_results);
 
-	fprintf(stdout, "\n---\n");
-	gMemReport(stdout);
+	print_memory_report(stdout);
 	return 0;
 
 
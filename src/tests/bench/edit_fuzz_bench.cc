@@ -0,0 +1,516 @@
+/*
+ * PDFedit - free program for PDF document manipulation.
+ * Copyright (C) 2006-2009  PDFedit team: Michal Hocko,
+ *                                        Jozef Misutka,
+ *                                        Martin Petricek
+ *                   Former team members: Miroslav Jahoda
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program (in doc/LICENSE.GPL); if not, write to the 
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, 
+ * MA  02111-1307  USA
+ *
+ * Project is hosted on http://sourceforge.net/projects/pdfedit
+ */
+#include <kernel/cpdf.h>
+#include <kernel/cpage.h>
+#include <kernel/factories.h>
+#include "utils.h"
+#include <string>
+#include <vector>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+using namespace boost;
+using namespace pdfobjects;
+using namespace std;
+
+// Randomized editing workload. Every document (or all PDFs from a
+// directory) is copied to a temporary file and edited by a sequence of
+// random operations. The sequence depends only on the seed (-s) and the
+// document name, so a run can be repeated exactly. Each save/reopen cycle
+// and the end of the sequence verify that the saved document parses to the
+// same pages and operators as the edited one.
+
+enum operation
+{
+	OP_INSERT,
+	OP_DELETE,
+	OP_REPLACE,
+	OP_OPERAND,
+	OP_REPLACE_TEXT,
+	OP_PAGE_INSERT,
+	OP_PAGE_REMOVE,
+	OP_SAVE_REOPEN,
+	OP_COUNT
+};
+
+const char * op_names[OP_COUNT] = {
+	"insert_operator",
+	"delete_operator",
+	"replace_operator",
+	"operand_edit",
+	"replace_text",
+	"page_insert",
+	"page_remove",
+	"save_reopen"
+};
+
+// relative frequencies of operations
+const unsigned op_weights[OP_COUNT] = {20, 15, 15, 20, 10, 5, 5, 2};
+
+// xorshift generator - unlike rand() the sequence is the same everywhere
+class random_gen
+{
+	unsigned int state;
+public:
+	random_gen(unsigned int seed) : state(seed ? seed : 1) {}
+	unsigned int next()
+	{
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		return state;
+	}
+	// random number from [0, n)
+	size_t below(size_t n)
+	{
+		return n ? next() % n : 0;
+	}
+};
+
+struct fuzz_stats
+{
+	unsigned long done[OP_COUNT];
+	unsigned long skipped[OP_COUNT];
+	unsigned long errors;
+	unsigned long verify_failures;
+	unsigned long failed_docs;
+};
+
+// state of the document being edited
+struct fuzz_doc
+{
+	string name;		// original file
+	string tmp_name;	// edited copy
+	shared_ptr<CPdf> pdf;
+	shared_ptr<CPdf> source;	// pages are inserted from here
+	vector<size_t> source_pages;	// source pages not inserted yet
+	size_t max_pages;
+};
+
+// seed of the document - depends also on its name so that adding a file
+// doesn't change sequences of the others
+unsigned int doc_seed(unsigned int seed, const string & name)
+{
+	string::size_type slash = name.rfind('/');
+	unsigned int hash = 2166136261u;
+	for(size_t i = (slash == string::npos) ? 0 : slash + 1; i < name.size(); ++i)
+		hash = (hash ^ (unsigned char)name[i]) * 16777619u;
+	return hash ^ seed;
+}
+
+bool copy_file(const char * from, int to)
+{
+	FILE * in = fopen(from, "rb");
+	if(!in)
+		return false;
+	char buf[BUFSIZ];
+	size_t len;
+	bool ok = true;
+	while(ok && (len = fread(buf, 1, sizeof(buf), in)) > 0)
+		ok = write(to, buf, len) == (ssize_t)len;
+	fclose(in);
+	return ok;
+}
+
+// all operators of the content stream in the iterator order
+void collect_operators(shared_ptr<CContentStream> cs, vector<shared_ptr<PdfOperator> > & ops)
+{
+	ops.clear();
+	CContentStream::Operators top;
+	cs->getPdfOperators(top);
+	if(top.empty())
+		return;
+	PdfOperator::Iterator it = PdfOperator::getIterator(top.front());
+	for(; !it.isEnd(); it.next())
+		ops.push_back(it.getCurrent());
+}
+
+// closing operators of composites are changed only with the composite
+bool is_editable(shared_ptr<PdfOperator> op)
+{
+	string name;
+	op->getOperatorName(name);
+	return name != "Q" && name != "ET" && name != "EMC" && name != "EI" && name != "EX";
+}
+
+// picks a random editable operator of a random content stream of a random
+// page, returns false if there is none
+bool pick_operator(fuzz_doc & doc, random_gen & rnd, 
+		shared_ptr<CContentStream> & cs, shared_ptr<PdfOperator> & op)
+{
+	size_t pages = doc.pdf->getPageCount();
+	if(!pages)
+		return false;
+	shared_ptr<CPage> page = doc.pdf->getPage(1 + rnd.below(pages));
+	vector<shared_ptr<CContentStream> > streams;
+	page->getContentStreams(streams);
+	if(streams.empty())
+		return false;
+	cs = streams[rnd.below(streams.size())];
+	vector<shared_ptr<PdfOperator> > ops, editable;
+	collect_operators(cs, ops);
+	for(size_t i = 0; i < ops.size(); ++i)
+		if(is_editable(ops[i]))
+			editable.push_back(ops[i]);
+	if(editable.empty())
+		return false;
+	op = editable[rnd.below(editable.size())];
+	return true;
+}
+
+// number of operators on each page
+void get_operator_counts(shared_ptr<CPdf> pdf, vector<size_t> & counts)
+{
+	counts.clear();
+	size_t pages = pdf->getPageCount();
+	for(size_t p = 1; p <= pages; ++p)
+	{
+		vector<shared_ptr<CContentStream> > streams;
+		pdf->getPage(p)->getContentStreams(streams);
+		size_t count = 0;
+		for(size_t s = 0; s < streams.size(); ++s)
+		{
+			vector<shared_ptr<PdfOperator> > ops;
+			collect_operators(streams[s], ops);
+			count += ops.size();
+		}
+		counts.push_back(count);
+	}
+}
+
+// saves and reopens the document, returns false if the reopened document
+// differs from the saved one
+bool save_reopen(fuzz_doc & doc, struct result & res)
+{
+	vector<size_t> expected, found;
+	get_operator_counts(doc.pdf, expected);
+
+	time_stamp_t start, end;
+	get_time_stamp(&start);
+	doc.pdf->save();
+	doc.pdf.reset();
+	doc.pdf = open_file(doc.tmp_name.c_str());
+	get_time_stamp(&end);
+	update_result(start, end, res);
+
+	get_operator_counts(doc.pdf, found);
+	if(expected == found)
+		return true;
+	if(expected.size() != found.size())
+		fprintf(stderr, "%s: %lu pages saved, %lu found\n", doc.name.c_str(),
+				(unsigned long)expected.size(), (unsigned long)found.size());
+	for(size_t p = 0; p < expected.size() && p < found.size(); ++p)
+		if(expected[p] != found[p])
+			fprintf(stderr, "%s: page %lu: %lu operators saved, %lu found\n",
+					doc.name.c_str(), (unsigned long)p + 1,
+					(unsigned long)expected[p], (unsigned long)found[p]);
+	return false;
+}
+
+// line width operator used for insertions
+shared_ptr<PdfOperator> new_operator(random_gen & rnd)
+{
+	PdfOperator::Operands operands;
+	operands.push_back(shared_ptr<IProperty>(CRealFactory::getInstance(1 + rnd.below(10) / 4.0)));
+	return createOperator("w", operands);
+}
+
+// does one operation, returns false if it had nothing to work on
+bool do_operation(fuzz_doc & doc, operation op, random_gen & rnd, 
+		struct result * results, fuzz_stats & stats)
+{
+	time_stamp_t start, end;
+	shared_ptr<CContentStream> cs;
+	shared_ptr<PdfOperator> oper;
+	switch(op)
+	{
+		case OP_INSERT:
+		{
+			if(!pick_operator(doc, rnd, cs, oper))
+				return false;
+			shared_ptr<PdfOperator> newOper = new_operator(rnd);
+			get_time_stamp(&start);
+			cs->insertOperator(oper, newOper);
+			break;
+		}
+		case OP_DELETE:
+			if(!pick_operator(doc, rnd, cs, oper))
+				return false;
+			get_time_stamp(&start);
+			cs->deleteOperator(oper);
+			break;
+		case OP_REPLACE:
+		{
+			if(!pick_operator(doc, rnd, cs, oper))
+				return false;
+			get_time_stamp(&start);
+			cs->replaceOperator(oper, oper->clone());
+			break;
+		}
+		case OP_OPERAND:
+		{
+			if(!pick_operator(doc, rnd, cs, oper))
+				return false;
+			PdfOperator::Operands operands, numbers;
+			oper->getParameters(operands);
+			for(PdfOperator::Operands::iterator i = operands.begin(); i != operands.end(); ++i)
+				if(isReal(*i) || isInt(*i))
+					numbers.push_back(*i);
+			if(numbers.empty())
+				return false;
+			shared_ptr<IProperty> number = numbers[rnd.below(numbers.size())];
+			get_time_stamp(&start);
+			// integers are usually enumerations (line cap, rendering mode),
+			// so they get the same value which is still a change
+			if(isReal(number))
+			{
+				shared_ptr<CReal> real = IProperty::getSmartCObjectPtr<CReal>(number);
+				real->setValue(real->getValue() + 0.5);
+			}else
+			{
+				shared_ptr<CInt> integer = IProperty::getSmartCObjectPtr<CInt>(number);
+				integer->setValue(integer->getValue());
+			}
+			break;
+		}
+		case OP_REPLACE_TEXT:
+		{
+			size_t pages = doc.pdf->getPageCount();
+			if(!pages)
+				return false;
+			shared_ptr<CPage> page = doc.pdf->getPage(1 + rnd.below(pages));
+			string text;
+			page->getText(text);
+			if(text.empty())
+				return false;
+			string what = text.substr(rnd.below(text.size()), 1 + rnd.below(3));
+			string with(what.rbegin(), what.rend());
+			get_time_stamp(&start);
+			page->replaceText(what, with);
+			break;
+		}
+		case OP_PAGE_INSERT:
+		{
+			// objects copied from a document are remembered and reused, so
+			// a page can be copied from the same source just once
+			if(doc.source_pages.empty())
+			{
+				doc.source = open_file(doc.name.c_str(), CPdf::ReadOnly);
+				for(size_t p = doc.source->getPageCount(); p > 0; --p)
+					doc.source_pages.push_back(p);
+				if(doc.source_pages.empty())
+					return false;
+			}
+			size_t index = rnd.below(doc.source_pages.size());
+			shared_ptr<CPage> page = doc.source->getPage(doc.source_pages[index]);
+			doc.source_pages.erase(doc.source_pages.begin() + index);
+			size_t pos = 1 + rnd.below(doc.pdf->getPageCount() + 1);
+			get_time_stamp(&start);
+			doc.pdf->insertPage(page, pos);
+			break;
+		}
+		case OP_PAGE_REMOVE:
+		{
+			size_t pages = doc.pdf->getPageCount();
+			if(pages <= 1)
+				return false;
+			size_t pos = 1 + rnd.below(pages);
+			get_time_stamp(&start);
+			doc.pdf->removePage(pos);
+			break;
+		}
+		case OP_SAVE_REOPEN:
+			if(!save_reopen(doc, results[op]))
+				++stats.verify_failures;
+			return true;
+		default:
+			assert(!"Unknown operation");
+			return false;
+	}
+	get_time_stamp(&end);
+	update_result(start, end, results[op]);
+	return true;
+}
+
+operation pick_operation(const fuzz_doc & doc, random_gen & rnd)
+{
+	unsigned total = 0;
+	for(int op = 0; op < OP_COUNT; ++op)
+		total += op_weights[op];
+	unsigned value = rnd.below(total);
+	int op = 0;
+	while(value >= op_weights[op])
+		value -= op_weights[op++];
+
+	// keep the document size bounded
+	if(op == OP_PAGE_INSERT && doc.pdf->getPageCount() >= doc.max_pages)
+		op = OP_PAGE_REMOVE;
+	return (operation)op;
+}
+
+void fuzz_file(const string & name, unsigned int seed, unsigned long count,
+		struct result * results, fuzz_stats & stats)
+{
+	fuzz_doc doc;
+	doc.name = name;
+	char tmp_name[] = "/tmp/edit_fuzz_XXXXXX";
+	int fd = mkstemp(tmp_name);
+	if(fd < 0)
+	{
+		perror("mkstemp");
+		++stats.failed_docs;
+		return;
+	}
+	doc.tmp_name = tmp_name;
+	bool copied = copy_file(name.c_str(), fd);
+	close(fd);
+	try
+	{
+		if(!copied)
+			throw std::exception();
+		doc.pdf = open_file(doc.tmp_name.c_str());
+		// the workload saves changes, so it needs documents which can be 
+		// changed
+		if(doc.pdf->needsCredentials() || doc.pdf->getMode() == CPdf::ReadOnly)
+			throw std::exception();
+	}catch(...)
+	{
+		fprintf(stderr, "%s: unable to open - skipped\n", name.c_str());
+		++stats.failed_docs;
+		unlink(tmp_name);
+		return;
+	}
+	doc.max_pages = 2 * doc.pdf->getPageCount() + 1;
+
+	random_gen rnd(doc_seed(seed, name));
+	for(unsigned long step = 0; step < count; ++step)
+	{
+		operation op = pick_operation(doc, rnd);
+		try
+		{
+			if(do_operation(doc, op, rnd, results, stats))
+				++stats.done[op];
+			else
+				++stats.skipped[op];
+		}catch(std::exception & e)
+		{
+			fprintf(stderr, "%s: step %lu: %s failed: %s\n", name.c_str(), 
+					step, op_names[op], e.what());
+			++stats.errors;
+			if(!doc.pdf)
+				break;
+		}
+	}
+
+	// final check of everything done since the last save
+	try
+	{
+		if(doc.pdf && !save_reopen(doc, results[OP_SAVE_REOPEN]))
+			++stats.verify_failures;
+	}catch(std::exception & e)
+	{
+		fprintf(stderr, "%s: final save failed: %s\n", name.c_str(), e.what());
+		++stats.verify_failures;
+	}
+	doc.pdf.reset();
+	doc.source.reset();
+	unlink(tmp_name);
+}
+
+void print_stats(FILE * out, unsigned int seed, unsigned long count, const fuzz_stats & stats)
+{
+	if(bench_json_output())
+	{
+		fprintf(out, "{\"fuzz\": {\"seed\": %u, \"steps\": %lu, \"errors\": %lu, "
+				"\"verify_failures\": %lu, \"failed_docs\": %lu, \"operations\": {",
+				seed, count, stats.errors, stats.verify_failures, stats.failed_docs);
+		for(int op = 0; op < OP_COUNT; ++op)
+			fprintf(out, "%s\"%s\": {\"done\": %lu, \"skipped\": %lu}", op ? ", " : "",
+					op_names[op], stats.done[op], stats.skipped[op]);
+		fprintf(out, "}}}\n");
+		return;
+	}
+	fprintf(out, "fuzz:seed=%u:steps=%lu:errors=%lu:verify_failures=%lu:failed_docs=%lu\n",
+			seed, count, stats.errors, stats.verify_failures, stats.failed_docs);
+	for(int op = 0; op < OP_COUNT; ++op)
+		fprintf(out, "operations:%s:done=%lu:skipped=%lu\n", op_names[op], 
+				stats.done[op], stats.skipped[op]);
+}
+
+int main(int argc, char ** argv)
+{
+	int ret;
+
+	// -s seed and -n number of operations per document are not common
+	// benchmark options, so they are removed before init_bench parses the rest
+	unsigned int seed = 1;
+	unsigned long count = 200;
+	int args = 1;
+	for(int i = 1; i < argc; ++i)
+	{
+		if(!strcmp(argv[i], "-s") && i + 1 < argc)
+			seed = strtoul(argv[++i], NULL, 0);
+		else if(!strcmp(argv[i], "-n") && i + 1 < argc)
+			count = strtoul(argv[++i], NULL, 0);
+		else
+			argv[args++] = argv[i];
+	}
+	argc = args;
+	if((ret = init_bench(argc, argv)))
+		return ret;
+
+	vector<string> files;
+	for(int i = optind; i < argc; ++i)
+		add_input_files(argv[i], files);
+
+	struct result results[OP_COUNT];
+	for(int op = 0; op < OP_COUNT; ++op)
+		results[op] = result(op_names[op]);
+
+	fuzz_stats stats;
+	bool verified = true;
+	for(int round = 0; round < bench_round_count(); ++round)
+	{
+		bench_start_round(round);
+		// statistics of the last round are printed, all rounds do the same
+		memset(&stats, 0, sizeof(stats));
+		for(size_t f = 0; f < files.size(); ++f)
+			fuzz_file(files[f], seed, count, results, stats);
+		if(stats.verify_failures)
+			verified = false;
+	}
+
+	struct result *all_results[OP_COUNT + 1];
+	for(int op = 0; op < OP_COUNT; ++op)
+		all_results[op] = &results[op];
+	all_results[OP_COUNT] = NULL;
+
+	print_results(stdout, all_results);
+	print_stats(stdout, seed, count, stats);
+	print_memory_report(stdout);
+
+	// the document didn't survive the edits
+	return verified ? 0 : 1;
+}
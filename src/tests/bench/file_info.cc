@@ -24,6 +24,8 @@
 #include <kernel/cpdf.h>
 #include <kernel/xrefwriter.h>
 #include "utils.h"
+#include <string.h>
+#include <unistd.h>
 
 using namespace boost;
 using namespace pdfobjects;
@@ -64,21 +66,59 @@ void print_info(shared_ptr<CPdf> pdf, FILE * out)
 	// TODO number of direct objects - transitive from document catalog
 }
 
+void print_memory_usage(shared_ptr<CPdf> pdf, FILE * out)
+{
+	if(utils::isEncrypted(pdf))
+		return;
+
+	// loads all pages with their content streams
+	for(size_t i = 1; i <= pdf->getPageCount(); ++i)
+	{
+		vector<shared_ptr<CContentStream> > streams;
+		pdf->getPage(i)->getContentStreams(streams);
+	}
+
+	MemoryUsage usage = pdf->getMemoryUsage();
+	fprintf(out, "\tMemory usage with all pages loaded (bytes):\n");
+	fprintf(out, "\t\tcached objects: %lu\n", (unsigned long)usage.cachedObjects);
+	fprintf(out, "\t\tstream buffers: %lu\n", (unsigned long)usage.streamBuffers);
+	fprintf(out, "\t\toperators: %lu\n", (unsigned long)usage.operators);
+	fprintf(out, "\t\txref tables: %lu\n", (unsigned long)usage.xrefTables);
+	fprintf(out, "\t\tpending changes: %lu\n", (unsigned long)usage.pendingChanges);
+	fprintf(out, "\t\tdisplay lists: %lu\n", (unsigned long)usage.displayLists);
+	fprintf(out, "\t\ttotal: %lu\n", (unsigned long)usage.total());
+}
+
 int main(int argc, char ** argv)
 {
 	int ret;
 	FILE * out = stdout;
+
+	// -m is not a common benchmark option, so it is removed before
+	// init_bench parses the rest
+	bool memory = false;
+	int files = 1;
+	for(int i = 1; i < argc; ++i)
+	{
+		if(!strcmp(argv[i], "-m"))
+			memory = true;
+		else
+			argv[files++] = argv[i];
+	}
+	argc = files;
 	if((ret = init_bench(argc, argv)))
 		return ret;
 
 	ret = 0;
-	while(--argc > 0)
+	for(int i = optind; i < argc; ++i)
 	{
-		argv++;
-		fprintf(out, "Document information: \"%s\"\n", *argv);
+		fprintf(out, "Document information: \"%s\"\n", argv[i]);
 		try 
 		{
-			print_info(open_file(*argv), out);
+			shared_ptr<CPdf> pdf = open_file(argv[i]);
+			print_info(pdf, out);
+			if(memory)
+				print_memory_usage(pdf, out);
 		}catch(...)
 		{
 			fprintf(stderr, "Unable to process file\n");
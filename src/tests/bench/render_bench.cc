@@ -0,0 +1,245 @@
+/*
+ * PDFedit - free program for PDF document manipulation.
+ * Copyright (C) 2006-2009  PDFedit team: Michal Hocko,
+ *                                        Jozef Misutka,
+ *                                        Martin Petricek
+ *                   Former team members: Miroslav Jahoda
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program (in doc/LICENSE.GPL); if not, write to the 
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, 
+ * MA  02111-1307  USA
+ *
+ * Project is hosted on http://sourceforge.net/projects/pdfedit
+ */
+#include <kernel/cpdf.h>
+#include <kernel/cpage.h>
+#include <kernel/xpdf.h>
+#include <splash/SplashBitmap.h>
+#include <splash/SplashGlyphCache.h>
+#include <xpdf/SplashOutputDev.h>
+#include <xpdf/Page.h>
+#include <xpdf/Catalog.h>
+#include "utils.h"
+#include <string.h>
+#include <map>
+
+using namespace boost;
+using namespace pdfobjects;
+using namespace std;
+
+// rendering configuration - color mode and resolution
+struct render_config
+{
+	const char * name;
+	SplashColorMode mode;
+	int dpi;
+};
+
+const render_config configs[] = {
+	{"rgb_72", splashModeRGB8, 72},
+	{"rgb_150", splashModeRGB8, 150},
+	{"rgb_300", splashModeRGB8, 300},
+	{"gray_72", splashModeMono8, 72},
+	{"gray_150", splashModeMono8, 150},
+	{"mono_150", splashModeMono1, 150},
+};
+const size_t config_count = sizeof(configs)/sizeof(*configs);
+
+// 32-bit FNV-1a checksum, kept in unsigned long which has at least 32 bits
+typedef unsigned long checksum_t;
+
+// checksums of rendered pages keyed by configuration and page number
+typedef map<pair<size_t, size_t>, checksum_t> checksums_t;
+
+// FNV-1a of bitmap pixels (row padding is not included)
+checksum_t checksum(SplashBitmap * bitmap)
+{
+	size_t row_bytes;
+	switch(bitmap->getMode())
+	{
+		case splashModeMono1:
+			row_bytes = (bitmap->getWidth() + 7) / 8;
+			break;
+		case splashModeMono8:
+			row_bytes = bitmap->getWidth();
+			break;
+		default:
+			row_bytes = 3 * bitmap->getWidth();
+			break;
+	}
+	checksum_t hash = 2166136261UL;
+	for(int y = 0; y < bitmap->getHeight(); ++y)
+	{
+		const unsigned char * row = bitmap->getDataPtr() + y * bitmap->getRowSize();
+		for(size_t x = 0; x < row_bytes; ++x)
+		{
+			hash ^= row[x];
+			hash = (hash * 16777619UL) & 0xffffffffUL;
+		}
+	}
+	return hash;
+}
+
+// renders page and returns checksum of the bitmap
+checksum_t render(shared_ptr<CPage> page, SplashOutputDev & out, 
+		const render_config & config, struct result & result)
+{
+	DisplayParams params;
+	params.hDpi = params.vDpi = config.dpi;
+	time_stamp_t start, end;
+	get_time_stamp(&start);
+	page->displayPage(out, params);
+	get_time_stamp(&end);
+	update_result(start, end, result);
+	return checksum(out.getBitmap());
+}
+
+// renders page directly by Page::displaySlice, i.e. without the display
+// list CPage uses for splash devices, with the glyph cache disabled, and
+// returns checksum of the bitmap. Disabling the cache drops all glyphs
+// cached so far.
+checksum_t render_reference(shared_ptr<CPdf> pdf, shared_ptr<CPage> page, 
+		SplashOutputDev & out, const render_config & config)
+{
+	DisplayParams params;
+	XRef * xref = pdf->getCXref();
+	shared_ptr<Object> xpdf_page(page->getDictionary()->_makeXpdfObject(), xpdf::object_deleter());
+	const Dict * dict = xpdf_page->getDict();
+	Page xpage(xref, 0, dict, new PageAttrs(NULL, dict));
+	Catalog catalog(xref);
+
+	SplashGlyphCache * cache = SplashGlyphCache::getGlobal();
+	Gulong cache_size = cache->getMaxBytes();
+	cache->setMaxBytes(0);
+	out.startDoc(xref);
+	xpage.displaySlice(&out, config.dpi, config.dpi, 0, params.useMediaBox, params.crop,
+			-1, -1, -1, -1, gFalse, &catalog);
+	cache->setMaxBytes(cache_size);
+	return checksum(out.getBitmap());
+}
+
+// checks checksum against the one seen before, returns 0 if it is the same
+int check_sum(checksums_t & sums, size_t config, size_t page, checksum_t sum)
+{
+	checksums_t::key_type key(config, page);
+	checksums_t::iterator i = sums.find(key);
+	if(i == sums.end())
+	{
+		sums[key] = sum;
+		return 0;
+	}
+	if(i->second == sum)
+		return 0;
+	fprintf(stderr, "%s: page %lu rendered differently (%08lx and %08lx)\n",
+			configs[config].name, (unsigned long)page, i->second, sum);
+	return 1;
+}
+
+// renders all pages of a freshly opened document - the first rendering of
+// each page (cold) includes content stream parsing and display list
+// recording and starts with an empty process-wide glyph cache, so all its
+// glyphs are rasterized. The second one (warm) replays the display list with
+// the glyphs cached by the cold one. Both are checked against an untimed
+// reference rendering without the display list.
+int bench_config(size_t config, checksums_t & sums, struct result & cold, struct result & warm)
+{
+	int ret = 0;
+	SplashColor paper;
+	paper[0] = paper[1] = paper[2] = 0xff;
+	shared_ptr<CPdf> pdf = open_file(file_name, CPdf::ReadOnly);
+	// documents encrypted without user password can be rendered as well
+	if(pdf->needsCredentials())
+		pdf->setCredentials(NULL, NULL);
+	for(size_t p = 1; p <= pdf->getPageCount(); ++p)
+	{
+		shared_ptr<CPage> page = pdf->getPage(p);
+		SplashOutputDev reference(configs[config].mode, 4, gFalse, paper);
+		ret += check_sum(sums, config, p, render_reference(pdf, page, reference, configs[config]));
+		SplashOutputDev out(configs[config].mode, 4, gFalse, paper);
+		SplashGlyphCache::getGlobal()->clear();
+		ret += check_sum(sums, config, p, render(page, out, configs[config], cold));
+		ret += check_sum(sums, config, p, render(page, out, configs[config], warm));
+	}
+	return ret;
+}
+
+int main(int argc, char ** argv)
+{
+	int ret;
+
+	// -c file is not a common benchmark option, so it is removed before
+	// init_bench parses the rest
+	const char * sums_file = NULL;
+	int args = 1;
+	for(int i = 1; i < argc; ++i)
+	{
+		if(!strcmp(argv[i], "-c") && i + 1 < argc)
+			sums_file = argv[++i];
+		else
+			argv[args++] = argv[i];
+	}
+	argc = args;
+	if((ret = init_bench(argc, argv)))
+		return ret;
+
+	vector<string> names;
+	vector<struct result> results;
+	for(size_t c = 0; c < config_count; ++c)
+	{
+		names.push_back(string(configs[c].name) + "_cold");
+		names.push_back(string(configs[c].name) + "_warm");
+	}
+	for(size_t i = 0; i < names.size(); ++i)
+		results.push_back(result(names[i].c_str()));
+
+	checksums_t sums;
+	int mismatches = 0;
+	for(int round = 0; round < bench_round_count(); ++round)
+	{
+		bench_start_round(round);
+		try
+		{
+			for(size_t c = 0; c < config_count; ++c)
+				mismatches += bench_config(c, sums, results[2*c], results[2*c + 1]);
+		}catch(...)
+		{
+			// damaged or encrypted documents of the corpus
+			fprintf(stderr, "Unable to process file\n");
+			return 1;
+		}
+	}
+
+	vector<struct result *> all_results;
+	for(size_t i = 0; i < results.size(); ++i)
+		all_results.push_back(&results[i]);
+	all_results.push_back(NULL);
+
+	print_results(stdout, &all_results[0]);
+	print_memory_report(stdout);
+
+	// checksums of different runs can be compared by diff
+	if(sums_file)
+	{
+		FILE * f = fopen(sums_file, "w");
+		if(!f)
+		{
+			perror(sums_file);
+			return 1;
+		}
+		for(checksums_t::const_iterator i = sums.begin(); i != sums.end(); ++i)
+			fprintf(f, "%s %lu %08lx\n", configs[i->first.first].name,
+					(unsigned long)i->first.second, i->second);
+		fclose(f);
+	}
+	return mismatches ? 1 : 0;
+}
@@ -0,0 +1,194 @@
+/*
+ * PDFedit - free program for PDF document manipulation.
+ * Copyright (C) 2006-2009  PDFedit team: Michal Hocko,
+ *                                        Jozef Misutka,
+ *                                        Martin Petricek
+ *                   Former team members: Miroslav Jahoda
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program (in doc/LICENSE.GPL); if not, write to the 
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, 
+ * MA  02111-1307  USA
+ *
+ * Project is hosted on http://sourceforge.net/projects/pdfedit
+ */
+#include <kernel/cpdf.h>
+#include <kernel/cpage.h>
+#include <kernel/textoutput.h>
+#include "utils.h"
+
+using namespace boost;
+using namespace pdfobjects;
+using namespace textoutput;
+using namespace std;
+
+// word list in the form expected by line engines
+struct GridWords
+{
+	typedef SimpleWordEngine::Iterator Iterator;
+	SimpleWordEngine::PageFragments words;
+
+	Iterator begin () const { return words.begin(); }
+	Iterator end () const { return words.end(); }
+};
+
+// order in which words of a table are added
+enum grid_order
+{
+	// column by column as table generators usually write them
+	GRID_COLUMNS,
+	// row by row from the top
+	GRID_ROWS,
+	// row by row from the bottom
+	GRID_REVERSE
+};
+
+// dense table of rows x cols words
+void make_grid(GridWords &grid, int rows, int cols, grid_order order)
+{
+	for(int i = 0; i < rows * cols; ++i)
+	{
+		int r, c;
+		switch(order)
+		{
+			case GRID_COLUMNS:
+				c = i / rows;
+				r = i % rows;
+				break;
+			case GRID_ROWS:
+				r = i / cols;
+				c = i % cols;
+				break;
+			default:
+				r = rows - 1 - i / cols;
+				c = i % cols;
+				break;
+		}
+		shared_ptr<PageSimpleFragment> sfrag(new PageSimpleFragment);
+		sfrag->add(PageSimpleFragment::BBox(10 + c*30, 20 + r*12, 
+					35 + c*30, 10 + r*12));
+		shared_ptr<PageWord> word(new PageWord);
+		word->push_back(sfrag);
+		grid.words.push_back(word);
+	}
+}
+
+void bench_grid_lines(struct result *results, int rows, int cols, grid_order order)
+{
+	GridWords grid;
+	make_grid(grid, rows, cols, order);
+	time_stamp_t start, end;
+	get_time_stamp(&start);
+	SimpleLineEngine lines;
+	lines(grid);
+	get_time_stamp(&end);
+	update_result(start, end, *results);
+	assert(lines.end() - lines.begin() == rows);
+}
+
+void bench_convert(shared_ptr<CPdf> pdf, struct result *results)
+{
+	for(size_t p = 1; p <= pdf->getPageCount(); ++p)
+	{
+		shared_ptr<CPage> page = pdf->getPage(p);
+		XmlOutputBuilder out;
+		time_stamp_t start, end;
+		get_time_stamp(&start);
+		page->convert<SimpleWordEngine, SimpleLineEngine, SimpleColumnEngine>(out);
+		get_time_stamp(&end);
+		update_result(start, end, *results);
+	}
+}
+
+void bench_text(shared_ptr<CPdf> pdf, struct result *results, bool simple)
+{
+	for(size_t p = 1; p <= pdf->getPageCount(); ++p)
+	{
+		shared_ptr<CPage> page = pdf->getPage(p);
+		string text;
+		time_stamp_t start, end;
+		get_time_stamp(&start);
+		if(simple)
+			page->getSimpleText(text);
+		else
+			page->getText(text);
+		get_time_stamp(&end);
+		update_result(start, end, *results);
+	}
+}
+
+int main(int argc, char ** argv)
+{
+	int ret;
+	if((ret = init_bench(argc, argv)))
+		return ret;
+
+	DEFINE_RESULTS(convert_first, "convert_first");
+	DEFINE_RESULTS(convert_again, "convert_again");
+	DEFINE_RESULTS(text_xpdf, "text_xpdf");
+	DEFINE_RESULTS(text_simple_first, "text_simple_first");
+	DEFINE_RESULTS(text_simple_again, "text_simple_again");
+	DEFINE_RESULTS(grid_lines_50x10, "grid_lines_50x10");
+	DEFINE_RESULTS(grid_lines_200x20, "grid_lines_200x20");
+	DEFINE_RESULTS(grid_lines_1000x50, "grid_lines_1000x50");
+	DEFINE_RESULTS(grid_lines_1000x50_rows, "grid_lines_1000x50_rows");
+	DEFINE_RESULTS(grid_lines_1000x50_reverse, "grid_lines_1000x50_reverse");
+	DEFINE_RESULTS(grid_lines_40000x2_rows, "grid_lines_40000x2_rows");
+	DEFINE_RESULTS(grid_lines_40000x2_reverse, "grid_lines_40000x2_reverse");
+
+	for(int round = 0; round < bench_round_count(); ++round)
+	{
+		bench_start_round(round);
+		shared_ptr<CPdf> pdf = open_file(file_name, CPdf::ReadOnly);
+
+		// the first run includes content stream parsing
+		bench_convert(pdf, &convert_first);
+		bench_convert(pdf, &convert_again);
+		pdf.reset();
+
+		// plain text by xpdf and by the text engines -- content streams of
+		// a freshly opened document have to be parsed by the first run
+		pdf = open_file(file_name, CPdf::ReadOnly);
+		bench_text(pdf, &text_xpdf, false);
+		bench_text(pdf, &text_simple_first, true);
+		bench_text(pdf, &text_simple_again, true);
+		pdf.reset();
+
+		bench_grid_lines(&grid_lines_50x10, 50, 10, GRID_COLUMNS);
+		bench_grid_lines(&grid_lines_200x20, 200, 20, GRID_COLUMNS);
+		bench_grid_lines(&grid_lines_1000x50, 1000, 50, GRID_COLUMNS);
+		bench_grid_lines(&grid_lines_1000x50_rows, 1000, 50, GRID_ROWS);
+		bench_grid_lines(&grid_lines_1000x50_reverse, 1000, 50, GRID_REVERSE);
+		bench_grid_lines(&grid_lines_40000x2_rows, 40000, 2, GRID_ROWS);
+		bench_grid_lines(&grid_lines_40000x2_reverse, 40000, 2, GRID_REVERSE);
+	}
+
+	struct result *all_results [] = {
+		&convert_first,
+		&convert_again,
+		&text_xpdf,
+		&text_simple_first,
+		&text_simple_again,
+		&grid_lines_50x10,
+		&grid_lines_200x20,
+		&grid_lines_1000x50,
+		&grid_lines_1000x50_rows,
+		&grid_lines_1000x50_reverse,
+		&grid_lines_40000x2_rows,
+		&grid_lines_40000x2_reverse,
+		NULL
+	};
+
+	print_results(stdout, all_results);
+	print_memory_report(stdout);
+	return 0;
+}
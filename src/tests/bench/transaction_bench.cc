@@ -0,0 +1,151 @@
+/*
+ * PDFedit - free program for PDF document manipulation.
+ * Copyright (C) 2006-2009  PDFedit team: Michal Hocko,
+ *                                        Jozef Misutka,
+ *                                        Martin Petricek
+ *                   Former team members: Miroslav Jahoda
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program (in doc/LICENSE.GPL); if not, write to the 
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, 
+ * MA  02111-1307  USA
+ *
+ * Project is hosted on http://sourceforge.net/projects/pdfedit
+ */
+#include <kernel/cpdf.h>
+#include <kernel/cpage.h>
+#include <kernel/factories.h>
+#include "utils.h"
+
+using namespace boost;
+using namespace pdfobjects;
+using namespace std;
+
+// Benchmark for bulk changes with and without CPdf transaction
+
+shared_ptr<CContentStream> getFirstStream(shared_ptr<CPdf> pdf, int p)
+{
+	shared_ptr<CPage> page = pdf->getPage(p);
+	vector<shared_ptr<CContentStream> > cs;
+	page->getContentStreams(cs);
+	if (cs.empty())
+		return shared_ptr<CContentStream>();
+	return cs.front();
+}
+
+// inserts count operators one by one after the first operator of the
+// page content stream
+void insertOperators(shared_ptr<CContentStream> cs, int count)
+{
+	vector<shared_ptr<PdfOperator> > ops;
+	cs->getPdfOperators(ops);
+	if (ops.empty())
+		return;
+	PdfOperator::Operands operands;
+	for (int i = 0; i < count; ++i)
+		cs->insertOperator(ops.front(), createOperator("q", operands));
+}
+
+// changes count entries of the page dictionary
+void setProperties(shared_ptr<CPage> page, int count)
+{
+	shared_ptr<CDict> dict = page->getDictionary();
+	for (int i = 0; i < count; ++i)
+	{
+		CInt value(i);
+		dict->setProperty("PdfEditBench", value);
+	}
+}
+
+void bench_insert(const char *name, bool transaction, struct result *results, int count)
+{
+	shared_ptr<CPdf> pdf = open_file(name);
+	int pageCount = pdf->getPageCount();
+	for (int p = 1; p <= pageCount; ++p)
+	{
+		shared_ptr<CContentStream> cs = getFirstStream(pdf, p);
+		if (!cs)
+			continue;
+		time_stamp_t start, end;
+		get_time_stamp(&start);
+		if (transaction)
+			pdf->beginTransaction();
+		insertOperators(cs, count);
+		if (transaction)
+			pdf->commitTransaction();
+		get_time_stamp(&end);
+		update_result(start, end, *results);
+	}
+}
+
+void bench_dict(const char *name, bool transaction, struct result *results, int count)
+{
+	shared_ptr<CPdf> pdf = open_file(name);
+	int pageCount = pdf->getPageCount();
+	for (int p = 1; p <= pageCount; ++p)
+	{
+		shared_ptr<CPage> page = pdf->getPage(p);
+		// page contents observe the dictionary
+		vector<shared_ptr<CContentStream> > cs;
+		page->getContentStreams(cs);
+		time_stamp_t start, end;
+		get_time_stamp(&start);
+		if (transaction)
+			pdf->beginTransaction();
+		setProperties(page, count);
+		if (transaction)
+			pdf->commitTransaction();
+		get_time_stamp(&end);
+		update_result(start, end, *results);
+	}
+}
+
+int main(int argc, char ** argv)
+{
+	int ret;
+
+	if((ret = init_bench(argc, argv)))
+		return ret;
+
+	DEFINE_RESULTS(insert10, "insertOperator10");
+	DEFINE_RESULTS(insert10tr, "insertOperator10_transaction");
+	DEFINE_RESULTS(insert100, "insertOperator100");
+	DEFINE_RESULTS(insert100tr, "insertOperator100_transaction");
+	DEFINE_RESULTS(dict100, "setProperty100");
+	DEFINE_RESULTS(dict100tr, "setProperty100_transaction");
+
+	for(int round = 0; round < bench_round_count(); ++round)
+	{
+		bench_start_round(round);
+		bench_insert(file_name, false, &insert10, 10);
+		bench_insert(file_name, true, &insert10tr, 10);
+		bench_insert(file_name, false, &insert100, 100);
+		bench_insert(file_name, true, &insert100tr, 100);
+
+		bench_dict(file_name, false, &dict100, 100);
+		bench_dict(file_name, true, &dict100tr, 100);
+	}
+
+	struct result *all_results [] = {
+		&insert10,
+		&insert10tr,
+		&insert100,
+		&insert100tr,
+		&dict100,
+		&dict100tr,
+		NULL
+	};
+
+	print_results(stdout, all_results);
+	print_memory_report(stdout);
+	return 0;
+}
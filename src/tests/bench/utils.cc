@@ -22,19 +22,94 @@
  * Project is hosted on http://sourceforge.net/projects/pdfedit
  */
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <ctype.h>
+#include <algorithm>
 #include <kernel/pdfedit-core-dev.h>
 #include "utils.h"
 const char *file_name;
+
+static const char * bench_name = "";
+static int warmup_rounds = 0;
+static int measured_rounds = 5;
+static bool json_output = false;
+static bool measuring = true;
+static unsigned long allocations = 0;
+
+#ifdef __GLIBC__
+// counts allocations of the whole process - operator new ends up in malloc
+// as well
+extern "C" {
+void * __libc_malloc(size_t size) __THROW;
+void * __libc_calloc(size_t n, size_t size) __THROW;
+void * __libc_realloc(void * ptr, size_t size) __THROW;
+
+void * malloc(size_t size) __THROW
+{
+	__sync_fetch_and_add(&allocations, 1);
+	return __libc_malloc(size);
+}
+
+void * calloc(size_t n, size_t size) __THROW
+{
+	__sync_fetch_and_add(&allocations, 1);
+	return __libc_calloc(n, size);
+}
+
+void * realloc(void * ptr, size_t size) __THROW
+{
+	__sync_fetch_and_add(&allocations, 1);
+	return __libc_realloc(ptr, size);
+}
+}
+#endif
+
+unsigned long alloc_count()
+{
+	return allocations;
+}
+
 int parse_cmd_line(int argc, char **argv)
 {
-	if(argc<2)
+	const char * slash = strrchr(argv[0], '/');
+	bench_name = slash ? slash + 1 : argv[0];
+
+	int opt;
+	while((opt = getopt(argc, argv, "w:r:j")) != -1)
+	{
+		switch(opt)
+		{
+			case 'w':
+				warmup_rounds = atoi(optarg);
+				break;
+			case 'r':
+				measured_rounds = atoi(optarg);
+				break;
+			case 'j':
+				json_output = true;
+				break;
+			default:
+				std::cerr << "Usage: " << bench_name << " [-w warmup_rounds] [-r rounds] [-j] file" << std::endl;
+				exit(EXIT_FAILURE);
+		}
+	}
+	if(optind >= argc)
 	{
 		std::cerr << "Bad usage. Filename parameter expected" << std::endl;
 		exit(EXIT_FAILURE);
 	}
+	if(warmup_rounds < 0 || measured_rounds < 1)
+	{
+		std::cerr << "Bad usage. At least one measured round expected" << std::endl;
+		exit(EXIT_FAILURE);
+	}
 
-	// TODO use getopt instead and support several files
-	file_name = argv[1];
+	// TODO support several files
+	file_name = argv[optind];
 	return 0;
 }
 
@@ -48,48 +123,158 @@ int init_bench(int argc, char **argv)
 	return parse_cmd_line(argc, argv);
 }
 
+int bench_round_count()
+{
+	return warmup_rounds + measured_rounds;
+}
+
+void bench_start_round(int round)
+{
+	measuring = round >= warmup_rounds;
+}
+
+bool bench_measuring()
+{
+	return measuring;
+}
+
+bool bench_json_output()
+{
+	return json_output;
+}
+
+void get_time_stamp(time_stamp_t * val)
+{
+	clock_gettime(CLOCK_MONOTONIC, &val->time);
+	val->allocs = allocations;
+}
+
 // result is in miliseconds
 double time_diff(time_stamp_t &start, time_stamp_t &end)
 {
-	time_stamp_t diff;
-	diff.tv_sec = end.tv_sec - start.tv_sec;
-	diff.tv_usec = end.tv_usec - start.tv_usec;
-	if(start.tv_usec > end.tv_usec)
-	{
-		--diff.tv_sec;
-		diff.tv_usec += 1000000;
-	}
-
-	return diff.tv_sec*1000 + (double)diff.tv_usec/(double)1000;
+	return (end.time.tv_sec - start.time.tv_sec)*1000.0 
+		+ (end.time.tv_nsec - start.time.tv_nsec)/1000000.0;
 }
 
 void update_result(double time, struct result & result)
 {
+	if(!measuring)
+		return;
 	if(time >= result.max_time)
 		result.max_time = time;
 	if (time <= result.min_time)
 		result.min_time = time;
 	result.sum_time += time;
 	++(result.count);
+	result.samples.push_back(time);
 	result.valid = true;
 }
 
+void update_result(time_stamp_t &start, time_stamp_t &end, struct result & result)
+{
+	if(!measuring)
+		return;
+	update_result(time_diff(start, end), result);
+	result.allocs += end.allocs - start.allocs;
+}
+
+namespace {
+
+// nearest rank percentile of sorted samples
+double percentile(const std::vector<double> & sorted, int per)
+{
+	size_t rank = (sorted.size() * per + 99) / 100;
+	return sorted[rank ? rank - 1 : 0];
+}
+
+long max_rss_kb()
+{
+	struct rusage usage;
+	if(getrusage(RUSAGE_SELF, &usage))
+		return -1;
+	return usage.ru_maxrss;
+}
+
+void print_json_string(FILE * out, const char * str)
+{
+	fputc('"', out);
+	for(; *str; ++str)
+	{
+		if(*str == '"' || *str == '\\')
+			fprintf(out, "\\%c", *str);
+		else if((unsigned char)*str < 0x20)
+			fprintf(out, "\\u%04x", *str);
+		else
+			fputc(*str, out);
+	}
+	fputc('"', out);
+}
+
+} // namespace
+
 void print_results(FILE * out, struct result ** results)
 {
 using namespace std;
+	if(json_output)
+	{
+		// one result per line so that line oriented tools can process it
+		fprintf(out, "{\"benchmark\": ");
+		print_json_string(out, bench_name);
+		fprintf(out, ", \"file\": ");
+		print_json_string(out, file_name);
+		fprintf(out, ", \"warmup\": %d, \"rounds\": %d, \"max_rss_kb\": %ld, \"results\": [\n",
+				warmup_rounds, measured_rounds, max_rss_kb());
+	}
 	for(struct result **iter=results; *iter; ++iter)
 	{
 		struct result * curr = *iter;
-		fprintf(out, "%s", curr->name);
+		if(json_output)
+		{
+			fprintf(out, "{\"name\": ");
+			print_json_string(out, curr->name);
+		}
+		else
+			fprintf(out, "%s", curr->name);
 		if(!curr->valid)
 		{
-			fprintf(out, ":NO_RESULTS\n");
+			fprintf(out, json_output ? ", \"count\": 0}" : ":NO_RESULTS");
+			fprintf(out, (json_output && *(iter+1)) ? ",\n" : "\n");
 			continue;
 		}
 		double avg = (double)curr->sum_time/(double)curr->count;
-		fprintf(out, ":max=%g:min=%g:avg=%g:count=%u\n", 
-				curr->max_time, curr->min_time, avg, curr->count);
+		vector<double> sorted(curr->samples);
+		sort(sorted.begin(), sorted.end());
+		double allocs = (double)curr->allocs/(double)curr->count;
+		if(json_output)
+		{
+			fprintf(out, ", \"count\": %u, \"max\": %g, \"min\": %g, \"avg\": %g, "
+					"\"median\": %g, \"p5\": %g, \"p95\": %g, \"p99\": %g, \"allocs\": %g, "
+					"\"samples\": [",
+					curr->count, curr->max_time, curr->min_time, avg,
+					percentile(sorted, 50), percentile(sorted, 5), percentile(sorted, 95),
+					percentile(sorted, 99), allocs);
+			// in the measured order, compare_runs.sh uses them for a rank test
+			for(size_t i = 0; i < curr->samples.size(); ++i)
+				fprintf(out, i ? ", %g" : "%g", curr->samples[i]);
+			fprintf(out, "]}%s\n", *(iter+1) ? "," : "");
+		}
+		else
+			fprintf(out, ":max=%g:min=%g:avg=%g:count=%u:median=%g:p95=%g:p99=%g:allocs=%g\n", 
+					curr->max_time, curr->min_time, avg, curr->count,
+					percentile(sorted, 50), percentile(sorted, 95), percentile(sorted, 99),
+					allocs);
 	}
+	if(json_output)
+		fprintf(out, "]}\n");
+}
+
+void print_memory_report(FILE * out)
+{
+	if(json_output)
+		return;
+	fprintf(out, "\n---\n");
+	fprintf(out, "max_rss_kb=%ld\n", max_rss_kb());
+	gMemReport(out);
 }
 
 int getFontId(boost::shared_ptr<pdfobjects::CPage> page, const std::string &fontName, std::string &fontId)
@@ -104,3 +289,41 @@ int getFontId(boost::shared_ptr<pdfobjects::CPage> page, const std::string &font
 		}
 	return -1;
 }
+
+namespace {
+
+bool is_pdf(const std::string & name)
+{
+	if(name.size() < 4)
+		return false;
+	std::string ext = name.substr(name.size() - 4);
+	for(size_t i = 0; i < ext.size(); ++i)
+		ext[i] = tolower(ext[i]);
+	return ext == ".pdf";
+}
+
+}
+
+void add_input_files(const char * path, std::vector<std::string> & files)
+{
+	struct stat st;
+	if(stat(path, &st) || !S_ISDIR(st.st_mode))
+	{
+		files.push_back(path);
+		return;
+	}
+	DIR * dir = opendir(path);
+	if(!dir)
+	{
+		perror(path);
+		return;
+	}
+	std::vector<std::string> names;
+	struct dirent * entry;
+	while((entry = readdir(dir)))
+		if(is_pdf(entry->d_name))
+			names.push_back(std::string(path) + "/" + entry->d_name);
+	closedir(dir);
+	std::sort(names.begin(), names.end());
+	files.insert(files.end(), names.begin(), names.end());
+}
@@ -27,21 +27,45 @@
 #include <kernel/static.h>
 #include <kernel/cpdf.h>
 #include <kernel/cpage.h>
-#include <sys/time.h>
 #include <time.h>
 #include <boost/shared_ptr.hpp>
 #include <limits.h>
+#include <vector>
+#include <string>
 
 extern const char * file_name;
 
+/* Parses common benchmark options and the file name:
+ * bench [-w warmup_rounds] [-r rounds] [-j] file
+ * -w rounds which run but are not measured (default 0)
+ * -r measured rounds (default 1)
+ * -j prints results as JSON instead of text
+ */
 int init_bench(int argc, char **argv);
 
-// redefine if something different than gettimeofday should
-// be used for time measuring
-typedef struct timeval time_stamp_t;
+// number of all rounds (warmup + measured) main should run
+int bench_round_count();
+// has to be called at the start of each round - results updated during
+// warmup rounds are ignored
+void bench_start_round(int round);
+// true if the current round is measured (not a warmup one)
+bool bench_measuring();
+// true if results are printed as JSON (-j)
+bool bench_json_output();
+
+// monotonic time and number of heap allocations done so far
+struct time_stamp
+{
+	struct timespec time;
+	unsigned long allocs;
+};
+typedef struct time_stamp time_stamp_t;
 double time_diff(time_stamp_t &start, time_stamp_t &end);
-// gets current time stamp - pointer to timeval struct
-#define get_time_stamp(val)	gettimeofday(val, NULL)
+// gets current time stamp - pointer to time_stamp_t struct
+void get_time_stamp(time_stamp_t * val);
+// number of heap allocations (malloc family and operator new) since the
+// start - always 0 if not supported by the platform
+unsigned long alloc_count();
 
 struct result
 {
@@ -51,12 +75,27 @@ struct result
 	unsigned count;
 	const char * name;
 	bool valid;
+	unsigned long allocs;
+	std::vector<double> samples;
+
+	// empty (invalid) result with the given name
+	explicit result(const char * n = NULL)
+		: max_time(0), min_time(LONG_MAX), sum_time(0), count(0),
+		  name(n), valid(false), allocs(0)
+	{}
 };
 
-#define DEFINE_RESULTS(var, name) struct result var = {0,LONG_MAX,0,0,name,false}
+#define DEFINE_RESULTS(var, name) struct result var(name)
 
 void update_result(double time, struct result & result);
+// same as above but also counts allocations done between start and end
+void update_result(time_stamp_t &start, time_stamp_t &end, struct result & result);
+// prints results in the text (name:max=..:min=..:avg=..:count=..:median=..
+// :p95=..:p99=..:allocs=..) or JSON format
 void print_results(FILE * out, struct result ** results);
+// prints maximum resident set size and xpdf memory debug information if
+// available (nothing for JSON output which contains RSS already)
+void print_memory_report(FILE * out);
 
 
 static inline boost::shared_ptr<pdfobjects::CPdf> open_file(
@@ -66,6 +105,9 @@ static inline boost::shared_ptr<pdfobjects::CPdf> open_file(
 	return pdfobjects::CPdf::getInstance(name, mode);
 }
 
+// adds the file or all *.pdf files of the directory (sorted by name)
+void add_input_files(const char * path, std::vector<std::string> & files);
+
 // TODO something like this should be part of standard API
 int getFontId(boost::shared_ptr<pdfobjects::CPage> page, const std::string &fontName, std::string &fontId);
 
@@ -24,6 +24,9 @@
 #include <kernel/xrefwriter.h>
 #include <kernel/pdfedit-core-dev.h>
 #include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <unistd.h>
 #include "utils.h"
 
 using namespace boost;
@@ -46,7 +49,7 @@ void bench_changeRevision(XRefWriter * xref, struct result * result)
 		xref->changeRevision(i);
 		get_time_stamp(&end);
 		if(result)
-			update_result(time_diff(start, end), *result);
+			update_result(start, end, *result);
 	}
 }
 
@@ -71,7 +74,7 @@ void bench_knowsRef(XRefWriter * xref, struct result * result_known, struct resu
 		if(state == UNUSED_REF)
 		{
 			if(result_unknown)
-				update_result(time_diff(start, end), *result_unknown);
+				update_result(start, end, *result_unknown);
 			++not_present;
 		}
 		else
@@ -81,7 +84,7 @@ void bench_knowsRef(XRefWriter * xref, struct result * result_known, struct resu
 			// be present
 			assert(state == INITIALIZED_REF);
 			if(result_known)
-				update_result(time_diff(start, end), *result_known);
+				update_result(start, end, *result_known);
 			--total;
 		}
 	}
@@ -95,7 +98,7 @@ void bench_knowsRef(XRefWriter * xref, struct result * result_known, struct resu
 		get_time_stamp(&end);
 		assert(state == UNUSED_REF);
 		if(result_unknown)
-			update_result(time_diff(start, end), *result_unknown);
+			update_result(start, end, *result_unknown);
 	}
 }
 
@@ -134,7 +137,7 @@ void bench_changeObject(XRefWriter * xref, struct result *result, int per)
 		xref->changeObject(ref.num, ref.gen, changed_obj);
 		get_time_stamp(&end);
 		if(result)
-			update_result(time_diff(start, end), *result);
+			update_result(start, end, *result);
 		xpdf::freeXpdfObject(changed_obj);
 	}
 }
@@ -164,7 +167,7 @@ void bench_fetch(XRefWriter *xref, struct result * result_known, struct result *
 		if(state == UNUSED_REF)
 		{
 			if(result_unknown)
-				update_result(time_diff(start, end), *result_unknown);
+				update_result(start, end, *result_unknown);
 			++not_present;
 		}
 		else
@@ -174,7 +177,7 @@ void bench_fetch(XRefWriter *xref, struct result * result_known, struct result *
 			// be present
 			assert(state == INITIALIZED_REF);
 			if(result_known)
-				update_result(time_diff(start, end), *result_known);
+				update_result(start, end, *result_known);
 			--total;
 		}
 	}
@@ -191,11 +194,66 @@ void bench_fetch(XRefWriter *xref, struct result * result_known, struct result *
 		obj.free();
 		assert(state == UNUSED_REF);
 		if(result_unknown)
-			update_result(time_diff(start, end), *result_unknown);
+			update_result(start, end, *result_unknown);
 	}
 
 }
 
+// repeatedly changes one object and saves it as a new revision
+void bench_saveChanges(const char * fname, struct result * result, int count)
+{
+	// changes are saved to a copy of the file
+	char tmp_name[] = "/tmp/xrefwriter_benchXXXXXX";
+	int fd = mkstemp(tmp_name);
+	if(fd < 0)
+		return;
+	close(fd);
+	{
+		std::ifstream in(fname, std::ios::binary);
+		std::ofstream out(tmp_name, std::ios::binary);
+		out << in.rdbuf();
+	}
+
+	shared_ptr<CPdf> pdf;
+	XRefWriter * xref;
+	open_and_get_xrefwriter(pdf, xref, tmp_name);
+	if(pdf->getMode() == CPdf::ReadOnly)
+	{
+		pdf.reset();
+		unlink(tmp_name);
+		return;
+	}
+
+	// the first object in use is changed each time
+	int obj_count = xref->getNumObjects();
+	IndiRef ref;
+	for(ref.num = 1; ref.num <= obj_count; ++ref.num)
+		if(xref->knowsRef(ref) == INITIALIZED_REF)
+			break;
+
+	time_stamp_t start, end;
+	for(int i = 0; i < count; ++i)
+	{
+		Object orig_obj;
+		xref->fetch(ref.num, ref.gen, &orig_obj);
+		Object * changed_obj = orig_obj.clone();
+		orig_obj.free();
+		if(!changed_obj)
+			break;
+		xref->changeObject(ref.num, ref.gen, changed_obj);
+		xpdf::freeXpdfObject(changed_obj);
+
+		get_time_stamp(&start);
+		xref->saveChanges(true);
+		get_time_stamp(&end);
+		if(result)
+			update_result(start, end, *result);
+	}
+
+	pdf.reset();
+	unlink(tmp_name);
+}
+
 int main(int argc, char ** argv)
 {
 	int ret;
@@ -203,51 +261,61 @@ int main(int argc, char ** argv)
 	if((ret = init_bench(argc, argv)))
 		return ret;
 
-	time_stamp_t start, end;
-	shared_ptr<CPdf> pdf;
-	XRefWriter * xref;
-
-	// changeRevision test
-	open_and_get_xrefwriter(pdf, xref, file_name);
 	DEFINE_RESULTS(changeRevisionResults1, "changeRevision_no_changed");
-	bench_changeRevision(xref, &changeRevisionResults1);
-
-	// knowsRef test without any changed objects
-	open_and_get_xrefwriter(pdf, xref, file_name);
 	DEFINE_RESULTS(knowsRef_known1, "knowsRef_known_no_changed");
 	DEFINE_RESULTS(knowsRef_unknown1, "knowsRef_unknown_no_changed");
-	bench_knowsRef(xref, &knowsRef_known1, &knowsRef_unknown1);
-
-	// knowsRef test with all indirect object changed
-	open_and_get_xrefwriter(pdf, xref, file_name);
 	DEFINE_RESULTS(knowsRef_known2, "knowsRef_known_all_changed");
 	DEFINE_RESULTS(knowsRef_unknown2, "knowsRef_unknown_all_changed");
 	DEFINE_RESULTS(changeObject_all, "changeObject_all");
-	// change all objects bench
-	if(pdf->getMode() != CPdf::ReadOnly)
-	{
-		bench_changeObject(xref, &changeObject_all, 100);
-		bench_knowsRef(xref, &knowsRef_known2, &knowsRef_unknown2);
-	}
-	
-	// fetch without changed objects
-	open_and_get_xrefwriter(pdf, xref, file_name);
 	DEFINE_RESULTS(fetch_known1, "fetch_known_no_changed");
 	DEFINE_RESULTS(fetch_unknown1, "fetch_unknown_no_changed");
-	bench_fetch(xref, &fetch_known1, &fetch_unknown1);
-	
-	// fetch with all objects changed
-	open_and_get_xrefwriter(pdf, xref, file_name);
 	DEFINE_RESULTS(fetch_known2, "fetch_known_all_changed");
 	DEFINE_RESULTS(fetch_unknown2, "fetch_unknown_all_changed");
-	if(pdf->getMode() != CPdf::ReadOnly)
+	DEFINE_RESULTS(saveChanges_one_changed, "saveChanges_one_changed");
+
+	for(int round = 0; round < bench_round_count(); ++round)
 	{
-		bench_changeObject(xref, NULL, 100);
-		bench_fetch(xref, &fetch_known2, &fetch_unknown2);
+		bench_start_round(round);
+		time_stamp_t start, end;
+		shared_ptr<CPdf> pdf;
+		XRefWriter * xref;
+
+		// changeRevision test
+		open_and_get_xrefwriter(pdf, xref, file_name);
+		bench_changeRevision(xref, &changeRevisionResults1);
+
+		// knowsRef test without any changed objects
+		open_and_get_xrefwriter(pdf, xref, file_name);
+		bench_knowsRef(xref, &knowsRef_known1, &knowsRef_unknown1);
+
+		// knowsRef test with all indirect object changed
+		open_and_get_xrefwriter(pdf, xref, file_name);
+		// change all objects bench
+		if(pdf->getMode() != CPdf::ReadOnly)
+		{
+			bench_changeObject(xref, &changeObject_all, 100);
+			bench_knowsRef(xref, &knowsRef_known2, &knowsRef_unknown2);
+		}
+
+		// fetch without changed objects
+		open_and_get_xrefwriter(pdf, xref, file_name);
+		bench_fetch(xref, &fetch_known1, &fetch_unknown1);
+
+		// fetch with all objects changed
+		open_and_get_xrefwriter(pdf, xref, file_name);
+		if(pdf->getMode() != CPdf::ReadOnly)
+		{
+			bench_changeObject(xref, NULL, 100);
+			bench_fetch(xref, &fetch_known2, &fetch_unknown2);
+		}
+
+		// repeated small saves
+		bench_saveChanges(file_name, &saveChanges_one_changed, 50);
+
+		// clone (???)
+		// reserveRef (RESERVED_NUMBER)
 	}
 
-	// clone (???)
-	// reserveRef (RESERVED_NUMBER)
 	struct result *all_results [] = {
 		&changeRevisionResults1, 
 		&knowsRef_known1, &knowsRef_unknown1,
@@ -255,6 +323,7 @@ int main(int argc, char ** argv)
 		&changeObject_all,
 		&fetch_known1, &fetch_unknown1,
 		&fetch_known2, &fetch_unknown2,
+		&saveChanges_one_changed,
 		NULL
 	};
 
@@ -262,10 +331,7 @@ int main(int argc, char ** argv)
 
 	// finally prints xpdf memory debug information if available (DEBUG_MEM
 	// macro is defined during compilation)
-	// last pdf must be reseted because we need to drop the last reference
-	// to deallocate CPdf
-	pdf.reset();
-	fprintf(stdout, "\n---\n");
-	gMemReport(stdout);
+	// the last CPdf has been deallocated at the end of the last round
+	print_memory_report(stdout);
 	return 0;
 }
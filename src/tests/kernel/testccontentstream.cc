@@ -140,6 +140,248 @@ frontinsert (ostream& oss, const char* fileName)
 
 //=====================================================================================
 
+/** Counts content stream change notifications and keeps the last change. */
+class ChangeCounter : public observer::IObserver<CContentStream>
+{
+public:
+	mutable size_t count;
+	mutable CContentStream::OperatorsChange last;
+	ChangeCounter () : count (0) { last.front = last.back = 0; }
+	virtual ~ChangeCounter () throw() {}
+	void notify (boost::shared_ptr<CContentStream>, boost::shared_ptr<const observer::IChangeContext<CContentStream> > context) const throw()
+	{ 
+		++count; 
+		boost::shared_ptr<const CContentStream::OperatorsChangeContext> change 
+			= boost::dynamic_pointer_cast<const CContentStream::OperatorsChangeContext> (context);
+		assert (change);
+		last = change->getValueId ();
+	}
+	priority_t getPriority () const throw()
+		{ return 0; }
+};
+
+bool
+batchchange (ostream& oss, const char* fileName)
+{
+	boost::shared_ptr<CPdf> ppdf = getTestCPdf (fileName);
+	size_t pagecnt = ppdf->getPageCount ();
+	ppdf.reset();
+	
+	for (size_t i = 0; i < pagecnt && i < TEST_MAX_PAGE_COUNT; ++i)
+	{
+		boost::shared_ptr<CPdf> pdf = getTestCPdf (fileName);
+		boost::shared_ptr<CPage> page = pdf->getPage (i + 1);
+		
+		vector<boost::shared_ptr<CContentStream> > ccs;
+		page->getContentStreams (ccs);
+		assert (!ccs.empty());
+		shared_ptr<CContentStream> cs = ccs.front();
+		shared_ptr<ChangeCounter> counter (new ChangeCounter ());
+		REGISTER_SHAREDPTR_OBSERVER(cs, counter);
+
+		vector<shared_ptr<PdfOperator> > ops;
+		cs->getPdfOperators (ops);
+		if (3 > ops.size())
+		{
+			UNREGISTER_SHAREDPTR_OBSERVER(cs, counter);
+			continue;
+		}
+
+		// Delete first two operators
+		size_t cnt = ops.size();
+		CPPUNIT_ASSERT_EQUAL ((size_t)2, cs->deleteOperators (ops[0], ops[1]));
+		CPPUNIT_ASSERT_EQUAL ((size_t)1, counter->count);
+		ops.clear();
+		cs->getPdfOperators (ops);
+		CPPUNIT_ASSERT_EQUAL (cnt - 2, ops.size());
+
+		// Replace all operators named as the last one
+		string name;
+		ops.back()->getOperatorName (name);
+		size_t named = 0;
+		for (vector<shared_ptr<PdfOperator> >::iterator it = ops.begin(); it != ops.end(); ++it)
+		{
+			string tmp;
+			(*it)->getOperatorName (tmp);
+			if (tmp == name)
+				++named;
+		}
+		PdfOperator::Operands operands;
+		shared_ptr<PdfOperator> newop (new SimpleGenericOperator ("n", 0, operands));
+		CPPUNIT_ASSERT (named <= cs->replaceOperators (name, newop));
+		CPPUNIT_ASSERT_EQUAL ((size_t)2, counter->count);
+		ops.clear();
+		cs->getPdfOperators (ops);
+		for (vector<shared_ptr<PdfOperator> >::iterator it = ops.begin(); it != ops.end(); ++it)
+		{
+			string tmp;
+			(*it)->getOperatorName (tmp);
+			CPPUNIT_ASSERT (tmp != name);
+		}
+
+		UNREGISTER_SHAREDPTR_OBSERVER(cs, counter);
+		_working (oss);
+	}
+	
+	return true;
+}
+
+//=====================================================================================
+
+size_t
+countOperators (shared_ptr<CContentStream> cs, const string& name)
+{
+	vector<shared_ptr<PdfOperator> > ops;
+	cs->getPdfOperators (ops);
+	if (ops.empty())
+		return 0;
+
+	size_t count = 0;
+	for (PdfOperator::Iterator it = PdfOperator::getIterator (ops.front()); !it.isEnd(); it.next())
+	{
+		string tmp;
+		it.getCurrent()->getOperatorName (tmp);
+		if (tmp == name)
+			++count;
+	}
+	return count;
+}
+
+bool
+nestedreplace (ostream& oss, const char* fileName)
+{
+	boost::shared_ptr<CPdf> pdf = getTestCPdf (fileName);
+	if (0 == pdf->getPageCount ())
+		return true;
+	boost::shared_ptr<CPage> page = pdf->getPage (1);
+
+	// q BT Tj Tj ET Q Tj
+	PdfOperator::Operands operands;
+	shared_ptr<UnknownCompositePdfOperator> q (new UnknownCompositePdfOperator ("q", "Q"));
+	shared_ptr<UnknownCompositePdfOperator> bt (new UnknownCompositePdfOperator ("BT", "ET"));
+	q->push_back (bt, q);
+	for (int i = 0; i < 2; ++i)
+	{
+		PdfOperator::Operands text;
+		text.push_back (shared_ptr<IProperty> (new CString ("nested")));
+		bt->push_back (createOperator ("Tj", text), getLastOperator (bt));
+	}
+	bt->push_back (createOperator ("ET", operands), getLastOperator (bt));
+	q->push_back (createOperator ("Q", operands), getLastOperator (q));
+	PdfOperator::Operands text;
+	text.push_back (shared_ptr<IProperty> (new CString ("top")));
+	std::deque<shared_ptr<PdfOperator> > ops;
+	ops.push_back (q);
+	ops.push_back (createOperator ("Tj", text));
+	page->addContentStreamToFront (ops);
+
+	vector<shared_ptr<CContentStream> > ccs;
+	page->getContentStreams (ccs);
+	CPPUNIT_ASSERT (!ccs.empty());
+	shared_ptr<CContentStream> cs = ccs.front();
+	CPPUNIT_ASSERT_EQUAL ((size_t)3, countOperators (cs, "Tj"));
+
+	// operators inside composites have to be replaced too
+	shared_ptr<PdfOperator> newop (new SimpleGenericOperator ("n", 0, operands));
+	CPPUNIT_ASSERT_EQUAL ((size_t)3, cs->replaceOperators ("Tj", newop));
+	CPPUNIT_ASSERT_EQUAL ((size_t)0, countOperators (cs, "Tj"));
+	CPPUNIT_ASSERT_EQUAL ((size_t)3, countOperators (cs, "n"));
+
+	// a replaced composite is replaced including its children (the top
+	// level n stays)
+	CPPUNIT_ASSERT_EQUAL ((size_t)1, cs->replaceOperators ("q", newop));
+	CPPUNIT_ASSERT_EQUAL ((size_t)2, countOperators (cs, "n"));
+	CPPUNIT_ASSERT_EQUAL ((size_t)0, countOperators (cs, "q"));
+
+	_working (oss);
+	return true;
+}
+
+//=====================================================================================
+
+shared_ptr<PdfOperator>
+createTj ()
+{
+	PdfOperator::Operands text;
+	text.push_back (shared_ptr<IProperty> (new CString ("text")));
+	return createOperator ("Tj", text);
+}
+
+bool
+changeextent (ostream& oss, const char* fileName)
+{
+	boost::shared_ptr<CPdf> pdf = getTestCPdf (fileName);
+	if (0 == pdf->getPageCount ())
+		return true;
+	boost::shared_ptr<CPage> page = pdf->getPage (1);
+
+	// q BT Tj ET Q Tj Tj Tj
+	PdfOperator::Operands operands;
+	shared_ptr<UnknownCompositePdfOperator> q (new UnknownCompositePdfOperator ("q", "Q"));
+	shared_ptr<UnknownCompositePdfOperator> bt (new UnknownCompositePdfOperator ("BT", "ET"));
+	q->push_back (bt, q);
+	bt->push_back (createTj (), getLastOperator (bt));
+	bt->push_back (createOperator ("ET", operands), getLastOperator (bt));
+	q->push_back (createOperator ("Q", operands), getLastOperator (q));
+	std::deque<shared_ptr<PdfOperator> > ops;
+	ops.push_back (q);
+	for (int i = 0; i < 3; ++i)
+		ops.push_back (createTj ());
+	page->addContentStreamToFront (ops);
+
+	vector<shared_ptr<CContentStream> > ccs;
+	page->getContentStreams (ccs);
+	shared_ptr<CContentStream> cs = ccs.front();
+	shared_ptr<ChangeCounter> counter (new ChangeCounter ());
+	REGISTER_SHAREDPTR_OBSERVER(cs, counter);
+	vector<shared_ptr<PdfOperator> > top;
+	cs->getPdfOperators (top);
+	// the stream is parsed again, so look for the composite
+	size_t n = top.size(), composite = 0;
+	while (composite < n && top[composite] == getLastOperator (top[composite]))
+		++composite;
+	CPPUNIT_ASSERT (composite + 2 < n);
+
+	// unknown changes - the parsed stream has not been reported yet
+	cs->saveChange ();
+	CPPUNIT_ASSERT_EQUAL ((size_t)1, counter->count);
+	CPPUNIT_ASSERT_EQUAL ((size_t)0, counter->last.front);
+	CPPUNIT_ASSERT_EQUAL ((size_t)0, counter->last.back);
+
+	// first level operator
+	cs->deleteOperator (PdfOperator::getIterator (top[n - 2]));
+	CPPUNIT_ASSERT_EQUAL ((size_t)2, counter->count);
+	CPPUNIT_ASSERT_EQUAL (n - 2, counter->last.front);
+	CPPUNIT_ASSERT_EQUAL ((size_t)1, counter->last.back);
+
+	// into a composite - the first level composite changes
+	PdfOperator::Iterator nested = PdfOperator::getIterator (top[composite]);
+	nested.next ();
+	cs->insertOperator (nested, createTj ());
+	CPPUNIT_ASSERT_EQUAL ((size_t)3, counter->count);
+	CPPUNIT_ASSERT_EQUAL (composite, counter->last.front);
+	CPPUNIT_ASSERT_EQUAL (n - 2 - composite, counter->last.back);
+
+	// behind a first level operator
+	cs->insertOperator (PdfOperator::getIterator (top[composite]), createTj ());
+	CPPUNIT_ASSERT_EQUAL (composite + 1, counter->last.front);
+	CPPUNIT_ASSERT_EQUAL (n - 2 - composite, counter->last.back);
+
+	// operands only
+	PdfOperator::Operands params;
+	top[n - 1]->getParameters (params);
+	CPPUNIT_ASSERT (!params.empty());
+	IProperty::getSmartCObjectPtr<CString> (params.front())->setValue ("changed");
+	CPPUNIT_ASSERT_EQUAL ((size_t)5, counter->count);
+	CPPUNIT_ASSERT (counter->last.front + counter->last.back >= n);
+
+	UNREGISTER_SHAREDPTR_OBSERVER(cs, counter);
+	_working (oss);
+	return true;
+}
+
+//=====================================================================================
+
 bool
 position (ostream& oss, const char* fileName, const libs::Rectangle rc)
 {
@@ -712,6 +954,7 @@ class TestCContentStream : public CppUnit::TestFixture
 		CPPUNIT_TEST(TestPrint);
 		CPPUNIT_TEST(TestSetCS);
 		CPPUNIT_TEST(TestFront);
+		CPPUNIT_TEST(TestBatch);
 		CPPUNIT_TEST(TestCStreams);
 	CPPUNIT_TEST_SUITE_END();
 
@@ -785,6 +1028,34 @@ public:
 	//
 	//
 	//
+	void TestBatch ()
+	{
+		OUTPUT << "CContentStream ..." << endl;
+		
+		for(TestParams::FileList::const_iterator it = TestParams::instance().files.begin(); 
+				it != TestParams::instance().files.end(); 
+					++it)
+		{
+			OUTPUT << "Testing filename: " << *it << endl;
+			
+			BEGIN_CHECK_READONLY;
+				TEST(" batch changes");
+				CPPUNIT_ASSERT (batchchange (OUTPUT, (*it).c_str()));
+				OK_TEST;
+
+				TEST(" replace nested operators");
+				CPPUNIT_ASSERT (nestedreplace (OUTPUT, (*it).c_str()));
+				OK_TEST;
+
+				TEST(" extent of changes");
+				CPPUNIT_ASSERT (changeextent (OUTPUT, (*it).c_str()));
+				OK_TEST;
+			END_CHECK_READONLY;
+		}
+	}
+	//
+	//
+	//
 	void TestFront ()
 	{
 		OUTPUT << "CContentStream ..." << endl;
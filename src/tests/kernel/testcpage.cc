@@ -33,6 +33,9 @@
 #include "kernel/factories.h"
 #include "kernel/cpage.h"
 #include "kernel/cannotation.h"
+#include "kernel/textindex.h"
+#include "kernel/cpagedisplay.h"
+#include "xpdf/SplashOutputDev.h"
 
 
 //=====================================================================================
@@ -146,6 +149,47 @@ display (UNUSED_PARAM ostream& oss, const char* fileName)
 
 //=====================================================================================
 
+namespace {
+	size_t displaySplash (boost::shared_ptr<CPage> page, const DisplayListCache& cache)
+	{
+		SplashColor paper = {0xff, 0xff, 0xff};
+		SplashOutputDev out (splashModeRGB8, 4, gFalse, paper);
+		page->displayPage (out);
+		return cache.getMemoryUsage ();
+	}
+}
+
+bool
+displayListCache (UNUSED_PARAM ostream& oss, const char* fileName)
+{
+	boost::shared_ptr<CPdf> pdf = getTestCPdf (fileName);
+	if (2 > pdf->getPageCount ())
+		return true;
+	DisplayListCache& cache = pdf->getDisplayListCache ();
+
+	// pages with DCT images are drawn directly and are not kept
+	size_t first = displaySplash (pdf->getPage (1), cache);
+	size_t both = displaySplash (pdf->getPage (2), cache);
+	size_t second = both - first;
+	if (0 == first || 0 == second)
+		return true;
+
+	// lists over the budget are dropped, the least recently used first
+	cache.setBudget (std::max (first, second));
+	CPPUNIT_ASSERT (second == cache.getMemoryUsage ());
+	CPPUNIT_ASSERT (first == displaySplash (pdf->getPage (1), cache));
+	
+	// a list which does not fit is not kept at all
+	cache.setBudget (std::min (first, second) - 1);
+	CPPUNIT_ASSERT (0 == cache.getMemoryUsage ());
+	CPPUNIT_ASSERT (0 == displaySplash (pdf->getPage (1), cache));
+
+	_working (oss);
+	return true;
+}
+
+//=====================================================================================
+
 bool
 _export (UNUSED_PARAM ostream& oss, const char* fileName)
 {
@@ -203,6 +247,207 @@ findtext (UNUSED_PARAM ostream& oss, const char* fileName)
 }
 
 
+//=====================================================================================
+
+/** Scans text by the matcher, counting occurences of each pattern. */
+size_t
+matchercount (const TextMatcher& matcher, const string& text, vector<size_t>& counts)
+{
+	counts.assign (matcher.size(), 0);
+	size_t total = 0;
+	TextMatcher::State state = matcher.start ();
+	for (size_t i = 0; i < text.length(); ++i)
+	{
+		state = matcher.step (state, static_cast<Unicode> (text[i] & 0xff));
+		const vector<size_t>& matches = matcher.matches (state);
+		for (vector<size_t>::const_iterator it = matches.begin(); it != matches.end(); ++it)
+			{ ++counts[*it]; ++total; }
+	}
+	return total;
+}
+
+bool
+textmatcher (ostream& oss)
+{
+	vector<string> patterns;
+	vector<size_t> counts;
+
+	// overlapping patterns
+	patterns.push_back ("he");
+	patterns.push_back ("she");
+	patterns.push_back ("his");
+	patterns.push_back ("hers");
+	TextMatcher ac (patterns, true);
+	CPPUNIT_ASSERT_EQUAL ((size_t)3, matchercount (ac, "ushers", counts));
+	CPPUNIT_ASSERT_EQUAL ((size_t)1, counts[0]);
+	CPPUNIT_ASSERT_EQUAL ((size_t)1, counts[1]);
+	CPPUNIT_ASSERT_EQUAL ((size_t)0, counts[2]);
+	CPPUNIT_ASSERT_EQUAL ((size_t)1, counts[3]);
+	CPPUNIT_ASSERT_EQUAL ((size_t)4, matchercount (ac, "hishers", counts));
+
+	// matcher reports overlapping occurences of one pattern, empty
+	// patterns are ignored
+	patterns.clear ();
+	patterns.push_back ("");
+	patterns.push_back ("aa");
+	TextMatcher aa (patterns, true);
+	CPPUNIT_ASSERT_EQUAL ((size_t)2, aa.size());
+	CPPUNIT_ASSERT_EQUAL ((size_t)3, matchercount (aa, "aaaa", counts));
+	CPPUNIT_ASSERT_EQUAL ((size_t)0, counts[0]);
+
+	// case folding
+	patterns.clear ();
+	patterns.push_back ("Hello");
+	patterns.push_back ("\xe9t\xe9");
+	TextMatcher sensitive (patterns, true);
+	TextMatcher insensitive (patterns, false);
+	CPPUNIT_ASSERT_EQUAL ((size_t)0, matchercount (sensitive, "hello HELLO hElLo", counts));
+	CPPUNIT_ASSERT_EQUAL ((size_t)1, matchercount (sensitive, "Hello HELLO", counts));
+	CPPUNIT_ASSERT_EQUAL ((size_t)3, matchercount (insensitive, "hello HELLO hElLo", counts));
+	CPPUNIT_ASSERT_EQUAL ((size_t)0, matchercount (sensitive, "\xc9T\xc9", counts));
+	CPPUNIT_ASSERT_EQUAL ((size_t)1, matchercount (insensitive, "\xc9T\xc9", counts));
+
+	_working (oss);
+	return true;
+}
+
+//=====================================================================================
+
+/** Counts occurences of texts on the page. */
+size_t
+searchcount (shared_ptr<CPage> page, const vector<string>& texts, bool caseSensitive, bool wholeWord, 
+			 vector<libs::Rectangle>& recs)
+{
+	TextSearchParams params;
+	params.caseSensitive = caseSensitive;
+	params.wholeWord = wholeWord;
+	recs.clear ();
+	size_t found = page->findText (texts, recs, params);
+	CPPUNIT_ASSERT_EQUAL (found, recs.size());
+	return found;
+}
+
+/** Counts occurences of text on the page. */
+size_t
+searchcount (shared_ptr<CPage> page, const string& text, bool caseSensitive, bool wholeWord)
+{
+	vector<libs::Rectangle> recs;
+	return searchcount (page, vector<string> (1, text), caseSensitive, wholeWord, recs);
+}
+
+/** Creates text showing operator. */
+shared_ptr<PdfOperator>
+textoperator (const string& text)
+{
+	PdfOperator::Operands operands;
+	operands.push_back (shared_ptr<IProperty> (new CString (text)));
+	return createOperator ("Tj", operands);
+}
+
+/** Creates new line operator. */
+shared_ptr<PdfOperator>
+lineoperator ()
+{
+	PdfOperator::Operands operands;
+	operands.push_back (shared_ptr<IProperty> (new CReal (0)));
+	operands.push_back (shared_ptr<IProperty> (new CReal (-20)));
+	return createOperator ("Td", operands);
+}
+
+bool
+findtextparams (ostream& oss, const char* fileName)
+{
+	boost::shared_ptr<CPdf> pdf = getTestCPdf (fileName);
+	if (0 == pdf->getPageCount ())
+		return true;
+	boost::shared_ptr<CPage> page = pdf->getPage (1);
+
+	// Replace page contents with known text
+	vector<shared_ptr<CContentStream> > ccs;
+	page->getContentStreams (ccs);
+	for (size_t i = 0; i < ccs.size(); ++i)
+		page->removeContentStream (0);
+	string font = page->addSystemType1Font ("Helvetica");
+
+	// BT /font 12 Tf 1 0 0 1 x y Tm
+	//  (He) Tj (llo) Tj ( world) Tj 0 -20 Td
+	//  (HELLO othello) Tj 0 -20 Td
+	//  (shell ushers aaaa) Tj 
+	// ET
+	libs::Rectangle mb = page->getMediabox ();
+	PdfOperator::Operands operands;
+	shared_ptr<UnknownCompositePdfOperator> bt (new UnknownCompositePdfOperator ("BT", "ET"));
+	operands.push_back (shared_ptr<IProperty> (new CName (font)));
+	operands.push_back (shared_ptr<IProperty> (new CReal (12)));
+	bt->push_back (createOperator ("Tf", operands), bt);
+	operands.clear ();
+	double tm[] = { 1, 0, 0, 1, mb.xleft + 20, (mb.yleft + mb.yright) / 2 };
+	for (size_t i = 0; i < sizeof (tm) / sizeof (tm[0]); ++i)
+		operands.push_back (shared_ptr<IProperty> (new CReal (tm[i])));
+	bt->push_back (createOperator ("Tm", operands), getLastOperator (bt));
+	operands.clear ();
+	bt->push_back (textoperator ("He"), getLastOperator (bt));
+	bt->push_back (textoperator ("llo"), getLastOperator (bt));
+	bt->push_back (textoperator (" world"), getLastOperator (bt));
+	bt->push_back (lineoperator (), getLastOperator (bt));
+	bt->push_back (textoperator ("HELLO othello"), getLastOperator (bt));
+	bt->push_back (lineoperator (), getLastOperator (bt));
+	bt->push_back (textoperator ("shell ushers aaaa"), getLastOperator (bt));
+	bt->push_back (createOperator ("ET", operands), getLastOperator (bt));
+	std::deque<shared_ptr<PdfOperator> > ops;
+	ops.push_back (bt);
+	page->addContentStreamToFront (ops);
+
+	// case folding
+	CPPUNIT_ASSERT_EQUAL ((size_t)3, searchcount (page, "hello", false, false));
+	CPPUNIT_ASSERT_EQUAL ((size_t)1, searchcount (page, "hello", true, false));
+	CPPUNIT_ASSERT_EQUAL ((size_t)1, searchcount (page, "HELLO", true, false));
+
+	// word boundaries
+	CPPUNIT_ASSERT_EQUAL ((size_t)2, searchcount (page, "hello", false, true));
+	CPPUNIT_ASSERT_EQUAL ((size_t)0, searchcount (page, "hello", true, true));
+	CPPUNIT_ASSERT_EQUAL ((size_t)1, searchcount (page, "shell", false, true));
+	CPPUNIT_ASSERT_EQUAL ((size_t)0, searchcount (page, "hell", false, true));
+
+	// occurences of one pattern do not overlap
+	CPPUNIT_ASSERT_EQUAL ((size_t)2, searchcount (page, "aa", false, false));
+	CPPUNIT_ASSERT_EQUAL ((size_t)4, searchcount (page, "ll", false, false));
+
+	// matches crossing operators and lines
+	CPPUNIT_ASSERT_EQUAL ((size_t)1, searchcount (page, "Hello", true, true));
+	CPPUNIT_ASSERT_EQUAL ((size_t)1, searchcount (page, "world hello", false, false));
+	CPPUNIT_ASSERT_EQUAL ((size_t)1, searchcount (page, "world HELLO", true, true));
+	CPPUNIT_ASSERT_EQUAL ((size_t)1, searchcount (page, "othello shell", false, false));
+
+	// box of a match crossing operators spans the boxes of its parts
+	vector<libs::Rectangle> whole, head, tail;
+	searchcount (page, vector<string> (1, "Hello"), true, false, whole);
+	searchcount (page, vector<string> (1, "He"), true, false, head);
+	searchcount (page, vector<string> (1, "llo"), true, false, tail);
+	CPPUNIT_ASSERT (!whole.empty() && !head.empty() && !tail.empty());
+	CPPUNIT_ASSERT_DOUBLES_EQUAL (head.front().xleft, whole.front().xleft, 0.01);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL (tail.front().xright, whole.front().xright, 0.01);
+	CPPUNIT_ASSERT (head.front().xright <= tail.front().xleft + 0.01);
+
+	// several patterns at once, overlapping ones are all reported
+	vector<string> texts;
+	texts.push_back ("he");
+	texts.push_back ("she");
+	texts.push_back ("hers");
+	vector<libs::Rectangle> recs;
+	CPPUNIT_ASSERT_EQUAL ((size_t)6, searchcount (page, texts, true, false, recs));
+	CPPUNIT_ASSERT_EQUAL ((size_t)8, searchcount (page, texts, false, false, recs));
+	texts.clear ();
+	texts.push_back ("shell");
+	texts.push_back ("hell");
+	texts.push_back ("ushers");
+	CPPUNIT_ASSERT_EQUAL ((size_t)6, searchcount (page, texts, false, false, recs));
+	CPPUNIT_ASSERT_EQUAL ((size_t)2, searchcount (page, texts, false, true, recs));
+
+	_working (oss);
+	return true;
+}
+
 //=====================================================================================
 
 bool
@@ -593,6 +838,10 @@ public:
 			TEST(" display");
 			CPPUNIT_ASSERT (display (OUTPUT, (*it).c_str()));
 			OK_TEST;
+
+			TEST(" display list cache");
+			CPPUNIT_ASSERT (displayListCache (OUTPUT, (*it).c_str()));
+			OK_TEST;
 		}
 	}
 	//
@@ -630,6 +879,10 @@ public:
 	void TestFind ()
 	{
 		OUTPUT << "CPage find..." << endl;
+
+		TEST(" text matcher");
+		CPPUNIT_ASSERT (textmatcher (OUTPUT));
+		OK_TEST;
 		
 		for(TestParams::FileList::const_iterator it = TestParams::instance().files.begin(); 
 				it != TestParams::instance().files.end(); 
@@ -640,6 +893,12 @@ public:
 			TEST(" find text");
 			CPPUNIT_ASSERT (findtext (OUTPUT, (*it).c_str()));
 			OK_TEST;
+
+			BEGIN_CHECK_READONLY;
+				TEST(" find text with search parameters");
+				CPPUNIT_ASSERT (findtextparams (OUTPUT, (*it).c_str()));
+				OK_TEST;
+			END_CHECK_READONLY;
 		}
 	}
 	//
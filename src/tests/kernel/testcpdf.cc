@@ -31,6 +31,7 @@
 #include "kernel/cpdf.h"
 #include "kernel/pdfwriter.h"
 #include "kernel/delinearizator.h"
+#include "kernel/loadprogress.h"
 
 using namespace pdfobjects;
 using namespace utils;
@@ -77,6 +78,82 @@ public:
 	}
 };
 
+/** Load progress recording stages and canceling at given one.
+ */
+class TestLoadProgress: public LoadProgress
+{
+public:
+	std::vector<Stage> stages;
+	size_t pages;
+	int cancelStage;
+
+	TestLoadProgress(int cancel=-1):pages(0), cancelStage(cancel)
+	{
+	}
+
+	virtual void stage(Stage stage, size_t)
+	{
+		stages.push_back(stage);
+		if(stage==cancelStage)
+			cancel();
+	}
+
+	virtual void step(size_t step)
+	{
+		if(stages.back()==PagesStage)
+			pages=step;
+	}
+};
+
+/** Observer counting notifications.
+ */
+class TestChangeCounter: public IPropertyObserver
+{
+public:
+	mutable int count;
+
+	TestChangeCounter():count(0)
+	{
+	}
+
+	virtual ~TestChangeCounter()throw()
+	{
+	}
+
+	virtual void notify(boost::shared_ptr<IProperty>, boost::shared_ptr<const observer::IChangeContext<IProperty> >)const throw()
+	{
+		++count;
+	}
+
+	virtual priority_t getPriority()const throw()
+	{
+		return 0;
+	}
+};
+
+/** Postponed change which changes given dictionary and fails then, as an
+ * observer which can't finish its work would.
+ */
+class TestFailingChange: public IPendingChange
+{
+	boost::shared_ptr<CDict> dict;
+public:
+	TestFailingChange(boost::shared_ptr<CDict> _dict):dict(_dict)
+	{
+	}
+
+	virtual void merge(const IPendingChange &)
+	{
+	}
+
+	virtual void dispatch()
+	{
+		CInt value(42);
+		dict->setProperty("PdfEditTestFailed", value);
+		throw CObjInvalidOperation();
+	}
+};
+
 class TestCPdf: public CppUnit::TestFixture
 {
 	CPPUNIT_TEST_SUITE(TestCPdf);
@@ -1140,6 +1217,216 @@ public:
 	}
 
 #define staticArraySize(array) sizeof(array)/sizeof(*array)
+	void loadProgressTC(string& fname)
+	{
+		printf("%s\n", __FUNCTION__);
+
+		printf("TC01:\tAll stages are reported in order\n");
+		TestLoadProgress progress;
+		boost::shared_ptr<CPdf> pdf=CPdf::getInstance(fname.c_str(), CPdf::ReadOnly, &progress);
+		CPPUNIT_ASSERT(progress.stages.size()==4);
+		CPPUNIT_ASSERT(progress.stages[0]==LoadProgress::OpenStage);
+		CPPUNIT_ASSERT(progress.stages[1]==LoadProgress::RevisionsStage);
+		CPPUNIT_ASSERT(progress.stages[2]==LoadProgress::PagesStage);
+		CPPUNIT_ASSERT(progress.stages[3]==LoadProgress::DoneStage);
+		CPPUNIT_ASSERT(!progress.isCanceled());
+
+		printf("TC02:\tPage count is reported in the pages stage\n");
+		CPPUNIT_ASSERT(progress.pages==pdf->getPageCount());
+
+		printf("TC03:\tCanceled loading doesn't create instance\n");
+		for(int stage=LoadProgress::OpenStage; stage<LoadProgress::DoneStage; ++stage)
+		{
+			TestLoadProgress cancelProgress(stage);
+			try
+			{
+				CPdf::getInstance(fname.c_str(), CPdf::ReadOnly, &cancelProgress);
+				CPPUNIT_FAIL("LoadCanceledException expected");
+			}catch(LoadCanceledException &)
+			{
+			}
+			CPPUNIT_ASSERT(cancelProgress.stages.back()<=stage+1);
+		}
+	}
+
+	void transactionTC(string& fname)
+	{
+		printf("%s\n", __FUNCTION__);
+
+		boost::shared_ptr<CPdf> pdf=getTestCPdf(fname.c_str(), CPdf::Advanced);
+		if(pdf->getMode()==CPdf::ReadOnly || !pdf->getPageCount())
+		{
+			printf("%s: Document is read only and it is not usable for this test\n", __FUNCTION__);
+			return;
+		}
+		boost::shared_ptr<CDict> pageDict=pdf->getPage(1)->getDictionary();
+		boost::shared_ptr<TestChangeCounter> counter(new TestChangeCounter());
+		pageDict->registerObserver(counter);
+
+		printf("TC01:\tChanges are not dispatched inside transaction\n");
+		pdf->beginTransaction();
+		CPPUNIT_ASSERT(pdf->inTransaction());
+		for(int i=0; i<10; ++i)
+		{
+			CInt value(i);
+			pageDict->setProperty("PdfEditTest", value);
+		}
+		CName name("Test");
+		pageDict->setProperty("PdfEditTest1", name);
+		CPPUNIT_ASSERT(counter->count==0);
+		CPPUNIT_ASSERT(pdf->isChanged());
+
+		printf("TC02:\tNested transaction doesn't dispatch changes\n");
+		pdf->beginTransaction();
+		pdf->commitTransaction();
+		CPPUNIT_ASSERT(pdf->inTransaction());
+		CPPUNIT_ASSERT(counter->count==0);
+
+		printf("TC03:\tChanges of the same entry are merged\n");
+		pdf->commitTransaction();
+		CPPUNIT_ASSERT(!pdf->inTransaction());
+		CPPUNIT_ASSERT(counter->count==2);
+		int value;
+		pageDict->getProperty<CInt>("PdfEditTest")->getValue(value);
+		CPPUNIT_ASSERT(value==9);
+
+		printf("TC04:\tChanges are dispatched immediately out of transaction\n");
+		CInt value1(1);
+		pageDict->setProperty("PdfEditTest", value1);
+		CPPUNIT_ASSERT(counter->count==3);
+
+		printf("TC05:\tScoped transaction commits when leaving the scope\n");
+		{
+			CPdf::Transaction transaction(pdf);
+			pageDict->delProperty("PdfEditTest");
+			pageDict->delProperty("PdfEditTest1");
+			CPPUNIT_ASSERT(counter->count==3);
+		}
+		CPPUNIT_ASSERT(!pdf->inTransaction());
+		CPPUNIT_ASSERT(counter->count==5);
+
+		printf("TC06:\tFailed dispatching still writes changed properties to the xref\n");
+		pdf->beginTransaction();
+		CInt value2(2);
+		pageDict->setProperty("PdfEditTest", value2);
+		pdf->deferChange(counter.get(), "fail",
+				boost::shared_ptr<IPendingChange>(new TestFailingChange(pageDict)));
+		bool failed=false;
+		try
+		{
+			pdf->commitTransaction();
+		}catch(CObjInvalidOperation &)
+		{
+			failed=true;
+		}
+		CPPUNIT_ASSERT(failed);
+		CPPUNIT_ASSERT(!pdf->inTransaction());
+		IndiRef pageRef=pageDict->getIndiRef();
+		Object pageObj;
+		pdf->getCXref()->fetch(pageRef.num, pageRef.gen, &pageObj);
+		CPPUNIT_ASSERT(pageObj.isDict());
+		Object obj;
+		CPPUNIT_ASSERT(pageObj.dictLookupNF("PdfEditTest", &obj)->isInt() && obj.getInt()==2);
+		obj.free();
+		CPPUNIT_ASSERT(pageObj.dictLookupNF("PdfEditTestFailed", &obj)->isInt() && obj.getInt()==42);
+		obj.free();
+		pageObj.free();
+
+		printf("TC07:\tScoped transaction doesn't hide commit failure\n");
+		failed=false;
+		try
+		{
+			CPdf::Transaction transaction(pdf);
+			pdf->deferChange(counter.get(), "fail",
+					boost::shared_ptr<IPendingChange>(new TestFailingChange(pageDict)));
+		}catch(CObjInvalidOperation &)
+		{
+			failed=true;
+		}
+		CPPUNIT_ASSERT(failed);
+		CPPUNIT_ASSERT(!pdf->inTransaction());
+
+		pageDict->unregisterObserver(counter);
+	}
+
+	/** Compares all revisions of pdf with a fresh parse of the file.
+	 * Leaves pdf in the newest revision.
+	 */
+	void checkRevisions(boost::shared_ptr<CPdf> pdf, const string & file)
+	{
+		for(CPdf::revision_t rev=0; rev<pdf->getRevisionsCount(); ++rev)
+		{
+			pdf->changeRevision(rev);
+			boost::shared_ptr<CPdf> fresh=getTestCPdf(file.c_str(), CPdf::ReadOnly);
+			CPPUNIT_ASSERT(fresh->getRevisionsCount()==pdf->getRevisionsCount());
+			fresh->changeRevision(rev);
+
+			CXref * xref=pdf->getCXref();
+			CXref * freshXref=fresh->getCXref();
+			CPPUNIT_ASSERT(xref->getSize()==freshXref->getSize());
+			for(int i=0; i<xref->getSize(); ++i)
+			{
+				XRefEntry * entry=xref->getEntry(i);
+				XRefEntry * freshEntry=freshXref->getEntry(i);
+				CPPUNIT_ASSERT(entry->type==freshEntry->type);
+				if(entry->type==xrefEntryFree)
+					continue;
+				CPPUNIT_ASSERT(entry->offset==freshEntry->offset);
+				CPPUNIT_ASSERT(entry->gen==freshEntry->gen);
+			}
+
+			string trailer, freshTrailer;
+			pdf->getTrailer()->getStringRepresentation(trailer);
+			fresh->getTrailer()->getStringRepresentation(freshTrailer);
+			CPPUNIT_ASSERT(trailer==freshTrailer);
+		}
+		pdf->changeRevision(pdf->getRevisionsCount()-1);
+	}
+
+	void revisionSnapshotsTC(string& fname)
+	{
+		printf("%s\n", __FUNCTION__);
+
+		// works on a copy, because new revisions are saved
+		string file=fname+"_revisions.pdf";
+		FILE * in=fopen(fname.c_str(), "rb");
+		FILE * out=fopen(file.c_str(), "wb");
+		CPPUNIT_ASSERT(in && out);
+		char buf[BUFSIZ];
+		size_t len;
+		while((len=fread(buf, 1, sizeof(buf), in))>0)
+			CPPUNIT_ASSERT(fwrite(buf, 1, len, out)==len);
+		fclose(in);
+		fclose(out);
+
+		boost::shared_ptr<CPdf> pdf=getTestCPdf(file.c_str(), CPdf::Advanced);
+		if(pdf->getMode()==CPdf::ReadOnly || pdf->isLinearized() || !pdf->getPageCount())
+		{
+			printf("%s: Document is not usable for this test\n", __FUNCTION__);
+			pdf.reset();
+			remove(file.c_str());
+			return;
+		}
+
+		printf("TC01:\tRevisions match the file after switching revisions\n");
+		checkRevisions(pdf, file);
+
+		printf("TC02:\tRevisions match the file after incremental saves\n");
+		for(int i=0; i<3; ++i)
+		{
+			CInt value(i);
+			pdf->getPage(1)->getDictionary()->setProperty("PdfEditTestRevision", value);
+			pdf->save(true);
+			checkRevisions(pdf, file);
+		}
+
+		pdf.reset();
+		#if TEMP_FILES_CREATE
+		#else
+			remove(file.c_str());
+		#endif
+	}
+
 	void changeTrailerTC(string& fname)
 	{
 		printf("%s\n", __FUNCTION__);
@@ -1353,6 +1640,9 @@ public:
 
 			delinearizatorTC(fileName);
 			changeTrailerTC(fileName);
+			loadProgressTC(fileName);
+			transactionTC(fileName);
+			revisionSnapshotsTC(fileName);
 		}
 		revisionsTC();
 		printf("TEST_CPDF testig finished\n");
@@ -31,6 +31,7 @@
 #include "kernel/cpdf.h"
 #include "kernel/pdfwriter.h"
 #include "kernel/delinearizator.h"
+#include "kernel/flattener.h"
 
 using namespace pdfobjects;
 using namespace utils;
@@ -237,6 +238,32 @@ class TestEncryptCPdf: public CppUnit::TestFixture
 		}
 		checkNeedCredentialMethods(pdf, true);
 	}
+	void writeTC(const string & fileName, const string & passwd)
+	{
+		OUTPUT << "TC03: encrypted document writing\n";
+		shared_ptr<Flattener> flattener = Flattener::getInstance(fileName.c_str(), new OldStylePdfWriter());
+		CPPUNIT_ASSERT(flattener);
+		if(flattener->getNeedCredentials())
+			flattener->setCredentials(passwd.c_str(), passwd.c_str());
+		CPPUNIT_ASSERT(!flattener->flatten("testfile_flatten"));
+		flattener.reset();
+
+		// written document keeps encryption and the same password
+		shared_ptr<CPdf> orig = getTestCPdf(fileName.c_str(), CPdf::ReadOnly);
+		orig->setCredentials(passwd.c_str(), passwd.c_str());
+		shared_ptr<CPdf> written = getTestCPdf("testfile_flatten", CPdf::ReadOnly);
+		CPPUNIT_ASSERT(isEncrypted(written));
+		written->setCredentials(passwd.c_str(), passwd.c_str());
+		CPPUNIT_ASSERT_EQUAL(orig->getPageCount(), written->getPageCount());
+		for(size_t i=1; i<=orig->getPageCount(); ++i)
+		{
+			string origText, writtenText;
+			orig->getPage(i)->getText(origText);
+			written->getPage(i)->getText(writtenText);
+			CPPUNIT_ASSERT(origText == writtenText);
+		}
+		OUTPUT << endl;
+	}
 public:
 	void setUp()
 	{
@@ -272,6 +299,7 @@ public:
 			// only encrypted documents are cheched
 			noCredentialsTC(pdf);
 			credentialsTC(pdf, passwd);
+			writeTC(fileName, passwd);
 		}
 		str.close();
 	}
@@ -66,6 +66,122 @@ bool text_cpageout (UNUSED_PARAM std::ostream& oss,
 	return true;
 }
 
+//=====================================================================================
+bool text_streamout (UNUSED_PARAM std::ostream& oss, 
+			   UNUSED_PARAM const char* file_name)
+{
+
+	boost::shared_ptr<CPdf> pdf = getTestCPdf (file_name);
+
+	vector<size_t> positions;
+	for (size_t i = 0; i < pdf->getPageCount() && i < TEST_MAX_PAGE_COUNT; ++i)
+		positions.push_back (i+1);
+
+	// Stream output must be the same as the one kept in memory
+	XmlOutputBuilder out;
+	for (size_t i = 0; i < positions.size(); ++i)
+		pdf->getPage (positions[i])->convert<SimpleWordEngine,
+											 SimpleLineEngine,
+											 SimpleColumnEngine> (out);
+	ostringstream xml;
+	// small buffer to flush in the middle of pages
+	XmlStreamOutputBuilder xmlout (xml, 256);
+	convert_pages<SimpleWordEngine, SimpleLineEngine, SimpleColumnEngine> (*pdf, positions, xmlout);
+	CPPUNIT_ASSERT (XmlOutputBuilder::xml (out) == xml.str());
+
+	// One json object per page
+	ostringstream json;
+	JsonLinesOutputBuilder jsonout (json);
+	convert_pages<SimpleWordEngine, SimpleLineEngine, SimpleColumnEngine> (*pdf, positions, jsonout);
+	string line;
+	istringstream lines (json.str());
+	size_t count = 0;
+	while (getline (lines, line))
+	{
+		CPPUNIT_ASSERT (0 == line.find ("{\"page\":"));
+		CPPUNIT_ASSERT ('}' == line[line.size() - 1]);
+		// text is escaped, so lines are plain ASCII whatever the fonts are
+		for (string::const_iterator it = line.begin(); it != line.end(); ++it)
+			CPPUNIT_ASSERT (0x20 <= *it && 0x7f > *it);
+		++count;
+	}
+	CPPUNIT_ASSERT_EQUAL (positions.size(), count);
+
+	return true;
+}
+
+//=====================================================================================
+
+/** Pages of the testset where the text engines are known to miss words. */
+struct KnownTextDifference
+{
+	const char* file;
+	size_t page;
+	size_t missing;		/**< Words found by xpdf only. */
+	const char* reason;
+};
+
+const KnownTextDifference known_text_differences[] = {
+	{"00uebung.pdf", 1, 7, "accents are separate glyphs placed over letters"},
+	{"3_pkcs.pdf", 2, 9, "letter spaced words are split to letters"},
+};
+
+// number of words the text engines may miss on the page
+size_t allowed_missing (const char* file_name, size_t page, size_t words)
+{
+	const char* base = strrchr (file_name, '/');
+	base = base ? base + 1 : file_name;
+	for (size_t i = 0; i < sizeof (known_text_differences) / sizeof (*known_text_differences); ++i)
+	{
+		const KnownTextDifference& known = known_text_differences[i];
+		if (0 == strcmp (known.file, base) && known.page == page)
+			return known.missing;
+	}
+	// kerned words split to parts and punctuation set in another font
+	// (TN5603.Filters.pdf) are reported as different words, 1 in 20 at most
+	return std::max (static_cast<size_t> (1), words / 20);
+}
+
+bool text_simpletext (std::ostream& oss, const char* file_name)
+{
+
+	boost::shared_ptr<CPdf> pdf = getTestCPdf (file_name);
+
+	size_t xpdf_words = 0, common_words = 0;
+	for (size_t i = 0; i < pdf->getPageCount() && i < TEST_MAX_PAGE_COUNT; ++i)
+	{
+		boost::shared_ptr<CPage> page = pdf->getPage (i+1);
+
+		// Compare words found by xpdf and by the text engines
+		string xpdf, simple;
+		page->getText (xpdf);
+		page->getSimpleText (simple);
+		multiset<string> xpdf_set, simple_set;
+		string word;
+		istringstream xpdf_str (xpdf);
+		while (xpdf_str >> word)
+			xpdf_set.insert (word);
+		istringstream simple_str (simple);
+		while (simple_str >> word)
+			simple_set.insert (word);
+		
+		vector<string> common;
+		set_intersection (xpdf_set.begin(), xpdf_set.end(), 
+						  simple_set.begin(), simple_set.end(), 
+						  back_inserter (common));
+		xpdf_words += xpdf_set.size();
+		common_words += common.size();
+
+		// Lines may be ordered differently, but the words have to be the same
+		CPPUNIT_ASSERT (xpdf_set.size() - common.size() 
+				<= allowed_missing (file_name, i+1, xpdf_set.size()));
+	}
+
+	oss << " (" << common_words << " of " << xpdf_words << " words match)" << flush;
+
+	return true;
+}
+
 
 //=========================================================================
 // class TestTextOutput
@@ -75,6 +191,8 @@ class TestTextOutput : public CppUnit::TestFixture
 {
 	CPPUNIT_TEST_SUITE(TestTextOutput);
 		CPPUNIT_TEST(test_cpageout);
+		CPPUNIT_TEST(test_streamout);
+		CPPUNIT_TEST(test_simpletext);
 	CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -98,6 +216,38 @@ public:
 			OK_TEST;
 		}
 	}
+	//
+	//
+	//
+	void test_streamout ()
+	{
+		for (TestParams::FileList::const_iterator it = TestParams::instance().files.begin (); 
+				it != TestParams::instance().files.end(); 
+					++it)
+		{
+			OUTPUT << "Testing filename: " << *it << endl;
+			
+			TEST(" text stream output");
+			CPPUNIT_ASSERT (text_streamout (OUTPUT, (*it).c_str()));
+			OK_TEST;
+		}
+	}
+	//
+	//
+	//
+	void test_simpletext ()
+	{
+		for (TestParams::FileList::const_iterator it = TestParams::instance().files.begin (); 
+				it != TestParams::instance().files.end(); 
+					++it)
+		{
+			OUTPUT << "Testing filename: " << *it << endl;
+			
+			TEST(" simple text output");
+			CPPUNIT_ASSERT (text_simpletext (OUTPUT, (*it).c_str()));
+			OK_TEST;
+		}
+	}
 
 };
 
@@ -102,13 +102,14 @@ namespace {
 		string operator () (shared_ptr<CPdf> pdf, 
 							shared_ptr<CPage> page, 
 							const std::string& file, 
-							size_t hdpi, size_t vdpi)
+							size_t hdpi, size_t vdpi, size_t threads)
 		{
 			_time time;
 			SplashColor paperColor;
 			paperColor[0] = paperColor[1] = paperColor[2] = 0xff;
 			SplashOutputDev splash  (splashModeBGR8, 4, gFalse, paperColor);
 			splash.startDoc(pdf->getCXref());
+			splash.setRenderThreads(threads);
 
 			// alter display params
 			pdfobjects::DisplayParams displayparams;
@@ -185,6 +186,7 @@ main(int argc, char ** argv)
 		("what", po::value<Pages>(), "page to convert")
 		("hdpi", po::value<size_t>()->default_value(72), "horizontal dpi")
 		("vdpi", po::value<size_t>()->default_value(72), "vertical dpi")
+		("threads", po::value<size_t>()->default_value(1), "rendering threads")
 	;
 
 	po::variables_map vm;
@@ -210,6 +212,7 @@ main(int argc, char ** argv)
 
 	size_t hdpi = vm["hdpi"].as<size_t>();
 	size_t vdpi = vm["vdpi"].as<size_t>();
+	size_t threads = vm["threads"].as<size_t>();
 
 	try
 	{
@@ -236,7 +239,7 @@ main(int argc, char ** argv)
 				oss << i << ".bmp";
 				_time time;
 				shared_ptr<CPage> page = pdf->getPage(i);
-				std::cout << "\nPage " << i << _bmpify()(pdf, page, oss.str(), hdpi, vdpi);
+				std::cout << "\nPage " << i << _bmpify()(pdf, page, oss.str(), hdpi, vdpi, threads);
 				std::cout << " [all:" << time.passed() << "]";
 			}
 		}
@@ -254,7 +257,7 @@ main(int argc, char ** argv)
 			oss << *it << ".bmp";
 			_time time;
 			shared_ptr<CPage> page = pdf->getPage(*it);
-			std::cout << "\nPage " << *it << _bmpify()(pdf, page, oss.str(), hdpi, vdpi);
+			std::cout << "\nPage " << *it << _bmpify()(pdf, page, oss.str(), hdpi, vdpi, threads);
 			std::cout << " [all:" << time.passed() << "]";
 		}
 
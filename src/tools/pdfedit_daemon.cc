@@ -0,0 +1,1022 @@
+/*
+ * PDFedit - free program for PDF document manipulation.
+ * Copyright (C) 2006-2009  PDFedit team: Michal Hocko,
+ *                                        Jozef Misutka,
+ *                                        Martin Petricek
+ *                   Former team members: Miroslav Jahoda
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program (in doc/LICENSE.GPL); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA  02111-1307  USA
+ *
+ * Project is hosted on http://sourceforge.net/projects/pdfedit
+ */
+
+/*
+ * Batch processing daemon.
+ *
+ * Keeps pdfedit core initialized and serves requests on a unix domain socket.
+ * Each request is one line containing a JSON object, each response is one
+ * line with a JSON object as well:
+ *
+ * {"id":1, "op":"pdf_to_text", "file":"a.pdf", "pages":[1,2]}
+ * {"id":1, "ok":true, "pages":[1,2], "text":["...","..."]}
+ *
+ * Supported operations (optional parameters in brackets):
+ *  ping
+ *  pdf_to_text  file [pages] [encoding]
+ *  flatten      file [output]
+ *  delinearize  file output
+ *  replace_text file what with [from] [to] [output]
+ *  add_text     file text pages position [font] [output]
+ *
+ * what and with are strings or arrays of strings of the same size, position
+ * is an [x, y] array. Operations changing the document save it in place unless
+ * output is given (the file is copied there first). Errors are reported as
+ * {"id":1, "ok":false, "error":"..."}.
+ *
+ * The kernel is not thread safe (xpdf globals, CPdf instance registry), so the
+ * worker pool consists of processes forked after the core initialization.
+ * Workers accept connections on the shared listening socket, each serves one
+ * connection at a time. A worker has its address space limited to its
+ * initial size plus the per-job memory limit, it retires after a job runs out
+ * of memory or leaves too much memory behind and after max-jobs jobs. The
+ * connection is closed when a worker retires, the master process forks a new
+ * worker instead.
+ */
+
+#include <kernel/pdfedit-core-dev.h>
+#include <kernel/cpdf.h>
+#include <kernel/cpage.h>
+#include <kernel/cpagefonts.h>
+#include <kernel/delinearizator.h>
+#include <kernel/flattener.h>
+#include <kernel/pdfwriter.h>
+#include <boost/program_options.hpp>
+#include <sstream>
+#include <fstream>
+#include <vector>
+#include <limits>
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+
+using namespace pdfobjects;
+using namespace std;
+using namespace boost;
+using namespace utils;
+
+namespace po = program_options;
+
+namespace {
+
+	// default values
+	const string DEFAULT_SOCKET ("/tmp/pdfedit_daemon.socket");
+	const size_t DEFAULT_WORKERS = 4;
+	const size_t DEFAULT_MEMORY_LIMIT = 512;	// MB
+	const size_t DEFAULT_MAX_JOBS = 1000;
+	const string DEFAULT_FONT_DIR (".");
+	const size_t MAX_REQUEST_SIZE = 1024*1024;
+
+	/** Daemon configuration. */
+	struct Config
+	{
+		string socket;
+		size_t workers;
+		size_t memoryLimit;	/**< Per job address space limit in bytes (0 unlimited). */
+		size_t maxJobs;
+	};
+
+	/** Set by SIGTERM/SIGINT in the master process. */
+	volatile sig_atomic_t stopping = 0;
+
+	void stopHandler (int)
+		{ stopping = 1; }
+
+
+	//
+	// JSON
+	//
+
+	/** Error in the request. */
+	struct RequestError : public std::exception
+	{
+		string msg;
+		RequestError (const string& m) : msg (m) {}
+		~RequestError () throw () {}
+		const char* what () const throw () { return msg.c_str(); }
+	};
+
+	/** Parsed JSON value. */
+	struct Value
+	{
+		enum Type {Null, Bool, Number, String, Array, Object};
+		typedef vector<Value> Items;
+		typedef vector<pair<string, Value> > Members;
+
+		Type type;
+		bool b;
+		double n;
+		string s;
+		Items items;
+		Members members;
+
+		Value () : type (Null), b (false), n (0) {}
+
+		/** Returns member of an object or NULL. */
+		const Value* get (const string& name) const
+		{
+			for (Members::const_iterator it = members.begin(); it != members.end(); ++it)
+				if (it->first == name)
+					return &it->second;
+			return NULL;
+		}
+	};
+
+	/** Minimal JSON parser, strings are kept in UTF-8. */
+	class Parser
+	{
+		/** Maximal nesting of objects and arrays. */
+		static const size_t MAX_DEPTH = 64;
+
+		const string& _in;
+		size_t _pos;
+		size_t _depth;
+
+	public:
+		Parser (const string& in) : _in (in), _pos (0), _depth (0) {}
+
+		Value parse ()
+		{
+			Value v = value ();
+			ws ();
+			if (_pos != _in.size())
+				fail ("trailing characters");
+			return v;
+		}
+
+	private:
+		void fail (const char* msg)
+		{
+			ostringstream oss;
+			oss << "invalid JSON at " << _pos << ": " << msg;
+			throw RequestError (oss.str());
+		}
+
+		void ws ()
+		{
+			while (_pos < _in.size() && isspace ((unsigned char)_in[_pos]))
+				++_pos;
+		}
+
+		bool eat (char c)
+		{
+			ws ();
+			if (_pos < _in.size() && _in[_pos] == c)
+			{
+				++_pos;
+				return true;
+			}
+			return false;
+		}
+
+		void expect (char c)
+		{
+			if (!eat (c))
+				fail ("unexpected character");
+		}
+
+		bool keyword (const char* kw)
+		{
+			size_t len = strlen (kw);
+			if (0 != _in.compare (_pos, len, kw))
+				return false;
+			_pos += len;
+			return true;
+		}
+
+		Value value ()
+		{
+			ws ();
+			if (_pos >= _in.size())
+				fail ("unexpected end");
+
+			Value v;
+			char c = _in[_pos];
+			if ('{' == c || '[' == c)
+			{
+				if (_depth >= MAX_DEPTH)
+					fail ("nesting too deep");
+				++_depth;
+				++_pos;
+				if ('{' == c)
+				{
+					v.type = Value::Object;
+					if (!eat ('}'))
+					{
+						do {
+							ws ();
+							string name = str ();
+							expect (':');
+							v.members.push_back (make_pair (name, value ()));
+						}while (eat (','));
+						expect ('}');
+					}
+				}else
+				{
+					v.type = Value::Array;
+					if (!eat (']'))
+					{
+						do {
+							v.items.push_back (value ());
+						}while (eat (','));
+						expect (']');
+					}
+				}
+				--_depth;
+			}else if ('"' == c)
+			{
+				v.type = Value::String;
+				v.s = str ();
+			}else if (keyword ("true"))
+			{
+				v.type = Value::Bool;
+				v.b = true;
+			}else if (keyword ("false"))
+			{
+				v.type = Value::Bool;
+			}else if (keyword ("null"))
+			{
+			}else
+			{
+				const char* begin = _in.c_str() + _pos;
+				char* end;
+				v.type = Value::Number;
+				v.n = strtod (begin, &end);
+				if (end == begin)
+					fail ("unexpected character");
+				_pos += end - begin;
+			}
+			return v;
+		}
+
+		unsigned hex4 ()
+		{
+			if (_pos + 4 > _in.size())
+				fail ("bad escape");
+			unsigned u = 0;
+			for (size_t i = 0; i < 4; ++i)
+			{
+				char c = _in[_pos++];
+				u <<= 4;
+				if (c >= '0' && c <= '9') u |= c - '0';
+				else if (c >= 'a' && c <= 'f') u |= c - 'a' + 10;
+				else if (c >= 'A' && c <= 'F') u |= c - 'A' + 10;
+				else fail ("bad escape");
+			}
+			return u;
+		}
+
+		static void utf8 (string& out, unsigned u)
+		{
+			if (u < 0x80)
+				out += (char)u;
+			else if (u < 0x800)
+			{
+				out += (char)(0xc0 | (u >> 6));
+				out += (char)(0x80 | (u & 0x3f));
+			}else if (u < 0x10000)
+			{
+				out += (char)(0xe0 | (u >> 12));
+				out += (char)(0x80 | ((u >> 6) & 0x3f));
+				out += (char)(0x80 | (u & 0x3f));
+			}else
+			{
+				out += (char)(0xf0 | (u >> 18));
+				out += (char)(0x80 | ((u >> 12) & 0x3f));
+				out += (char)(0x80 | ((u >> 6) & 0x3f));
+				out += (char)(0x80 | (u & 0x3f));
+			}
+		}
+
+		string str ()
+		{
+			if (_pos >= _in.size() || '"' != _in[_pos])
+				fail ("string expected");
+			++_pos;
+			string out;
+			while (true)
+			{
+				if (_pos >= _in.size())
+					fail ("unterminated string");
+				char c = _in[_pos++];
+				if ('"' == c)
+					break;
+				if ('\\' != c)
+				{
+					out += c;
+					continue;
+				}
+				if (_pos >= _in.size())
+					fail ("unterminated string");
+				switch (_in[_pos++])
+				{
+					case '"': out += '"'; break;
+					case '\\': out += '\\'; break;
+					case '/': out += '/'; break;
+					case 'b': out += '\b'; break;
+					case 'f': out += '\f'; break;
+					case 'n': out += '\n'; break;
+					case 'r': out += '\r'; break;
+					case 't': out += '\t'; break;
+					case 'u':
+						{
+							unsigned u = hex4 ();
+							if (u >= 0xdc00 && u <= 0xdfff)
+								fail ("bad surrogate pair");
+							// surrogate pair
+							if (u >= 0xd800 && u < 0xdc00)
+							{
+								if (!keyword ("\\u"))
+									fail ("bad surrogate pair");
+								unsigned low = hex4 ();
+								if (low < 0xdc00 || low > 0xdfff)
+									fail ("bad surrogate pair");
+								u = 0x10000 + ((u - 0xd800) << 10) + (low - 0xdc00);
+							}
+							utf8 (out, u);
+						}
+						break;
+					default:
+						fail ("bad escape");
+				}
+			}
+			return out;
+		}
+	};
+
+	/** Escapes string for JSON output. */
+	string quote (const string& s)
+	{
+		string out ("\"");
+		for (string::const_iterator it = s.begin(); it != s.end(); ++it)
+		{
+			unsigned char c = *it;
+			switch (c)
+			{
+				case '"': out += "\\\""; break;
+				case '\\': out += "\\\\"; break;
+				case '\n': out += "\\n"; break;
+				case '\r': out += "\\r"; break;
+				case '\t': out += "\\t"; break;
+				default:
+					if (c < 0x20)
+					{
+						char buf[8];
+						snprintf (buf, sizeof (buf), "\\u%04x", c);
+						out += buf;
+					}else
+						out += c;
+			}
+		}
+		return out + "\"";
+	}
+
+	/** Response object being built. */
+	class Response
+	{
+		ostringstream _oss;
+
+	public:
+		Response (const Value* id)
+		{
+			_oss << "{\"id\":";
+			if (!id || Value::Null == id->type)
+				_oss << "null";
+			else if (Value::String == id->type)
+				_oss << quote (id->s);
+			else
+				_oss << id->n;
+		}
+
+		Response& add (const string& name, const string& value)
+			{ _oss << "," << quote (name) << ":" << quote (value); return *this; }
+		Response& add (const string& name, size_t value)
+			{ _oss << "," << quote (name) << ":" << value; return *this; }
+		Response& add (const string& name, bool value)
+			{ _oss << "," << quote (name) << ":" << (value ? "true" : "false"); return *this; }
+		/** Adds already formatted JSON value. */
+		Response& addRaw (const string& name, const string& json)
+			{ _oss << "," << quote (name) << ":" << json; return *this; }
+
+		string str () const
+			{ return _oss.str() + "}\n"; }
+	};
+
+
+	//
+	// Request parameters
+	//
+
+	const Value& param (const Value& req, const string& name)
+	{
+		const Value* v = req.get (name);
+		if (!v)
+			throw RequestError ("missing parameter " + name);
+		return *v;
+	}
+
+	string stringParam (const Value& req, const string& name)
+	{
+		const Value& v = param (req, name);
+		if (Value::String != v.type)
+			throw RequestError (name + " has to be a string");
+		return v.s;
+	}
+
+	string stringParam (const Value& req, const string& name, const string& def)
+		{ return req.get (name) ? stringParam (req, name) : def; }
+
+	size_t numberParam (const Value& req, const string& name, size_t def)
+	{
+		const Value* v = req.get (name);
+		if (!v)
+			return def;
+		// also rejects NaN
+		if (Value::Number != v->type || !(v->n >= 0))
+			throw RequestError (name + " has to be a non negative number");
+		// the cast is undefined for values out of range
+		if (v->n >= static_cast<double> (std::numeric_limits<size_t>::max()))
+			throw RequestError (name + " is out of range");
+		return static_cast<size_t> (v->n);
+	}
+
+	/** Returns string or array of strings parameter. */
+	vector<string> stringsParam (const Value& req, const string& name)
+	{
+		const Value& v = param (req, name);
+		vector<string> result;
+		if (Value::String == v.type)
+		{
+			result.push_back (v.s);
+			return result;
+		}
+		if (Value::Array == v.type)
+			for (Value::Items::const_iterator it = v.items.begin(); it != v.items.end(); ++it)
+			{
+				if (Value::String != it->type)
+					break;
+				result.push_back (it->s);
+			}
+		if (result.size() != v.items.size() || result.empty())
+			throw RequestError (name + " has to be a string or an array of strings");
+		return result;
+	}
+
+	vector<double> numbersParam (const Value& req, const string& name)
+	{
+		const Value& v = param (req, name);
+		vector<double> result;
+		if (Value::Number == v.type)
+			result.push_back (v.n);
+		else if (Value::Array == v.type)
+			for (Value::Items::const_iterator it = v.items.begin(); it != v.items.end(); ++it)
+			{
+				if (Value::Number != it->type)
+					throw RequestError (name + " has to be a number or an array of numbers");
+				result.push_back (it->n);
+			}
+		else
+			throw RequestError (name + " has to be a number or an array of numbers");
+		return result;
+	}
+
+	/** Returns checked page numbers, all pages if the parameter is missing. */
+	vector<size_t> pagesParam (const Value& req, size_t pageCount)
+	{
+		vector<size_t> pages;
+		if (!req.get ("pages"))
+		{
+			for (size_t i = 1; i <= pageCount; ++i)
+				pages.push_back (i);
+			return pages;
+		}
+		vector<double> nums = numbersParam (req, "pages");
+		for (vector<double>::const_iterator it = nums.begin(); it != nums.end(); ++it)
+		{
+			if (!(*it >= 1 && *it <= static_cast<double> (pageCount)))
+				throw RequestError ("invalid page number");
+			pages.push_back (static_cast<size_t> (*it));
+		}
+		return pages;
+	}
+
+
+	//
+	// Operations
+	//
+
+	/** Returns system fonts, they are looked up in the master before workers are forked. */
+	const CPageFonts::SystemFontList& systemFonts ()
+	{
+		static CPageFonts::SystemFontList fonts (CPageFonts::getSystemFonts ());
+		return fonts;
+	}
+
+	void copyFile (const string& from, const string& to)
+	{
+		ifstream in (from.c_str(), ios::binary);
+		if (!in)
+			throw RequestError ("unable to open " + from);
+		ofstream out (to.c_str(), ios::binary);
+		if (!out)
+			throw RequestError ("unable to create " + to);
+		out << in.rdbuf ();
+		if (!out)
+			throw RequestError ("unable to write " + to);
+	}
+
+	/**
+	 * Opens document for changes.
+	 *
+	 * The file is copied to the output first if it is given. Linearized
+	 * documents are delinearized the same way as add_text and replace_text
+	 * tools do it.
+	 *
+	 * @param file Name of the changed file (updated).
+	 */
+	shared_ptr<CPdf> openForChange (const Value& req, string& file)
+	{
+		file = stringParam (req, "file");
+		if (req.get ("output"))
+		{
+			string output = stringParam (req, "output");
+			copyFile (file, output);
+			file = output;
+		}
+
+		shared_ptr<CPdf> pdf = CPdf::getInstance (file.c_str(), CPdf::ReadWrite);
+		if (pdf->isLinearized())
+		{
+			pdf.reset ();
+			string out (file+"-delinearised.pdf");
+			{
+				shared_ptr<Delinearizator> del (Delinearizator::getInstance(file.c_str(), new OldStylePdfWriter));
+				if (!del || del->delinearize(out.c_str()))
+					throw RequestError ("unable to delinearize " + file);
+			}
+			file = out;
+			pdf = CPdf::getInstance (file.c_str(), CPdf::ReadWrite);
+		}
+		return pdf;
+	}
+
+	void opPdfToText (const Value& req, Response& resp)
+	{
+		string file = stringParam (req, "file");
+		string encoding = stringParam (req, "encoding", "UTF-8");
+		shared_ptr<CPdf> pdf = CPdf::getInstance (file.c_str(), CPdf::ReadOnly);
+		vector<size_t> pages = pagesParam (req, pdf->getPageCount());
+
+		ostringstream numbers, texts;
+		for (vector<size_t>::const_iterator it = pages.begin(); it != pages.end(); ++it)
+		{
+			shared_ptr<CPage> page = pdf->getPage (*it);
+			// use media box as pdf_to_text does
+			DisplayParams dp;
+			dp.useMediaBox = gTrue;
+			dp.crop = gFalse;
+			dp.rotate = page->getRotation ();
+			page->setDisplayParams (dp);
+
+			string text;
+			page->getText (text, &encoding);
+			const char* sep = (it == pages.begin()) ? "" : ",";
+			numbers << sep << *it;
+			texts << sep << quote (text);
+		}
+		resp.addRaw ("pages", "[" + numbers.str() + "]");
+		resp.addRaw ("text", "[" + texts.str() + "]");
+	}
+
+	void opFlatten (const Value& req, Response& resp)
+	{
+		string file = stringParam (req, "file");
+		string output = stringParam (req, "output", file + ".flatten");
+		shared_ptr<Flattener> flattener = Flattener::getInstance (file.c_str(), new OldStylePdfWriter());
+		if (!flattener)
+			throw RequestError ("unable to open " + file);
+		if (flattener->flatten (output.c_str()))
+			throw RequestError ("unable to write " + output);
+		resp.add ("output", output);
+	}
+
+	void opDelinearize (const Value& req, Response& resp)
+	{
+		string file = stringParam (req, "file");
+		string output = stringParam (req, "output");
+		shared_ptr<Delinearizator> del = Delinearizator::getInstance (file.c_str(), new OldStylePdfWriter());
+		if (!del)
+			throw RequestError ("unable to open " + file + " or it is not linearized");
+		if (del->delinearize (output.c_str()))
+			throw RequestError ("unable to write " + output);
+		resp.add ("output", output);
+	}
+
+	void opReplaceText (const Value& req, Response& resp)
+	{
+		vector<string> whats = stringsParam (req, "what");
+		vector<string> withs = stringsParam (req, "with");
+		if (whats.size() != withs.size())
+			throw RequestError ("what and with have to be of the same size");
+
+		string file;
+		shared_ptr<CPdf> pdf = openForChange (req, file);
+		size_t from = std::max (numberParam (req, "from", 1), (size_t)1);
+		size_t to = std::min (numberParam (req, "to", pdf->getPageCount()), (size_t)pdf->getPageCount());
+
+		size_t replaced = 0;
+		{
+			// content streams are saved once per page, not once per occurence
+			CPdf::Transaction transaction (pdf);
+			for (size_t i = from; i <= to; ++i)
+			{
+				shared_ptr<CPage> page = pdf->getPage (i);
+				for (size_t j = 0; j < whats.size(); ++j)
+					replaced += page->replaceText (whats[j], withs[j]);
+			}
+			transaction.commit ();
+		}
+		pdf->save ();
+		resp.add ("output", file).add ("replaced", replaced);
+	}
+
+	void opAddText (const Value& req, Response& resp)
+	{
+		string text = stringParam (req, "text");
+		string font_id = stringParam (req, "font", "Helvetica");
+		vector<double> pos = numbersParam (req, "position");
+		if (2 != pos.size())
+			throw RequestError ("position has to be [x, y]");
+		param (req, "pages");
+
+		string file;
+		shared_ptr<CPdf> pdf = openForChange (req, file);
+		vector<size_t> pages = pagesParam (req, pdf->getPageCount());
+
+		const CPageFonts::SystemFontList& fonts = systemFonts ();
+		bool systemFont = fonts.end() != std::find (fonts.begin(), fonts.end(), font_id);
+		{
+			CPdf::Transaction transaction (pdf);
+			for (vector<size_t>::const_iterator it = pages.begin(); it != pages.end(); ++it)
+			{
+				shared_ptr<CPage> page = pdf->getPage (*it);
+				string id = systemFont ? page->addSystemType1Font (font_id) : font_id;
+				page->addText (text, libs::Point (pos[0], pos[1]), id);
+			}
+			transaction.commit ();
+		}
+		pdf->save ();
+		resp.add ("output", file);
+	}
+
+	/**
+	 * Processes one request line and returns the response line.
+	 *
+	 * @param outOfMemory Set if the job exceeded the memory limit.
+	 */
+	string process (const string& line, bool& outOfMemory)
+	{
+		Value req;
+		const Value* id = NULL;
+		try
+		{
+			req = Parser (line).parse ();
+			if (Value::Object != req.type)
+				throw RequestError ("request has to be an object");
+			id = req.get ("id");
+			string op = stringParam (req, "op");
+
+			Response resp (id);
+			resp.add ("ok", true);
+			if ("ping" == op)
+				resp.add ("pid", (size_t)getpid ());
+			else if ("pdf_to_text" == op)
+				opPdfToText (req, resp);
+			else if ("flatten" == op)
+				opFlatten (req, resp);
+			else if ("delinearize" == op)
+				opDelinearize (req, resp);
+			else if ("replace_text" == op)
+				opReplaceText (req, resp);
+			else if ("add_text" == op)
+				opAddText (req, resp);
+			else
+				throw RequestError ("unknown operation " + op);
+			return resp.str ();
+
+		}catch (std::bad_alloc&)
+		{
+			outOfMemory = true;
+			return Response (id).add ("ok", false).add ("error", string ("memory limit exceeded")).str ();
+		}catch (std::exception& e)
+		{
+			return Response (id).add ("ok", false).add ("error", string (e.what())).str ();
+		}catch (...)
+		{
+			return Response (id).add ("ok", false).add ("error", string ("unknown error")).str ();
+		}
+	}
+
+
+	//
+	// Worker
+	//
+
+	/** Returns size of the address space of this process in bytes. */
+	size_t addressSpace ()
+	{
+		size_t pages = 0;
+		FILE* f = fopen ("/proc/self/statm", "r");
+		if (f)
+		{
+			if (1 != fscanf (f, "%zu", &pages))
+				pages = 0;
+			fclose (f);
+		}
+		return pages * sysconf (_SC_PAGESIZE);
+	}
+
+	bool writeAll (int fd, const string& data)
+	{
+		size_t done = 0;
+		while (done < data.size())
+		{
+			ssize_t ret = write (fd, data.data() + done, data.size() - done);
+			if (ret < 0 && EINTR == errno)
+				continue;
+			if (ret <= 0)
+				return false;
+			done += ret;
+		}
+		return true;
+	}
+
+	/**
+	 * Serves requests of one connection.
+	 *
+	 * @return false if the worker should retire.
+	 */
+	bool serve (int fd, const Config& cfg, size_t baseline, size_t& jobs)
+	{
+		string buffer;
+		char chunk[64*1024];
+		while (true)
+		{
+			size_t eol;
+			while (string::npos == (eol = buffer.find ('\n')))
+			{
+				if (buffer.size() > MAX_REQUEST_SIZE)
+				{
+					writeAll (fd, Response (NULL).add ("ok", false).add ("error", string ("request too long")).str());
+					return true;
+				}
+				ssize_t ret = read (fd, chunk, sizeof (chunk));
+				if (ret < 0 && EINTR == errno)
+					continue;
+				if (ret <= 0)
+					return true;
+				buffer.append (chunk, ret);
+			}
+
+			string line (buffer, 0, eol);
+			buffer.erase (0, eol + 1);
+			if (line.find_first_not_of (" \t\r") == string::npos)
+				continue;
+
+			bool retire = false;
+			string reply = process (line, retire);
+			++jobs;
+
+			// memory which was not given back stays with the worker
+			if (cfg.memoryLimit && addressSpace () > baseline + cfg.memoryLimit / 2)
+				retire = true;
+			if (!writeAll (fd, reply) || retire)
+				return !retire;
+		}
+	}
+
+	void worker (int listenFd, const Config& cfg)
+	{
+		signal (SIGTERM, SIG_DFL);
+		signal (SIGINT, SIG_DFL);
+		signal (SIGPIPE, SIG_IGN);
+
+		size_t baseline = addressSpace ();
+		if (cfg.memoryLimit && baseline)
+		{
+			struct rlimit rl;
+			rl.rlim_cur = rl.rlim_max = baseline + cfg.memoryLimit;
+			if (setrlimit (RLIMIT_AS, &rl))
+				perror ("setrlimit");
+		}
+
+		size_t jobs = 0;
+		while (!cfg.maxJobs || jobs < cfg.maxJobs)
+		{
+			int fd = accept (listenFd, NULL, NULL);
+			if (fd < 0)
+			{
+				if (EINTR == errno || ECONNABORTED == errno)
+					continue;
+				perror ("accept");
+				_exit (1);
+			}
+			bool ok = serve (fd, cfg, baseline, jobs);
+			close (fd);
+			if (!ok)
+				break;
+		}
+		// skip destructors of the state shared with the master
+		_exit (0);
+	}
+
+	pid_t spawn (int listenFd, const Config& cfg)
+	{
+		pid_t pid = fork ();
+		if (0 == pid)
+			worker (listenFd, cfg);
+		if (pid < 0)
+			perror ("fork");
+		return pid;
+	}
+
+
+	//
+	// Master
+	//
+
+	int listenOn (const string& path)
+	{
+		struct sockaddr_un addr;
+		if (path.size() >= sizeof (addr.sun_path))
+		{
+			cerr << "Socket path too long" << endl;
+			return -1;
+		}
+		memset (&addr, 0, sizeof (addr));
+		addr.sun_family = AF_UNIX;
+		strcpy (addr.sun_path, path.c_str());
+
+		int fd = socket (AF_UNIX, SOCK_STREAM, 0);
+		if (fd < 0)
+		{
+			perror ("socket");
+			return -1;
+		}
+		// remove stale socket
+		unlink (path.c_str());
+		// only the owner can talk to the daemon
+		mode_t mask = umask (0077);
+		int ret = bind (fd, (struct sockaddr*)&addr, sizeof (addr));
+		umask (mask);
+		if (ret || listen (fd, 64))
+		{
+			perror (path.c_str());
+			close (fd);
+			return -1;
+		}
+		return fd;
+	}
+
+	void run (int listenFd, const Config& cfg)
+	{
+		struct sigaction sa;
+		memset (&sa, 0, sizeof (sa));
+		sa.sa_handler = stopHandler;
+		sigemptyset (&sa.sa_mask);
+		// no SA_RESTART, waitpid has to be interrupted
+		sigaction (SIGTERM, &sa, NULL);
+		sigaction (SIGINT, &sa, NULL);
+		signal (SIGPIPE, SIG_IGN);
+
+		vector<pid_t> workers;
+		for (size_t i = 0; i < cfg.workers; ++i)
+			workers.push_back (spawn (listenFd, cfg));
+
+		while (!stopping)
+		{
+			int status;
+			pid_t pid = waitpid (-1, &status, 0);
+			if (pid < 0)
+			{
+				if (EINTR == errno)
+					continue;
+				perror ("waitpid");
+				break;
+			}
+			if (WIFSIGNALED (status) || (WIFEXITED (status) && WEXITSTATUS (status)))
+				cerr << "worker " << pid << " failed" << endl;
+			vector<pid_t>::iterator it = std::find (workers.begin(), workers.end(), pid);
+			if (it == workers.end())
+				continue;
+			// do not fork again and again if workers die immediately
+			if (WIFEXITED (status) && WEXITSTATUS (status))
+				sleep (1);
+			*it = spawn (listenFd, cfg);
+		}
+
+		for (vector<pid_t>::const_iterator it = workers.begin(); it != workers.end(); ++it)
+			if (*it > 0)
+				kill (*it, SIGTERM);
+		for (vector<pid_t>::const_iterator it = workers.begin(); it != workers.end(); ++it)
+			if (*it > 0)
+				waitpid (*it, NULL, 0);
+	}
+
+	// library wrapper
+	struct _pdf_lib {
+		bool _ok;
+		_pdf_lib (int argc, char ** argv, const string& font_dir) {
+			struct pdfedit_core_dev_init init;
+			init.cfgFileName = NULL;
+			init.fontDir = font_dir.c_str();
+			_ok = (0 == pdfedit_core_dev_init(&argc, &argv, &init));
+		}
+		~_pdf_lib () {pdfedit_core_dev_destroy();}
+	};
+
+} // namespace
+
+int
+main(int argc, char ** argv)
+{
+	//
+	// parameter parsing
+	//
+	po::options_description desc("Allowed options");
+	desc.add_options()
+		("help", "produce help message")
+		("socket", po::value<string>()->default_value(DEFAULT_SOCKET), "unix domain socket to listen on")
+		("workers", po::value<size_t>()->default_value(DEFAULT_WORKERS), "number of worker processes")
+		("memory-limit", po::value<size_t>()->default_value(DEFAULT_MEMORY_LIMIT), "memory available to one job in MB (0 unlimited)")
+		("max-jobs", po::value<size_t>()->default_value(DEFAULT_MAX_JOBS), "jobs served by a worker before it is replaced (0 unlimited)")
+		("font-dir", po::value<string>()->default_value(DEFAULT_FONT_DIR), "(xpdf) font directory with font definitions(e.g. N019003L.PFB)")
+	;
+
+	po::variables_map vm;
+	try {
+		po::store(po::parse_command_line(argc, argv, desc), vm);
+		po::notify(vm);
+	}catch(std::exception& e)
+	{
+		std::cout << "exception - " << e.what() << ". Please, check your parameters." << endl;
+		return 1;
+	}
+		if (vm.count("help"))
+		{
+			cout << desc << endl;
+			return 1;
+		}
+
+	Config cfg;
+	cfg.socket = vm["socket"].as<string>();
+	cfg.workers = std::max (vm["workers"].as<size_t>(), (size_t)1);
+	cfg.memoryLimit = vm["memory-limit"].as<size_t>() * 1024 * 1024;
+	cfg.maxJobs = vm["max-jobs"].as<size_t>();
+	string font_dir = vm["font-dir"].as<string>();
+
+	// pdf lib init is shared by all workers
+	_pdf_lib _lib(argc, argv, font_dir);
+		if (!_lib._ok)
+			return 1;
+	systemFonts ();
+
+	int fd = listenOn (cfg.socket);
+		if (fd < 0)
+			return 1;
+
+	run (fd, cfg);
+
+	close (fd);
+	unlink (cfg.socket.c_str());
+	return 0;
+}
@@ -24,6 +24,11 @@
 // vim:tabstop=4:shiftwidth=4:noexpandtab:textwidth=80
 #include "kernel/static.h" // WIN32 port - precompiled headers - REMOVE IN FUTURE!
 #include "debug.h"
+#include <deque>
+#include <stdlib.h>
+#ifndef WIN32
+#include <pthread.h>
+#endif
 
 /** Prefix for debug messages. */
 #define DEBUG_PREFIX "DEBUG"
@@ -34,6 +39,176 @@ namespace debug
 DebugTarget kernelDebugTarget;
 DebugTarget guiDebugTarget;
 DebugTarget utilsDebugTarget;
+
+#ifndef WIN32
+namespace {
+
+/** Message waiting for the output. */
+struct PendingMsg
+{
+	std::ostream * stream;
+	std::string msg;
+};
+typedef std::deque<PendingMsg> PendingQueue;
+
+/** Protects the asynchronous log state (and the streams if it doesn't run). */
+pthread_mutex_t logMutex = PTHREAD_MUTEX_INITIALIZER;
+/** Held while queued messages are written, so that their order is kept.
+ * Always locked before logMutex.
+ */
+pthread_mutex_t outputMutex = PTHREAD_MUTEX_INITIALIZER;
+/** Signals new messages (or stop) to the writer thread. */
+pthread_cond_t logCond = PTHREAD_COND_INITIALIZER;
+pthread_t writerThread;
+bool asyncRunning = false;
+bool stopRequested = false;
+bool atExitRegistered = false;
+size_t maxPendingMsgs = 0;
+size_t droppedMsgs = 0;
+PendingQueue pendingMsgs;
+
+/** Writes and flushes given messages and reports dropped ones. */
+void writePending(PendingQueue & batch, size_t dropped)
+{
+	for(PendingQueue::iterator i = batch.begin(); i != batch.end(); ++i)
+		*(i->stream) << i->msg;
+	if(dropped)
+		std::cerr << DBG_WARN << ":DEBUG: " << dropped << " debug messages dropped\n";
+	for(PendingQueue::iterator i = batch.begin(); i != batch.end(); ++i)
+		i->stream->flush();
+	std::cerr.flush();
+	batch.clear();
+}
+
+/** Writes queued messages until stop is requested.
+ * Messages are taken in batches so that logMutex is not held during the
+ * output.
+ */
+void * writerMain(void *)
+{
+	PendingQueue batch;
+	for(;;)
+	{
+		pthread_mutex_lock(&logMutex);
+		while(pendingMsgs.empty() && !droppedMsgs && !stopRequested)
+			pthread_cond_wait(&logCond, &logMutex);
+		if(pendingMsgs.empty() && !droppedMsgs)
+		{
+			// following messages are written directly
+			asyncRunning = false;
+			pthread_mutex_unlock(&logMutex);
+			break;
+		}
+		pthread_mutex_unlock(&logMutex);
+
+		// the queue could have been written by writeDbg meanwhile
+		pthread_mutex_lock(&outputMutex);
+		pthread_mutex_lock(&logMutex);
+		batch.swap(pendingMsgs);
+		size_t dropped = droppedMsgs;
+		droppedMsgs = 0;
+		pthread_mutex_unlock(&logMutex);
+		writePending(batch, dropped);
+		pthread_mutex_unlock(&outputMutex);
+	}
+	return NULL;
+}
+
+void stopAsyncLogAtExit()
+{
+	stopAsyncLog();
+}
+
+} // namespace
+#endif
+
+void writeDbg(DebugTarget & target, unsigned int level, const std::string & msg)
+{
+#ifndef WIN32
+	if(level <= DBG_ERR)
+	{
+		// Errors must not be dropped nor lost in the queue if the program
+		// crashes, so they are written directly (after all queued messages)
+		pthread_mutex_lock(&outputMutex);
+		pthread_mutex_lock(&logMutex);
+		PendingQueue batch;
+		batch.swap(pendingMsgs);
+		size_t dropped = droppedMsgs;
+		droppedMsgs = 0;
+		writePending(batch, dropped);
+		target.stream << msg << std::flush;
+		pthread_mutex_unlock(&logMutex);
+		pthread_mutex_unlock(&outputMutex);
+		return;
+	}
+	pthread_mutex_lock(&logMutex);
+	if(asyncRunning)
+	{
+		if(pendingMsgs.size() < maxPendingMsgs)
+		{
+			PendingMsg pending;
+			pending.stream = &target.stream;
+			pendingMsgs.push_back(pending);
+			pendingMsgs.back().msg = msg;
+			if(pendingMsgs.size() == 1)
+				pthread_cond_signal(&logCond);
+		}else
+			++droppedMsgs;
+		pthread_mutex_unlock(&logMutex);
+		return;
+	}
+	target.stream << msg << std::flush;
+	pthread_mutex_unlock(&logMutex);
+#else
+	target.stream << msg << std::flush;
+#endif
+}
+
+bool startAsyncLog(size_t maxPending)
+{
+#ifndef WIN32
+	pthread_mutex_lock(&logMutex);
+	if(asyncRunning || stopRequested)
+	{
+		// already running or being stopped
+		bool running = asyncRunning && !stopRequested;
+		if(running)
+			maxPendingMsgs = maxPending;
+		pthread_mutex_unlock(&logMutex);
+		return running;
+	}
+	maxPendingMsgs = maxPending;
+	asyncRunning = !pthread_create(&writerThread, NULL, writerMain, NULL);
+	if(asyncRunning && !atExitRegistered)
+		atExitRegistered = !atexit(stopAsyncLogAtExit);
+	bool running = asyncRunning;
+	pthread_mutex_unlock(&logMutex);
+	return running;
+#else
+	return false;
+#endif
+}
+
+void stopAsyncLog()
+{
+#ifndef WIN32
+	pthread_mutex_lock(&logMutex);
+	if(!asyncRunning || stopRequested)
+	{
+		pthread_mutex_unlock(&logMutex);
+		return;
+	}
+	// writer thread writes everything what is pending before it ends
+	stopRequested = true;
+	pthread_cond_signal(&logCond);
+	pthread_mutex_unlock(&logMutex);
+	pthread_join(writerThread, NULL);
+
+	pthread_mutex_lock(&logMutex);
+	stopRequested = false;
+	pthread_mutex_unlock(&logMutex);
+#endif
+}
   
 unsigned int changeDebugLevel(DebugTarget & debugTarget, unsigned int level)
 {
@@ -28,6 +28,7 @@
 #include <iostream>
 #include <string>
 #include <iomanip>
+#include <sstream>
 
 // =============================================================================
 namespace debug {
@@ -63,6 +64,16 @@ template<> struct CompileTimeChecker<true> { CompileTimeChecker(...) {} };
 #define DEFAULT_DEBUG_LEVEL debug::DBG_ERR
 #endif
 
+/** Maximum debug level compiled in.
+ * Messages with higher priority number are eliminated by compiler (their
+ * arguments are not evaluated at all) and no runtime debugLevel can enable
+ * them. Configure sets it for release builds (--with-max-debug-level), all
+ * messages are compiled in by default.
+ */
+#ifndef MAX_DEBUG_LEVEL
+#define MAX_DEBUG_LEVEL debug::DBG_DBG
+#endif
+
 /** Panic situation priority.
  * After this kind of message, program usually ends without any resonable
  * rescue routines. It should contain the cause of this state.
@@ -132,6 +143,41 @@ struct DebugTarget
 	DebugTarget(unsigned int level, std::ostream & s): debugLevel(level), stream(s) {}
 };
 
+/** Writes formatted message to the target stream.
+ * @param target Target for the message.
+ * @param level Priority of the message.
+ * @param msg Complete message (including new line).
+ *
+ * Message goes to the asynchronous log if it is running, otherwise it is
+ * written (and flushed) directly. Messages with DBG_ERR or higher priority
+ * are always written directly, after all queued ones. Messages from
+ * different threads are never interleaved.
+ */
+void writeDbg(DebugTarget & target, unsigned int level, const std::string & msg);
+
+/** Starts asynchronous logging.
+ * @param maxPending Maximum number of messages waiting for output.
+ *
+ * All following debug messages are just queued and a background thread
+ * writes them to their target streams, so that callers don't wait for
+ * the output. When the queue is full, messages are dropped and their number
+ * is reported later (errors are never queued nor dropped, see writeDbg).
+ * Pending messages are written at exit or by stopAsyncLog.
+ * <br>
+ * Don't use with fork (the background thread doesn't exist in the child
+ * process).
+ *
+ * @return true if asynchronous logging is running, false if it is not
+ * supported on this platform.
+ */
+bool startAsyncLog(size_t maxPending = 10000);
+
+/** Stops asynchronous logging.
+ * Writes all pending messages and waits for the background thread.
+ * Following messages are written directly again.
+ */
+void stopAsyncLog();
+
 /** Debug target for kernel. */
 extern DebugTarget kernelDebugTarget;
 /** Debug target for gui. */
@@ -225,15 +271,18 @@ void changeDebugLevel(unsigned int level);
  * @code
  * priority:prefix:fileName:functionName:line: message
  * @endcode
+ * Messages above MAX_DEBUG_LEVEL are compiled out.
  */
 #define _printDbg(prefix, level, target, msg)					\
 	do {									\
-	if (target.debugLevel >= level) { 					\
-		target.stream << level <<":"<<prefix<<":"			\
+	if ((level) <= MAX_DEBUG_LEVEL && target.debugLevel >= level) { 	\
+		std::ostringstream _dbgStream;					\
+		_dbgStream << level <<":"<<prefix<<":"				\
 		    << __FILE__ << ":" << __FUNCTION__ <<":"<< __LINE__ 	\
 			<< ": "							\
 			<<  msg 						\
-			<< std::endl;						\
+			<< "\n";						\
+		debug::writeDbg(target, (level), _dbgStream.str());			\
 	}									\
 	}while(0)
 
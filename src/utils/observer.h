@@ -310,6 +310,20 @@ public:
 	 */
 	virtual priority_t getPriority()const throw() =0;
 
+	/** Checks whether notification can't be postponed.
+	 *
+	 * Observer handler may collect changes and notify observers later (e.g.
+	 * at the end of a transaction). Observers which keep internal structures
+	 * consistent with the change should return true to be notified
+	 * immediately.
+	 *
+	 * @return false by default.
+	 */
+	virtual bool isSynchronous()const throw()
+	{
+		return false;
+	}
+
 	/** Sets active flag value.
 	 * @param active Flag value to be set.
 	 * @return previous value of the flag.
@@ -0,0 +1,260 @@
+/*
+ * PDFedit - free program for PDF document manipulation.
+ * Copyright (C) 2006-2009  PDFedit team: Michal Hocko,
+ *                                        Jozef Misutka,
+ *                                        Martin Petricek
+ *                   Former team members: Miroslav Jahoda
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program (in doc/LICENSE.GPL); if not, write to the 
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, 
+ * MA  02111-1307  USA
+ *
+ * Project is hosted on http://sourceforge.net/projects/pdfedit
+ */
+// vim:tabstop=4:shiftwidth=4:noexpandtab:textwidth=80
+#include "kernel/static.h" // WIN32 port - precompiled headers - REMOVE IN FUTURE!
+#include "trace.h"
+#include <vector>
+#include <set>
+#include <string>
+#include <stdio.h>
+#include <stdlib.h>
+#ifndef WIN32
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+namespace trace
+{
+
+volatile bool enabled = false;
+
+#ifndef WIN32
+namespace {
+
+/** Names of counters in the output. */
+const char * counterNames[COUNTER_COUNT] = {
+	"objects_fetched",
+	"bytes_decoded",
+	"operators_parsed"
+};
+
+/** Recorded event. */
+struct Event
+{
+	const char * name;
+	const char * category;
+	/** 'X' for complete event, 'C' for counters. */
+	char phase;
+	int tid;
+	double ts;
+	double dur;
+	/** Counter values for 'C' event. */
+	long values[COUNTER_COUNT];
+};
+typedef std::vector<Event> Events;
+
+/** Protects everything below. */
+pthread_mutex_t traceMutex = PTHREAD_MUTEX_INITIALIZER;
+Events events;
+size_t droppedEvents = 0;
+std::string outputFile;
+long counters[COUNTER_COUNT];
+bool countersChanged = false;
+int lastTid = 0;
+bool atExitRegistered = false;
+
+/** Small per-thread id used as tid in the output. */
+__thread int threadId = 0;
+
+int currentTid()
+{
+	if(!threadId)
+		threadId = ++lastTid;
+	return threadId;
+}
+
+/** Adds event, traceMutex has to be locked. */
+void addEvent(const Event & event)
+{
+	if(events.size() < MAX_EVENTS)
+		events.push_back(event);
+	else
+		++droppedEvents;
+}
+
+void stopAtExit()
+{
+	stop();
+}
+
+/** Starts tracing when environment variable is set. */
+struct EnvStarter
+{
+	EnvStarter()
+	{
+		const char * file = getenv(TRACE_ENV);
+		if(file && *file)
+			start(file);
+	}
+} envStarter;
+
+} // namespace
+
+double now()
+{
+	timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (double)t.tv_sec * 1000000 + t.tv_nsec / 1000;
+}
+
+bool start(const char * fileName)
+{
+	pthread_mutex_lock(&traceMutex);
+	if(enabled)
+	{
+		pthread_mutex_unlock(&traceMutex);
+		return false;
+	}
+	events.clear();
+	droppedEvents = 0;
+	outputFile = fileName;
+	for(int i = 0; i < COUNTER_COUNT; ++i)
+		counters[i] = 0;
+	countersChanged = false;
+	if(!atExitRegistered)
+		atExitRegistered = !atexit(stopAtExit);
+	enabled = true;
+	pthread_mutex_unlock(&traceMutex);
+	return true;
+}
+
+bool stop()
+{
+	pthread_mutex_lock(&traceMutex);
+	if(!enabled)
+	{
+		pthread_mutex_unlock(&traceMutex);
+		return false;
+	}
+	enabled = false;
+	Events written;
+	written.swap(events);
+	size_t dropped = droppedEvents;
+	std::string fileName = outputFile;
+	pthread_mutex_unlock(&traceMutex);
+
+	FILE * f = fopen(fileName.c_str(), "w");
+	if(!f)
+		return false;
+	int pid = getpid();
+	fprintf(f, "{\"displayTimeUnit\": \"ms\", \"droppedEvents\": %lu, \"traceEvents\": [\n",
+			(unsigned long)dropped);
+	std::set<int> tids;
+	bool first = true;
+	for(Events::const_iterator i = written.begin(); i != written.end(); ++i)
+	{
+		if('X' == i->phase)
+		{
+			fprintf(f, "%s{\"name\": \"%s\", \"cat\": \"%s\", \"ph\": \"X\", "
+					"\"ts\": %.0f, \"dur\": %.0f, \"pid\": %d, \"tid\": %d}",
+					first ? "" : ",\n", i->name, i->category, i->ts, i->dur,
+					pid, i->tid);
+			tids.insert(i->tid);
+		}else
+		{
+			fprintf(f, "%s{\"name\": \"counters\", \"ph\": \"C\", \"ts\": %.0f, "
+					"\"pid\": %d, \"args\": {", first ? "" : ",\n", i->ts, pid);
+			for(int c = 0; c < COUNTER_COUNT; ++c)
+				fprintf(f, "%s\"%s\": %ld", c ? ", " : "", counterNames[c], i->values[c]);
+			fprintf(f, "}}");
+		}
+		first = false;
+	}
+	for(std::set<int>::const_iterator i = tids.begin(); i != tids.end(); ++i)
+	{
+		fprintf(f, "%s{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": %d, "
+				"\"tid\": %d, \"args\": {\"name\": \"thread %d\"}}",
+				first ? "" : ",\n", pid, *i, *i);
+		first = false;
+	}
+	fprintf(f, "\n]}\n");
+	return !fclose(f);
+}
+
+void complete(const char * name, const char * category, double start)
+{
+	Event event;
+	event.name = name;
+	event.category = category;
+	event.phase = 'X';
+	event.ts = start;
+	event.dur = now() - start;
+
+	pthread_mutex_lock(&traceMutex);
+	// tracing may have been stopped since the scope started
+	if(enabled)
+	{
+		event.tid = currentTid();
+		addEvent(event);
+		if(countersChanged)
+		{
+			// counters are recorded at the end of the scope which changed them
+			event.phase = 'C';
+			event.ts += event.dur;
+			for(int i = 0; i < COUNTER_COUNT; ++i)
+				event.values[i] = counters[i];
+			addEvent(event);
+			countersChanged = false;
+		}
+	}
+	pthread_mutex_unlock(&traceMutex);
+}
+
+void addCount(Counter counter, long delta)
+{
+	pthread_mutex_lock(&traceMutex);
+	counters[counter] += delta;
+	countersChanged = true;
+	pthread_mutex_unlock(&traceMutex);
+}
+
+#else
+
+double now()
+{
+	return 0;
+}
+
+bool start(const char *)
+{
+	return false;
+}
+
+bool stop()
+{
+	return false;
+}
+
+void complete(const char *, const char *, double)
+{
+}
+
+void addCount(Counter, long)
+{
+}
+
+#endif
+
+} // namespace trace
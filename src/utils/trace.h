@@ -0,0 +1,137 @@
+/*
+ * PDFedit - free program for PDF document manipulation.
+ * Copyright (C) 2006-2009  PDFedit team: Michal Hocko,
+ *                                        Jozef Misutka,
+ *                                        Martin Petricek
+ *                   Former team members: Miroslav Jahoda
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program (in doc/LICENSE.GPL); if not, write to the 
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, 
+ * MA  02111-1307  USA
+ *
+ * Project is hosted on http://sourceforge.net/projects/pdfedit
+ */
+// vim:tabstop=4:shiftwidth=4:noexpandtab:textwidth=80
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <cstddef>
+
+/** Tracing of hot paths.
+ * Scoped trace points and counters are collected in memory and written as
+ * Chrome trace_event JSON (loadable by chrome://tracing or Perfetto) when
+ * tracing stops. Each thread has its own timeline.
+ * <br>
+ * Tracing is enabled by start or by setting PDFEDIT_TRACE environment
+ * variable to the output file name (file is written at exit). When it is
+ * disabled, trace point costs just one test of a global flag.
+ */
+namespace trace
+{
+
+/** Counters collected by trace points. */
+enum Counter
+{
+	OBJECTS_FETCHED = 0,	/**< Objects fetched from xref. */
+	BYTES_DECODED,			/**< Bytes of stream data decoded by kernel. */
+	OPERATORS_PARSED,		/**< Content stream operators parsed. */
+	COUNTER_COUNT
+};
+
+/** Name of the environment variable with the output file. */
+#define TRACE_ENV "PDFEDIT_TRACE"
+
+/** Maximum number of events kept in memory.
+ * Following events are dropped and their number is reported in the output.
+ */
+const size_t MAX_EVENTS = 1000000;
+
+/** Flag whether tracing is running.
+ * Don't change directly, use start and stop.
+ */
+extern volatile bool enabled;
+
+/** Starts tracing.
+ * @param fileName Output file name.
+ *
+ * Previously collected events are discarded. Events are written to the file
+ * by stop (which is also called at exit).
+ *
+ * @return false if tracing is already running or it is not supported on
+ * this platform, true otherwise.
+ */
+bool start(const char * fileName);
+
+/** Stops tracing and writes collected events.
+ * @return true if events have been written, false otherwise.
+ */
+bool stop();
+
+/** Records complete event.
+ * @param name Event name (has to be a string literal).
+ * @param category Event category (has to be a string literal).
+ * @param start Start time in microseconds (see now).
+ */
+void complete(const char * name, const char * category, double start);
+
+/** Adds delta to the counter (slow path of count). */
+void addCount(Counter counter, long delta);
+
+/** Returns monotonic time in microseconds. */
+double now();
+
+/** Adds delta to the counter if tracing is running.
+ * Changed counter values are recorded when the next trace scope ends.
+ */
+inline void count(Counter counter, long delta = 1)
+{
+	if(enabled)
+		addCount(counter, delta);
+}
+
+/** Trace point covering lifetime of the instance.
+ * Use TRACE_SCOPE macro rather than this class directly.
+ */
+class Scope
+{
+	const char * name;
+	const char * category;
+	double startTime;
+	bool active;
+public:
+	Scope(const char * n, const char * c)
+		: name(n), category(c), startTime(0), active(enabled)
+	{
+		if(active)
+			startTime = now();
+	}
+	~Scope()
+	{
+		if(active)
+			complete(name, category, startTime);
+	}
+};
+
+} // namespace trace
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+
+/** Traces the rest of the current block.
+ * @param category Category of the event (string literal).
+ * @param name Name of the event (string literal).
+ */
+#define TRACE_SCOPE(category, name)	\
+	trace::Scope TRACE_CONCAT(_traceScope, __LINE__) (name, category)
+
+#endif
@@ -24,6 +24,7 @@
 #include "splash/SplashPattern.h"
 #include "splash/SplashScreen.h"
 #include "splash/SplashFont.h"
+#include "splash/SplashDisplayList.h"
 #include "splash/SplashGlyphBitmap.h"
 #include "splash/Splash.h"
 
@@ -790,6 +791,8 @@ Splash::Splash(SplashBitmap *bitmapA, GBool vectorAntialiasA,
   }
   clearModRegion();
   debugMode = gFalse;
+  displayList = NULL;
+  bandThreads = 1;
 }
 
 Splash::Splash(SplashBitmap *bitmapA, GBool vectorAntialiasA,
@@ -813,9 +816,39 @@ Splash::Splash(SplashBitmap *bitmapA, GBool vectorAntialiasA,
   }
   clearModRegion();
   debugMode = gFalse;
+  displayList = NULL;
+  bandThreads = 1;
+}
+
+Splash::Splash(SplashBitmap *bitmapA, GBool vectorAntialiasA,
+	       SplashState *stateA, int bandY0, int bandY1) {
+  int i;
+
+  bitmap = bitmapA;
+  vectorAntialias = vectorAntialiasA;
+  state = stateA->copy();
+  state->clip->clipToRect(0, bandY0, bitmap->width - 0.001, bandY1 - 0.001);
+  if (vectorAntialias) {
+    aaBuf = new SplashBitmap(splashAASize * bitmap->width, splashAASize,
+			     1, splashModeMono1, gFalse);
+    for (i = 0; i <= splashAASize * splashAASize; ++i) {
+      aaGamma[i] = splashPow((SplashCoord)i /
+			       (SplashCoord)(splashAASize * splashAASize),
+			     1.5);
+    }
+  } else {
+    aaBuf = NULL;
+  }
+  clearModRegion();
+  debugMode = gFalse;
+  displayList = NULL;
+  bandThreads = 1;
 }
 
 Splash::~Splash() {
+  if (displayList) {
+    delete displayList;
+  }
   while (state->next) {
     restoreState();
   }
@@ -906,50 +939,86 @@ GBool Splash::getInNonIsolatedGroup() {
 //------------------------------------------------------------------------
 
 void Splash::setMatrix(SplashCoord *matrix) {
+  if (displayList) {
+    displayList->setMatrix(matrix);
+  }
   memcpy(state->matrix, matrix, 6 * sizeof(SplashCoord));
 }
 
 void Splash::setStrokePattern(SplashPattern *strokePattern) {
+  if (displayList) {
+    displayList->setStrokePattern(strokePattern);
+  }
   state->setStrokePattern(strokePattern);
 }
 
 void Splash::setFillPattern(SplashPattern *fillPattern) {
+  if (displayList) {
+    displayList->setFillPattern(fillPattern);
+  }
   state->setFillPattern(fillPattern);
 }
 
 void Splash::setScreen(SplashScreen *screen) {
+  if (displayList) {
+    displayList->setScreen(screen);
+  }
   state->setScreen(screen);
 }
 
 void Splash::setBlendFunc(SplashBlendFunc func) {
+  if (displayList) {
+    displayList->setBlendFunc(func);
+  }
   state->blendFunc = func;
 }
 
 void Splash::setStrokeAlpha(SplashCoord alpha) {
+  if (displayList) {
+    displayList->setStrokeAlpha(alpha);
+  }
   state->strokeAlpha = alpha;
 }
 
 void Splash::setFillAlpha(SplashCoord alpha) {
+  if (displayList) {
+    displayList->setFillAlpha(alpha);
+  }
   state->fillAlpha = alpha;
 }
 
 void Splash::setLineWidth(SplashCoord lineWidth) {
+  if (displayList) {
+    displayList->setLineWidth(lineWidth);
+  }
   state->lineWidth = lineWidth;
 }
 
 void Splash::setLineCap(int lineCap) {
+  if (displayList) {
+    displayList->setLineCap(lineCap);
+  }
   state->lineCap = lineCap;
 }
 
 void Splash::setLineJoin(int lineJoin) {
+  if (displayList) {
+    displayList->setLineJoin(lineJoin);
+  }
   state->lineJoin = lineJoin;
 }
 
 void Splash::setMiterLimit(SplashCoord miterLimit) {
+  if (displayList) {
+    displayList->setMiterLimit(miterLimit);
+  }
   state->miterLimit = miterLimit;
 }
 
 void Splash::setFlatness(SplashCoord flatness) {
+  if (displayList) {
+    displayList->setFlatness(flatness);
+  }
   if (flatness < 1) {
     state->flatness = 1;
   } else {
@@ -959,33 +1028,58 @@ void Splash::setFlatness(SplashCoord flatness) {
 
 void Splash::setLineDash(SplashCoord *lineDash, int lineDashLength,
 			 SplashCoord lineDashPhase) {
+  if (displayList) {
+    displayList->setLineDash(lineDash, lineDashLength, lineDashPhase);
+  }
   state->setLineDash(lineDash, lineDashLength, lineDashPhase);
 }
 
 void Splash::setStrokeAdjust(GBool strokeAdjust) {
+  if (displayList) {
+    displayList->setStrokeAdjust(strokeAdjust);
+  }
   state->strokeAdjust = strokeAdjust;
 }
 
 void Splash::clipResetToRect(SplashCoord x0, SplashCoord y0,
 			     SplashCoord x1, SplashCoord y1) {
+  if (displayList) {
+    displayList->clipResetToRect(x0, y0, x1, y1);
+  }
   state->clip->resetToRect(x0, y0, x1, y1);
 }
 
 SplashError Splash::clipToRect(SplashCoord x0, SplashCoord y0,
 			       SplashCoord x1, SplashCoord y1) {
+  if (displayList) {
+    displayList->clipToRect(x0, y0, x1, y1);
+  }
   return state->clip->clipToRect(x0, y0, x1, y1);
 }
 
 SplashError Splash::clipToPath(SplashPath *path, GBool eo) {
+  if (displayList) {
+    displayList->clipToPath(path, eo);
+  }
   return state->clip->clipToPath(path, state->matrix, state->flatness, eo);
 }
 
 void Splash::setSoftMask(SplashBitmap *softMask) {
+  if (displayList) {
+    if (softMask) {
+      finishBandRendering();
+    } else {
+      displayList->clearSoftMask();
+    }
+  }
   state->setSoftMask(softMask);
 }
 
 void Splash::setInNonIsolatedGroup(SplashBitmap *alpha0BitmapA,
 				   int alpha0XA, int alpha0YA) {
+  if (displayList) {
+    finishBandRendering();
+  }
   alpha0Bitmap = alpha0BitmapA;
   alpha0X = alpha0XA;
   alpha0Y = alpha0YA;
@@ -997,6 +1091,9 @@ void Splash::setInNonIsolatedGroup(SplashBitmap *alpha0BitmapA,
 //------------------------------------------------------------------------
 
 void Splash::saveState() {
+  if (displayList) {
+    displayList->saveState();
+  }
   SplashState *newState;
 
   newState = state->copy();
@@ -1010,6 +1107,9 @@ SplashError Splash::restoreState() {
   if (!state->next) {
     return splashErrNoSave;
   }
+  if (displayList) {
+    displayList->restoreState();
+  }
   oldState = state;
   state = state->next;
   delete oldState;
@@ -1025,6 +1125,10 @@ void Splash::clear(SplashColorPtr color, Guchar alpha) {
   Guchar mono;
   int x, y;
 
+  if (displayList) {
+    finishBandRendering();
+  }
+
   switch (bitmap->mode) {
   case splashModeMono1:
     mono = (color[0] & 0x80) ? 0xff : 0x00;
@@ -1133,6 +1237,10 @@ SplashError Splash::stroke(SplashPath *path) {
   if (path->length == 0) {
     return splashErrEmptyPath;
   }
+  if (displayList) {
+    displayList->stroke(path);
+    return splashOk;
+  }
   path2 = flattenPath(path, state->matrix, state->flatness);
   if (state->lineDashLength > 0) {
     dPath = makeDashedPath(path2);
@@ -1482,6 +1590,13 @@ SplashError Splash::fill(SplashPath *path, GBool eo) {
     printf("fill [eo:%d]:\n", eo);
     dumpPath(path);
   }
+  if (displayList) {
+    if (path->length == 0) {
+      return splashErrEmptyPath;
+    }
+    displayList->fill(path, eo);
+    return splashOk;
+  }
   return fillWithPattern(path, eo, state->fillPattern, state->fillAlpha);
 }
 
@@ -1569,6 +1684,14 @@ SplashError Splash::xorFill(SplashPath *path, GBool eo) {
   SplashClipResult clipRes, clipRes2;
   SplashBlendFunc origBlendFunc;
 
+  if (displayList) {
+    if (path->length == 0) {
+      return splashErrEmptyPath;
+    }
+    displayList->xorFill(path, eo);
+    return splashOk;
+  }
+
   if (path->length == 0) {
     return splashErrEmptyPath;
   }
@@ -1667,6 +1790,11 @@ SplashError Splash::fillGlyph2(int x0, int y0, SplashGlyphBitmap *glyph) {
   Guchar *p;
   int x1, y1, xx, xx1, yy;
 
+  if (displayList) {
+    displayList->fillGlyph(x0, y0, glyph);
+    return splashOk;
+  }
+
   if ((clipRes = state->clip->testRect(x0 - glyph->x,
 				       y0 - glyph->y,
 				       x0 - glyph->x + glyph->w - 1,
@@ -1801,6 +1929,11 @@ SplashError Splash::fillImageMask(SplashImageMaskSource src, void *srcData,
     return splashErrSingularMatrix;
   }
 
+  if (displayList) {
+    displayList->fillImageMask(src, srcData, w, h, mat, glyphMode);
+    return splashOk;
+  }
+
   // compute scale, shear, rotation, translation parameters
   rot = splashAbs(mat[1]) > splashAbs(mat[0]);
   if (rot) {
@@ -2120,6 +2253,11 @@ SplashError Splash::drawImage(SplashImageSource src, void *srcData,
     return splashErrSingularMatrix;
   }
 
+  if (displayList) {
+    displayList->drawImage(src, srcData, srcMode, srcAlpha, w, h, mat);
+    return splashOk;
+  }
+
   // compute scale, shear, rotation, translation parameters
   rot = splashAbs(mat[1]) > splashAbs(mat[0]);
   if (rot) {
@@ -2784,6 +2922,10 @@ SplashError Splash::composite(SplashBitmap *src, int xSrc, int ySrc,
   Guchar *ap;
   int x, y;
 
+  if (displayList) {
+    finishBandRendering();
+  }
+
   if (src->mode != bitmap->mode) {
     return splashErrModeMismatch;
   }
@@ -2836,6 +2978,10 @@ void Splash::compositeBackground(SplashColorPtr color) {
   Guchar alpha, alpha1, c, color0, color1, color2, color3;
   int x, y, mask;
 
+  if (displayList) {
+    finishBandRendering();
+  }
+
   switch (bitmap->mode) {
   case splashModeMono1:
     color0 = color[0];
@@ -2923,6 +3069,10 @@ SplashError Splash::blitTransparent(SplashBitmap *src, int xSrc, int ySrc,
   Guchar *q;
   int x, y, mask;
 
+  if (displayList) {
+    finishBandRendering();
+  }
+
   if (src->mode != bitmap->mode) {
     return splashErrModeMismatch;
   }
@@ -2995,6 +3145,42 @@ SplashError Splash::blitTransparent(SplashBitmap *src, int xSrc, int ySrc,
   return splashOk;
 }
 
+//------------------------------------------------------------------------
+// band rendering
+//------------------------------------------------------------------------
+
+GBool Splash::startBandRendering(int nThreads) {
+  if (displayList || nThreads < 1 ||
+      state->next || state->softMask || state->inNonIsolatedGroup) {
+    return gFalse;
+  }
+  displayList = new SplashDisplayList(state);
+  bandThreads = nThreads;
+  return gTrue;
+}
+
+void Splash::finishBandRendering() {
+  SplashDisplayList *dl;
+
+  if (!displayList) {
+    return;
+  }
+  dl = displayList;
+  displayList = NULL;
+  dl->render(bitmap, vectorAntialias, bandThreads);
+  delete dl;
+
+  // the bands don't report back what they touched
+  updateModX(0);
+  updateModY(0);
+  updateModX(bitmap->width - 1);
+  updateModY(bitmap->height - 1);
+}
+
+//------------------------------------------------------------------------
+// misc
+//------------------------------------------------------------------------
+
 SplashPath *Splash::makeStrokePath(SplashPath *path, GBool flatten) {
   SplashPath *pathIn, *pathOut;
   SplashCoord w, d, dx, dy, wdx, wdy, dxNext, dyNext, wdxNext, wdyNext;
@@ -25,6 +25,7 @@ class SplashScreen;
 class SplashPath;
 class SplashXPath;
 class SplashFont;
+class SplashDisplayList;
 struct SplashPipe;
 
 //------------------------------------------------------------------------
@@ -206,6 +207,24 @@ public:
   SplashError blitTransparent(SplashBitmap *src, int xSrc, int ySrc,
 			      int xDest, int yDest, int w, int h);
 
+  //----- band rendering
+
+  // Start recording drawing operations instead of rasterizing them.
+  // State changes still take effect immediately, so the state read
+  // functions keep working.  The recorded operations are rasterized
+  // by finishBandRendering, in horizontal bands on up to <nThreads>
+  // threads.  Operations which can't be recorded (e.g., those which
+  // read the bitmap back) call finishBandRendering first and are then
+  // executed immediately.  Returns false (and does nothing) if band
+  // rendering can't be started in the current state.
+  GBool startBandRendering(int nThreads);
+
+  // Rasterize all recorded operations and go back to immediate
+  // rendering.  Does nothing if band rendering is not active.
+  void finishBandRendering();
+
+  GBool isBandRendering() { return displayList != NULL; }
+
   //----- misc
 
   // Construct a path for a stroke, given the path to be stroked, and
@@ -238,6 +257,11 @@ public:
 
 private:
 
+  // Used by SplashDisplayList: draw rows [<bandY0>, <bandY1>) of
+  // <bitmapA>, starting with a copy of <stateA>.
+  Splash(SplashBitmap *bitmapA, GBool vectorAntialiasA,
+	 SplashState *stateA, int bandY0, int bandY1);
+
   void pipeInit(SplashPipe *pipe, int x, int y,
 		SplashPattern *pattern, SplashColorPtr cSrc,
 		SplashCoord aInput, GBool usesShape,
@@ -288,6 +312,10 @@ private:
   SplashClipResult opClipRes;
   GBool vectorAntialias;
   GBool debugMode;
+  SplashDisplayList *displayList; // recorded operations (band rendering)
+  int bandThreads;		// number of threads for band rendering
+
+  friend class SplashDisplayList;
 };
 
 #endif
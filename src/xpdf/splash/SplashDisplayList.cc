@@ -0,0 +1,575 @@
+//========================================================================
+//
+// SplashDisplayList.cc
+//
+//========================================================================
+
+#include <xpdf-aconf.h>
+
+#ifdef USE_GCC_PRAGMAS
+#pragma implementation
+#endif
+
+#ifdef WIN32
+#  include <windows.h>
+#else
+#  include <pthread.h>
+#endif
+#include <string.h>
+#include "goo/gmem.h"
+#include "goo/GMutex.h"
+#include "splash/SplashBitmap.h"
+#include "splash/SplashState.h"
+#include "splash/SplashPath.h"
+#include "splash/SplashPattern.h"
+#include "splash/SplashScreen.h"
+#include "splash/SplashGlyphBitmap.h"
+#include "splash/Splash.h"
+#include "splash/SplashDisplayList.h"
+
+//------------------------------------------------------------------------
+
+enum SplashDisplayListOpKind {
+  splashDLSetMatrix,
+  splashDLSetStrokePattern,
+  splashDLSetFillPattern,
+  splashDLSetScreen,
+  splashDLSetBlendFunc,
+  splashDLSetStrokeAlpha,
+  splashDLSetFillAlpha,
+  splashDLSetLineWidth,
+  splashDLSetLineCap,
+  splashDLSetLineJoin,
+  splashDLSetMiterLimit,
+  splashDLSetFlatness,
+  splashDLSetLineDash,
+  splashDLSetStrokeAdjust,
+  splashDLClipResetToRect,
+  splashDLClipToRect,
+  splashDLClipToPath,
+  splashDLClearSoftMask,
+  splashDLSaveState,
+  splashDLRestoreState,
+  splashDLStroke,
+  splashDLFill,
+  splashDLXorFill,
+  splashDLFillGlyph,
+  splashDLFillImageMask,
+  splashDLDrawImage
+};
+
+struct SplashDisplayListOp {
+  int kind;
+  SplashCoord c[6];		// matrix / rectangle / scalar arguments
+  int i[8];			// integer arguments
+  SplashPath *path;
+  SplashPattern *pattern;
+  SplashScreen *screen;
+  SplashBlendFunc blendFunc;
+  SplashCoord *lineDash;
+  Guchar *data;			// glyph bitmap or image rows
+  Guchar *alpha;		// image alpha rows
+};
+
+// Source for replaying a recorded image or image mask.
+struct SplashDisplayListImage {
+  Guchar *data;
+  Guchar *alpha;
+  int rowSize;			// bytes per row in <data>
+  int w;			// pixels per row (bytes per row in <alpha>)
+  int y;
+};
+
+static GBool imageMaskSrc(void *data, SplashColorPtr line) {
+  SplashDisplayListImage *img = (SplashDisplayListImage *)data;
+
+  memcpy(line, img->data + img->y * img->rowSize, img->rowSize);
+  ++img->y;
+  return gTrue;
+}
+
+static GBool imageSrc(void *data, SplashColorPtr colorLine,
+		      Guchar *alphaLine) {
+  SplashDisplayListImage *img = (SplashDisplayListImage *)data;
+
+  memcpy(colorLine, img->data + img->y * img->rowSize, img->rowSize);
+  if (alphaLine && img->alpha) {
+    memcpy(alphaLine, img->alpha + img->y * img->w, img->w);
+  }
+  ++img->y;
+  return gTrue;
+}
+
+//------------------------------------------------------------------------
+// band rendering threads
+//------------------------------------------------------------------------
+
+struct SplashBandJob {
+  SplashDisplayList *list;
+  SplashBitmap *bitmap;
+  GBool vectorAntialias;
+  int bandHeight;
+  int nBands;
+  int nextBand;
+  GMutex mutex;
+};
+
+static void runBandJob(SplashBandJob *job) {
+  int band, y0, y1;
+
+  while (1) {
+    gLockMutex(&job->mutex);
+    band = job->nextBand++;
+    gUnlockMutex(&job->mutex);
+    if (band >= job->nBands) {
+      break;
+    }
+    y0 = band * job->bandHeight;
+    y1 = y0 + job->bandHeight;
+    if (y1 > job->bitmap->getHeight()) {
+      y1 = job->bitmap->getHeight();
+    }
+    job->list->renderBand(job->bitmap, job->vectorAntialias, y0, y1);
+  }
+}
+
+#ifdef WIN32
+static DWORD WINAPI bandThread(LPVOID arg) {
+  runBandJob((SplashBandJob *)arg);
+  return 0;
+}
+#else
+static void *bandThread(void *arg) {
+  runBandJob((SplashBandJob *)arg);
+  return NULL;
+}
+#endif
+
+//------------------------------------------------------------------------
+// SplashDisplayList
+//------------------------------------------------------------------------
+
+SplashDisplayList::SplashDisplayList(SplashState *initStateA) {
+  initState = initStateA->copy();
+  ops = NULL;
+  length = size = 0;
+}
+
+SplashDisplayList::~SplashDisplayList() {
+  SplashDisplayListOp *op;
+  int i;
+
+  for (i = 0; i < length; ++i) {
+    op = &ops[i];
+    if (op->path) {
+      delete op->path;
+    }
+    if (op->pattern) {
+      delete op->pattern;
+    }
+    if (op->screen) {
+      delete op->screen;
+    }
+    gfree(op->lineDash);
+    gfree(op->data);
+    gfree(op->alpha);
+  }
+  gfree(ops);
+  delete initState;
+}
+
+SplashDisplayListOp *SplashDisplayList::addOp(int kind) {
+  SplashDisplayListOp *op;
+
+  if (length == size) {
+    size = size ? 2 * size : 256;
+    ops = (SplashDisplayListOp *)greallocn(ops, size,
+					   sizeof(SplashDisplayListOp));
+  }
+  op = &ops[length++];
+  memset(op, 0, sizeof(SplashDisplayListOp));
+  op->kind = kind;
+  return op;
+}
+
+void SplashDisplayList::setMatrix(SplashCoord *matrix) {
+  SplashDisplayListOp *op = addOp(splashDLSetMatrix);
+
+  memcpy(op->c, matrix, 6 * sizeof(SplashCoord));
+}
+
+void SplashDisplayList::setStrokePattern(SplashPattern *pattern) {
+  addOp(splashDLSetStrokePattern)->pattern = pattern->copy();
+}
+
+void SplashDisplayList::setFillPattern(SplashPattern *pattern) {
+  addOp(splashDLSetFillPattern)->pattern = pattern->copy();
+}
+
+void SplashDisplayList::setScreen(SplashScreen *screen) {
+  addOp(splashDLSetScreen)->screen = screen->copy();
+}
+
+void SplashDisplayList::setBlendFunc(SplashBlendFunc func) {
+  addOp(splashDLSetBlendFunc)->blendFunc = func;
+}
+
+void SplashDisplayList::setStrokeAlpha(SplashCoord alpha) {
+  addOp(splashDLSetStrokeAlpha)->c[0] = alpha;
+}
+
+void SplashDisplayList::setFillAlpha(SplashCoord alpha) {
+  addOp(splashDLSetFillAlpha)->c[0] = alpha;
+}
+
+void SplashDisplayList::setLineWidth(SplashCoord lineWidth) {
+  addOp(splashDLSetLineWidth)->c[0] = lineWidth;
+}
+
+void SplashDisplayList::setLineCap(int lineCap) {
+  addOp(splashDLSetLineCap)->i[0] = lineCap;
+}
+
+void SplashDisplayList::setLineJoin(int lineJoin) {
+  addOp(splashDLSetLineJoin)->i[0] = lineJoin;
+}
+
+void SplashDisplayList::setMiterLimit(SplashCoord miterLimit) {
+  addOp(splashDLSetMiterLimit)->c[0] = miterLimit;
+}
+
+void SplashDisplayList::setFlatness(SplashCoord flatness) {
+  addOp(splashDLSetFlatness)->c[0] = flatness;
+}
+
+void SplashDisplayList::setLineDash(SplashCoord *lineDash, int lineDashLength,
+				    SplashCoord lineDashPhase) {
+  SplashDisplayListOp *op = addOp(splashDLSetLineDash);
+
+  if (lineDash && lineDashLength > 0) {
+    op->lineDash = (SplashCoord *)gmallocn(lineDashLength,
+					   sizeof(SplashCoord));
+    memcpy(op->lineDash, lineDash, lineDashLength * sizeof(SplashCoord));
+    op->i[0] = lineDashLength;
+  }
+  op->c[0] = lineDashPhase;
+}
+
+void SplashDisplayList::setStrokeAdjust(GBool strokeAdjust) {
+  addOp(splashDLSetStrokeAdjust)->i[0] = strokeAdjust;
+}
+
+void SplashDisplayList::clipResetToRect(SplashCoord x0, SplashCoord y0,
+					SplashCoord x1, SplashCoord y1) {
+  SplashDisplayListOp *op = addOp(splashDLClipResetToRect);
+
+  op->c[0] = x0;
+  op->c[1] = y0;
+  op->c[2] = x1;
+  op->c[3] = y1;
+}
+
+void SplashDisplayList::clipToRect(SplashCoord x0, SplashCoord y0,
+				   SplashCoord x1, SplashCoord y1) {
+  SplashDisplayListOp *op = addOp(splashDLClipToRect);
+
+  op->c[0] = x0;
+  op->c[1] = y0;
+  op->c[2] = x1;
+  op->c[3] = y1;
+}
+
+void SplashDisplayList::clipToPath(SplashPath *path, GBool eo) {
+  SplashDisplayListOp *op = addOp(splashDLClipToPath);
+
+  op->path = path->copy();
+  op->i[0] = eo;
+}
+
+void SplashDisplayList::clearSoftMask() {
+  addOp(splashDLClearSoftMask);
+}
+
+void SplashDisplayList::saveState() {
+  addOp(splashDLSaveState);
+}
+
+void SplashDisplayList::restoreState() {
+  addOp(splashDLRestoreState);
+}
+
+void SplashDisplayList::stroke(SplashPath *path) {
+  addOp(splashDLStroke)->path = path->copy();
+}
+
+void SplashDisplayList::fill(SplashPath *path, GBool eo) {
+  SplashDisplayListOp *op = addOp(splashDLFill);
+
+  op->path = path->copy();
+  op->i[0] = eo;
+}
+
+void SplashDisplayList::xorFill(SplashPath *path, GBool eo) {
+  SplashDisplayListOp *op = addOp(splashDLXorFill);
+
+  op->path = path->copy();
+  op->i[0] = eo;
+}
+
+void SplashDisplayList::fillGlyph(int x0, int y0, SplashGlyphBitmap *glyph) {
+  SplashDisplayListOp *op;
+  int n;
+
+  if (glyph->aa) {
+    n = glyph->w * glyph->h;
+  } else {
+    n = ((glyph->w + 7) >> 3) * glyph->h;
+  }
+  op = addOp(splashDLFillGlyph);
+  op->i[0] = x0;
+  op->i[1] = y0;
+  op->i[2] = glyph->x;
+  op->i[3] = glyph->y;
+  op->i[4] = glyph->w;
+  op->i[5] = glyph->h;
+  op->i[6] = glyph->aa;
+  op->data = (Guchar *)gmalloc(n > 0 ? n : 1);
+  memcpy(op->data, glyph->data, n);
+}
+
+void SplashDisplayList::fillImageMask(SplashImageMaskSource src,
+				      void *srcData, int w, int h,
+				      SplashCoord *mat, GBool glyphMode) {
+  SplashDisplayListOp *op;
+  int y;
+
+  // decode the whole mask now -- the source is not thread safe, and
+  // may be gone by the time the list is rasterized
+  op = addOp(splashDLFillImageMask);
+  memcpy(op->c, mat, 6 * sizeof(SplashCoord));
+  op->i[0] = w;
+  op->i[1] = h;
+  op->i[2] = glyphMode;
+  op->data = (Guchar *)gmallocn(h > 0 ? h : 1, w > 0 ? w : 1);
+  for (y = 0; y < h; ++y) {
+    (*src)(srcData, op->data + y * w);
+  }
+}
+
+void SplashDisplayList::drawImage(SplashImageSource src, void *srcData,
+				  SplashColorMode srcMode, GBool srcAlpha,
+				  int w, int h, SplashCoord *mat) {
+  SplashDisplayListOp *op;
+  int rowSize, y;
+
+  // decode the whole image now (see fillImageMask)
+  rowSize = w * splashColorModeNComps[srcMode];
+  op = addOp(splashDLDrawImage);
+  memcpy(op->c, mat, 6 * sizeof(SplashCoord));
+  op->i[0] = w;
+  op->i[1] = h;
+  op->i[2] = srcMode;
+  op->i[3] = srcAlpha;
+  op->data = (Guchar *)gmallocn(h > 0 ? h : 1, rowSize > 0 ? rowSize : 1);
+  if (srcAlpha) {
+    op->alpha = (Guchar *)gmallocn(h > 0 ? h : 1, w > 0 ? w : 1);
+  }
+  for (y = 0; y < h; ++y) {
+    (*src)(srcData, op->data + y * rowSize,
+	   srcAlpha ? op->alpha + y * w : (Guchar *)NULL);
+  }
+}
+
+void SplashDisplayList::replay(Splash *splash, SplashCoord bandY0,
+			       SplashCoord bandY1) {
+  SplashDisplayListOp *op;
+  SplashDisplayListImage img;
+  SplashGlyphBitmap glyph;
+  int i;
+
+  for (i = 0; i < length; ++i) {
+    op = &ops[i];
+    switch (op->kind) {
+    case splashDLSetMatrix:
+      splash->setMatrix(op->c);
+      break;
+    case splashDLSetStrokePattern:
+      splash->setStrokePattern(op->pattern->copy());
+      break;
+    case splashDLSetFillPattern:
+      splash->setFillPattern(op->pattern->copy());
+      break;
+    case splashDLSetScreen:
+      splash->setScreen(op->screen->copy());
+      break;
+    case splashDLSetBlendFunc:
+      splash->setBlendFunc(op->blendFunc);
+      break;
+    case splashDLSetStrokeAlpha:
+      splash->setStrokeAlpha(op->c[0]);
+      break;
+    case splashDLSetFillAlpha:
+      splash->setFillAlpha(op->c[0]);
+      break;
+    case splashDLSetLineWidth:
+      splash->setLineWidth(op->c[0]);
+      break;
+    case splashDLSetLineCap:
+      splash->setLineCap(op->i[0]);
+      break;
+    case splashDLSetLineJoin:
+      splash->setLineJoin(op->i[0]);
+      break;
+    case splashDLSetMiterLimit:
+      splash->setMiterLimit(op->c[0]);
+      break;
+    case splashDLSetFlatness:
+      splash->setFlatness(op->c[0]);
+      break;
+    case splashDLSetLineDash:
+      splash->setLineDash(op->lineDash, op->i[0], op->c[0]);
+      break;
+    case splashDLSetStrokeAdjust:
+      splash->setStrokeAdjust(op->i[0]);
+      break;
+    case splashDLClipResetToRect:
+      // resetting must not escape the band
+      splash->clipResetToRect(op->c[0], op->c[1], op->c[2], op->c[3]);
+      splash->clipToRect(0, bandY0,
+			 splash->getBitmap()->getWidth() - 0.001, bandY1);
+      break;
+    case splashDLClipToRect:
+      splash->clipToRect(op->c[0], op->c[1], op->c[2], op->c[3]);
+      break;
+    case splashDLClipToPath:
+      splash->clipToPath(op->path, op->i[0]);
+      break;
+    case splashDLClearSoftMask:
+      splash->setSoftMask(NULL);
+      break;
+    case splashDLSaveState:
+      splash->saveState();
+      break;
+    case splashDLRestoreState:
+      splash->restoreState();
+      break;
+    case splashDLStroke:
+      splash->stroke(op->path);
+      break;
+    case splashDLFill:
+      splash->fill(op->path, op->i[0]);
+      break;
+    case splashDLXorFill:
+      splash->xorFill(op->path, op->i[0]);
+      break;
+    case splashDLFillGlyph:
+      glyph.x = op->i[2];
+      glyph.y = op->i[3];
+      glyph.w = op->i[4];
+      glyph.h = op->i[5];
+      glyph.aa = op->i[6];
+      glyph.data = op->data;
+      glyph.freeData = gFalse;
+      splash->fillGlyph2(op->i[0], op->i[1], &glyph);
+      break;
+    case splashDLFillImageMask:
+      img.data = op->data;
+      img.alpha = NULL;
+      img.rowSize = op->i[0];
+      img.w = op->i[0];
+      img.y = 0;
+      splash->fillImageMask(&imageMaskSrc, &img, op->i[0], op->i[1],
+			    op->c, op->i[2]);
+      break;
+    case splashDLDrawImage:
+      img.data = op->data;
+      img.alpha = op->alpha;
+      img.rowSize = op->i[0] * splashColorModeNComps[op->i[2]];
+      img.w = op->i[0];
+      img.y = 0;
+      splash->drawImage(&imageSrc, &img, (SplashColorMode)op->i[2], op->i[3],
+			op->i[0], op->i[1], op->c);
+      break;
+    }
+  }
+}
+
+void SplashDisplayList::renderBand(SplashBitmap *bitmap,
+				   GBool vectorAntialias, int y0, int y1) {
+  Splash *splash;
+
+  splash = new Splash(bitmap, vectorAntialias, initState, y0, y1);
+  replay(splash, (SplashCoord)y0, (SplashCoord)y1 - 0.001);
+  delete splash;
+}
+
+void SplashDisplayList::render(SplashBitmap *bitmap, GBool vectorAntialias,
+			       int nThreads) {
+  SplashBandJob job;
+#ifdef WIN32
+  HANDLE *threads;
+#else
+  pthread_t *threads;
+#endif
+  int h, nStarted, i;
+
+  h = bitmap->getHeight();
+  job.list = this;
+  job.bitmap = bitmap;
+  job.vectorAntialias = vectorAntialias;
+
+  // use a few more bands than threads, so that a band full of
+  // complex content doesn't leave the other threads idle
+  job.nBands = nThreads > 1 ? 4 * nThreads : 1;
+  if (job.nBands > h / splashDisplayListMinBandHeight) {
+    job.nBands = h / splashDisplayListMinBandHeight;
+  }
+  if (job.nBands < 1) {
+    job.nBands = 1;
+  }
+  job.bandHeight = (h + job.nBands - 1) / job.nBands;
+  job.nextBand = 0;
+  if (nThreads > job.nBands) {
+    nThreads = job.nBands;
+  }
+  if (nThreads <= 1) {
+    renderBand(bitmap, vectorAntialias, 0, h);
+    return;
+  }
+
+  gInitMutex(&job.mutex);
+#ifdef WIN32
+  threads = (HANDLE *)gmallocn(nThreads - 1, sizeof(HANDLE));
+#else
+  threads = (pthread_t *)gmallocn(nThreads - 1, sizeof(pthread_t));
+#endif
+  nStarted = 0;
+  for (i = 0; i < nThreads - 1; ++i) {
+#ifdef WIN32
+    if (!(threads[nStarted] = CreateThread(NULL, 0, &bandThread, &job,
+					   0, NULL))) {
+      break;
+    }
+#else
+    if (pthread_create(&threads[nStarted], NULL, &bandThread, &job)) {
+      break;
+    }
+#endif
+    ++nStarted;
+  }
+
+  // the calling thread works on bands, too -- if no thread could be
+  // started, it simply does all of them
+  runBandJob(&job);
+
+  for (i = 0; i < nStarted; ++i) {
+#ifdef WIN32
+    WaitForSingleObject(threads[i], INFINITE);
+    CloseHandle(threads[i]);
+#else
+    pthread_join(threads[i], NULL);
+#endif
+  }
+  gfree(threads);
+  gDestroyMutex(&job.mutex);
+}
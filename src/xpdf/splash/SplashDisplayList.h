@@ -0,0 +1,115 @@
+//========================================================================
+//
+// SplashDisplayList.h
+//
+//========================================================================
+
+#ifndef SPLASHDISPLAYLIST_H
+#define SPLASHDISPLAYLIST_H
+
+#include <xpdf-aconf.h>
+
+#ifdef USE_GCC_PRAGMAS
+#pragma interface
+#endif
+
+#include "goo/gtypes.h"
+#include "splash/SplashTypes.h"
+#include "splash/Splash.h"
+
+class SplashBitmap;
+class SplashState;
+class SplashPath;
+class SplashPattern;
+class SplashScreen;
+struct SplashGlyphBitmap;
+struct SplashDisplayListOp;
+
+//------------------------------------------------------------------------
+
+// Bands are never made smaller than this many rows.
+#define splashDisplayListMinBandHeight 32
+
+//------------------------------------------------------------------------
+// SplashDisplayList
+//------------------------------------------------------------------------
+
+// A list of Splash drawing operations, recorded in place of
+// rasterizing them.  All data referenced by the operations (paths,
+// patterns, glyph bitmaps, decoded image rows) is copied, so the list
+// is self-contained and read-only once recorded.  It can then be
+// rasterized in horizontal bands, each band by its own Splash object
+// (clipped to the band) drawing into the shared bitmap, on several
+// threads at once.
+//
+// Splash does the recording -- see Splash::startBandRendering.
+class SplashDisplayList {
+public:
+
+  // Create an empty list.  <initState> is the graphics state in effect
+  // when recording starts; it is copied.
+  SplashDisplayList(SplashState *initStateA);
+
+  ~SplashDisplayList();
+
+  // Number of recorded operations.
+  int getLength() { return length; }
+
+  //----- recording
+
+  void setMatrix(SplashCoord *matrix);
+  void setStrokePattern(SplashPattern *pattern);
+  void setFillPattern(SplashPattern *pattern);
+  void setScreen(SplashScreen *screen);
+  void setBlendFunc(SplashBlendFunc func);
+  void setStrokeAlpha(SplashCoord alpha);
+  void setFillAlpha(SplashCoord alpha);
+  void setLineWidth(SplashCoord lineWidth);
+  void setLineCap(int lineCap);
+  void setLineJoin(int lineJoin);
+  void setMiterLimit(SplashCoord miterLimit);
+  void setFlatness(SplashCoord flatness);
+  void setLineDash(SplashCoord *lineDash, int lineDashLength,
+		   SplashCoord lineDashPhase);
+  void setStrokeAdjust(GBool strokeAdjust);
+  void clipResetToRect(SplashCoord x0, SplashCoord y0,
+		       SplashCoord x1, SplashCoord y1);
+  void clipToRect(SplashCoord x0, SplashCoord y0,
+		  SplashCoord x1, SplashCoord y1);
+  void clipToPath(SplashPath *path, GBool eo);
+  void clearSoftMask();
+  void saveState();
+  void restoreState();
+  void stroke(SplashPath *path);
+  void fill(SplashPath *path, GBool eo);
+  void xorFill(SplashPath *path, GBool eo);
+  // <x0>, <y0> are device coordinates, as in Splash::fillGlyph2.
+  void fillGlyph(int x0, int y0, SplashGlyphBitmap *glyph);
+  void fillImageMask(SplashImageMaskSource src, void *srcData,
+		     int w, int h, SplashCoord *mat, GBool glyphMode);
+  void drawImage(SplashImageSource src, void *srcData,
+		 SplashColorMode srcMode, GBool srcAlpha,
+		 int w, int h, SplashCoord *mat);
+
+  //----- rasterizing
+
+  // Rasterize the list into <bitmap>, split into horizontal bands
+  // which are drawn by up to <nThreads> threads.
+  void render(SplashBitmap *bitmap, GBool vectorAntialias, int nThreads);
+
+  // Rasterize rows [<y0>, <y1>) of <bitmap>.
+  void renderBand(SplashBitmap *bitmap, GBool vectorAntialias,
+		  int y0, int y1);
+
+private:
+
+  SplashDisplayListOp *addOp(int kind);
+  void replay(Splash *splash, SplashCoord bandY0, SplashCoord bandY1);
+
+  SplashState *initState;	// graphics state at the start
+  SplashDisplayListOp *ops;	// recorded operations
+  int length;			// number of operations
+  int size;			// size of the ops array
+};
+
+#endif
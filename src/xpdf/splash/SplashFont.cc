@@ -15,6 +15,7 @@
 #include "splash/SplashMath.h"
 #include "splash/SplashGlyphBitmap.h"
 #include "splash/SplashFontFile.h"
+#include "splash/SplashGlyphCache.h"
 #include "splash/SplashFont.h"
 
 //------------------------------------------------------------------------
@@ -95,6 +96,8 @@ SplashFont::~SplashFont() {
 GBool SplashFont::getGlyph(int c, int xFrac, int yFrac,
 			   SplashGlyphBitmap *bitmap) {
   SplashGlyphBitmap bitmap2;
+  SplashGlyphCache *globalCache;
+  SplashFontFingerprint *fp;
   int size;
   Guchar *p;
   int i, j, k;
@@ -131,6 +134,28 @@ GBool SplashFont::getGlyph(int c, int xFrac, int yFrac,
     }
   }
 
+  // the glyph goes into the least recently used slot of the set
+  for (j = 0; j < cacheAssoc; ++j) {
+    if ((cacheTags[i+j].mru & 0x7fffffff) == cacheAssoc - 1) {
+      break;
+    }
+  }
+  p = cache + (i+j) * glyphSize;
+
+  // check the global cache, which may have the glyph from another
+  // SplashFont instance (e.g., from an earlier document, or another
+  // rendering thread)
+  globalCache = SplashGlyphCache::getGlobal();
+  fp = fontFile->getFingerprint();
+  if (fp && globalCache->lookup(fp, mat, aa, c, xFrac, yFrac,
+				&bitmap2, p, glyphSize)) {
+    setCacheTag(i, j, c, xFrac, yFrac, &bitmap2);
+    *bitmap = bitmap2;
+    bitmap->data = p;
+    bitmap->freeData = gFalse;
+    return gTrue;
+  }
+
   // generate the glyph bitmap
   if (!makeGlyph(c, xFrac, yFrac, &bitmap2)) {
     return gFalse;
@@ -143,28 +168,16 @@ GBool SplashFont::getGlyph(int c, int xFrac, int yFrac,
     return gTrue;
   }
 
-  // insert glyph pixmap in cache
+  // insert glyph pixmap in both caches
   if (aa) {
     size = bitmap2.w * bitmap2.h;
   } else {
     size = ((bitmap2.w + 7) >> 3) * bitmap2.h;
   }
-  p = NULL; // make gcc happy
-  for (j = 0; j < cacheAssoc; ++j) {
-    if ((cacheTags[i+j].mru & 0x7fffffff) == cacheAssoc - 1) {
-      cacheTags[i+j].mru = 0x80000000;
-      cacheTags[i+j].c = c;
-      cacheTags[i+j].xFrac = (short)xFrac;
-      cacheTags[i+j].yFrac = (short)yFrac;
-      cacheTags[i+j].x = bitmap2.x;
-      cacheTags[i+j].y = bitmap2.y;
-      cacheTags[i+j].w = bitmap2.w;
-      cacheTags[i+j].h = bitmap2.h;
-      p = cache + (i+j) * glyphSize;
-      memcpy(p, bitmap2.data, size);
-    } else {
-      ++cacheTags[i+j].mru;
-    }
+  setCacheTag(i, j, c, xFrac, yFrac, &bitmap2);
+  memcpy(p, bitmap2.data, size);
+  if (fp) {
+    globalCache->insert(fp, mat, aa, c, xFrac, yFrac, &bitmap2);
   }
   *bitmap = bitmap2;
   bitmap->data = p;
@@ -174,3 +187,26 @@ GBool SplashFont::getGlyph(int c, int xFrac, int yFrac,
   }
   return gTrue;
 }
+
+// Store the tag for glyph <c> in slot <j> of the set starting at
+// <i>, making it the most recently used one.
+void SplashFont::setCacheTag(int i, int j, int c, int xFrac, int yFrac,
+			     SplashGlyphBitmap *bitmap) {
+  int k;
+
+  for (k = 0; k < cacheAssoc; ++k) {
+    if (k != j &&
+	(cacheTags[i+k].mru & 0x7fffffff) <
+	  (cacheTags[i+j].mru & 0x7fffffff)) {
+      ++cacheTags[i+k].mru;
+    }
+  }
+  cacheTags[i+j].mru = 0x80000000;
+  cacheTags[i+j].c = c;
+  cacheTags[i+j].xFrac = (short)xFrac;
+  cacheTags[i+j].yFrac = (short)yFrac;
+  cacheTags[i+j].x = bitmap->x;
+  cacheTags[i+j].y = bitmap->y;
+  cacheTags[i+j].w = bitmap->w;
+  cacheTags[i+j].h = bitmap->h;
+}
@@ -85,6 +85,9 @@ public:
 
 protected:
 
+  void setCacheTag(int i, int j, int c, int xFrac, int yFrac,
+		   SplashGlyphBitmap *bitmap);
+
   SplashFontFile *fontFile;
   SplashCoord mat[4];		// font transform matrix
 				//   (text space -> device space)
@@ -27,6 +27,7 @@
 #include "splash/SplashFontFile.h"
 #include "splash/SplashFontFileID.h"
 #include "splash/SplashFont.h"
+#include "splash/SplashGlyphCache.h"
 #include "splash/SplashFontEngine.h"
 
 #ifdef VMS
@@ -35,6 +36,88 @@ extern "C" int unlink(char *filename);
 #endif
 #endif
 
+//------------------------------------------------------------------------
+
+// Font loader kinds, mixed into the font fingerprints.
+enum SplashFontLoaderKind {
+  splashLoaderType1,
+  splashLoaderType1C,
+  splashLoaderOpenTypeT1C,
+  splashLoaderCID,
+  splashLoaderOpenTypeCFF,
+  splashLoaderTrueType
+};
+
+static inline void addFingerprintByte(SplashFontFingerprint *fp, Guint b) {
+  fp->hash1 = (fp->hash1 ^ b) * 16777619;	// FNV-1a
+  fp->hash2 = fp->hash2 * 65599 + b;		// sdbm
+}
+
+static void addFingerprintString(SplashFontFingerprint *fp, char *s) {
+  if (s) {
+    for (; *s; ++s) {
+      addFingerprintByte(fp, (Guchar)*s);
+    }
+  }
+  addFingerprintByte(fp, 0);
+}
+
+// Compute the content fingerprint of a font file, together with the
+// parameters which affect the glyph mapping.  This has to be done
+// before the font engines get the file, because they may delete it.
+static void fingerprintFontFile(SplashFontFingerprint *fp, char *fileName,
+				SplashFontLoaderKind kind, char **enc,
+				Gushort *codeToGID, int codeToGIDLen) {
+  FILE *f;
+  Guchar buf[4096];
+  int n, i;
+
+  fp->hash1 = 2166136261U;
+  fp->hash2 = 0;
+  fp->len = 0;
+  fp->ok = gFalse;
+  if (!(f = fopen(fileName, "rb"))) {
+    return;
+  }
+  while ((n = (int)fread(buf, 1, sizeof(buf), f)) > 0) {
+    for (i = 0; i < n; ++i) {
+      addFingerprintByte(fp, buf[i]);
+    }
+    fp->len += n;
+  }
+  fclose(f);
+  addFingerprintByte(fp, kind);
+  if (enc) {
+    for (i = 0; i < 256; ++i) {
+      addFingerprintString(fp, enc[i]);
+    }
+  }
+  for (i = 0; i < codeToGIDLen; ++i) {
+    addFingerprintByte(fp, codeToGID[i] & 0xff);
+    addFingerprintByte(fp, codeToGID[i] >> 8);
+  }
+  fp->ok = gTrue;
+}
+
+// Font rasterizer backends.
+#if HAVE_T1LIB_H
+#define splashBackendT1 1
+#endif
+#if HAVE_FREETYPE_FREETYPE_H || HAVE_FREETYPE_H
+#define splashBackendFT 2
+#endif
+
+// Attach a fingerprint to a newly loaded font file.  Glyphs from
+// different rasterizers must not be shared, so the backend is mixed
+// in as well.
+static void setFingerprint(SplashFontFingerprint *dst,
+			   SplashFontFingerprint *fp, int backend) {
+  if (fp->ok) {
+    *dst = *fp;
+    addFingerprintByte(dst, backend);
+  }
+}
+
 //------------------------------------------------------------------------
 // SplashFontEngine
 //------------------------------------------------------------------------
@@ -109,19 +192,29 @@ SplashFontFile *SplashFontEngine::loadType1Font(SplashFontFileID *idA,
 						char *fileName,
 						GBool deleteFile, char **enc) {
   SplashFontFile *fontFile;
+  SplashFontFingerprint fp;
+  int backend;
 
+  fingerprintFontFile(&fp, fileName, splashLoaderType1, enc, NULL, 0);
   fontFile = NULL;
+  backend = 0;
 #if HAVE_T1LIB_H
   if (!fontFile && t1Engine) {
     fontFile = t1Engine->loadType1Font(idA, fileName, deleteFile, enc);
+    backend = splashBackendT1;
   }
 #endif
 #if HAVE_FREETYPE_FREETYPE_H || HAVE_FREETYPE_H
   if (!fontFile && ftEngine) {
     fontFile = ftEngine->loadType1Font(idA, fileName, deleteFile, enc);
+    backend = splashBackendFT;
   }
 #endif
 
+  if (fontFile) {
+    setFingerprint(&fontFile->fingerprint, &fp, backend);
+  }
+
 #ifndef WIN32
   // delete the (temporary) font file -- with Unix hard link
   // semantics, this will remove the last link; otherwise it will
@@ -140,19 +233,29 @@ SplashFontFile *SplashFontEngine::loadType1CFont(SplashFontFileID *idA,
 						 GBool deleteFile,
 						 char **enc) {
   SplashFontFile *fontFile;
+  SplashFontFingerprint fp;
+  int backend;
 
+  fingerprintFontFile(&fp, fileName, splashLoaderType1C, enc, NULL, 0);
   fontFile = NULL;
+  backend = 0;
 #if HAVE_T1LIB_H
   if (!fontFile && t1Engine) {
     fontFile = t1Engine->loadType1CFont(idA, fileName, deleteFile, enc);
+    backend = splashBackendT1;
   }
 #endif
 #if HAVE_FREETYPE_FREETYPE_H || HAVE_FREETYPE_H
   if (!fontFile && ftEngine) {
     fontFile = ftEngine->loadType1CFont(idA, fileName, deleteFile, enc);
+    backend = splashBackendFT;
   }
 #endif
 
+  if (fontFile) {
+    setFingerprint(&fontFile->fingerprint, &fp, backend);
+  }
+
 #ifndef WIN32
   // delete the (temporary) font file -- with Unix hard link
   // semantics, this will remove the last link; otherwise it will
@@ -171,14 +274,23 @@ SplashFontFile *SplashFontEngine::loadOpenTypeT1CFont(SplashFontFileID *idA,
 						      GBool deleteFile,
 						      char **enc) {
   SplashFontFile *fontFile;
+  SplashFontFingerprint fp;
+  int backend;
 
+  fingerprintFontFile(&fp, fileName, splashLoaderOpenTypeT1C, enc, NULL, 0);
   fontFile = NULL;
+  backend = 0;
 #if HAVE_FREETYPE_FREETYPE_H || HAVE_FREETYPE_H
   if (!fontFile && ftEngine) {
     fontFile = ftEngine->loadOpenTypeT1CFont(idA, fileName, deleteFile, enc);
+    backend = splashBackendFT;
   }
 #endif
 
+  if (fontFile) {
+    setFingerprint(&fontFile->fingerprint, &fp, backend);
+  }
+
 #ifndef WIN32
   // delete the (temporary) font file -- with Unix hard link
   // semantics, this will remove the last link; otherwise it will
@@ -196,14 +308,23 @@ SplashFontFile *SplashFontEngine::loadCIDFont(SplashFontFileID *idA,
 					      char *fileName,
 					      GBool deleteFile) {
   SplashFontFile *fontFile;
+  SplashFontFingerprint fp;
+  int backend;
 
+  fingerprintFontFile(&fp, fileName, splashLoaderCID, NULL, NULL, 0);
   fontFile = NULL;
+  backend = 0;
 #if HAVE_FREETYPE_FREETYPE_H || HAVE_FREETYPE_H
   if (!fontFile && ftEngine) {
     fontFile = ftEngine->loadCIDFont(idA, fileName, deleteFile);
+    backend = splashBackendFT;
   }
 #endif
 
+  if (fontFile) {
+    setFingerprint(&fontFile->fingerprint, &fp, backend);
+  }
+
 #ifndef WIN32
   // delete the (temporary) font file -- with Unix hard link
   // semantics, this will remove the last link; otherwise it will
@@ -221,14 +342,23 @@ SplashFontFile *SplashFontEngine::loadOpenTypeCFFFont(SplashFontFileID *idA,
 						      char *fileName,
 						      GBool deleteFile) {
   SplashFontFile *fontFile;
+  SplashFontFingerprint fp;
+  int backend;
 
+  fingerprintFontFile(&fp, fileName, splashLoaderOpenTypeCFF, NULL, NULL, 0);
   fontFile = NULL;
+  backend = 0;
 #if HAVE_FREETYPE_FREETYPE_H || HAVE_FREETYPE_H
   if (!fontFile && ftEngine) {
     fontFile = ftEngine->loadOpenTypeCFFFont(idA, fileName, deleteFile);
+    backend = splashBackendFT;
   }
 #endif
 
+  if (fontFile) {
+    setFingerprint(&fontFile->fingerprint, &fp, backend);
+  }
+
 #ifndef WIN32
   // delete the (temporary) font file -- with Unix hard link
   // semantics, this will remove the last link; otherwise it will
@@ -248,12 +378,18 @@ SplashFontFile *SplashFontEngine::loadTrueTypeFont(SplashFontFileID *idA,
 						   Gushort *codeToGID,
 						   int codeToGIDLen) {
   SplashFontFile *fontFile;
+  SplashFontFingerprint fp;
+  int backend;
 
+  fingerprintFontFile(&fp, fileName, splashLoaderTrueType, NULL,
+		      codeToGID, codeToGIDLen);
   fontFile = NULL;
+  backend = 0;
 #if HAVE_FREETYPE_FREETYPE_H || HAVE_FREETYPE_H
   if (!fontFile && ftEngine) {
     fontFile = ftEngine->loadTrueTypeFont(idA, fileName, deleteFile,
 					  codeToGID, codeToGIDLen);
+    backend = splashBackendFT;
   }
 #endif
 
@@ -261,6 +397,10 @@ SplashFontFile *SplashFontEngine::loadTrueTypeFont(SplashFontFileID *idA,
     gfree(codeToGID);
   }
 
+  if (fontFile) {
+    setFingerprint(&fontFile->fingerprint, &fp, backend);
+  }
+
 #ifndef WIN32
   // delete the (temporary) font file -- with Unix hard link
   // semantics, this will remove the last link; otherwise it will
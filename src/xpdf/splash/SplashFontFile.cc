@@ -33,6 +33,8 @@ SplashFontFile::SplashFontFile(SplashFontFileID *idA, char *fileNameA,
   id = idA;
   fileName = new GString(fileNameA);
   deleteFile = deleteFileA;
+  fingerprint.hash1 = fingerprint.hash2 = fingerprint.len = 0;
+  fingerprint.ok = gFalse;
   refCnt = 0;
 }
 
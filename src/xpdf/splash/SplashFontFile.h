@@ -15,6 +15,7 @@
 
 #include "goo/gtypes.h"
 #include "splash/SplashTypes.h"
+#include "splash/SplashGlyphCache.h"
 
 class GString;
 class SplashFontEngine;
@@ -37,6 +38,11 @@ public:
   // Get the font file ID.
   SplashFontFileID *getID() { return id; }
 
+  // Get the content fingerprint used to share glyphs through the
+  // global glyph cache, or NULL if the font data couldn't be read.
+  SplashFontFingerprint *getFingerprint()
+    { return fingerprint.ok ? &fingerprint : (SplashFontFingerprint *)NULL; }
+
   // Increment the reference count.
   void incRefCnt();
 
@@ -52,6 +58,7 @@ protected:
   SplashFontFileID *id;
   GString *fileName;
   GBool deleteFile;
+  SplashFontFingerprint fingerprint;
   int refCnt;
 
   friend class SplashFontEngine;
@@ -0,0 +1,307 @@
+//========================================================================
+//
+// SplashGlyphCache.cc
+//
+//========================================================================
+
+#include <xpdf-aconf.h>
+
+#ifdef USE_GCC_PRAGMAS
+#pragma implementation
+#endif
+
+#include <string.h>
+#include "goo/gmem.h"
+#include "splash/SplashMath.h"
+#include "splash/SplashGlyphBitmap.h"
+#include "splash/SplashGlyphCache.h"
+
+//------------------------------------------------------------------------
+
+struct SplashGlyphCacheEntry {
+  // key
+  Guint hash;
+  SplashFontFingerprint fp;
+  SplashCoord mat[4];
+  GBool aa;
+  int c;
+  short xFrac, yFrac;
+
+  // glyph
+  int x, y, w, h;
+  Guchar *data;
+  int dataSize;
+
+  SplashGlyphCacheEntry *next;	// next entry in hash bucket
+  SplashGlyphCacheEntry *lruPrev; // more recently used entry
+  SplashGlyphCacheEntry *lruNext; // less recently used entry
+};
+
+// Memory charged for one entry, on top of the bitmap data.
+#define entryOverhead ((int)sizeof(SplashGlyphCacheEntry) + \
+		       (int)sizeof(SplashGlyphCacheEntry *))
+
+#define initialTabSize 1024
+
+static SplashGlyphCache globalGlyphCache(splashGlyphCacheDefaultMaxBytes);
+
+//------------------------------------------------------------------------
+// SplashGlyphCache
+//------------------------------------------------------------------------
+
+SplashGlyphCache *SplashGlyphCache::getGlobal() {
+  return &globalGlyphCache;
+}
+
+SplashGlyphCache::SplashGlyphCache(Gulong maxBytesA) {
+  tabSize = initialTabSize;
+  tab = (SplashGlyphCacheEntry **)gmallocn(tabSize,
+					   sizeof(SplashGlyphCacheEntry *));
+  memset(tab, 0, tabSize * sizeof(SplashGlyphCacheEntry *));
+  lruHead = lruTail = NULL;
+  maxBytes = maxBytesA;
+  bytes = 0;
+  entries = 0;
+  hits = misses = insertions = evictions = 0;
+  gInitMutex(&mutex);
+}
+
+SplashGlyphCache::~SplashGlyphCache() {
+  clear();
+  gfree(tab);
+  gDestroyMutex(&mutex);
+}
+
+Guint SplashGlyphCache::hashKey(SplashFontFingerprint *fp, SplashCoord *mat,
+				GBool aa, int c, int xFrac, int yFrac) {
+  Guint h;
+  int i;
+
+  h = fp->hash1 ^ (fp->hash2 * 31) ^ fp->len;
+  for (i = 0; i < 4; ++i) {
+    h = h * 1000003 + (Guint)splashFloor(mat[i] * 1024);
+  }
+  h = h * 1000003 + (Guint)c;
+  h = h * 1000003 + (Guint)((xFrac << 8) | (yFrac << 1) | (aa ? 1 : 0));
+  return h ^ (h >> 15);
+}
+
+SplashGlyphCacheEntry *SplashGlyphCache::find(Guint h,
+					      SplashFontFingerprint *fp,
+					      SplashCoord *mat, GBool aa,
+					      int c, int xFrac, int yFrac) {
+  SplashGlyphCacheEntry *e;
+
+  for (e = tab[h & (tabSize - 1)]; e; e = e->next) {
+    if (e->hash == h && e->c == c &&
+	(int)e->xFrac == xFrac && (int)e->yFrac == yFrac &&
+	e->aa == aa &&
+	e->fp.hash1 == fp->hash1 && e->fp.hash2 == fp->hash2 &&
+	e->fp.len == fp->len &&
+	e->mat[0] == mat[0] && e->mat[1] == mat[1] &&
+	e->mat[2] == mat[2] && e->mat[3] == mat[3]) {
+      return e;
+    }
+  }
+  return NULL;
+}
+
+GBool SplashGlyphCache::lookup(SplashFontFingerprint *fp, SplashCoord *mat,
+			       GBool aa, int c, int xFrac, int yFrac,
+			       SplashGlyphBitmap *bitmap,
+			       Guchar *data, int dataSize) {
+  SplashGlyphCacheEntry *e;
+  Guint h;
+
+  h = hashKey(fp, mat, aa, c, xFrac, yFrac);
+  gLockMutex(&mutex);
+  if (!maxBytes ||
+      !(e = find(h, fp, mat, aa, c, xFrac, yFrac)) ||
+      e->dataSize > dataSize) {
+    ++misses;
+    gUnlockMutex(&mutex);
+    return gFalse;
+  }
+
+  // move to the front of the LRU list
+  if (e != lruHead) {
+    e->lruPrev->lruNext = e->lruNext;
+    if (e->lruNext) {
+      e->lruNext->lruPrev = e->lruPrev;
+    } else {
+      lruTail = e->lruPrev;
+    }
+    e->lruPrev = NULL;
+    e->lruNext = lruHead;
+    lruHead->lruPrev = e;
+    lruHead = e;
+  }
+
+  bitmap->x = e->x;
+  bitmap->y = e->y;
+  bitmap->w = e->w;
+  bitmap->h = e->h;
+  bitmap->aa = aa;
+  memcpy(data, e->data, e->dataSize);
+  ++hits;
+  gUnlockMutex(&mutex);
+  return gTrue;
+}
+
+void SplashGlyphCache::insert(SplashFontFingerprint *fp, SplashCoord *mat,
+			      GBool aa, int c, int xFrac, int yFrac,
+			      SplashGlyphBitmap *bitmap) {
+  SplashGlyphCacheEntry *e;
+  Guint h;
+  int size;
+
+  if (aa) {
+    size = bitmap->w * bitmap->h;
+  } else {
+    size = ((bitmap->w + 7) >> 3) * bitmap->h;
+  }
+  h = hashKey(fp, mat, aa, c, xFrac, yFrac);
+
+  gLockMutex(&mutex);
+  if ((Gulong)(size + entryOverhead) > maxBytes ||
+      find(h, fp, mat, aa, c, xFrac, yFrac)) {
+    // too big for the budget, or another thread got there first
+    gUnlockMutex(&mutex);
+    return;
+  }
+  evict(maxBytes - (size + entryOverhead));
+
+  e = (SplashGlyphCacheEntry *)gmalloc(sizeof(SplashGlyphCacheEntry));
+  e->hash = h;
+  e->fp = *fp;
+  e->mat[0] = mat[0];
+  e->mat[1] = mat[1];
+  e->mat[2] = mat[2];
+  e->mat[3] = mat[3];
+  e->aa = aa;
+  e->c = c;
+  e->xFrac = (short)xFrac;
+  e->yFrac = (short)yFrac;
+  e->x = bitmap->x;
+  e->y = bitmap->y;
+  e->w = bitmap->w;
+  e->h = bitmap->h;
+  e->dataSize = size;
+  e->data = (Guchar *)gmalloc(size > 0 ? size : 1);
+  memcpy(e->data, bitmap->data, size);
+
+  e->next = tab[h & (tabSize - 1)];
+  tab[h & (tabSize - 1)] = e;
+  e->lruPrev = NULL;
+  e->lruNext = lruHead;
+  if (lruHead) {
+    lruHead->lruPrev = e;
+  } else {
+    lruTail = e;
+  }
+  lruHead = e;
+
+  bytes += size + entryOverhead;
+  ++entries;
+  ++insertions;
+  if (entries > (Gulong)tabSize * 2) {
+    growTable();
+  }
+  gUnlockMutex(&mutex);
+}
+
+// Remove <e> from its hash bucket and the LRU list, and free it.
+// Called with the mutex held.
+void SplashGlyphCache::unlinkEntry(SplashGlyphCacheEntry *e) {
+  SplashGlyphCacheEntry **p;
+
+  for (p = &tab[e->hash & (tabSize - 1)]; *p != e; p = &(*p)->next) ;
+  *p = e->next;
+  if (e->lruPrev) {
+    e->lruPrev->lruNext = e->lruNext;
+  } else {
+    lruHead = e->lruNext;
+  }
+  if (e->lruNext) {
+    e->lruNext->lruPrev = e->lruPrev;
+  } else {
+    lruTail = e->lruPrev;
+  }
+  bytes -= e->dataSize + entryOverhead;
+  --entries;
+  gfree(e->data);
+  gfree(e);
+}
+
+// Drop least recently used glyphs until at most <limit> bytes are in
+// use.  Called with the mutex held.
+void SplashGlyphCache::evict(Gulong limit) {
+  while (lruTail && bytes > limit) {
+    unlinkEntry(lruTail);
+    ++evictions;
+  }
+}
+
+// Double the number of hash buckets.  Called with the mutex held.
+void SplashGlyphCache::growTable() {
+  SplashGlyphCacheEntry **newTab;
+  SplashGlyphCacheEntry *e, *next;
+  int newSize, i;
+
+  newSize = tabSize * 2;
+  newTab = (SplashGlyphCacheEntry **)gmallocn(newSize,
+					      sizeof(SplashGlyphCacheEntry *));
+  memset(newTab, 0, newSize * sizeof(SplashGlyphCacheEntry *));
+  for (i = 0; i < tabSize; ++i) {
+    for (e = tab[i]; e; e = next) {
+      next = e->next;
+      e->next = newTab[e->hash & (newSize - 1)];
+      newTab[e->hash & (newSize - 1)] = e;
+    }
+  }
+  gfree(tab);
+  tab = newTab;
+  tabSize = newSize;
+}
+
+void SplashGlyphCache::setMaxBytes(Gulong maxBytesA) {
+  gLockMutex(&mutex);
+  maxBytes = maxBytesA;
+  evict(maxBytes);
+  gUnlockMutex(&mutex);
+}
+
+Gulong SplashGlyphCache::getMaxBytes() {
+  Gulong ret;
+
+  gLockMutex(&mutex);
+  ret = maxBytes;
+  gUnlockMutex(&mutex);
+  return ret;
+}
+
+void SplashGlyphCache::getStats(SplashGlyphCacheStats *stats) {
+  gLockMutex(&mutex);
+  stats->hits = hits;
+  stats->misses = misses;
+  stats->insertions = insertions;
+  stats->evictions = evictions;
+  stats->entries = entries;
+  stats->bytes = bytes;
+  stats->maxBytes = maxBytes;
+  gUnlockMutex(&mutex);
+}
+
+void SplashGlyphCache::resetStats() {
+  gLockMutex(&mutex);
+  hits = misses = insertions = evictions = 0;
+  gUnlockMutex(&mutex);
+}
+
+void SplashGlyphCache::clear() {
+  gLockMutex(&mutex);
+  while (lruTail) {
+    unlinkEntry(lruTail);
+  }
+  gUnlockMutex(&mutex);
+}
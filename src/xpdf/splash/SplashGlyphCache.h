@@ -0,0 +1,119 @@
+//========================================================================
+//
+// SplashGlyphCache.h
+//
+//========================================================================
+
+#ifndef SPLASHGLYPHCACHE_H
+#define SPLASHGLYPHCACHE_H
+
+#include <xpdf-aconf.h>
+
+#ifdef USE_GCC_PRAGMAS
+#pragma interface
+#endif
+
+#include "goo/gtypes.h"
+#include "goo/GMutex.h"
+#include "splash/SplashTypes.h"
+
+struct SplashGlyphBitmap;
+struct SplashGlyphCacheEntry;
+
+//------------------------------------------------------------------------
+
+// Default memory budget of the global glyph cache, in bytes.
+#define splashGlyphCacheDefaultMaxBytes (8 * 1024 * 1024)
+
+//------------------------------------------------------------------------
+// SplashFontFingerprint
+//------------------------------------------------------------------------
+
+// Content based identity of a loaded font file.  Two font files with
+// the same fingerprint produce the same glyph bitmaps, no matter
+// which document (or which SplashFontEngine) loaded them.
+struct SplashFontFingerprint {
+  Guint hash1, hash2;		// two independent hashes of the font data
+  Guint len;			// length of the font data
+  GBool ok;			// false if the font data couldn't be read
+};
+
+//------------------------------------------------------------------------
+// SplashGlyphCacheStats
+//------------------------------------------------------------------------
+
+struct SplashGlyphCacheStats {
+  Gulong hits;			// lookups satisfied by the cache
+  Gulong misses;		// lookups which had to rasterize
+  Gulong insertions;		// glyphs added to the cache
+  Gulong evictions;		// glyphs dropped to stay within budget
+  Gulong entries;		// glyphs currently cached
+  Gulong bytes;			// memory currently used
+  Gulong maxBytes;		// memory budget
+};
+
+//------------------------------------------------------------------------
+// SplashGlyphCache
+//------------------------------------------------------------------------
+
+// Process-wide glyph bitmap cache.  It sits behind the small
+// per-SplashFont caches and keeps rasterized glyphs alive across
+// SplashFontEngine instances, i.e., across documents, repeated
+// SplashOutputDev::startDoc calls and rendering threads.  Glyphs are
+// keyed by font fingerprint, font matrix, anti-aliasing and
+// (sub)pixel offset.  All methods are thread safe.
+class SplashGlyphCache {
+public:
+
+  // Return the process-wide cache.
+  static SplashGlyphCache *getGlobal();
+
+  SplashGlyphCache(Gulong maxBytesA);
+  ~SplashGlyphCache();
+
+  // Look up a glyph.  On success, the bitmap data is copied to
+  // <data> (which has room for <dataSize> bytes) and the glyph
+  // offset/size is stored in <bitmap>.
+  GBool lookup(SplashFontFingerprint *fp, SplashCoord *mat, GBool aa,
+	       int c, int xFrac, int yFrac,
+	       SplashGlyphBitmap *bitmap, Guchar *data, int dataSize);
+
+  // Add a glyph.  The bitmap data is copied.
+  void insert(SplashFontFingerprint *fp, SplashCoord *mat, GBool aa,
+	      int c, int xFrac, int yFrac, SplashGlyphBitmap *bitmap);
+
+  // Set the memory budget, evicting glyphs as needed.  A budget of
+  // zero disables the cache.
+  void setMaxBytes(Gulong maxBytesA);
+  Gulong getMaxBytes();
+
+  // Retrieve/reset the hit statistics.
+  void getStats(SplashGlyphCacheStats *stats);
+  void resetStats();
+
+  // Drop all cached glyphs.
+  void clear();
+
+private:
+
+  static Guint hashKey(SplashFontFingerprint *fp, SplashCoord *mat,
+		       GBool aa, int c, int xFrac, int yFrac);
+  SplashGlyphCacheEntry *find(Guint h, SplashFontFingerprint *fp,
+			      SplashCoord *mat, GBool aa,
+			      int c, int xFrac, int yFrac);
+  void unlinkEntry(SplashGlyphCacheEntry *e);
+  void evict(Gulong limit);
+  void growTable();
+
+  SplashGlyphCacheEntry **tab;	// hash table
+  int tabSize;			// number of hash buckets (power of 2)
+  SplashGlyphCacheEntry *lruHead; // most recently used entry
+  SplashGlyphCacheEntry *lruTail; // least recently used entry
+  Gulong maxBytes;
+  Gulong bytes;
+  Gulong entries;
+  Gulong hits, misses, insertions, evictions;
+  GMutex mutex;
+};
+
+#endif
@@ -4,6 +4,11 @@
 //
 // Copyright 1996-2003 Glyph & Cog, LLC
 //
+// Changes:
+// Michal Hocko - Encryptor for writing of encrypted documents
+// 		- AES uses lookup tables for whole rounds and AES-NI
+// 		  instructions if they are supported by the CPU
+//
 //========================================================================
 
 #include <xpdf-aconf.h>
@@ -13,14 +18,27 @@
 #endif
 
 #include <string.h>
+#include <time.h>
 #include "goo/gmem.h"
 #include "xpdf/Decrypt.h"
 
+// AES-NI instructions are used through intrinsics enabled per function, so
+// the rest of the code doesn't depend on them and the CPU support is
+// checked at runtime
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__)) && \
+    (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#define AESNI_SUPPORT 1
+#include <cpuid.h>
+#include <wmmintrin.h>
+#endif
+
 static void rc4InitKey(Guchar *key, int keyLen, Guchar *state);
 static Guchar rc4DecryptByte(Guchar *state, Guchar *x, Guchar *y, Guchar c);
 static void aesKeyExpansion(DecryptAESState *s,
 			    Guchar *objKey, int objKeyLen);
 static void aesDecryptBlock(DecryptAESState *s, Guchar *in, GBool last);
+static void aesEncryptKeyExpansion(Guint *w, Guchar *rk, Guchar *objKey);
+static void aesEncryptBlock(Guint *w, Guchar *rk, Guchar *in, Guchar *out);
 static void md5(Guchar *msg, int msgLen, Guchar *digest);
 
 static Guchar passwordPad[32] = {
@@ -177,28 +195,11 @@ GBool Decrypt::makeFileKey2(int encVersion, int encRevision, int keyLength,
   return ok;
 }
 
-//------------------------------------------------------------------------
-// DecryptStream
-//------------------------------------------------------------------------
-
-DecryptStream::DecryptStream(Stream *strA, const Guchar *fileKey,
-			     CryptAlgorithm algoA, int keyLength,
-			     int objNum, int objGen):
-  FilterStream(strA)
-{
+int Decrypt::makeObjectKey(const Guchar *fileKey, CryptAlgorithm algo,
+			   int keyLength, int objNum, int objGen,
+			   Guchar *objKey) {
   int n, i;
 
-  algo = algoA;
-
-  // We have to store key and obj releated stuff
-  // into the initContext for clone purposes
-  initContext.fileKey = (Guchar *)gmalloc(sizeof(Guchar)*keyLength);
-  memcpy(initContext.fileKey, fileKey, keyLength);
-  initContext.keyLength = keyLength;
-  initContext.objNum = objNum;
-  initContext.objGen = objGen;
-
-  // construct object key
   for (i = 0; i < keyLength; ++i) {
     objKey[i] = fileKey[i];
   }
@@ -217,9 +218,33 @@ DecryptStream::DecryptStream(Stream *strA, const Guchar *fileKey,
     n = keyLength + 5;
   }
   md5(objKey, n, objKey);
-  if ((objKeyLength = keyLength + 5) > 16) {
-    objKeyLength = 16;
+  if ((n = keyLength + 5) > 16) {
+    n = 16;
   }
+  return n;
+}
+
+//------------------------------------------------------------------------
+// DecryptStream
+//------------------------------------------------------------------------
+
+DecryptStream::DecryptStream(Stream *strA, const Guchar *fileKey,
+			     CryptAlgorithm algoA, int keyLength,
+			     int objNum, int objGen):
+  FilterStream(strA)
+{
+  algo = algoA;
+
+  // We have to store key and obj releated stuff
+  // into the initContext for clone purposes
+  initContext.fileKey = (Guchar *)gmalloc(sizeof(Guchar)*keyLength);
+  memcpy(initContext.fileKey, fileKey, keyLength);
+  initContext.keyLength = keyLength;
+  initContext.objNum = objNum;
+  initContext.objGen = objGen;
+
+  objKeyLength = Decrypt::makeObjectKey(fileKey, algo, keyLength,
+					objNum, objGen, objKey);
 }
 
 // creates new DecryptStream with cloned stream holder
@@ -339,6 +364,92 @@ GBool DecryptStream::isBinary(GBool last)const {
   return str->isBinary(last);
 }
 
+//------------------------------------------------------------------------
+// Encryptor
+//------------------------------------------------------------------------
+
+Encryptor::Encryptor(const Guchar *fileKey, CryptAlgorithm algoA,
+		     int keyLength, int objNum, int objGen) {
+  algo = algoA;
+  objKeyLength = Decrypt::makeObjectKey(fileKey, algo, keyLength,
+					objNum, objGen, objKey);
+}
+
+int Encryptor::getEncryptedLength(int len) const {
+  if (algo == cryptAES) {
+    // initialization vector and padding (always at least one byte)
+    return 16 + (len / 16 + 1) * 16;
+  }
+  return len;
+}
+
+int Encryptor::encrypt(const Guchar *in, int len, Guchar *out) {
+  Guchar rc4State[256];
+  Guchar x, y;
+  Guint w[44];
+  Guchar rk[11 * 16];
+  Guchar block[16];
+  Guchar *cbc;
+  int n, i, j;
+
+  switch (algo) {
+  case cryptRC4:
+    x = y = 0;
+    rc4InitKey(objKey, objKeyLength, rc4State);
+    for (i = 0; i < len; ++i) {
+      out[i] = rc4DecryptByte(rc4State, &x, &y, in[i]);
+    }
+    return len;
+  case cryptAES:
+    aesEncryptKeyExpansion(w, rk, objKey);
+
+    // initialization vector just has to be unpredictable, so it is
+    // derived from the (secret) object key, a counter and time
+    {
+      static Guint counter = 0;
+      Guchar seed[16 + 12];
+      Guint values[3];
+      values[0] = ++counter;
+      values[1] = (Guint)time(NULL);
+      values[2] = (Guint)clock();
+      memcpy(seed, objKey, objKeyLength);
+      for (i = 0; i < 3; ++i) {
+	for (j = 0; j < 4; ++j) {
+	  seed[objKeyLength + 4 * i + j] = (values[i] >> (8 * j)) & 0xff;
+	}
+      }
+      md5(seed, objKeyLength + 12, out);
+    }
+
+    // CBC with the padding added to the last block
+    cbc = out;
+    n = 16;
+    for (i = 0; i <= len; i += 16) {
+      for (j = 0; j < 16; ++j) {
+	block[j] = (i + j < len) ? in[i + j] : (Guchar)(16 - (len - i));
+	block[j] ^= cbc[j];
+      }
+      aesEncryptBlock(w, rk, block, out + n);
+      cbc = out + n;
+      n += 16;
+    }
+    return n;
+  }
+  return 0;
+}
+
+GString *Encryptor::encrypt(const GString *s) {
+  Guchar *buf;
+  GString *ret;
+  int n;
+
+  buf = (Guchar *)gmalloc(getEncryptedLength(s->getLength()));
+  n = encrypt((Guchar *)s->getCString(), s->getLength(), buf);
+  ret = new GString((char *)buf, n);
+  gfree(buf);
+  return ret;
+}
+
 //------------------------------------------------------------------------
 // RC4-compatible decryption
 //------------------------------------------------------------------------
@@ -439,37 +550,6 @@ static inline Guint rotWord(Guint x) {
   return ((x << 8) & 0xffffffff) | (x >> 24);
 }
 
-static inline void invSubBytes(Guchar *state) {
-  int i;
-
-  for (i = 0; i < 16; ++i) {
-    state[i] = invSbox[state[i]];
-  }
-}
-
-static inline void invShiftRows(Guchar *state) {
-  Guchar t;
-
-  t = state[7];
-  state[7] = state[6];
-  state[6] = state[5];
-  state[5] = state[4];
-  state[4] = t;
-
-  t = state[8];
-  state[8] = state[10];
-  state[10] = t;
-  t = state[9];
-  state[9] = state[11];
-  state[11] = t;
-
-  t = state[12];
-  state[12] = state[13];
-  state[13] = state[14];
-  state[14] = state[15];
-  state[15] = t;
-}
-
 // {09} \cdot s
 static inline Guchar mul09(Guchar s) {
   Guchar s2, s4, s8;
@@ -510,22 +590,6 @@ static inline Guchar mul0e(Guchar s) {
   return s2 ^ s4 ^ s8;
 }
 
-static inline void invMixColumns(Guchar *state) {
-  int c;
-  Guchar s0, s1, s2, s3;
-
-  for (c = 0; c < 4; ++c) {
-    s0 = state[c];
-    s1 = state[4+c];
-    s2 = state[8+c];
-    s3 = state[12+c];
-    state[c] =    mul0e(s0) ^ mul0b(s1) ^ mul0d(s2) ^ mul09(s3);
-    state[4+c] =  mul09(s0) ^ mul0e(s1) ^ mul0b(s2) ^ mul0d(s3);
-    state[8+c] =  mul0d(s0) ^ mul09(s1) ^ mul0e(s2) ^ mul0b(s3);
-    state[12+c] = mul0b(s0) ^ mul0d(s1) ^ mul09(s2) ^ mul0e(s3);
-  }
-}
-
 static inline void invMixColumnsW(Guint *w) {
   int c;
   Guchar s0, s1, s2, s3;
@@ -542,77 +606,252 @@ static inline void invMixColumnsW(Guint *w) {
   }
 }
 
-static inline void addRoundKey(Guchar *state, Guint *w) {
-  int c;
+// {02} \cdot s
+static inline Guchar mul02(Guchar s) {
+  return (s & 0x80) ? ((s << 1) ^ 0x1b) : (s << 1);
+}
 
-  for (c = 0; c < 4; ++c) {
-    state[c] ^= w[c] >> 24;
-    state[4+c] ^= w[c] >> 16;
-    state[8+c] ^= w[c] >> 8;
-    state[12+c] ^= w[c];
+// Lookup tables for whole rounds.  te[0][x] is the column produced by
+// SubBytes and MixColumns from byte x in the first row, te[1..3] are the
+// same for other rows (just rotated).  td are the same for InvSubBytes and
+// InvMixColumns.
+struct AESTables {
+  Guint te[4][256];
+  Guint td[4][256];
+  GBool aesni;			// AES-NI instructions are available
+
+  AESTables();
+};
+
+AESTables::AESTables() {
+  Guint t, u;
+  Guchar s, si;
+  int i, j;
+
+  for (i = 0; i < 256; ++i) {
+    s = sbox[i];
+    si = invSbox[i];
+    t = ((Guint)mul02(s) << 24) | ((Guint)s << 16) | ((Guint)s << 8)
+        | (Guint)(mul02(s) ^ s);
+    u = ((Guint)mul0e(si) << 24) | ((Guint)mul09(si) << 16)
+        | ((Guint)mul0d(si) << 8) | (Guint)mul0b(si);
+    for (j = 0; j < 4; ++j) {
+      te[j][i] = t;
+      td[j][i] = u;
+      t = (t >> 8) | (t << 24);
+      u = (u >> 8) | (u << 24);
+    }
   }
+
+  aesni = gFalse;
+#ifdef AESNI_SUPPORT
+  unsigned int eax, ebx, ecx, edx;
+  if (__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+    aesni = (ecx & bit_AES) != 0;
+  }
+#endif
 }
 
-static void aesKeyExpansion(DecryptAESState *s,
-			    Guchar *objKey, int objKeyLen) {
+static AESTables aesTables;
+
+static inline Guint getWord(Guchar *p) {
+  return ((Guint)p[0] << 24) | ((Guint)p[1] << 16) | ((Guint)p[2] << 8)
+         | (Guint)p[3];
+}
+
+static inline void putWord(Guint x, Guchar *p) {
+  p[0] = x >> 24;
+  p[1] = x >> 16;
+  p[2] = x >> 8;
+  p[3] = x;
+}
+
+// round keys in byte order (as used by AES-NI)
+static void aesRoundKeys(Guint *w, Guchar *rk) {
+  int i;
+
+  for (i = 0; i < 44; ++i) {
+    putWord(w[i], rk + 4 * i);
+  }
+}
+
+static void aesEncryptKeyExpansion(Guint *w, Guchar *rk, Guchar *objKey) {
   Guint temp;
-  int i, round;
+  int i;
 
   //~ this assumes objKeyLen == 16
 
   for (i = 0; i < 4; ++i) {
-    s->w[i] = (objKey[4*i] << 24) + (objKey[4*i+1] << 16) +
-              (objKey[4*i+2] << 8) + objKey[4*i+3];
+    w[i] = getWord(objKey + 4 * i);
   }
   for (i = 4; i < 44; ++i) {
-    temp = s->w[i-1];
+    temp = w[i-1];
     if (!(i & 3)) {
       temp = subWord(rotWord(temp)) ^ rcon[i/4];
     }
-    s->w[i] = s->w[i-4] ^ temp;
+    w[i] = w[i-4] ^ temp;
   }
+  aesRoundKeys(w, rk);
+}
+
+static void aesKeyExpansion(DecryptAESState *s,
+			    Guchar *objKey, int objKeyLen) {
+  int round;
+
+  // keys for the equivalent inverse cipher
+  aesEncryptKeyExpansion(s->w, s->rk, objKey);
   for (round = 1; round <= 9; ++round) {
     invMixColumnsW(&s->w[round * 4]);
   }
+  aesRoundKeys(s->w, s->rk);
 }
 
-static void aesDecryptBlock(DecryptAESState *s, Guchar *in, GBool last) {
-  int c, round, n, i;
+#ifdef AESNI_SUPPORT
 
-  // initial state
-  for (c = 0; c < 4; ++c) {
-    s->state[c] = in[4*c];
-    s->state[4+c] = in[4*c+1];
-    s->state[8+c] = in[4*c+2];
-    s->state[12+c] = in[4*c+3];
+__attribute__((target("aes,sse2")))
+static void aesniEncryptBlock(Guchar *rk, Guchar *in, Guchar *out) {
+  __m128i state;
+  int round;
+
+  state = _mm_xor_si128(_mm_loadu_si128((__m128i *)in),
+			_mm_loadu_si128((__m128i *)rk));
+  for (round = 1; round <= 9; ++round) {
+    state = _mm_aesenc_si128(state,
+			     _mm_loadu_si128((__m128i *)(rk + round * 16)));
+  }
+  state = _mm_aesenclast_si128(state,
+			       _mm_loadu_si128((__m128i *)(rk + 10 * 16)));
+  _mm_storeu_si128((__m128i *)out, state);
+}
+
+__attribute__((target("aes,sse2")))
+static void aesniDecryptBlock(Guchar *rk, Guchar *in, Guchar *out) {
+  __m128i state;
+  int round;
+
+  state = _mm_xor_si128(_mm_loadu_si128((__m128i *)in),
+			_mm_loadu_si128((__m128i *)(rk + 10 * 16)));
+  for (round = 9; round >= 1; --round) {
+    state = _mm_aesdec_si128(state,
+			     _mm_loadu_si128((__m128i *)(rk + round * 16)));
+  }
+  state = _mm_aesdeclast_si128(state, _mm_loadu_si128((__m128i *)rk));
+  _mm_storeu_si128((__m128i *)out, state);
+}
+
+#endif
+
+static void aesEncryptBlock(Guint *w, Guchar *rk, Guchar *in, Guchar *out) {
+  Guint s0, s1, s2, s3, t0, t1, t2, t3;
+  int round;
+
+#ifdef AESNI_SUPPORT
+  if (aesTables.aesni) {
+    aesniEncryptBlock(rk, in, out);
+    return;
   }
+#endif
 
   // round 0
-  addRoundKey(s->state, &s->w[10 * 4]);
+  s0 = getWord(in) ^ w[0];
+  s1 = getWord(in + 4) ^ w[1];
+  s2 = getWord(in + 8) ^ w[2];
+  s3 = getWord(in + 12) ^ w[3];
 
   // rounds 1-9
-  for (round = 9; round >= 1; --round) {
-    invSubBytes(s->state);
-    invShiftRows(s->state);
-    invMixColumns(s->state);
-    addRoundKey(s->state, &s->w[round * 4]);
+  for (round = 1; round <= 9; ++round) {
+    t0 = aesTables.te[0][s0 >> 24] ^ aesTables.te[1][(s1 >> 16) & 0xff]
+         ^ aesTables.te[2][(s2 >> 8) & 0xff] ^ aesTables.te[3][s3 & 0xff]
+         ^ w[round * 4];
+    t1 = aesTables.te[0][s1 >> 24] ^ aesTables.te[1][(s2 >> 16) & 0xff]
+         ^ aesTables.te[2][(s3 >> 8) & 0xff] ^ aesTables.te[3][s0 & 0xff]
+         ^ w[round * 4 + 1];
+    t2 = aesTables.te[0][s2 >> 24] ^ aesTables.te[1][(s3 >> 16) & 0xff]
+         ^ aesTables.te[2][(s0 >> 8) & 0xff] ^ aesTables.te[3][s1 & 0xff]
+         ^ w[round * 4 + 2];
+    t3 = aesTables.te[0][s3 >> 24] ^ aesTables.te[1][(s0 >> 16) & 0xff]
+         ^ aesTables.te[2][(s1 >> 8) & 0xff] ^ aesTables.te[3][s2 & 0xff]
+         ^ w[round * 4 + 3];
+    s0 = t0; s1 = t1; s2 = t2; s3 = t3;
   }
 
   // round 10
-  invSubBytes(s->state);
-  invShiftRows(s->state);
-  addRoundKey(s->state, &s->w[0]);
+  putWord(((Guint)sbox[s0 >> 24] << 24) | ((Guint)sbox[(s1 >> 16) & 0xff] << 16)
+	  | ((Guint)sbox[(s2 >> 8) & 0xff] << 8) | (Guint)sbox[s3 & 0xff],
+	  out);
+  putWord(((Guint)sbox[s1 >> 24] << 24) | ((Guint)sbox[(s2 >> 16) & 0xff] << 16)
+	  | ((Guint)sbox[(s3 >> 8) & 0xff] << 8) | (Guint)sbox[s0 & 0xff],
+	  out + 4);
+  putWord(((Guint)sbox[s2 >> 24] << 24) | ((Guint)sbox[(s3 >> 16) & 0xff] << 16)
+	  | ((Guint)sbox[(s0 >> 8) & 0xff] << 8) | (Guint)sbox[s1 & 0xff],
+	  out + 8);
+  putWord(((Guint)sbox[s3 >> 24] << 24) | ((Guint)sbox[(s0 >> 16) & 0xff] << 16)
+	  | ((Guint)sbox[(s1 >> 8) & 0xff] << 8) | (Guint)sbox[s2 & 0xff],
+	  out + 12);
+  for (round = 0; round < 4; ++round) {
+    putWord(getWord(out + 4 * round) ^ w[40 + round], out + 4 * round);
+  }
+}
 
-  // CBC
-  for (c = 0; c < 4; ++c) {
-    s->buf[4*c] = s->state[c] ^ s->cbc[4*c];
-    s->buf[4*c+1] = s->state[4+c] ^ s->cbc[4*c+1];
-    s->buf[4*c+2] = s->state[8+c] ^ s->cbc[4*c+2];
-    s->buf[4*c+3] = s->state[12+c] ^ s->cbc[4*c+3];
+static void aesDecryptWords(Guint *w, Guchar *in, Guchar *out) {
+  Guint s0, s1, s2, s3, t0, t1, t2, t3;
+  int round;
+
+  // round 0
+  s0 = getWord(in) ^ w[40];
+  s1 = getWord(in + 4) ^ w[41];
+  s2 = getWord(in + 8) ^ w[42];
+  s3 = getWord(in + 12) ^ w[43];
+
+  // rounds 1-9
+  for (round = 9; round >= 1; --round) {
+    t0 = aesTables.td[0][s0 >> 24] ^ aesTables.td[1][(s3 >> 16) & 0xff]
+         ^ aesTables.td[2][(s2 >> 8) & 0xff] ^ aesTables.td[3][s1 & 0xff]
+         ^ w[round * 4];
+    t1 = aesTables.td[0][s1 >> 24] ^ aesTables.td[1][(s0 >> 16) & 0xff]
+         ^ aesTables.td[2][(s3 >> 8) & 0xff] ^ aesTables.td[3][s2 & 0xff]
+         ^ w[round * 4 + 1];
+    t2 = aesTables.td[0][s2 >> 24] ^ aesTables.td[1][(s1 >> 16) & 0xff]
+         ^ aesTables.td[2][(s0 >> 8) & 0xff] ^ aesTables.td[3][s3 & 0xff]
+         ^ w[round * 4 + 2];
+    t3 = aesTables.td[0][s3 >> 24] ^ aesTables.td[1][(s2 >> 16) & 0xff]
+         ^ aesTables.td[2][(s1 >> 8) & 0xff] ^ aesTables.td[3][s0 & 0xff]
+         ^ w[round * 4 + 3];
+    s0 = t0; s1 = t1; s2 = t2; s3 = t3;
   }
 
-  // save the input block for the next CBC
+  // round 10
+  putWord((((Guint)invSbox[s0 >> 24] << 24)
+	   | ((Guint)invSbox[(s3 >> 16) & 0xff] << 16)
+	   | ((Guint)invSbox[(s2 >> 8) & 0xff] << 8)
+	   | (Guint)invSbox[s1 & 0xff]) ^ w[0], out);
+  putWord((((Guint)invSbox[s1 >> 24] << 24)
+	   | ((Guint)invSbox[(s0 >> 16) & 0xff] << 16)
+	   | ((Guint)invSbox[(s3 >> 8) & 0xff] << 8)
+	   | (Guint)invSbox[s2 & 0xff]) ^ w[1], out + 4);
+  putWord((((Guint)invSbox[s2 >> 24] << 24)
+	   | ((Guint)invSbox[(s1 >> 16) & 0xff] << 16)
+	   | ((Guint)invSbox[(s0 >> 8) & 0xff] << 8)
+	   | (Guint)invSbox[s3 & 0xff]) ^ w[2], out + 8);
+  putWord((((Guint)invSbox[s3 >> 24] << 24)
+	   | ((Guint)invSbox[(s2 >> 16) & 0xff] << 16)
+	   | ((Guint)invSbox[(s1 >> 8) & 0xff] << 8)
+	   | (Guint)invSbox[s0 & 0xff]) ^ w[3], out + 12);
+}
+
+static void aesDecryptBlock(DecryptAESState *s, Guchar *in, GBool last) {
+  int n, i;
+
+#ifdef AESNI_SUPPORT
+  if (aesTables.aesni) {
+    aesniDecryptBlock(s->rk, in, s->buf);
+  } else
+#endif
+  aesDecryptWords(s->w, in, s->buf);
+
+  // CBC and save the input block for the next CBC
   for (i = 0; i < 16; ++i) {
+    s->buf[i] ^= s->cbc[i];
     s->cbc[i] = in[i];
   }
 
@@ -620,6 +859,9 @@ static void aesDecryptBlock(DecryptAESState *s, Guchar *in, GBool last) {
   s->bufIdx = 0;
   if (last) {
     n = s->buf[15];
+    if (n < 1 || n > 16) { // this should never happen, but just in case
+      n = 16;
+    }
     for (i = 15; i >= n; --i) {
       s->buf[i] = s->buf[i-n];
     }
@@ -9,6 +9,8 @@
 // 		- key and object releated information given to the DecryptStream
 // 		  constructor are stored in DecryptContext context to enable
 // 		  clone implementation 
+// 		- Encryptor class for writing of encrypted documents
+// 		- table based AES (AES-NI if the CPU supports it)
 //
 //========================================================================
 
@@ -45,6 +47,13 @@ public:
 			   Guchar *fileKey, GBool encryptMetadata,
 			   GBool *ownerPasswordOk);
 
+  // Generate the key for the object <objNum> <objGen> from the file key
+  // to <objKey> (at least 16 + 9 bytes).  Returns the length of the
+  // object key.
+  static int makeObjectKey(const Guchar *fileKey, CryptAlgorithm algo,
+			   int keyLength, int objNum, int objGen,
+			   Guchar *objKey);
+
 private:
 
   static GBool makeFileKey2(int encVersion, int encRevision, int keyLength,
@@ -66,7 +75,7 @@ struct DecryptRC4State {
 
 struct DecryptAESState {
   Guint w[44];
-  Guchar state[16];
+  Guchar rk[11 * 16];		// round keys for AES-NI
   Guchar cbc[16];
   Guchar buf[16];
   int bufIdx;
@@ -109,4 +118,34 @@ private:
   DecryptContext initContext;
 };
 
+//------------------------------------------------------------------------
+// Encryptor
+//------------------------------------------------------------------------
+
+// Encrypts strings and stream data of one object, so that DecryptStream
+// created with the same parameters decrypts them.
+class Encryptor {
+public:
+
+  Encryptor(const Guchar *fileKey, CryptAlgorithm algoA, int keyLength,
+	    int objNum, int objGen);
+
+  // Returns the size of encrypted <len> bytes.
+  int getEncryptedLength(int len) const;
+
+  // Encrypt <len> bytes of <in> to <out>, which must have space for
+  // getEncryptedLength(<len>) bytes.  AES data are prefixed by a random
+  // initialization vector and padded.  Returns number of bytes written.
+  int encrypt(const Guchar *in, int len, Guchar *out);
+
+  // Returns a new encrypted copy of the string.
+  GString *encrypt(const GString *s);
+
+private:
+
+  CryptAlgorithm algo;
+  int objKeyLength;
+  Guchar objKey[16 + 9];
+};
+
 #endif
@@ -0,0 +1,1104 @@
+//========================================================================
+//
+// DisplayListOutputDev.cc
+//
+//========================================================================
+
+#include <xpdf-aconf.h>
+
+#ifdef USE_GCC_PRAGMAS
+#pragma implementation
+#endif
+
+#include <string.h>
+#include "goo/gmem.h"
+#include "goo/GList.h"
+#include "goo/GString.h"
+#include "xpdf/Object.h"
+#include "xpdf/Stream.h"
+#include "xpdf/Function.h"
+#include "xpdf/GfxFont.h"
+#include "xpdf/Page.h"
+#include "xpdf/DisplayListOutputDev.h"
+
+//------------------------------------------------------------------------
+
+enum DisplayListOpKind {
+  dlSaveState,
+  dlRestoreState,
+  dlUpdateAll,
+  dlUpdateCTM,
+  dlUpdateLineDash,
+  dlUpdateFlatness,
+  dlUpdateLineJoin,
+  dlUpdateLineCap,
+  dlUpdateMiterLimit,
+  dlUpdateLineWidth,
+  dlUpdateStrokeAdjust,
+  dlUpdateFillColorSpace,
+  dlUpdateStrokeColorSpace,
+  dlUpdateFillColor,
+  dlUpdateStrokeColor,
+  dlUpdateBlendMode,
+  dlUpdateFillOpacity,
+  dlUpdateStrokeOpacity,
+  dlUpdateFillOverprint,
+  dlUpdateStrokeOverprint,
+  dlUpdateTransfer,
+  dlUpdateFont,
+  dlUpdateTextMat,
+  dlUpdateCharSpace,
+  dlUpdateRender,
+  dlUpdateRise,
+  dlUpdateWordSpace,
+  dlUpdateHorizScaling,
+  dlUpdateTextPos,
+  dlUpdateTextShift,
+  dlStroke,
+  dlFill,
+  dlEOFill,
+  dlClip,
+  dlEOClip,
+  dlClipToStrokePath,
+  dlBeginStringOp,
+  dlEndStringOp,
+  dlBeginString,
+  dlEndString,
+  dlDrawChar,
+  dlBeginType3Char,
+  dlEndType3Char,
+  dlEndTextObject,
+  dlDrawImageMask,
+  dlDrawImage,
+  dlDrawMaskedImage,
+  dlDrawSoftMaskedImage,
+  dlType3D0,
+  dlType3D1,
+  dlBeginTransparencyGroup,
+  dlEndTransparencyGroup,
+  dlPaintTransparencyGroup,
+  dlSetSoftMask,
+  dlClearSoftMask,
+  dlSetVectorAntialias
+};
+
+struct DisplayListOp {
+  int kind;
+  int state;			// index into the states array, or -1
+  double c[6];			// numeric arguments
+  int i[5];			// integer/boolean arguments
+  CharCode code;
+  GfxPath *path;		// path (user space), for path ops
+  GString *s;			// string, for beginString
+  Unicode *u;			// Unicode mapping, for chars
+  DisplayListImage *img;	// image data
+  DisplayListImage *mask;	// mask data
+  GfxImageColorMap *colorMap;
+  GfxImageColorMap *maskColorMap;
+  int *maskColors;
+  GfxColorSpace *colorSpace;	// transparency group blending space
+  Function *func;		// soft mask transfer function
+  GfxColor *color;		// soft mask backdrop
+};
+
+struct DisplayListState {
+  GfxState *state;
+  double ctm[6];		// CTM as recorded
+};
+
+struct DisplayListImage {
+  GBool hasRef;
+  Ref ref;			// image XObject, if any
+  char *data;			// decoded samples
+  Guint size;
+};
+
+// Concatenate: apply <a> first, then <b>.
+static void concatMat(const double *a, const double *b, double *r) {
+  double t[6];
+
+  t[0] = a[0] * b[0] + a[1] * b[2];
+  t[1] = a[0] * b[1] + a[1] * b[3];
+  t[2] = a[2] * b[0] + a[3] * b[2];
+  t[3] = a[2] * b[1] + a[3] * b[3];
+  t[4] = a[4] * b[0] + a[5] * b[2] + b[4];
+  t[5] = a[4] * b[1] + a[5] * b[3] + b[5];
+  memcpy(r, t, 6 * sizeof(double));
+}
+
+static GBool invertMat(const double *m, double *r) {
+  double det;
+
+  det = m[0] * m[3] - m[1] * m[2];
+  if (det == 0) {
+    return gFalse;
+  }
+  det = 1 / det;
+  r[0] = m[3] * det;
+  r[1] = -m[1] * det;
+  r[2] = -m[2] * det;
+  r[3] = m[0] * det;
+  r[4] = (m[2] * m[5] - m[3] * m[4]) * det;
+  r[5] = (m[1] * m[4] - m[0] * m[5]) * det;
+  return gTrue;
+}
+
+//------------------------------------------------------------------------
+// DisplayListOutputDev
+//------------------------------------------------------------------------
+
+DisplayListOutputDev::DisplayListOutputDev(Gulong maxImageBytesA) {
+  ops = NULL;
+  length = size = 0;
+  states = NULL;
+  nStates = statesSize = 0;
+  images = new GList();
+  fonts = new GList();
+  lastState = NULL;
+  stateDirty = gTrue;
+  firstPending = -1;
+  imageBytes = 0;
+  maxImageBytes = maxImageBytesA;
+  recHDPI = recVDPI = 72;
+  resolutionDependent = gFalse;
+  ok = gFalse;
+}
+
+DisplayListOutputDev::~DisplayListOutputDev() {
+  clear();
+  gfree(ops);
+  gfree(states);
+  delete images;
+  delete fonts;
+}
+
+void DisplayListOutputDev::clear() {
+  DisplayListOp *op;
+  DisplayListImage *img;
+  int i;
+
+  for (i = 0; i < length; ++i) {
+    op = &ops[i];
+    if (op->path) {
+      delete op->path;
+    }
+    if (op->s) {
+      delete op->s;
+    }
+    gfree(op->u);
+    if (op->colorMap) {
+      delete op->colorMap;
+    }
+    if (op->maskColorMap) {
+      delete op->maskColorMap;
+    }
+    gfree(op->maskColors);
+    if (op->colorSpace) {
+      delete op->colorSpace;
+    }
+    if (op->func) {
+      delete op->func;
+    }
+    gfree(op->color);
+  }
+  length = 0;
+  for (i = 0; i < nStates; ++i) {
+    delete states[i].state;
+  }
+  nStates = 0;
+  for (i = 0; i < images->getLength(); ++i) {
+    img = (DisplayListImage *)images->get(i);
+    gfree(img->data);
+    gfree(img);
+  }
+  delete images;
+  images = new GList();
+  for (i = 0; i < fonts->getLength(); ++i) {
+    ((GfxFont *)fonts->get(i))->decRefCnt();
+  }
+  delete fonts;
+  fonts = new GList();
+  lastState = NULL;
+  stateDirty = gTrue;
+  firstPending = -1;
+  imageBytes = 0;
+  resolutionDependent = gFalse;
+  ok = gFalse;
+}
+
+void DisplayListOutputDev::record(const Page *page, const Catalog *catalog,
+				  double hDPI, double vDPI) {
+  clear();
+  ok = gTrue;
+  recHDPI = hDPI;
+  recVDPI = vDPI;
+
+  // the whole media box, uncropped, so that any slice can be replayed
+  page->displaySlice(this, hDPI, vDPI, 0, gTrue, gFalse, -1, -1, -1, -1,
+		     gFalse, catalog, &abortCheck, this);
+
+  if (!ok) {
+    clear();
+  }
+}
+
+// Stop interpreting the page once the recording has given up.
+GBool DisplayListOutputDev::abortCheck(void *data) {
+  return !((DisplayListOutputDev *)data)->ok;
+}
+
+Gulong DisplayListOutputDev::getMemoryUsage() {
+  return (Gulong)size * sizeof(DisplayListOp) +
+         (Gulong)statesSize * sizeof(DisplayListState) +
+         (Gulong)nStates * sizeof(GfxState) +
+         imageBytes;
+}
+
+// Take a snapshot of <state>, and hand it to the update ops recorded
+// since the last one.
+int DisplayListOutputDev::snapshot(GfxState *state) {
+  DisplayListState *st;
+  GfxFont *font;
+  int i;
+
+  if (nStates == statesSize) {
+    statesSize = statesSize ? 2 * statesSize : 64;
+    states = (DisplayListState *)greallocn(states, statesSize,
+					   sizeof(DisplayListState));
+  }
+  st = &states[nStates];
+  st->state = state->copy(false);
+  memcpy(st->ctm, state->getCTM(), 6 * sizeof(double));
+
+  // the fonts belong to the resource dictionaries, which go away with
+  // the Gfx object
+  if ((font = (GfxFont *)state->getFont())) {
+    for (i = 0; i < fonts->getLength(); ++i) {
+      if (fonts->get(i) == font) {
+	break;
+      }
+    }
+    if (i == fonts->getLength()) {
+      font->incRefCnt();
+      fonts->append(font);
+    }
+  }
+
+  if (firstPending >= 0) {
+    for (i = firstPending; i < length; ++i) {
+      if (ops[i].state < 0) {
+	ops[i].state = nStates;
+      }
+    }
+    firstPending = -1;
+  }
+  lastState = state;
+  stateDirty = gFalse;
+  return nStates++;
+}
+
+DisplayListOp *DisplayListOutputDev::addOp(int kind, GfxState *state) {
+  DisplayListOp *op;
+  int stateIdx;
+
+  // Gfx hands out a new GfxState object on save/restore
+  if (state && (stateDirty || state != lastState)) {
+    stateIdx = snapshot(state);
+  } else {
+    stateIdx = state ? nStates - 1 : -1;
+  }
+  if (length == size) {
+    size = size ? 2 * size : 256;
+    ops = (DisplayListOp *)greallocn(ops, size, sizeof(DisplayListOp));
+  }
+  op = &ops[length++];
+  memset(op, 0, sizeof(DisplayListOp));
+  op->kind = kind;
+  op->state = stateIdx;
+  return op;
+}
+
+// Record a state update.  The snapshot is taken lazily, when the next
+// drawing operation needs it, so that a run of updates shares one.
+DisplayListOp *DisplayListOutputDev::addUpdate(int kind, GfxState *state) {
+  DisplayListOp *op;
+
+  if (length == size) {
+    size = size ? 2 * size : 256;
+    ops = (DisplayListOp *)greallocn(ops, size, sizeof(DisplayListOp));
+  }
+  op = &ops[length];
+  memset(op, 0, sizeof(DisplayListOp));
+  op->kind = kind;
+  op->state = -1;
+  if (firstPending < 0) {
+    firstPending = length;
+  }
+  ++length;
+  lastState = state;
+  stateDirty = gTrue;
+  return op;
+}
+
+// Read <size> bytes of decoded samples from <str>.  Image XObjects
+// drawn more than once are read only once.
+DisplayListImage *DisplayListOutputDev::readImage(Object *ref, Stream *str,
+						  Guint size) {
+  DisplayListImage *img;
+  Guint i;
+  int c, j;
+
+  if (ref && ref->isRef()) {
+    for (j = 0; j < images->getLength(); ++j) {
+      img = (DisplayListImage *)images->get(j);
+      if (img->hasRef && img->ref.num == ref->getRefNum() &&
+	  img->ref.gen == ref->getRefGen() && img->size == size) {
+	return img;
+      }
+    }
+  }
+  if (imageBytes + size > maxImageBytes) {
+    ok = gFalse;
+    return NULL;
+  }
+
+  img = (DisplayListImage *)gmalloc(sizeof(DisplayListImage));
+  img->hasRef = ref && ref->isRef();
+  if (img->hasRef) {
+    img->ref = ref->getRef();
+  }
+  img->size = size;
+  img->data = (char *)gmalloc(size > 0 ? size : 1);
+  str->reset();
+  for (i = 0; i < size && (c = str->getChar()) != EOF; ++i) {
+    img->data[i] = (char)c;
+  }
+  if (i < size) {
+    memset(img->data + i, 0, size - i);
+  }
+  str->close();
+  images->append(img);
+  imageBytes += size;
+  return img;
+}
+
+//----- recording
+
+void DisplayListOutputDev::startPage(int, GfxState *state) {
+  memcpy(baseCTM, state->getCTM(), 6 * sizeof(double));
+}
+
+void DisplayListOutputDev::endPage() {
+  if (firstPending >= 0) {
+    snapshot(lastState);
+  }
+}
+
+void DisplayListOutputDev::saveState(GfxState *state) {
+  addOp(dlSaveState, state);
+}
+
+void DisplayListOutputDev::restoreState(GfxState *state) {
+  addOp(dlRestoreState, state);
+}
+
+void DisplayListOutputDev::updateAll(GfxState *state) {
+  addUpdate(dlUpdateAll, state);
+}
+
+void DisplayListOutputDev::updateCTM(GfxState *state, double m11, double m12,
+				     double m21, double m22,
+				     double m31, double m32) {
+  DisplayListOp *op;
+
+  op = addUpdate(dlUpdateCTM, state);
+  op->c[0] = m11;
+  op->c[1] = m12;
+  op->c[2] = m21;
+  op->c[3] = m22;
+  op->c[4] = m31;
+  op->c[5] = m32;
+}
+
+void DisplayListOutputDev::updateLineDash(GfxState *state) {
+  addUpdate(dlUpdateLineDash, state);
+}
+
+void DisplayListOutputDev::updateFlatness(GfxState *state) {
+  addUpdate(dlUpdateFlatness, state);
+}
+
+void DisplayListOutputDev::updateLineJoin(GfxState *state) {
+  addUpdate(dlUpdateLineJoin, state);
+}
+
+void DisplayListOutputDev::updateLineCap(GfxState *state) {
+  addUpdate(dlUpdateLineCap, state);
+}
+
+void DisplayListOutputDev::updateMiterLimit(GfxState *state) {
+  addUpdate(dlUpdateMiterLimit, state);
+}
+
+void DisplayListOutputDev::updateLineWidth(GfxState *state) {
+  addUpdate(dlUpdateLineWidth, state);
+}
+
+void DisplayListOutputDev::updateStrokeAdjust(GfxState *state) {
+  addUpdate(dlUpdateStrokeAdjust, state);
+}
+
+void DisplayListOutputDev::updateFillColorSpace(GfxState *state) {
+  addUpdate(dlUpdateFillColorSpace, state);
+}
+
+void DisplayListOutputDev::updateStrokeColorSpace(GfxState *state) {
+  addUpdate(dlUpdateStrokeColorSpace, state);
+}
+
+void DisplayListOutputDev::updateFillColor(GfxState *state) {
+  addUpdate(dlUpdateFillColor, state);
+}
+
+void DisplayListOutputDev::updateStrokeColor(GfxState *state) {
+  addUpdate(dlUpdateStrokeColor, state);
+}
+
+void DisplayListOutputDev::updateBlendMode(GfxState *state) {
+  addUpdate(dlUpdateBlendMode, state);
+}
+
+void DisplayListOutputDev::updateFillOpacity(GfxState *state) {
+  addUpdate(dlUpdateFillOpacity, state);
+}
+
+void DisplayListOutputDev::updateStrokeOpacity(GfxState *state) {
+  addUpdate(dlUpdateStrokeOpacity, state);
+}
+
+void DisplayListOutputDev::updateFillOverprint(GfxState *state) {
+  addUpdate(dlUpdateFillOverprint, state);
+}
+
+void DisplayListOutputDev::updateStrokeOverprint(GfxState *state) {
+  addUpdate(dlUpdateStrokeOverprint, state);
+}
+
+void DisplayListOutputDev::updateTransfer(GfxState *state) {
+  addUpdate(dlUpdateTransfer, state);
+}
+
+void DisplayListOutputDev::updateFont(GfxState *state) {
+  addUpdate(dlUpdateFont, state);
+}
+
+void DisplayListOutputDev::updateTextMat(GfxState *state) {
+  addUpdate(dlUpdateTextMat, state);
+}
+
+void DisplayListOutputDev::updateCharSpace(GfxState *state) {
+  addUpdate(dlUpdateCharSpace, state);
+}
+
+void DisplayListOutputDev::updateRender(GfxState *state) {
+  addUpdate(dlUpdateRender, state);
+}
+
+void DisplayListOutputDev::updateRise(GfxState *state) {
+  addUpdate(dlUpdateRise, state);
+}
+
+void DisplayListOutputDev::updateWordSpace(GfxState *state) {
+  addUpdate(dlUpdateWordSpace, state);
+}
+
+void DisplayListOutputDev::updateHorizScaling(GfxState *state) {
+  addUpdate(dlUpdateHorizScaling, state);
+}
+
+void DisplayListOutputDev::updateTextPos(GfxState *state) {
+  addUpdate(dlUpdateTextPos, state);
+}
+
+void DisplayListOutputDev::updateTextShift(GfxState *state, double shift) {
+  addUpdate(dlUpdateTextShift, state)->c[0] = shift;
+}
+
+void DisplayListOutputDev::stroke(GfxState *state) {
+  addOp(dlStroke, state)->path = state->getPath()->copy();
+}
+
+void DisplayListOutputDev::fill(GfxState *state) {
+  addOp(dlFill, state)->path = state->getPath()->copy();
+}
+
+void DisplayListOutputDev::eoFill(GfxState *state) {
+  addOp(dlEOFill, state)->path = state->getPath()->copy();
+}
+
+void DisplayListOutputDev::clip(GfxState *state) {
+  addOp(dlClip, state)->path = state->getPath()->copy();
+}
+
+void DisplayListOutputDev::eoClip(GfxState *state) {
+  addOp(dlEOClip, state)->path = state->getPath()->copy();
+}
+
+void DisplayListOutputDev::clipToStrokePath(GfxState *state) {
+  addOp(dlClipToStrokePath, state)->path = state->getPath()->copy();
+}
+
+void DisplayListOutputDev::beginStringOp(GfxState *state) {
+  addOp(dlBeginStringOp, state);
+}
+
+void DisplayListOutputDev::endStringOp(GfxState *state) {
+  addOp(dlEndStringOp, state);
+}
+
+void DisplayListOutputDev::beginString(GfxState *state, const GString *s) {
+  addOp(dlBeginString, state)->s = s->copy();
+}
+
+void DisplayListOutputDev::endString(GfxState *state) {
+  addOp(dlEndString, state);
+}
+
+void DisplayListOutputDev::drawChar(GfxState *state, double x, double y,
+				    double dx, double dy,
+				    double originX, double originY,
+				    CharCode code, int nBytes,
+				    const Unicode *u, int uLen) {
+  DisplayListOp *op;
+
+  op = addOp(dlDrawChar, state);
+  op->c[0] = x;
+  op->c[1] = y;
+  op->c[2] = dx;
+  op->c[3] = dy;
+  op->c[4] = originX;
+  op->c[5] = originY;
+  op->code = code;
+  op->i[0] = nBytes;
+  op->i[1] = uLen;
+  if (uLen > 0) {
+    op->u = (Unicode *)gmallocn(uLen, sizeof(Unicode));
+    memcpy(op->u, u, uLen * sizeof(Unicode));
+  }
+}
+
+GBool DisplayListOutputDev::beginType3Char(GfxState *state,
+					   double x, double y,
+					   double dx, double dy,
+					   CharCode code, Unicode *u, int uLen) {
+  DisplayListOp *op;
+
+  op = addOp(dlBeginType3Char, state);
+  op->c[0] = x;
+  op->c[1] = y;
+  op->c[2] = dx;
+  op->c[3] = dy;
+  op->code = code;
+  op->i[1] = uLen;
+  if (uLen > 0) {
+    op->u = (Unicode *)gmallocn(uLen, sizeof(Unicode));
+    memcpy(op->u, u, uLen * sizeof(Unicode));
+  }
+  // always record the glyph procedure -- the target device decides
+  // whether it needs it
+  return gFalse;
+}
+
+void DisplayListOutputDev::endType3Char(GfxState *state) {
+  addOp(dlEndType3Char, state);
+}
+
+void DisplayListOutputDev::endTextObject(GfxState *state) {
+  addOp(dlEndTextObject, state);
+}
+
+void DisplayListOutputDev::drawImageMask(GfxState *state, Object *ref,
+					 Stream *str, int width, int height,
+					 GBool invert, GBool inlineImg) {
+  DisplayListImage *img;
+  DisplayListOp *op;
+
+  if (!(img = readImage(ref, str, height * ((width + 7) >> 3)))) {
+    return;
+  }
+  op = addOp(dlDrawImageMask, state);
+  op->img = img;
+  op->i[0] = width;
+  op->i[1] = height;
+  op->i[2] = invert;
+  op->i[3] = inlineImg;
+}
+
+void DisplayListOutputDev::drawImage(GfxState *state, Object *ref,
+				     Stream *str, int width, int height,
+				     GfxImageColorMap *colorMap,
+				     int *maskColors, GBool inlineImg) {
+  DisplayListImage *img;
+  DisplayListOp *op;
+  int n;
+
+  // may be decoded at a reduced resolution when drawn directly
+  if (!inlineImg && str->getKind() == strDCT) {
+    ok = gFalse;
+    return;
+  }
+  n = colorMap->getNumPixelComps();
+  if (!(img = readImage(ref, str,
+			height * ((width * n * colorMap->getBits() + 7) >> 3)))) {
+    return;
+  }
+  op = addOp(dlDrawImage, state);
+  op->img = img;
+  op->i[0] = width;
+  op->i[1] = height;
+  op->i[3] = inlineImg;
+  op->colorMap = colorMap->copy();
+  if (maskColors) {
+    op->maskColors = (int *)gmallocn(2 * n, sizeof(int));
+    memcpy(op->maskColors, maskColors, 2 * n * sizeof(int));
+  }
+}
+
+void DisplayListOutputDev::drawMaskedImage(GfxState *state, Object *ref,
+					   Stream *str, int width, int height,
+					   GfxImageColorMap *colorMap,
+					   Stream *maskStr,
+					   int maskWidth, int maskHeight,
+					   GBool maskInvert) {
+  DisplayListImage *img, *mask;
+  DisplayListOp *op;
+
+  if (!(img = readImage(ref, str,
+			height * ((width * colorMap->getNumPixelComps() *
+				   colorMap->getBits() + 7) >> 3))) ||
+      !(mask = readImage(NULL, maskStr,
+			 maskHeight * ((maskWidth + 7) >> 3)))) {
+    return;
+  }
+  op = addOp(dlDrawMaskedImage, state);
+  op->img = img;
+  op->mask = mask;
+  op->i[0] = width;
+  op->i[1] = height;
+  op->i[2] = maskWidth;
+  op->i[3] = maskHeight;
+  op->i[4] = maskInvert;
+  op->colorMap = colorMap->copy();
+}
+
+void DisplayListOutputDev::drawSoftMaskedImage(GfxState *state, Object *ref,
+					       Stream *str,
+					       int width, int height,
+					       GfxImageColorMap *colorMap,
+					       Stream *maskStr,
+					       int maskWidth, int maskHeight,
+					       GfxImageColorMap *maskColorMap) {
+  DisplayListImage *img, *mask;
+  DisplayListOp *op;
+
+  if (!(img = readImage(ref, str,
+			height * ((width * colorMap->getNumPixelComps() *
+				   colorMap->getBits() + 7) >> 3))) ||
+      !(mask = readImage(NULL, maskStr,
+			 maskHeight * ((maskWidth *
+					maskColorMap->getNumPixelComps() *
+					maskColorMap->getBits() + 7) >> 3)))) {
+    return;
+  }
+  op = addOp(dlDrawSoftMaskedImage, state);
+  op->img = img;
+  op->mask = mask;
+  op->i[0] = width;
+  op->i[1] = height;
+  op->i[2] = maskWidth;
+  op->i[3] = maskHeight;
+  op->colorMap = colorMap->copy();
+  op->maskColorMap = maskColorMap->copy();
+}
+
+void DisplayListOutputDev::type3D0(GfxState *state, double wx, double wy) {
+  DisplayListOp *op;
+
+  op = addOp(dlType3D0, state);
+  op->c[0] = wx;
+  op->c[1] = wy;
+}
+
+void DisplayListOutputDev::type3D1(GfxState *state, double wx, double wy,
+				   double llx, double lly,
+				   double urx, double ury) {
+  DisplayListOp *op;
+
+  op = addOp(dlType3D1, state);
+  op->c[0] = wx;
+  op->c[1] = wy;
+  op->c[2] = llx;
+  op->c[3] = lly;
+  op->c[4] = urx;
+  op->c[5] = ury;
+}
+
+void DisplayListOutputDev::beginTransparencyGroup(
+				   GfxState *state, const double *bbox,
+				   const GfxColorSpace *blendingColorSpace,
+				   GBool isolated, GBool knockout,
+				   GBool forSoftMask) {
+  DisplayListOp *op;
+
+  op = addOp(dlBeginTransparencyGroup, state);
+  memcpy(op->c, bbox, 4 * sizeof(double));
+  if (blendingColorSpace) {
+    op->colorSpace = blendingColorSpace->copy();
+  }
+  op->i[0] = isolated;
+  op->i[1] = knockout;
+  op->i[2] = forSoftMask;
+}
+
+void DisplayListOutputDev::endTransparencyGroup(GfxState *state) {
+  addOp(dlEndTransparencyGroup, state);
+}
+
+void DisplayListOutputDev::paintTransparencyGroup(GfxState *state,
+						  const double *bbox) {
+  memcpy(addOp(dlPaintTransparencyGroup, state)->c, bbox,
+	 4 * sizeof(double));
+}
+
+void DisplayListOutputDev::setSoftMask(GfxState *state, const double *bbox,
+				       GBool alpha, Function *transferFunc,
+				       const GfxColor *backdropColor) {
+  DisplayListOp *op;
+
+  op = addOp(dlSetSoftMask, state);
+  memcpy(op->c, bbox, 4 * sizeof(double));
+  op->i[0] = alpha;
+  if (transferFunc) {
+    op->func = transferFunc->copy();
+  }
+  op->color = (GfxColor *)gmalloc(sizeof(GfxColor));
+  *op->color = *backdropColor;
+}
+
+void DisplayListOutputDev::clearSoftMask(GfxState *state) {
+  addOp(dlClearSoftMask, state);
+}
+
+void DisplayListOutputDev::setVectorAntialias(GBool vaa) {
+  addOp(dlSetVectorAntialias, NULL)->i[0] = vaa;
+}
+
+GBool DisplayListOutputDev::axialShadedFill(GfxState *, GfxAxialShading *) {
+  resolutionDependent = gTrue;
+  return gFalse;
+}
+
+GBool DisplayListOutputDev::radialShadedFill(GfxState *, GfxRadialShading *) {
+  resolutionDependent = gTrue;
+  return gFalse;
+}
+
+//----- replaying
+
+void DisplayListOutputDev::replay(OutputDev *out, const Page *page,
+				  double hDPI, double vDPI, int rotate,
+				  GBool useMediaBox, GBool crop,
+				  int sliceX, int sliceY,
+				  int sliceW, int sliceH,
+				  GBool (*abortCheckCbk)(void *data),
+				  void *abortCheckCbkData) {
+  PDFRectangle box;
+  const PDFRectangle *cropBox;
+  GfxState *pageState, *state;
+  DisplayListState *st;
+  DisplayListOp *op;
+  MemStream *str, *maskStr;
+  Object dictObj;
+  double adj[6], ictm[6], ctm[6];
+  const double *newCTM;
+  GBool vaa;
+  int depth, i, j;
+
+  if (!ok) {
+    return;
+  }
+
+  rotate += page->getRotate();
+  if (rotate >= 360) {
+    rotate -= 360;
+  } else if (rotate < 0) {
+    rotate += 360;
+  }
+  page->makeBox(hDPI, vDPI, rotate, useMediaBox, out->upsideDown(),
+		sliceX, sliceY, sliceW, sliceH, &box, &crop);
+
+  // same set up as Gfx::Gfx
+  pageState = new GfxState(hDPI, vDPI, &box, rotate, out->upsideDown());
+  out->startPage(page->getNum(), pageState);
+  out->setDefaultCTM(pageState->getCTM());
+  out->updateAll(pageState);
+  if (crop) {
+    cropBox = page->getCropBox();
+    pageState->moveTo(cropBox->x1, cropBox->y1);
+    pageState->lineTo(cropBox->x2, cropBox->y1);
+    pageState->lineTo(cropBox->x2, cropBox->y2);
+    pageState->lineTo(cropBox->x1, cropBox->y2);
+    pageState->closePath();
+    pageState->clip();
+    out->clip(pageState);
+    pageState->clearPath();
+  }
+
+  // recording device space -> target device space
+  invertMat(baseCTM, adj);
+  concatMat(adj, pageState->getCTM(), adj);
+
+  vaa = out->getVectorAntialias();
+  dictObj.initNull();
+
+  for (i = 0; i < length; ++i) {
+    op = &ops[i];
+    if (abortCheckCbk && (i & 0xff) == 0 && (*abortCheckCbk)(abortCheckCbkData)) {
+      break;
+    }
+
+    st = NULL;
+    state = NULL;
+    if (op->state >= 0) {
+      st = &states[op->state];
+      state = st->state;
+      concatMat(st->ctm, adj, ctm);
+      state->setCTM(ctm[0], ctm[1], ctm[2], ctm[3], ctm[4], ctm[5]);
+      memcpy(ctm, state->getCTM(), 6 * sizeof(double));
+      if (op->path) {
+	state->setPath(op->path->copy());
+      }
+    }
+
+    switch (op->kind) {
+    case dlSaveState:
+      out->saveState(state);
+      break;
+    case dlRestoreState:
+      out->restoreState(state);
+      break;
+    case dlUpdateAll:
+      out->updateAll(state);
+      break;
+    case dlUpdateCTM:
+      out->updateCTM(state, op->c[0], op->c[1], op->c[2], op->c[3],
+		     op->c[4], op->c[5]);
+      break;
+    case dlUpdateLineDash:
+      out->updateLineDash(state);
+      break;
+    case dlUpdateFlatness:
+      out->updateFlatness(state);
+      break;
+    case dlUpdateLineJoin:
+      out->updateLineJoin(state);
+      break;
+    case dlUpdateLineCap:
+      out->updateLineCap(state);
+      break;
+    case dlUpdateMiterLimit:
+      out->updateMiterLimit(state);
+      break;
+    case dlUpdateLineWidth:
+      out->updateLineWidth(state);
+      break;
+    case dlUpdateStrokeAdjust:
+      out->updateStrokeAdjust(state);
+      break;
+    case dlUpdateFillColorSpace:
+      out->updateFillColorSpace(state);
+      break;
+    case dlUpdateStrokeColorSpace:
+      out->updateStrokeColorSpace(state);
+      break;
+    case dlUpdateFillColor:
+      out->updateFillColor(state);
+      break;
+    case dlUpdateStrokeColor:
+      out->updateStrokeColor(state);
+      break;
+    case dlUpdateBlendMode:
+      out->updateBlendMode(state);
+      break;
+    case dlUpdateFillOpacity:
+      out->updateFillOpacity(state);
+      break;
+    case dlUpdateStrokeOpacity:
+      out->updateStrokeOpacity(state);
+      break;
+    case dlUpdateFillOverprint:
+      out->updateFillOverprint(state);
+      break;
+    case dlUpdateStrokeOverprint:
+      out->updateStrokeOverprint(state);
+      break;
+    case dlUpdateTransfer:
+      out->updateTransfer(state);
+      break;
+    case dlUpdateFont:
+      out->updateFont(state);
+      break;
+    case dlUpdateTextMat:
+      out->updateTextMat(state);
+      break;
+    case dlUpdateCharSpace:
+      out->updateCharSpace(state);
+      break;
+    case dlUpdateRender:
+      out->updateRender(state);
+      break;
+    case dlUpdateRise:
+      out->updateRise(state);
+      break;
+    case dlUpdateWordSpace:
+      out->updateWordSpace(state);
+      break;
+    case dlUpdateHorizScaling:
+      out->updateHorizScaling(state);
+      break;
+    case dlUpdateTextPos:
+      out->updateTextPos(state);
+      break;
+    case dlUpdateTextShift:
+      out->updateTextShift(state, op->c[0]);
+      break;
+    case dlStroke:
+      out->stroke(state);
+      break;
+    case dlFill:
+      out->fill(state);
+      break;
+    case dlEOFill:
+      out->eoFill(state);
+      break;
+    case dlClip:
+      out->clip(state);
+      break;
+    case dlEOClip:
+      out->eoClip(state);
+      break;
+    case dlClipToStrokePath:
+      out->clipToStrokePath(state);
+      break;
+    case dlBeginStringOp:
+      out->beginStringOp(state);
+      break;
+    case dlEndStringOp:
+      out->endStringOp(state);
+      break;
+    case dlBeginString:
+      out->beginString(state, op->s);
+      break;
+    case dlEndString:
+      out->endString(state);
+      break;
+    case dlDrawChar:
+      out->drawChar(state, op->c[0], op->c[1], op->c[2], op->c[3],
+		    op->c[4], op->c[5], op->code, op->i[0], op->u, op->i[1]);
+      break;
+    case dlBeginType3Char:
+      if (out->beginType3Char(state, op->c[0], op->c[1], op->c[2], op->c[3],
+			      op->code, op->u, op->i[1])) {
+	// the device has the glyph already -- skip the glyph procedure,
+	// including its endType3Char
+	for (depth = 1, j = i + 1; j < length; ++j) {
+	  if (ops[j].kind == dlBeginType3Char) {
+	    ++depth;
+	  } else if (ops[j].kind == dlEndType3Char && --depth == 0) {
+	    break;
+	  }
+	}
+	i = j;
+      }
+      break;
+    case dlEndType3Char:
+      out->endType3Char(state);
+      break;
+    case dlEndTextObject:
+      out->endTextObject(state);
+      break;
+    case dlDrawImageMask:
+      str = new MemStream(op->img->data, 0, op->img->size, &dictObj);
+      out->drawImageMask(state, NULL, str, op->i[0], op->i[1],
+			 op->i[2], op->i[3]);
+      delete str;
+      break;
+    case dlDrawImage:
+      str = new MemStream(op->img->data, 0, op->img->size, &dictObj);
+      out->drawImage(state, NULL, str, op->i[0], op->i[1], op->colorMap,
+		     op->maskColors, op->i[3]);
+      delete str;
+      break;
+    case dlDrawMaskedImage:
+      str = new MemStream(op->img->data, 0, op->img->size, &dictObj);
+      maskStr = new MemStream(op->mask->data, 0, op->mask->size, &dictObj);
+      out->drawMaskedImage(state, NULL, str, op->i[0], op->i[1],
+			   op->colorMap, maskStr, op->i[2], op->i[3],
+			   op->i[4]);
+      delete maskStr;
+      delete str;
+      break;
+    case dlDrawSoftMaskedImage:
+      str = new MemStream(op->img->data, 0, op->img->size, &dictObj);
+      maskStr = new MemStream(op->mask->data, 0, op->mask->size, &dictObj);
+      out->drawSoftMaskedImage(state, NULL, str, op->i[0], op->i[1],
+			       op->colorMap, maskStr, op->i[2], op->i[3],
+			       op->maskColorMap);
+      delete maskStr;
+      delete str;
+      break;
+    case dlType3D0:
+      out->type3D0(state, op->c[0], op->c[1]);
+      break;
+    case dlType3D1:
+      out->type3D1(state, op->c[0], op->c[1], op->c[2], op->c[3],
+		   op->c[4], op->c[5]);
+      break;
+    case dlBeginTransparencyGroup:
+      out->beginTransparencyGroup(state, op->c, op->colorSpace,
+				  op->i[0], op->i[1], op->i[2]);
+      break;
+    case dlEndTransparencyGroup:
+      out->endTransparencyGroup(state);
+      break;
+    case dlPaintTransparencyGroup:
+      out->paintTransparencyGroup(state, op->c);
+      break;
+    case dlSetSoftMask:
+      out->setSoftMask(state, op->c, op->i[0], op->func, op->color);
+      break;
+    case dlClearSoftMask:
+      out->clearSoftMask(state);
+      break;
+    case dlSetVectorAntialias:
+      // only switch anti-aliasing back on if the device had it on
+      out->setVectorAntialias(op->i[0] && vaa);
+      break;
+    }
+
+    // Some devices move the CTM of the state they are given, and
+    // expect the following operations to draw relative to that (e.g.,
+    // SplashOutputDev for Type 3 glyphs and transparency groups).
+    // Carry such a change over to the rest of the list.
+    if (st) {
+      newCTM = state->getCTM();
+      if (memcmp(newCTM, ctm, 6 * sizeof(double)) &&
+	  invertMat(st->ctm, ictm)) {
+	concatMat(ictm, newCTM, adj);
+      }
+    }
+  }
+
+  out->endPage();
+  delete pageState;
+}
@@ -0,0 +1,266 @@
+//========================================================================
+//
+// DisplayListOutputDev.h
+//
+//========================================================================
+
+#ifndef DISPLAYLISTOUTPUTDEV_H
+#define DISPLAYLISTOUTPUTDEV_H
+
+#include <xpdf-aconf.h>
+
+#ifdef USE_GCC_PRAGMAS
+#pragma interface
+#endif
+
+#include "goo/gtypes.h"
+#include "xpdf/CharTypes.h"
+#include "xpdf/GfxState.h"
+#include "xpdf/OutputDev.h"
+
+class GList;
+class GfxFont;
+class Page;
+class Catalog;
+struct DisplayListOp;
+struct DisplayListState;
+struct DisplayListImage;
+
+//------------------------------------------------------------------------
+
+// Default limit on the decoded image data kept by one list, in bytes.
+#define displayListDefaultMaxImageBytes (64 * 1024 * 1024)
+
+//------------------------------------------------------------------------
+// DisplayListOutputDev
+//------------------------------------------------------------------------
+
+// Records the drawing operations of a page once, and replays them on
+// another OutputDev at any resolution, rotation or page slice without
+// re-interpreting the content stream.
+//
+// The page is recorded over its whole media box.  Paths are kept in
+// user space, graphics state snapshots are taken only when the state
+// has changed, and image data is decoded once and kept in memory
+// (shared between uses of the same image XObject).  On replay every
+// recorded CTM is mapped from the recording device space to the
+// target one.
+//
+// Shadings and tiling patterns are reduced to fills by Gfx.  Axial
+// and radial shadings are split according to the device resolution,
+// so a list containing them is replayed exactly only at the
+// resolution it was recorded at (see isResolutionDependent).
+//
+// Recording gives up on DCT images drawn from XObjects, because the
+// target device may decode them at a reduced resolution (see
+// SplashOutputDev::setReducedImageDecode), which is both faster and
+// smaller than keeping their full resolution samples.  Such pages
+// should be drawn directly.
+//
+// Replay reproduces the calls Gfx would make on a device which draws
+// text with drawChar() and does not look at the current text position
+// in the state -- e.g., SplashOutputDev.
+class DisplayListOutputDev: public OutputDev {
+public:
+
+  // Create an empty list.  Recording gives up (see isOk) when the
+  // decoded image data would exceed <maxImageBytesA>.
+  DisplayListOutputDev(Gulong maxImageBytesA = displayListDefaultMaxImageBytes);
+
+  // Destructor.
+  virtual ~DisplayListOutputDev();
+
+  // Record <page> at <hDPI> x <vDPI>.  Any previously recorded
+  // operations are dropped.
+  void record(const Page *page, const Catalog *catalog,
+	      double hDPI = 72, double vDPI = 72);
+
+  // Check if the last recording was complete and can be replayed.
+  // Recording gives up on DCT images (see above) and when the decoded
+  // image data would exceed the limit given to the constructor.
+  GBool isOk() { return ok; }
+
+  // Check if the last recording contains fills whose number depends
+  // on the resolution, i.e., axial or radial shadings.
+  GBool isResolutionDependent() { return resolutionDependent; }
+
+  // Resolution of the last recording.
+  double getHDPI() { return recHDPI; }
+  double getVDPI() { return recVDPI; }
+
+  // Number of recorded operations.
+  int getLength() { return length; }
+
+  // Approximate memory used by the list, in bytes.
+  Gulong getMemoryUsage();
+
+  // Replay the list on <out>.  The parameters have the same meaning as
+  // for Page::displaySlice; <page> must be the recorded page.
+  void replay(OutputDev *out, const Page *page, double hDPI, double vDPI,
+	      int rotate, GBool useMediaBox, GBool crop,
+	      int sliceX, int sliceY, int sliceW, int sliceH,
+	      GBool (*abortCheckCbk)(void *data) = NULL,
+	      void *abortCheckCbkData = NULL);
+
+  //----- get info about output device
+
+  // Does this device use upside-down coordinates?
+  // (Upside-down means (0,0) is the top left corner of the page.)
+  virtual GBool upsideDown()const { return gTrue; }
+
+  // Does this device use drawChar() or drawString()?
+  virtual GBool useDrawChar()const { return gTrue; }
+
+  // Does this device use beginType3Char/endType3Char?  Otherwise,
+  // text in Type 3 fonts will be drawn with drawChar/drawString.
+  virtual GBool interpretType3Chars()const { return gTrue; }
+
+  // Shaded fills are only noted (see isResolutionDependent) and then
+  // left to Gfx.
+  virtual GBool useShadedFills()const { return gTrue; }
+
+  //----- initialization and control
+
+  // Start a page.
+  virtual void startPage(int pageNum, GfxState *state);
+
+  // End a page.
+  virtual void endPage();
+
+  //----- save/restore graphics state
+  virtual void saveState(GfxState *state);
+  virtual void restoreState(GfxState *state);
+
+  //----- update graphics state
+  virtual void updateAll(GfxState *state);
+  virtual void updateCTM(GfxState *state, double m11, double m12,
+			 double m21, double m22, double m31, double m32);
+  virtual void updateLineDash(GfxState *state);
+  virtual void updateFlatness(GfxState *state);
+  virtual void updateLineJoin(GfxState *state);
+  virtual void updateLineCap(GfxState *state);
+  virtual void updateMiterLimit(GfxState *state);
+  virtual void updateLineWidth(GfxState *state);
+  virtual void updateStrokeAdjust(GfxState *state);
+  virtual void updateFillColorSpace(GfxState *state);
+  virtual void updateStrokeColorSpace(GfxState *state);
+  virtual void updateFillColor(GfxState *state);
+  virtual void updateStrokeColor(GfxState *state);
+  virtual void updateBlendMode(GfxState *state);
+  virtual void updateFillOpacity(GfxState *state);
+  virtual void updateStrokeOpacity(GfxState *state);
+  virtual void updateFillOverprint(GfxState *state);
+  virtual void updateStrokeOverprint(GfxState *state);
+  virtual void updateTransfer(GfxState *state);
+
+  //----- update text state
+  virtual void updateFont(GfxState *state);
+  virtual void updateTextMat(GfxState *state);
+  virtual void updateCharSpace(GfxState *state);
+  virtual void updateRender(GfxState *state);
+  virtual void updateRise(GfxState *state);
+  virtual void updateWordSpace(GfxState *state);
+  virtual void updateHorizScaling(GfxState *state);
+  virtual void updateTextPos(GfxState *state);
+  virtual void updateTextShift(GfxState *state, double shift);
+
+  //----- path painting
+  virtual void stroke(GfxState *state);
+  virtual void fill(GfxState *state);
+  virtual void eoFill(GfxState *state);
+
+  //----- path clipping
+  virtual void clip(GfxState *state);
+  virtual void eoClip(GfxState *state);
+  virtual void clipToStrokePath(GfxState *state);
+
+  //----- text drawing
+  virtual void beginStringOp(GfxState *state);
+  virtual void endStringOp(GfxState *state);
+  virtual void beginString(GfxState *state, const GString *s);
+  virtual void endString(GfxState *state);
+  virtual void drawChar(GfxState *state, double x, double y,
+			double dx, double dy,
+			double originX, double originY,
+			CharCode code, int nBytes, const Unicode *u, int uLen);
+  virtual GBool beginType3Char(GfxState *state, double x, double y,
+			       double dx, double dy,
+			       CharCode code, Unicode *u, int uLen);
+  virtual void endType3Char(GfxState *state);
+  virtual void endTextObject(GfxState *state);
+
+  //----- image drawing
+  virtual void drawImageMask(GfxState *state, Object *ref, Stream *str,
+			     int width, int height, GBool invert,
+			     GBool inlineImg);
+  virtual void drawImage(GfxState *state, Object *ref, Stream *str,
+			 int width, int height, GfxImageColorMap *colorMap,
+			 int *maskColors, GBool inlineImg);
+  virtual void drawMaskedImage(GfxState *state, Object *ref, Stream *str,
+			       int width, int height,
+			       GfxImageColorMap *colorMap,
+			       Stream *maskStr, int maskWidth, int maskHeight,
+			       GBool maskInvert);
+  virtual void drawSoftMaskedImage(GfxState *state, Object *ref, Stream *str,
+				   int width, int height,
+				   GfxImageColorMap *colorMap,
+				   Stream *maskStr,
+				   int maskWidth, int maskHeight,
+				   GfxImageColorMap *maskColorMap);
+
+  //----- Type 3 font operators
+  virtual void type3D0(GfxState *state, double wx, double wy);
+  virtual void type3D1(GfxState *state, double wx, double wy,
+		       double llx, double lly, double urx, double ury);
+
+  //----- transparency groups and soft masks
+  virtual void beginTransparencyGroup(GfxState *state, const double *bbox,
+				      const GfxColorSpace *blendingColorSpace,
+				      GBool isolated, GBool knockout,
+				      GBool forSoftMask);
+  virtual void endTransparencyGroup(GfxState *state);
+  virtual void paintTransparencyGroup(GfxState *state, const double *bbox);
+  virtual void setSoftMask(GfxState *state, const double *bbox, GBool alpha,
+			   Function *transferFunc,
+			   const GfxColor *backdropColor);
+  virtual void clearSoftMask(GfxState *state);
+
+  //----- shaded fills
+  virtual GBool axialShadedFill(GfxState *state, GfxAxialShading *shading);
+  virtual GBool radialShadedFill(GfxState *state, GfxRadialShading *shading);
+
+  //----- anti-aliasing
+  // Gfx turns vector anti-aliasing off around shadings; the list
+  // claims to anti-alias so that these switches get recorded.
+  virtual GBool getVectorAntialias() { return gTrue; }
+  virtual void setVectorAntialias(GBool vaa);
+
+private:
+
+  void clear();
+  static GBool abortCheck(void *data);
+  DisplayListOp *addOp(int kind, GfxState *state);
+  DisplayListOp *addUpdate(int kind, GfxState *state);
+  int snapshot(GfxState *state);
+  DisplayListImage *readImage(Object *ref, Stream *str, Guint size);
+
+  DisplayListOp *ops;		// recorded operations
+  int length;			// number of operations
+  int size;			// size of the ops array
+  DisplayListState *states;	// graphics state snapshots
+  int nStates;			// number of snapshots
+  int statesSize;		// size of the states array
+  GList *images;		// decoded image data [DisplayListImage]
+  GList *fonts;			// fonts referenced by snapshots [GfxFont]
+  GfxState *lastState;		// state object seen by the last call
+  GBool stateDirty;		// state changed since the last snapshot
+  int firstPending;		// first update op waiting for a snapshot
+  double baseCTM[6];		// default CTM of the recording
+  Gulong imageBytes;		// decoded image data kept
+  Gulong maxImageBytes;		// limit on imageBytes
+  double recHDPI, recVDPI;	// resolution of the recording
+  GBool resolutionDependent;	// recorded axial or radial shadings
+  GBool ok;
+};
+
+#endif
@@ -33,6 +33,14 @@ Function::Function() {
 Function::~Function() {
 }
 
+void Function::transformN(const double *in, double *out, int nPoints)const {
+  int i;
+
+  for (i = 0; i < nPoints; ++i) {
+    transform(in + i * m, out + i * n);
+  }
+}
+
 Function *Function::parse(const Object *funcObj) {
   Function *func;
   const Dict *dict;
@@ -195,6 +203,7 @@ SampledFunction::SampledFunction(const Object *funcObj, const Dict *dict) {
 
   samples = NULL;
   sBuf = NULL;
+  cacheValid = gFalse;
   ok = gFalse;
 
   //----- initialize the generic stuff
@@ -375,6 +384,22 @@ void SampledFunction::transform(const double *in, double *out)const {
   double efrac1[funcMaxInputs];
   int i, j, k, idx, t;
 
+  // check the cache -- shading fills tend to ask for the same value
+  // several times in a row
+  if (cacheValid) {
+    for (i = 0; i < m; ++i) {
+      if (in[i] != cacheIn[i]) {
+	break;
+      }
+    }
+    if (i == m) {
+      for (i = 0; i < n; ++i) {
+	out[i] = cacheOut[i];
+      }
+      return;
+    }
+  }
+
   // map input values into sample array
   for (i = 0; i < m; ++i) {
     x = (in[i] - domain[i][0]) * inputMul[i] + encode[i][0];
@@ -423,6 +448,63 @@ void SampledFunction::transform(const double *in, double *out)const {
       out[i] = range[i][1];
     }
   }
+
+  // save current result in the cache
+  for (i = 0; i < m; ++i) {
+    cacheIn[i] = in[i];
+  }
+  for (i = 0; i < n; ++i) {
+    cacheOut[i] = out[i];
+  }
+  cacheValid = gTrue;
+}
+
+void SampledFunction::transformN(const double *in, double *out,
+				 int nPoints)const {
+  double x, efrac0, efrac1, s0, s1;
+  int e0, e1, idx0, idx1, i, j;
+
+  // the generic m-linear interpolation is only needed for more than
+  // one input
+  if (m != 1) {
+    Function::transformN(in, out, nPoints);
+    return;
+  }
+
+  for (j = 0; j < nPoints; ++j, out += n) {
+
+    // map input value into sample array
+    x = (in[j] - domain[0][0]) * inputMul[0] + encode[0][0];
+    if (x < 0) {
+      x = 0;
+    } else if (x > sampleSize[0] - 1) {
+      x = sampleSize[0] - 1;
+    }
+    e0 = (int)x;
+    if ((e1 = e0 + 1) >= sampleSize[0]) {
+      // this happens if in[j] = domain[0][1]
+      e1 = e0;
+    }
+    efrac1 = x - e0;
+    efrac0 = 1 - efrac1;
+
+    // for each output, do linear interpolation
+    for (i = 0; i < n; ++i) {
+      idx0 = i + idxMul[0] * e0;
+      idx1 = i + idxMul[0] * e1;
+      s0 = (idx0 >= 0 && idx0 < nSamples) ? samples[idx0] : 0;
+      s1 = (idx1 >= 0 && idx1 < nSamples) ? samples[idx1] : 0;
+
+      // map output value to range
+      out[i] = (efrac0 * s0 + efrac1 * s1) * (decode[i][1] - decode[i][0]) +
+	       decode[i][0];
+      if (out[i] < range[i][0]) {
+	out[i] = range[i][0];
+      } else if (out[i] > range[i][1]) {
+	out[i] = range[i][1];
+      }
+    }
+  }
 }
 
 //------------------------------------------------------------------------
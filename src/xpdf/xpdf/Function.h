@@ -67,6 +67,10 @@ public:
   // Transform an input tuple into an output tuple.
   virtual void transform(const double *in, double *out)const = 0;
 
+  // Transform <nPoints> input tuples, stored one after another in
+  // <in>, into <nPoints> output tuples stored the same way in <out>.
+  virtual void transformN(const double *in, double *out, int nPoints)const;
+
   virtual GBool isOk()const = 0;
 
 protected:
@@ -108,6 +112,7 @@ public:
   virtual Function *copy()const { return new SampledFunction(this); }
   virtual int getType()const { return 0; }
   virtual void transform(const double *in, double *out)const;
+  virtual void transformN(const double *in, double *out, int nPoints)const;
   virtual GBool isOk()const { return ok; }
 
   int getSampleSize(int i) { return sampleSize[i]; }
@@ -133,6 +138,11 @@ private:
   double *samples;		// the samples
   int nSamples;			// size of the samples array
   double *sBuf;			// buffer for the transform function
+  mutable double		// last input value
+    cacheIn[funcMaxInputs];
+  mutable double		// last output value
+    cacheOut[funcMaxOutputs];
+  mutable GBool cacheValid;	// set if cacheIn/cacheOut are valid
   GBool ok;
 };
 
@@ -2124,11 +2124,14 @@ void Gfx::doAxialShFill(GfxAxialShading *shading) {
   double tMin, tMax, t, tx, ty;
   double s[4], sMin, sMax, tmp;
   double ux0, uy0, ux1, uy1, vx0, vy0, vx1, vy1;
-  double t0, t1, tt;
+  double t0, t1;
   double ta[axialMaxSplits + 1];
   int next[axialMaxSplits + 1];
+  double lutT[axialMaxSplits + 1];
+  GfxColor lut[axialMaxSplits + 1];
+  double ddx, ddy, len;
   GfxColor color0, color1;
-  int nComps;
+  int nComps, nSplits;
   int i, j, k, kk;
 
   if (out->useShadedFills() &&
@@ -2210,24 +2213,41 @@ void Gfx::doAxialShFill(GfxAxialShading *shading) {
   // difference across a region is small enough, and then the region
   // is painted with a single color.
 
+  // there is no point in splitting the t axis into regions smaller
+  // than a device pixel, so limit the number of splits by the device
+  // space length of the [tMin, tMax] part of the axis
+  state->transformDelta((tMax - tMin) * dx, (tMax - tMin) * dy, &ddx, &ddy);
+  len = sqrt(ddx * ddx + ddy * ddy);
+  nSplits = 2;
+  while (nSplits < axialMaxSplits && nSplits < len) {
+    nSplits *= 2;
+  }
+
+  // all the split points lie on a regular grid, so compute the colors
+  // of all of them at once
+  for (k = 0; k <= nSplits; ++k) {
+    t = tMin + ((double)k / (double)nSplits) * (tMax - tMin);
+    if (t < 0) {
+      lutT[k] = t0;
+    } else if (t > 1) {
+      lutT[k] = t1;
+    } else {
+      lutT[k] = t0 + (t1 - t0) * t;
+    }
+  }
+  shading->getColors(lutT, lut, nSplits + 1);
+
   // set up: require at least one split to avoid problems when the two
   // ends of the t axis have the same color
   nComps = shading->getColorSpace()->getNComps();
   ta[0] = tMin;
-  next[0] = axialMaxSplits / 2;
-  ta[axialMaxSplits / 2] = 0.5 * (tMin + tMax);
-  next[axialMaxSplits / 2] = axialMaxSplits;
-  ta[axialMaxSplits] = tMax;
-
-  // compute the color at t = tMin
-  if (tMin < 0) {
-    tt = t0;
-  } else if (tMin > 1) {
-    tt = t1;
-  } else {
-    tt = t0 + (t1 - t0) * tMin;
-  }
-  shading->getColor(tt, &color0);
+  next[0] = nSplits / 2;
+  ta[nSplits / 2] = 0.5 * (tMin + tMax);
+  next[nSplits / 2] = nSplits;
+  ta[nSplits] = tMax;
+
+  // the color at t = tMin
+  color0 = lut[0];
 
   // compute the coordinates of the point on the t axis at t = tMin;
   // then compute the intersection of the perpendicular line with the
@@ -2267,22 +2287,14 @@ void Gfx::doAxialShFill(GfxAxialShading *shading) {
   vy0 = ty + sMax * dx;
 
   i = 0;
-  while (i < axialMaxSplits) {
+  while (i < nSplits) {
 
     // bisect until color difference is small enough or we hit the
     // bisection limit
     j = next[i];
     while (j > i + 1) {
-      if (ta[j] < 0) {
-	tt = t0;
-      } else if (ta[j] > 1) {
-	tt = t1;
-      } else {
-	tt = t0 + (t1 - t0) * ta[j];
-      }
-      shading->getColor(tt, &color1);
       for (k = 0; k < nComps; ++k) {
-	if (abs(color1.c[k] - color0.c[k]) > axialColorDelta) {
+	if (abs(lut[j].c[k] - color0.c[k]) > axialColorDelta) {
 	  break;
 	}
       }
@@ -2295,6 +2307,7 @@ void Gfx::doAxialShFill(GfxAxialShading *shading) {
       next[k] = j;
       j = k;
     }
+    color1 = lut[j];
 
     // use the average of the colors of the two sides of the region
     for (k = 0; k < nComps; ++k) {
@@ -2373,6 +2386,10 @@ void Gfx::doRadialShFill(GfxRadialShading *shading) {
   int ia, ib, k, n;
   const double *ctm;
   double theta, alpha, angle, t;
+  double lutT[radialMaxSplits + 1];
+  GfxColor lut[radialMaxSplits + 1];
+  double len, scale;
+  int nSplits;
 
   if (out->useShadedFills() &&
       out->radialShadedFill(state, shading)) {
@@ -2489,6 +2506,7 @@ void Gfx::doRadialShFill(GfxRadialShading *shading) {
   if (fabs(ctm[3]) > t) {
     t = fabs(ctm[3]);
   }
+  scale = t;
   if (r0 > r1) {
     t *= r0;
   } else {
@@ -2505,6 +2523,32 @@ void Gfx::doRadialShFill(GfxRadialShading *shading) {
     }
   }
 
+  // there is no point in splitting the s range into steps smaller
+  // than a device pixel, so limit the number of splits by the (upper
+  // bound of the) device space distance the circles move and grow
+  // over the [sMin, sMax] range
+  len = (sqrt((x1 - x0) * (x1 - x0) + (y1 - y0) * (y1 - y0)) +
+	 fabs(r1 - r0)) * (sMax - sMin) * scale;
+  nSplits = 2;
+  while (nSplits < radialMaxSplits && nSplits < len) {
+    nSplits *= 2;
+  }
+
+  // all the split points lie on a regular grid, so compute the colors
+  // of all of them at once
+  for (k = 0; k <= nSplits; ++k) {
+    tb = t0 + (sMin + ((double)k / (double)nSplits) * (sMax - sMin)) *
+	      (t1 - t0);
+    if (tb < t0) {
+      lutT[k] = t0;
+    } else if (tb > t1) {
+      lutT[k] = t1;
+    } else {
+      lutT[k] = tb;
+    }
+  }
+  shading->getColors(lutT, lut, nSplits + 1);
+
   // setup for the start circle
   ia = 0;
   sa = sMin;
@@ -2512,16 +2556,10 @@ void Gfx::doRadialShFill(GfxRadialShading *shading) {
   xa = x0 + sa * (x1 - x0);
   ya = y0 + sa * (y1 - y0);
   ra = r0 + sa * (r1 - r0);
-  if (ta < t0) {
-    shading->getColor(t0, &colorA);
-  } else if (ta > t1) {
-    shading->getColor(t1, &colorA);
-  } else {
-    shading->getColor(ta, &colorA);
-  }
+  colorA = lut[0];
 
   // fill the circles
-  while (ia < radialMaxSplits) {
+  while (ia < nSplits) {
 
     // go as far along the t axis (toward t1) as we can, such that the
     // color difference is within the tolerance (radialColorDelta) --
@@ -2529,35 +2567,23 @@ void Gfx::doRadialShFill(GfxRadialShading *shading) {
     // limited to radialMaxSplits points along the t axis; require at
     // least one split to avoid problems when the innermost and
     // outermost colors are the same
-    ib = radialMaxSplits;
+    ib = nSplits;
     sb = sMax;
     tb = t0 + sb * (t1 - t0);
-    if (tb < t0) {
-      shading->getColor(t0, &colorB);
-    } else if (tb > t1) {
-      shading->getColor(t1, &colorB);
-    } else {
-      shading->getColor(tb, &colorB);
-    }
+    colorB = lut[ib];
     while (ib - ia > 1) {
       for (k = 0; k < nComps; ++k) {
 	if (abs(colorB.c[k] - colorA.c[k]) > radialColorDelta) {
 	  break;
 	}
       }
-      if (k == nComps && ib < radialMaxSplits) {
+      if (k == nComps && ib < nSplits) {
 	break;
       }
       ib = (ia + ib) / 2;
-      sb = sMin + ((double)ib / (double)radialMaxSplits) * (sMax - sMin);
+      sb = sMin + ((double)ib / (double)nSplits) * (sMax - sMin);
       tb = t0 + sb * (t1 - t0);
-      if (tb < t0) {
-	shading->getColor(t0, &colorB);
-      } else if (tb > t1) {
-	shading->getColor(t1, &colorB);
-      } else {
-	shading->getColor(tb, &colorB);
-      }
+      colorB = lut[ib];
     }
 
     // compute center and radius of the circle
@@ -20,6 +20,10 @@
 #include "xpdf/Object.h"
 #include "xpdf/CharTypes.h"
 
+#if MULTITHREADED
+#include "goo/GMutex.h"
+#endif
+
 class Dict;
 class CMap;
 class CharCodeToUnicode;
@@ -95,6 +99,11 @@ public:
 
   virtual ~GfxFont();
 
+  // Reference counting.  The font is deleted when the last reference
+  // is dropped; GfxFontDict holds the initial one.
+  void incRefCnt();
+  void decRefCnt();
+
   GBool isOk()const { return ok; }
 
   // Get font tag.
@@ -190,6 +199,10 @@ protected:
   double missingWidth;		// "default" width
   double ascent;		// max height above baseline
   double descent;		// max depth below baseline
+  int refCnt;
+#if MULTITHREADED
+  GMutex mutex;
+#endif
   GBool ok;
 };
 
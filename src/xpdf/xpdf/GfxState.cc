@@ -1909,6 +1909,47 @@ void GfxFunctionShading::getColor(double x, double y, GfxColor *color)const {
   }
 }
 
+// Compute the colors of an axial or radial shading for <nColors>
+// values of t at once, so that each function is evaluated by a single
+// batch transformN() call.
+static void getUnivariateShadingColors(Function *const *funcs, int nFuncs,
+				       const double *t,
+				       GfxColor *colors, int nColors) {
+  double in[funcMaxInputs];
+  double *out;
+  int nOut, i, j, k;
+
+  for (j = 0; j < nColors; ++j) {
+    for (k = 0; k < gfxColorMaxComps; ++k) {
+      colors[j].c[k] = 0;
+    }
+  }
+
+  // NB: there can be one function with n outputs or n functions with
+  // one output each (where n = number of color components)
+  for (i = 0; i < nFuncs; ++i) {
+    nOut = funcs[i]->getOutputSize();
+    out = (double *)gmallocn(nColors, nOut * sizeof(double));
+    if (funcs[i]->getInputSize() == 1) {
+      funcs[i]->transformN(t, out, nColors);
+    } else {
+      for (k = 0; k < funcMaxInputs; ++k) {
+	in[k] = 0;
+      }
+      for (j = 0; j < nColors; ++j) {
+	in[0] = t[j];
+	funcs[i]->transform(in, out + j * nOut);
+      }
+    }
+    for (j = 0; j < nColors; ++j) {
+      for (k = 0; k < nOut && i + k < gfxColorMaxComps; ++k) {
+	colors[j].c[i + k] = dblToCol(out[j * nOut + k]);
+      }
+    }
+    gfree(out);
+  }
+}
+
 //------------------------------------------------------------------------
 // GfxAxialShading
 //------------------------------------------------------------------------
@@ -2069,6 +2110,11 @@ void GfxAxialShading::getColor(double t, GfxColor *color)const {
   }
 }
 
+void GfxAxialShading::getColors(const double *t, GfxColor *colors,
+				int nColors)const {
+  getUnivariateShadingColors(funcs, nFuncs, t, colors, nColors);
+}
+
 //------------------------------------------------------------------------
 // GfxRadialShading
 //------------------------------------------------------------------------
@@ -2237,6 +2283,11 @@ void GfxRadialShading::getColor(double t, GfxColor *color)const {
   }
 }
 
+void GfxRadialShading::getColors(const double *t, GfxColor *colors,
+				 int nColors)const {
+  getUnivariateShadingColors(funcs, nFuncs, t, colors, nColors);
+}
+
 //------------------------------------------------------------------------
 // GfxShadingBitBuf
 //------------------------------------------------------------------------
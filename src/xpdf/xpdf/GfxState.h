@@ -722,6 +722,7 @@ public:
   int getNFuncs()const { return nFuncs; }
   Function *getFunc(int i)const { return funcs[i]; }
   void getColor(double t, GfxColor *color)const;
+  void getColors(const double *t, GfxColor *colors, int nColors)const;
 
 private:
 
@@ -761,6 +762,7 @@ public:
   int getNFuncs()const { return nFuncs; }
   Function *getFunc(int i)const { return funcs[i]; }
   void getColor(double t, GfxColor *color)const;
+  void getColors(const double *t, GfxColor *colors, int nColors)const;
 
 private:
 
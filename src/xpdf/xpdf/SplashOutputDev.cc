@@ -28,6 +28,7 @@
 #include "splash/SplashPattern.h"
 #include "splash/SplashScreen.h"
 #include "splash/SplashPath.h"
+#include "splash/SplashMath.h"
 #include "splash/SplashState.h"
 #include "splash/SplashErrorCodes.h"
 #include "splash/SplashFontEngine.h"
@@ -35,6 +36,7 @@
 #include "splash/SplashFontFile.h"
 #include "splash/SplashFontFileID.h"
 #include "splash/Splash.h"
+#include "splash/SplashDisplayList.h"
 #include "xpdf/SplashOutputDev.h"
 
 #ifdef VMS
@@ -590,6 +592,8 @@ SplashOutputDev::SplashOutputDev(SplashColorMode colorModeA,
 		      colorMode != splashModeMono1;
   setupScreenParams(72.0, 72.0);
   reverseVideo = reverseVideoA;
+  reducedImageDecode = gTrue;
+  renderThreads = 1;
   splashColorCopy(paperColor, paperColorA);
 
   xref = NULL;
@@ -768,9 +772,13 @@ void SplashOutputDev::startPage(int pageNum, GfxState *state) {
   // apparently hardwires it to true
   splash->setStrokeAdjust(globalParams->getStrokeAdjust());
   splash->clear(paperColor, 0);
+  if (renderThreads > 1 && h >= 2 * splashDisplayListMinBandHeight) {
+    splash->startBandRendering(renderThreads);
+  }
 }
 
 void SplashOutputDev::endPage() {
+  splash->finishBandRendering();
   if (colorMode != splashModeMono1) {
     splash->compositeBackground(paperColor);
   }
@@ -1975,7 +1983,7 @@ void SplashOutputDev::drawImage(GfxState *state, Object *ref, Stream *str,
   GfxCMYK cmyk;
 #endif
   Guchar pix;
-  int n, i;
+  int n, i, reduction;
 
   ctm = state->getCTM();
   mat[0] = ctm[0];
@@ -1985,6 +1993,15 @@ void SplashOutputDev::drawImage(GfxState *state, Object *ref, Stream *str,
   mat[4] = ctm[2] + ctm[4];
   mat[5] = ctm[3] + ctm[5];
 
+  // let the stream decode at reduced resolution if the image is drawn
+  // much smaller than its native size; the image matrix maps the unit
+  // square, so it doesn't depend on the image size
+  if (!inlineImg) {
+    reduction = str->reduceResolution(getImageReduction(mat, width, height));
+    width = (width + reduction - 1) / reduction;
+    height = (height + reduction - 1) / reduction;
+  }
+
   imgData.imgStr = new ImageStream(str, width,
 				   colorMap->getNumPixelComps(),
 				   colorMap->getBits());
@@ -2059,6 +2076,28 @@ void SplashOutputDev::drawImage(GfxState *state, Object *ref, Stream *str,
   str->close();
 }
 
+// Returns the (power of two) factor by which an image of size <width>
+// x <height> can be reduced while it still has at least as many pixels
+// as the device area covered by the image matrix <mat>.
+int SplashOutputDev::getImageReduction(const SplashCoord *mat,
+				       int width, int height) {
+  double scaledWidth, scaledHeight;
+  int reduction;
+
+  if (!reducedImageDecode) {
+    return 1;
+  }
+  scaledWidth = splashSqrt(mat[0] * mat[0] + mat[1] * mat[1]);
+  scaledHeight = splashSqrt(mat[2] * mat[2] + mat[3] * mat[3]);
+  reduction = 1;
+  while (reduction < 8 &&
+	 width / (2 * reduction) >= scaledWidth &&
+	 height / (2 * reduction) >= scaledHeight) {
+    reduction *= 2;
+  }
+  return reduction;
+}
+
 struct SplashOutMaskedImageData {
   ImageStream *imgStr;
   GfxImageColorMap *colorMap;
@@ -2436,6 +2475,9 @@ void SplashOutputDev::beginTransparencyGroup(GfxState *state, const double *bbox
   double xMin, yMin, xMax, yMax, x, y;
   int tx, ty, w, h;
 
+  // the group backdrop is read from the bitmap
+  splash->finishBandRendering();
+
   // transform the bbox
   state->transform(bbox[0], bbox[1], &x, &y);
   xMin = xMax = x;
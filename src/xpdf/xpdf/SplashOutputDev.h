@@ -191,6 +191,19 @@ public:
 
   SplashFont *getCurrentFont() { return font; }
 
+  // Enable/disable decoding of images at reduced resolution when they
+  // are drawn (much) smaller than their native size (e.g. thumbnails).
+  GBool getReducedImageDecode() { return reducedImageDecode; }
+  void setReducedImageDecode(GBool reducedImageDecodeA)
+    { reducedImageDecode = reducedImageDecodeA; }
+
+  // Set the number of threads used to rasterize a page.  With more
+  // than one thread, each page is recorded first and then rasterized
+  // in horizontal bands in parallel (see Splash::startBandRendering).
+  int getRenderThreads() { return renderThreads; }
+  void setRenderThreads(int renderThreadsA)
+    { renderThreads = renderThreadsA; }
+
 #if 1 //~tmp: turn off anti-aliasing temporarily
   virtual GBool getVectorAntialias();
   virtual void setVectorAntialias(GBool vaa);
@@ -215,6 +228,7 @@ private:
 			     Guchar *alphaLine);
   static GBool maskedImageSrc(void *data, SplashColorPtr line,
 			      Guchar *alphaLine);
+  int getImageReduction(const SplashCoord *mat, int width, int height);
 
   SplashColorMode colorMode;
   int bitmapRowPad;
@@ -222,6 +236,8 @@ private:
   GBool allowAntialias;
   GBool vectorAntialias;
   GBool reverseVideo;		// reverse video mode
+  GBool reducedImageDecode;	// allow reduced resolution image decoding
+  int renderThreads;		// threads for band rendering
   SplashColor paperColor;	// paper color
   SplashScreenParams screenParams;
 
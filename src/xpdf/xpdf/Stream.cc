@@ -2149,6 +2149,8 @@ DCTStream::DCTStream(Stream *strA, GBool colorXformA):
   colorXform = colorXformA;
   progressive = interleaved = gFalse;
   width = height = 0;
+  reduction = 1;
+  outWidth = outHeight = 0;
   mcuWidth = mcuHeight = 0;
   numComps = 0;
   comp = 0;
@@ -2194,6 +2196,7 @@ void DCTStream::reset() {
 
   progressive = interleaved = gFalse;
   width = height = 0;
+  outWidth = outHeight = 0;
   numComps = 0;
   numQuantTables = 0;
   numDCHuffTables = 0;
@@ -2203,10 +2206,14 @@ void DCTStream::reset() {
   restartInterval = 0;
 
   if (!readHeader()) {
-    y = height;
+    y = outHeight;
     return;
   }
 
+  // compute output image size
+  outWidth = (width + reduction - 1) / reduction;
+  outHeight = (height + reduction - 1) / reduction;
+
   // compute MCU size
   if (numComps == 1) {
     compInfo[0].hSample = compInfo[0].vSample = 1;
@@ -2248,7 +2255,7 @@ void DCTStream::reset() {
     if (bufWidth <= 0 || bufHeight <= 0 ||
 	bufWidth > INT_MAX / bufWidth / (int)sizeof(int)) {
       error(getPos(), "Invalid image size in DCT stream");
-      y = height;
+      y = outHeight;
       return;
     }
     for (i = 0; i < numComps; ++i) {
@@ -2306,17 +2313,31 @@ void DCTStream::close() {
   FilterStream::close();
 }
 
+int DCTStream::reduceResolution(int factor) {
+  // only power of two factors up to the data unit size are supported,
+  // so that a reduced sample never spans two MCU rows
+  reduction = 1;
+  while (reduction < 8 && 2 * reduction <= factor) {
+    reduction *= 2;
+  }
+  return reduction;
+}
+
 int DCTStream::getChar() {
   int c;
 
-  if (y >= height) {
+  if (y >= outHeight) {
     return EOF;
   }
   if (progressive || !interleaved) {
-    c = frameBuf[comp][y * bufWidth + x];
+    if (reduction > 1) {
+      c = getReducedSample();
+    } else {
+      c = frameBuf[comp][y * bufWidth + x];
+    }
     if (++comp == numComps) {
       comp = 0;
-      if (++x == width) {
+      if (++x == outWidth) {
 	x = 0;
 	++y;
       }
@@ -2324,21 +2345,25 @@ int DCTStream::getChar() {
   } else {
     if (dy >= mcuHeight) {
       if (!readMCURow()) {
-	y = height;
+	y = outHeight;
 	return EOF;
       }
       comp = 0;
       x = 0;
       dy = 0;
     }
-    c = rowBuf[comp][dy][x];
+    if (reduction > 1) {
+      c = getReducedSample();
+    } else {
+      c = rowBuf[comp][dy][x];
+    }
     if (++comp == numComps) {
       comp = 0;
-      if (++x == width) {
+      if (++x == outWidth) {
 	x = 0;
 	++y;
-	++dy;
-	if (y == height) {
+	dy += reduction;
+	if (y == outHeight) {
 	  readTrailer();
 	}
       }
@@ -2348,25 +2373,68 @@ int DCTStream::getChar() {
 }
 
 int DCTStream::lookChar() {
-  if (y >= height) {
+  if (y >= outHeight) {
     return EOF;
   }
   if (progressive || !interleaved) {
+    if (reduction > 1) {
+      return getReducedSample();
+    }
     return frameBuf[comp][y * bufWidth + x];
   } else {
     if (dy >= mcuHeight) {
       if (!readMCURow()) {
-	y = height;
+	y = outHeight;
 	return EOF;
       }
       comp = 0;
       x = 0;
       dy = 0;
     }
+    if (reduction > 1) {
+      return getReducedSample();
+    }
     return rowBuf[comp][dy][x];
   }
 }
 
+// Compute the current output sample of a reduced resolution image --
+// this is the average of the <reduction> x <reduction> block of full
+// resolution samples (clipped to the image size) which it covers.
+int DCTStream::getReducedSample() {
+  int *p1;
+  Guchar *p2;
+  int x0, y0, nx, ny, x1, y1, sum;
+
+  x0 = x * reduction;
+  y0 = y * reduction;
+  nx = width - x0;
+  if (nx > reduction) {
+    nx = reduction;
+  }
+  ny = height - y0;
+  if (ny > reduction) {
+    ny = reduction;
+  }
+  sum = 0;
+  if (progressive || !interleaved) {
+    for (y1 = 0; y1 < ny; ++y1) {
+      p1 = &frameBuf[comp][(y0 + y1) * bufWidth + x0];
+      for (x1 = 0; x1 < nx; ++x1) {
+	sum += p1[x1];
+      }
+    }
+  } else {
+    for (y1 = 0; y1 < ny; ++y1) {
+      p2 = &rowBuf[comp][dy + y1][x0];
+      for (x1 = 0; x1 < nx; ++x1) {
+	sum += p2[x1];
+      }
+    }
+  }
+  return (sum + (nx * ny) / 2) / (nx * ny);
+}
+
 void DCTStream::restart() {
   int i;
 
@@ -2418,8 +2486,13 @@ GBool DCTStream::readMCURow() {
 			    data1)) {
 	    return gFalse;
 	  }
-	  transformDataUnit(quantTables[compInfo[cc].quantTable],
-			    data1, data2);
+	  if (reduction == 8 && hSub == 1 && vSub == 1) {
+	    transformDataUnitDC(quantTables[compInfo[cc].quantTable],
+				data1, data2);
+	  } else {
+	    transformDataUnit(quantTables[compInfo[cc].quantTable],
+			      data1, data2);
+	  }
 	  if (hSub == 1 && vSub == 1) {
 	    for (y3 = 0, i = 0; y3 < 8; ++y3, i += 8) {
 	      p1 = &rowBuf[cc][y2+y3][x1+x2];
@@ -2818,7 +2891,11 @@ void DCTStream::decodeImage() {
 	    }
 
 	    // transform
-	    transformDataUnit(quantTable, dataIn, dataOut);
+	    if (reduction == 8 && hSub == 1 && vSub == 1) {
+	      transformDataUnitDC(quantTable, dataIn, dataOut);
+	    } else {
+	      transformDataUnit(quantTable, dataIn, dataOut);
+	    }
 
 	    // store back into frameBuf, doing replication for
 	    // subsampled components
@@ -3076,6 +3153,24 @@ void DCTStream::transformDataUnit(Gushort *quantTable,
   }
 }
 
+// Transform one data unit using only its DC coefficient.  This is
+// what transformDataUnit() computes for a data unit with all AC
+// coefficients zero, i.e. (approximately) the average of the data
+// unit, which is all we need when decoding a component that isn't
+// subsampled at 1/8 resolution.
+void DCTStream::transformDataUnitDC(Gushort *quantTable,
+				    int dataIn[64], Guchar dataOut[64]) {
+  Guchar c;
+  int t, i;
+
+  t = (dctSqrt2 * (dataIn[0] * quantTable[0]) + 512) >> 10;
+  t = (dctSqrt2 * t + 8192) >> 14;
+  c = dctClip[dctClipOffset + 128 + ((t + 8) >> 4)];
+  for (i = 0; i < 64; ++i) {
+    dataOut[i] = c;
+  }
+}
+
 int DCTStream::readHuffSym(DCTHuffTable *table) {
   Gushort code;
   int bit;
@@ -138,6 +138,12 @@ public:
   virtual void getImageParams(UNUSED_PARAM int *bitsPerComponent,
 			      UNUSED_PARAM StreamColorSpaceMode *csMode) {}
 
+  // Ask an image stream to decode at a reduced resolution, i.e. to
+  // divide both image dimensions by <factor> (rounding up).  This must
+  // be called before reset().  Returns the factor which will actually
+  // be used -- 1 if the stream can't decode at reduced resolution.
+  virtual int reduceResolution(UNUSED_PARAM int factor) { return 1; }
+
   // Return the next stream in the "stack".
   virtual Stream *getNextStream() { return NULL; }
 
@@ -645,6 +651,7 @@ public:
   virtual int lookChar();
   virtual GString *getPSFilter(int psLevel, const char *indent)const;
   virtual GBool isBinary(GBool last = gTrue)const;
+  virtual int reduceResolution(int factor);
   Stream *getRawStream() { return str; }
 
 private:
@@ -652,6 +659,8 @@ private:
   GBool progressive;		// set if in progressive mode
   GBool interleaved;		// set if in interleaved mode
   int width, height;		// image size
+  int reduction;		// reduction factor (1, 2, 4 or 8)
+  int outWidth, outHeight;	// size of the (reduced) output image
   int mcuWidth, mcuHeight;	// size of min coding unit, in data units
   int bufWidth, bufHeight;	// frameBuf size
   DCTCompInfo compInfo[4];	// info for each component
@@ -690,6 +699,9 @@ private:
   void decodeImage();
   void transformDataUnit(Gushort *quantTable,
 			 int dataIn[64], Guchar dataOut[64]);
+  void transformDataUnitDC(Gushort *quantTable,
+			   int dataIn[64], Guchar dataOut[64]);
+  int getReducedSample();
   int readHuffSym(DCTHuffTable *table);
   int readAmp(int size);
   int readBit();
@@ -336,6 +336,75 @@ XRef::~XRef() {
   destroyInternals();
 }
 
+GBool XRef::readXRefSection(Guint pos, XRefEntry **entriesA, int *sizeA,
+		Guint *maxObjA, Object *trailer, Guint *prevPos, GBool *hasPrev)
+{
+  // read the section into empty structures and put the current ones back
+  XRefEntry *savedEntries = entries;
+  int savedSize = size;
+  Guint savedMaxObj = maxObj;
+  Object savedTrailer = trailerDict;
+  GBool savedOk = ok;
+
+  entries = NULL;
+  size = 0;
+  maxObj = 0;
+  trailerDict = Object();
+  ok = gTrue;
+
+  *prevPos = pos;
+  *hasPrev = readXRef(prevPos);
+  GBool result = ok && !trailerDict.isNone();
+
+  *entriesA = entries;
+  *sizeA = size;
+  *maxObjA = maxObj;
+  *trailer = trailerDict;
+
+  entries = savedEntries;
+  size = savedSize;
+  maxObj = savedMaxObj;
+  trailerDict = savedTrailer;
+  ok = savedOk;
+
+  if (!result) {
+    gfree(*entriesA);
+    *entriesA = NULL;
+    *sizeA = 0;
+    trailer->free();
+  }
+  return result;
+}
+
+void XRef::switchInternals(int sizeA, Guint maxObjA, const Object *trailer)
+{
+  setErrCode(errNone);
+  size = sizeA;
+  maxObj = maxObjA;
+  if (streamEnds) {
+    gfree(streamEnds);
+    streamEnds = NULL;
+  }
+  streamEndsLen = 0;
+  if (objStr) {
+    delete objStr;
+    objStr = NULL;
+  }
+
+  useEncrypt = gFalse;
+  permFlags = defPermFlags;
+  ownerPasswordOk = gFalse;
+
+  // deep copy - copy would share the Dict with the caller which is not
+  // supposed to see changes of the current trailer
+  trailerDict.free();
+  Object *clone = trailer->clone();
+  trailerDict = *clone;
+  gfree(clone);
+  Dict *d = (Dict *)trailerDict.getDict();
+  d->setXRef(this);
+}
+
 // Read the 'startxref' position.
 Guint XRef::getStartXref() {
   char buf[xrefSearchSize+1];
@@ -187,6 +187,16 @@ protected:
   void initInternals(Guint pos);
   // destroy all internal structures which may be reinitialized
   void destroyInternals();
+  // reads single xref section (with its hybrid XRefStm section) at pos
+  // without touching the current table - entries which are not in the
+  // section have 0xffffffff offset. Caller has to gfree *entriesA and free
+  // the trailer. Returns gFalse if the section is malformed.
+  GBool readXRefSection(Guint pos, XRefEntry **entriesA, int *sizeA,
+		  Guint *maxObjA, Object *trailer, Guint *prevPos, GBool *hasPrev);
+  // switches to another already known table - entries array has to be
+  // filled by caller. Uses copy of the given trailer and resets all other
+  // internal structures the same way initInternals does.
+  void switchInternals(int sizeA, Guint maxObjA, const Object *trailer);
 
   Guint getStartXref();
   GBool readXRef(Guint *pos);
@@ -34,10 +34,11 @@ usage()
 	echo -e "\tfileN\tone or more files to use as benchmarks parameters"
 	echo 
 	echo "Script will create one directory for each benchmarks with the benchmark"
-	echo "name and _results suffix which will contain file_info and file_result"
+	echo "name and _results suffix which will contain file_info and file.json"
 	echo "files."
 	echo "The first one contains information about document, the later results from"
-	echo "the benchmarks"
+	echo "the benchmarks in JSON format. Result directories of two runs can be"
+	echo "compared by src/tests/bench/compare_runs.sh"
 	exit 1
 }
 
@@ -60,7 +61,8 @@ fi
 
 BENCH="$1"
 BENCH_SUFFIX="_results"
-ATEMPTS=3
+ATEMPTS=10
+WARMUP=1
 shift
 
 for b in $BENCH
@@ -83,11 +85,7 @@ do
 		echo -en "\t$f "
 		OUTNAME=`basename "$f"`
 		./file_info "$f" > "$OUT/${OUTNAME}_info" || continue
-		for i in `seq $ATEMPTS`
-		do
-			"./$b" "$f" >> "$OUT/${OUTNAME}${BENCH_SUFFIX}"
-			echo -n "$i "
-		done
+		"./$b" -j -w $WARMUP -r $ATEMPTS "$f" > "$OUT/${OUTNAME}.json" || echo -n "failed"
 		echo
 	done
 done